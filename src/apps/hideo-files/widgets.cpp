@@ -1,3 +1,4 @@
+#include <karm-image/thumbnail.h>
 #include <karm-kira/context-menu.h>
 #include <karm-kira/dialog.h>
 #include <karm-kira/error-page.h>
@@ -8,8 +9,10 @@
 #include <karm-ui/focus.h>
 #include <karm-ui/input.h>
 #include <karm-ui/layout.h>
+#include <karm-ui/list.h>
 #include <karm-ui/popover.h>
 #include <karm-ui/scroll.h>
+#include <karm-ui/view.h>
 #include <mdi/alert-decagram.h>
 #include <mdi/alert-outline.h>
 #include <mdi/arrow-left.h>
@@ -98,14 +101,40 @@ Ui::Child directoryContextMenu() {
     });
 }
 
-Ui::Child directorEntry(Sys::DirEntry const &entry, bool odd) {
+static constexpr isize THUMBNAIL_SIZE = 24;
+
+// Images get a thumbnail instead of an icon. It's only loaded when the entry
+// is built for the first time rather than every time the listing is, and
+// comes from the thumbnail cache once the image has been seen.
+Ui::Child directoryEntryIcon(Mime::Url const &dir, Sys::DirEntry const &entry) {
+    if (entry.type == Sys::Type::DIR)
+        return Ui::icon(Mdi::FOLDER);
+
+    auto mime = Mime::sniffSuffix(Mime::suffixOf(entry.name));
+    if (not mime or mime->type() != "image")
+        return Ui::icon(Mime::iconFor(mime.unwrapOr("file"s)));
+
+    auto url = dir;
+    url.append(entry.name);
+    return Ui::memo(hash(bytes(entry.name)), [url]() -> Ui::Child {
+        auto image = Image::loadThumbnail(url);
+        if (not image)
+            return Ui::icon(Mdi::IMAGE);
+
+        return Ui::image(image.unwrap()) |
+               Ui::cover() |
+               Ui::vhclip() |
+               Ui::pinSize(THUMBNAIL_SIZE);
+    });
+}
+
+Ui::Child directorEntry(Mime::Url const &dir, Sys::DirEntry const &entry, bool odd) {
     return Ui::button(
                Model::bind<Navigate>(entry.name),
                itemStyle(odd),
-               entry.type == Sys::Type::DIR
-                   ? Mdi::FOLDER
-                   : Mime::iconFor(Mime::sniffSuffix(Mime::suffixOf(entry.name)).unwrapOr("file"s)),
-               entry.name
+               Ui::hflow(8, Math::Align::CENTER, directoryEntryIcon(dir, entry), Ui::text(entry.name)) |
+                   Ui::insets({6, 16, 6, 12}) |
+                   Ui::minSize({Ui::UNCONSTRAINED, 36})
            ) |
            Kr::contextMenu(slot$(directoryContextMenu()));
 }
@@ -114,18 +143,25 @@ Ui::Child directoryListing(State const &s, Sys::Dir const &dir) {
     if (dir.entries().len() == 0)
         return Ui::bodyMedium(Ui::GRAY500, "This directory is empty.") | Ui::center();
 
-    Ui::Children children;
-    bool odd = true;
+    // Rows are only built when they come into view, large directories
+    // would take ages otherwise.
+    Vec<Sys::DirEntry> entries;
+    entries.ensure(dir.entries().len());
     for (auto const &entry : dir.entries()) {
         if (entry.hidden() and not s.showHidden)
             continue;
-        children.pushBack(directorEntry(entry, odd));
-        odd = !odd;
+        entries.pushBack(entry);
     }
 
-    return Ui::vflow(children) |
-           Ui::align(Math::Align::TOP | Math::Align::HFILL) |
-           Ui::vscroll() | Ui::key(s.currentIndex);
+    auto len = entries.len();
+    return Ui::list(
+               Ui::ListStyle::estimate(36),
+               len,
+               [dir = s.currentUrl(), entries = std::move(entries)](usize i) {
+                   return directorEntry(dir, entries[i], i % 2 == 0);
+               }
+           ) |
+           Ui::key(s.currentIndex);
 }
 
 Ui::Child breadcrumbItem(Str text, isize index) {
@@ -1,4 +1,5 @@
 #include <karm-image/loader.h>
+#include <karm-image/thumbnail.h>
 #include <karm-kira/scaffold.h>
 #include <karm-sys/entry.h>
 #include <karm-ui/app.h>
@@ -34,10 +35,12 @@ Async::Task<> entryPointAsync(Sys::Context &ctx) {
 
     if (args.len()) {
         auto url = co_try$(Mime::parseUrlOrPath(args[0]));
-        image = Image::load(url);
+        image = co_await Image::loadAsync(url);
 
         if (not image) {
             logError("Failed to load image: {}", image.none());
+        } else if (auto res = Image::saveThumbnail(url, image.unwrap()); not res) {
+            logWarn("Failed to save thumbnail: {}", res);
         }
     }
 
@@ -8,6 +8,7 @@
 #include <karm-sys/_embed.h>
 #include <karm-sys/file.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
 
 namespace Karm::Sys::_Embed {
 
@@ -328,6 +329,10 @@ Res<Vec<DirEntry>> readDir(Mime::Url const &) {
     return Error::notImplemented();
 }
 
+Res<> createDir(Mime::Url const &) {
+    return Error::notImplemented();
+}
+
 Res<Strong<Fd>> createFile(Mime::Url const &) {
     return Error::notImplemented();
 }
@@ -378,7 +383,7 @@ Res<> memFlush(void *, usize) {
 }
 
 Res<Stat> stat(Mime::Url const &) {
-    notImplemented();
+    return Error::notImplemented();
 }
 
 // MARK: Time ------------------------------------------------------------------
@@ -456,6 +461,20 @@ Res<> exit(i32) {
         ;
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+usize concurrency() {
+    return 1;
+}
+
+Res<> startThread(Func<void()>) {
+    return Error::notImplemented();
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
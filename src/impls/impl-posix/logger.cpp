@@ -1,11 +1,19 @@
+#include <karm-base/lock.h>
 #include <karm-logger/_embed.h>
 #include <karm-sys/chan.h>
 
 namespace Karm::Logger::_Embed {
 
-void loggerLock() {}
+// Logging can happen from the threads of a `Sys::Pool`.
+static Lock _lock;
 
-void loggerUnlock() {}
+void loggerLock() {
+    _lock.acquire();
+}
+
+void loggerUnlock() {
+    _lock.release();
+}
 
 Io::TextWriter &loggerOut() {
     return Sys::err();
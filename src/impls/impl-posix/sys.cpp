@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
@@ -19,6 +20,7 @@
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
 #include <karm-sys/proc.h>
 
 #include "fd.h"
@@ -174,6 +176,13 @@ Res<Vec<DirEntry>> readDir(Mime::Url const &url) {
     return Ok(entries);
 }
 
+Res<> createDir(Mime::Url const &url) {
+    String str = try$(resolve(url)).str();
+    if (::mkdir(str.buf(), 0755) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 Res<Stat> stat(Mime::Url const &url) {
     String str = try$(resolve(url)).str();
     struct stat buf;
@@ -427,6 +436,83 @@ Res<> exit(i32 res) {
     return Ok();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+usize concurrency() {
+    auto n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+static void *_threadEntry(void *arg) {
+    auto *entry = static_cast<Func<void()> *>(arg);
+    (*entry)();
+    delete entry;
+    return nullptr;
+}
+
+Res<> startThread(Func<void()> entry) {
+    auto *arg = new Func<void()>(std::move(entry));
+    pthread_t thread;
+    if (auto err = pthread_create(&thread, nullptr, _threadEntry, arg); err != 0) {
+        delete arg;
+        return Posix::fromErrno(err);
+    }
+    pthread_detach(thread);
+    return Ok();
+}
+
+struct PosixSema : public Sys::Sema {
+    pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _cond = PTHREAD_COND_INITIALIZER;
+    usize _count;
+
+    PosixSema(usize count)
+        : _count(count) {}
+
+    ~PosixSema() override {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    void wait() override {
+        pthread_mutex_lock(&_mutex);
+        while (_count == 0)
+            pthread_cond_wait(&_cond, &_mutex);
+        _count--;
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    bool tryWait() override {
+        pthread_mutex_lock(&_mutex);
+        bool acquired = _count > 0;
+        if (acquired)
+            _count--;
+        pthread_mutex_unlock(&_mutex);
+        return acquired;
+    }
+
+    void signal(usize n) override {
+        pthread_mutex_lock(&_mutex);
+        _count += n;
+        pthread_mutex_unlock(&_mutex);
+        if (n == 1)
+            pthread_cond_signal(&_cond);
+        else
+            pthread_cond_broadcast(&_cond);
+    }
+
+    usize count() override {
+        pthread_mutex_lock(&_mutex);
+        usize count = _count;
+        pthread_mutex_unlock(&_mutex);
+        return count;
+    }
+};
+
+Res<Strong<Sys::Sema>> createSema(usize count) {
+    return Ok(makeStrong<PosixSema>(count));
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
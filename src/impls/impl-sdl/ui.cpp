@@ -48,8 +48,30 @@ struct SdlHost :
         };
     }
 
-    void flip(Slice<Math::Recti>) override {
-        SDL_UpdateWindowSurface(_window);
+    void flip(Slice<Math::Recti> regions) override {
+        // NOTE: Regions are in window coordinates, but SDL expects
+        //       surface pixels, which differ on high-dpi displays.
+        auto scale = dpi();
+        auto surfaceBound = pixels().bound();
+
+        Vec<SDL_Rect> rects;
+        for (auto r : regions) {
+            auto scaled = Math::Rectf{
+                r.x * scale,
+                r.y * scale,
+                r.width * scale,
+                r.height * scale,
+            };
+            auto px = scaled.ceil().cast<isize>().clipTo(surfaceBound);
+            if (px.width <= 0 or px.height <= 0)
+                continue;
+            rects.pushBack({(int)px.x, (int)px.y, (int)px.width, (int)px.height});
+        }
+
+        if (rects.len() == 0)
+            return;
+
+        SDL_UpdateWindowSurfaceRects(_window, rects.buf(), rects.len());
     }
 
     static App::Key _fromSdlKeycode(SDL_Keycode sdl) {
@@ -317,7 +339,7 @@ struct SdlHost :
                 break;
 
             case SDL_WINDOWEVENT_EXPOSED:
-                _dirty.pushBack(pixels().bound());
+                _dirty.add(pixels().bound());
                 break;
             }
             break;
@@ -3,6 +3,7 @@
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/launch.h>
+#include <karm-sys/mutex.h>
 
 #include "fd.h"
 
@@ -53,8 +54,12 @@ Res<Vec<Sys::DirEntry>> readDir(Mime::Url const &) {
     notImplemented();
 }
 
+Res<> createDir(Mime::Url const &) {
+    return Error::notImplemented();
+}
+
 Res<Stat> stat(Mime::Url const &) {
-    notImplemented();
+    return Error::notImplemented();
 }
 
 // MARK: User interactions -----------------------------------------------------
@@ -163,6 +168,20 @@ Res<> exit(i32) {
     notImplemented();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+usize concurrency() {
+    return 1;
+}
+
+Res<> startThread(Func<void()>) {
+    return Error::notImplemented();
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
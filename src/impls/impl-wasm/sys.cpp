@@ -3,6 +3,7 @@
 #include <karm-base/time.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
+#include <karm-sys/mutex.h>
 
 #include "externs.h"
 
@@ -97,6 +98,10 @@ Res<Vec<DirEntry>> readDir(Mime::Url const &) {
     return Error::notImplemented("directory listing not supported");
 }
 
+Res<> createDir(Mime::Url const &) {
+    return Error::notImplemented("directory creation not supported");
+}
+
 Res<Stat> stat(Mime::Url const &) {
     return Error::notImplemented("directory listing not supported");
 }
@@ -171,6 +176,20 @@ Res<> populate(Vec<Sys::UserInfo> &) {
     return Ok();
 }
 
+// MARK: Threads ---------------------------------------------------------------
+
+usize concurrency() {
+    return 1;
+}
+
+Res<> startThread(Func<void()>) {
+    return Error::notImplemented();
+}
+
+Res<Strong<Sys::Sema>> createSema(usize) {
+    return Error::notImplemented();
+}
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox() {
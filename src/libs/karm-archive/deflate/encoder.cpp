@@ -0,0 +1,703 @@
+#include <karm-base/clamp.h>
+
+#include "encoder.h"
+
+namespace Deflate {
+
+// Same trade-offs as zlib, for the greedy levels `lazy` is instead the
+// longest match whose positions are all hashed.
+static constexpr Array<Encoder::Config, MAX_LEVEL + 1> CONFIGS = {{
+    {0, 0, 0, 0, true},
+    {4, 4, 8, 4, true},
+    {4, 5, 16, 8, true},
+    {4, 6, 32, 32, true},
+    {4, 4, 16, 16, false},
+    {8, 16, 32, 32, false},
+    {8, 16, 128, 128, false},
+    {8, 32, 128, 256, false},
+    {32, 128, 258, 1024, false},
+    {32, 258, 258, 4096, false},
+}};
+
+// A match of the minimum length this far back costs more than its literals.
+static constexpr usize TOO_FAR = 4096;
+
+static constexpr usize OUT_SIZE = 16384;
+
+// MARK: Tables ----------------------------------------------------------------
+
+// Length code of a match, indexed by its length minus 3.
+static constexpr Array<u8, 256> LENGTH_CODE = [] {
+    Array<u8, 256> res{};
+    for (usize code = 0; code < LENGTH_BASE.len() - 1; code++)
+        for (usize i = 0; i < (1uz << LENGTH_EXTRA[code]); i++)
+            res[LENGTH_BASE[code] - MIN_MATCH + i] = code;
+    // 258 has a code of its own, rather than being the last of 227-258.
+    res[255] = LENGTH_BASE.len() - 1;
+    return res;
+}();
+
+// Distance code of a match, indexed by its distance minus 1 when it's
+// under 256, or by 256 plus its distance minus 1 over 128.
+static constexpr Array<u8, 512> DIST_CODE = [] {
+    Array<u8, 512> res{};
+    for (usize code = 0; code < DIST_BASE.len(); code++) {
+        for (usize i = 0; i < (1uz << DIST_EXTRA[code]); i++) {
+            usize dist = DIST_BASE[code] - 1 + i;
+            if (dist < 256)
+                res[dist] = code;
+            else
+                res[256 + (dist >> 7)] = code;
+        }
+    }
+    return res;
+}();
+
+static always_inline usize _distCode(usize dist) {
+    return dist < 256 ? DIST_CODE[dist] : DIST_CODE[256 + (dist >> 7)];
+}
+
+// The fixed code has two more literal/length codes that are never used,
+// they still take their place when building the codes.
+static constexpr Array<u8, 288> FIXED_LIT_LENS = [] {
+    Array<u8, 288> res{};
+    for (usize i = 0; i < res.len(); i++)
+        res[i] = i < 144 ? 8 : i < 256 ? 9
+                           : i < 280   ? 7
+                                       : 8;
+    return res;
+}();
+
+static constexpr Array<u8, DIST_CODES> FIXED_DIST_LENS = [] {
+    Array<u8, DIST_CODES> res{};
+    for (usize i = 0; i < DIST_CODES; i++)
+        res[i] = 5;
+    return res;
+}();
+
+// MARK: Huffman ---------------------------------------------------------------
+
+static u16 _reverse(u16 code, usize len) {
+    u16 res = 0;
+    for (usize i = 0; i < len; i++) {
+        res = (res << 1) | (code & 1);
+        code >>= 1;
+    }
+    return res;
+}
+
+// Canonical codes, bit reversed since they are sent most significant bit
+// first in a stream that is otherwise least significant bit first.
+static void _buildCodes(Slice<u8> lens, MutSlice<u16> codes) {
+    Array<u16, MAX_BITS + 1> count{};
+    for (auto len : lens)
+        count[len]++;
+    count[0] = 0;
+
+    Array<u16, MAX_BITS + 1> next{};
+    u16 code = 0;
+    for (usize bits = 1; bits <= MAX_BITS; bits++) {
+        code = (code + count[bits - 1]) << 1;
+        next[bits] = code;
+    }
+
+    for (usize i = 0; i < lens.len(); i++)
+        if (lens[i])
+            codes[i] = _reverse(next[lens[i]]++, lens[i]);
+}
+
+void buildLengths(Slice<u32> freqs, MutSlice<u8> lens, usize limit) {
+    Array<u16, LIT_CODES> syms;
+    usize n = 0;
+    for (usize i = 0; i < freqs.len(); i++) {
+        lens[i] = 0;
+        if (freqs[i])
+            syms[n++] = i;
+    }
+
+    for (usize i = 0; n < 2; i++)
+        if (not freqs[i])
+            syms[n++] = i;
+
+    auto sorted = mutSub(syms, 0, n);
+    sort(sorted, [&](u16 a, u16 b) {
+        if (freqs[a] != freqs[b])
+            return freqs[a] <=> freqs[b];
+        return a <=> b;
+    });
+
+    // Moffat and Katajainen's in-place computation of the code lengths of
+    // a minimum-redundancy code, the weights being sorted.
+    // See "In-Place Calculation of Minimum-Redundancy Codes", 1995.
+    Array<isize, LIT_CODES> a;
+    for (usize i = 0; i < n; i++)
+        a[i] = freqs[syms[i]];
+
+    isize root = 0;
+    usize leaf = 2;
+    a[0] += a[1];
+    for (usize next = 1; next < n - 1; next++) {
+        if (leaf >= n or a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = next;
+        } else {
+            a[next] = a[leaf++];
+        }
+
+        if (leaf >= n or (root < (isize)next and a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = next;
+        } else {
+            a[next] += a[leaf++];
+        }
+    }
+
+    a[n - 2] = 0;
+    for (isize next = n - 3; next >= 0; next--)
+        a[next] = a[a[next]] + 1;
+
+    isize avail = 1;
+    isize used = 0;
+    isize depth = 0;
+    root = n - 2;
+    isize next = n - 1;
+    while (avail > 0) {
+        while (root >= 0 and a[root] == depth) {
+            used++;
+            root--;
+        }
+        while (avail > used) {
+            a[next--] = depth;
+            avail--;
+        }
+        avail = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    // Codes that are too long are shortened like JPEG does, see Annex K.3
+    // of ITU T.81, the tree stays complete.
+    Array<usize, LIT_CODES> count{};
+    usize maxLen = 0;
+    for (usize i = 0; i < n; i++) {
+        count[a[i]]++;
+        maxLen = max(maxLen, (usize)a[i]);
+    }
+
+    for (usize i = maxLen; i > limit; i--) {
+        while (count[i] > 0) {
+            usize j = i - 2;
+            while (count[j] == 0)
+                j--;
+            count[i] -= 2;
+            count[i - 1]++;
+            count[j + 1] += 2;
+            count[j]--;
+        }
+    }
+
+    // The most frequent symbols get the shortest codes.
+    usize i = n;
+    for (usize len = 1; len <= limit; len++)
+        for (usize k = 0; k < count[len]; k++)
+            lens[syms[--i]] = len;
+}
+
+// MARK: Encoder ---------------------------------------------------------------
+
+Encoder::Encoder(Io::Writer &writer, usize level)
+    : _writer(writer),
+      _level(clamp(level, MIN_LEVEL, MAX_LEVEL)),
+      _config(CONFIGS[_level]) {
+    // Matches are compared 8 bytes at a time, and may run past the end of
+    // the window.
+    _window.resize(2 * WINDOW_SIZE + MAX_MATCH + 8, 0);
+    _head.resize(HASH_SIZE, 0);
+    _prev.resize(WINDOW_SIZE, 0);
+    _syms.ensure(SYM_LIMIT);
+    _out.resize(OUT_SIZE, 0);
+}
+
+Res<usize> Encoder::write(Bytes bytes) {
+    if (_finished)
+        return Error::invalidInput("encoder is finished");
+
+    usize written = 0;
+    while (written < bytes.len()) {
+        if (_strstart >= WINDOW_SIZE + MAX_DIST)
+            _slide();
+
+        usize end = _strstart + _lookahead;
+        usize n = min(2 * WINDOW_SIZE - end, bytes.len() - written);
+        memcpy(_window.buf() + end, bytes.buf() + written, n);
+        _lookahead += n;
+        written += n;
+
+        try$(_compress(false));
+    }
+
+    return Ok(written);
+}
+
+Res<> Encoder::finish() {
+    if (_finished)
+        return Ok();
+
+    try$(_compress(true));
+    try$(_flushBlock(true));
+    _alignBits();
+    try$(_flushOut());
+    _finished = true;
+    return Ok();
+}
+
+// MARK: Matching --------------------------------------------------------------
+
+void Encoder::_slide() {
+    memcpy(_window.buf(), _window.buf() + WINDOW_SIZE, WINDOW_SIZE);
+    _strstart -= WINDOW_SIZE;
+    _matchStart = _matchStart >= WINDOW_SIZE ? _matchStart - WINDOW_SIZE : 0;
+    _blockStart -= WINDOW_SIZE;
+
+    for (auto &pos : _head)
+        pos = pos >= WINDOW_SIZE ? pos - WINDOW_SIZE : 0;
+    for (auto &pos : _prev)
+        pos = pos >= WINDOW_SIZE ? pos - WINDOW_SIZE : 0;
+}
+
+usize Encoder::_hash(usize pos) const {
+    u32 v;
+    memcpy(&v, _window.buf() + pos, sizeof(v));
+    return ((v & 0xffffff) * 0x9e3779b1u) >> (32 - HASH_BITS);
+}
+
+usize Encoder::_insertHash(usize pos) {
+    usize h = _hash(pos);
+    usize head = _head[h];
+    _prev[pos & (WINDOW_SIZE - 1)] = head;
+    _head[h] = pos;
+    return head;
+}
+
+static always_inline usize _commonLen(u8 const *a, u8 const *b, usize maxLen) {
+    usize len = 0;
+    while (len + 8 <= maxLen) {
+        u64 x, y;
+        memcpy(&x, a + len, sizeof(x));
+        memcpy(&y, b + len, sizeof(y));
+        if (u64 diff = x ^ y)
+            return len + __builtin_ctzll(diff) / 8;
+        len += 8;
+    }
+
+    while (len < maxLen and a[len] == b[len])
+        len++;
+    return len;
+}
+
+// Follow the hash chain from `cur` for a match longer than the previous
+// one, its start is kept in `_matchStart`.
+usize Encoder::_longestMatch(usize cur) {
+    usize chain = _config.chain;
+    if (_prevLen >= _config.good)
+        chain >>= 2;
+
+    usize best = _prevLen;
+    usize nice = min(_config.nice, _lookahead);
+    usize maxLen = min(MAX_MATCH, _lookahead);
+    usize limit = _strstart > MAX_DIST ? _strstart - MAX_DIST : 0;
+    u8 const *window = _window.buf();
+    u8 const *scan = window + _strstart;
+
+    do {
+        u8 const *match = window + cur;
+
+        // Only a longer match is interesting, check where it would differ
+        // before comparing the whole thing.
+        if (match[best] != scan[best] or match[0] != scan[0] or match[1] != scan[1])
+            continue;
+
+        usize len = _commonLen(scan, match, maxLen);
+        if (len > best) {
+            _matchStart = cur;
+            best = len;
+            if (len >= nice)
+                break;
+        }
+    } while ((cur = _prev[cur & (WINDOW_SIZE - 1)]) > limit and --chain != 0);
+
+    return min(best, _lookahead);
+}
+
+Res<> Encoder::_compressStored(bool) {
+    _strstart += _lookahead;
+    _lookahead = 0;
+
+    // Flushed before the start of the block could slide out.
+    if (_strstart - _blockStart >= MAX_DIST)
+        try$(_flushBlock(false));
+
+    return Ok();
+}
+
+// Take the first match found, only the positions of short matches are
+// hashed.
+Res<> Encoder::_compressFast(bool flush) {
+    while (true) {
+        if (_lookahead < MIN_LOOKAHEAD) {
+            if (not flush or _lookahead == 0)
+                return Ok();
+        }
+
+        usize head = 0;
+        if (_lookahead >= MIN_MATCH)
+            head = _insertHash(_strstart);
+
+        usize len = 0;
+        if (head != 0 and _strstart - head < MAX_DIST)
+            len = _longestMatch(head);
+
+        bool full;
+        if (len >= MIN_MATCH) {
+            full = _tallyMatch(_strstart - _matchStart, len);
+            _lookahead -= len;
+
+            if (len <= _config.lazy and _lookahead >= MIN_MATCH) {
+                for (usize i = 1; i < len; i++)
+                    _insertHash(_strstart + i);
+            }
+            _strstart += len;
+        } else {
+            full = _tallyLit(_window[_strstart]);
+            _lookahead--;
+            _strstart++;
+        }
+
+        if (full)
+            try$(_flushBlock(false));
+    }
+}
+
+// Before taking a match, look if there is a longer one starting at the next
+// byte, which is then taken instead.
+Res<> Encoder::_compressLazy(bool flush) {
+    while (true) {
+        if (_lookahead < MIN_LOOKAHEAD) {
+            if (not flush)
+                return Ok();
+            if (_lookahead == 0)
+                break;
+        }
+
+        usize head = 0;
+        if (_lookahead >= MIN_MATCH)
+            head = _insertHash(_strstart);
+
+        _prevLen = _matchLen;
+        _prevMatch = _matchStart;
+        _matchLen = MIN_MATCH - 1;
+
+        if (head != 0 and _prevLen < _config.lazy and _strstart - head < MAX_DIST) {
+            _matchLen = _longestMatch(head);
+            if (_matchLen == MIN_MATCH and _strstart - _matchStart > TOO_FAR)
+                _matchLen = MIN_MATCH - 1;
+        }
+
+        if (_prevLen >= MIN_MATCH and _matchLen <= _prevLen) {
+            // The previous match is the best, the current position is
+            // already hashed.
+            usize maxInsert = _strstart + _lookahead - MIN_MATCH;
+            bool full = _tallyMatch(_strstart - 1 - _prevMatch, _prevLen);
+            _lookahead -= _prevLen - 1;
+            for (usize i = 0; i < _prevLen - 2; i++)
+                if (++_strstart <= maxInsert)
+                    _insertHash(_strstart);
+            _matchAvailable = false;
+            _matchLen = MIN_MATCH - 1;
+            _strstart++;
+
+            if (full)
+                try$(_flushBlock(false));
+        } else if (_matchAvailable) {
+            if (_tallyLit(_window[_strstart - 1]))
+                try$(_flushBlock(false));
+            _strstart++;
+            _lookahead--;
+        } else {
+            _matchAvailable = true;
+            _strstart++;
+            _lookahead--;
+        }
+    }
+
+    if (_matchAvailable) {
+        _tallyLit(_window[_strstart - 1]);
+        _matchAvailable = false;
+    }
+
+    return Ok();
+}
+
+Res<> Encoder::_compress(bool flush) {
+    if (_level == MIN_LEVEL)
+        return _compressStored(flush);
+    if (_config.greedy)
+        return _compressFast(flush);
+    return _compressLazy(flush);
+}
+
+// MARK: Blocks ----------------------------------------------------------------
+
+bool Encoder::_tallyLit(u8 lit) {
+    _syms.pushBack({0, lit});
+    _litFreq[lit]++;
+    return _syms.len() == SYM_LIMIT;
+}
+
+bool Encoder::_tallyMatch(usize dist, usize len) {
+    _syms.pushBack({(u16)dist, (u8)(len - MIN_MATCH)});
+    _litFreq[END_OF_BLOCK + 1 + LENGTH_CODE[len - MIN_MATCH]]++;
+    _distFreq[_distCode(dist - 1)]++;
+    return _syms.len() == SYM_LIMIT;
+}
+
+void Encoder::_putBits(u32 bits, usize len) {
+    _bits |= (u64)bits << _count;
+    _count += len;
+    if (_count < 32)
+        return;
+
+    if (_outLen + 4 > _out.len())
+        _out.resize(_out.len() * 2, 0);
+
+    u8 *out = _out.buf() + _outLen;
+    out[0] = _bits;
+    out[1] = _bits >> 8;
+    out[2] = _bits >> 16;
+    out[3] = _bits >> 24;
+    _outLen += 4;
+    _bits >>= 32;
+    _count -= 32;
+}
+
+void Encoder::_alignBits() {
+    if (_outLen + 4 > _out.len())
+        _out.resize(_out.len() * 2, 0);
+
+    while (_count > 0) {
+        _out[_outLen++] = _bits;
+        _bits >>= 8;
+        _count = _count > 8 ? _count - 8 : 0;
+    }
+    _bits = 0;
+}
+
+Res<> Encoder::_flushOut() {
+    try$(_writer.write(sub(_out, 0, _outLen)));
+    _outLen = 0;
+    return Ok();
+}
+
+void Encoder::_writeStored(Bytes data, bool last) {
+    usize off = 0;
+    do {
+        usize n = min(MAX_STORED, data.len() - off);
+        bool final = last and off + n == data.len();
+        _putBits(final | (toUnderlyingType(BlockType::STORED) << 1), 3);
+        _alignBits();
+
+        if (_outLen + n + 4 > _out.len())
+            _out.resize(max(_out.len() * 2, _outLen + n + 4), 0);
+
+        u8 *out = _out.buf() + _outLen;
+        out[0] = n;
+        out[1] = n >> 8;
+        out[2] = ~n;
+        out[3] = ~n >> 8;
+        memcpy(out + 4, data.buf() + off, n);
+        _outLen += n + 4;
+        off += n;
+    } while (off < data.len());
+}
+
+void Encoder::_writeSyms(Slice<u8> litLens, Slice<u16> litCodes, Slice<u8> distLens, Slice<u16> distCodes) {
+    for (auto sym : _syms) {
+        if (sym.dist == 0) {
+            _putBits(litCodes[sym.val], litLens[sym.val]);
+            continue;
+        }
+
+        usize code = LENGTH_CODE[sym.val];
+        _putBits(litCodes[END_OF_BLOCK + 1 + code], litLens[END_OF_BLOCK + 1 + code]);
+        if (LENGTH_EXTRA[code])
+            _putBits(sym.val + MIN_MATCH - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+        usize dist = sym.dist - 1;
+        code = _distCode(dist);
+        _putBits(distCodes[code], distLens[code]);
+        if (DIST_EXTRA[code])
+            _putBits(dist + 1 - DIST_BASE[code], DIST_EXTRA[code]);
+    }
+
+    _putBits(litCodes[END_OF_BLOCK], litLens[END_OF_BLOCK]);
+}
+
+// Write what was compressed since the start of the block, as whichever of
+// the three kinds of block is the smallest.
+Res<> Encoder::_flushBlock(bool last) {
+    _litFreq[END_OF_BLOCK] = 1;
+
+    Array<u8, LIT_CODES> litLens;
+    Array<u8, DIST_CODES> distLens;
+    buildLengths(_litFreq, litLens, MAX_BITS);
+    buildLengths(_distFreq, distLens, MAX_BITS);
+
+    usize hlit = LIT_CODES;
+    while (hlit > 257 and litLens[hlit - 1] == 0)
+        hlit--;
+    usize hdist = DIST_CODES;
+    while (hdist > 1 and distLens[hdist - 1] == 0)
+        hdist--;
+
+    // The code lengths of both trees are sent as one sequence, with runs
+    // replaced by repeat codes.
+    Array<u8, LIT_CODES + DIST_CODES> lens;
+    for (usize i = 0; i < hlit; i++)
+        lens[i] = litLens[i];
+    for (usize i = 0; i < hdist; i++)
+        lens[hlit + i] = distLens[i];
+    usize nlens = hlit + hdist;
+
+    Array<u8, LIT_CODES + DIST_CODES> rleSyms;
+    Array<u8, LIT_CODES + DIST_CODES> rleExtra;
+    usize nrle = 0;
+    Array<u32, CODE_LEN_CODES> clFreq{};
+    auto emit = [&](u8 sym, u8 extra) {
+        rleSyms[nrle] = sym;
+        rleExtra[nrle++] = extra;
+        clFreq[sym]++;
+    };
+
+    for (usize i = 0; i < nlens;) {
+        u8 len = lens[i];
+        usize run = 1;
+        while (i + run < nlens and lens[i + run] == len)
+            run++;
+        i += run;
+
+        if (len == 0) {
+            while (run >= 11) {
+                usize n = min(run, 138uz);
+                emit(REPEAT_ZERO2, n - 11);
+                run -= n;
+            }
+            if (run >= 3) {
+                emit(REPEAT_ZERO, run - 3);
+                run = 0;
+            }
+        } else {
+            emit(len, 0);
+            run--;
+            while (run >= 3) {
+                usize n = min(run, 6uz);
+                emit(REPEAT_PREV, n - 3);
+                run -= n;
+            }
+        }
+
+        for (; run > 0; run--)
+            emit(len, 0);
+    }
+
+    Array<u8, CODE_LEN_CODES> clLens;
+    buildLengths(clFreq, clLens, MAX_CODE_LEN_BITS);
+    usize hclen = CODE_LEN_CODES;
+    while (hclen > 4 and clLens[CODE_LEN_ORDER[hclen - 1]] == 0)
+        hclen--;
+
+    // Sizes in bits of the block in each of its forms.
+    u64 extra = 0;
+    u64 dynamicSize = 3 + 5 + 5 + 4 + hclen * 3;
+    u64 fixedSize = 3;
+    for (usize i = 0; i < LIT_CODES; i++) {
+        dynamicSize += (u64)_litFreq[i] * litLens[i];
+        fixedSize += (u64)_litFreq[i] * FIXED_LIT_LENS[i];
+        if (i > END_OF_BLOCK)
+            extra += (u64)_litFreq[i] * LENGTH_EXTRA[i - END_OF_BLOCK - 1];
+    }
+    for (usize i = 0; i < DIST_CODES; i++) {
+        dynamicSize += (u64)_distFreq[i] * distLens[i];
+        fixedSize += (u64)_distFreq[i] * FIXED_DIST_LENS[i];
+        extra += (u64)_distFreq[i] * DIST_EXTRA[i];
+    }
+    for (usize i = 0; i < nrle; i++) {
+        dynamicSize += clLens[rleSyms[i]];
+        if (rleSyms[i] == REPEAT_PREV)
+            dynamicSize += 2;
+        else if (rleSyms[i] == REPEAT_ZERO)
+            dynamicSize += 3;
+        else if (rleSyms[i] == REPEAT_ZERO2)
+            dynamicSize += 7;
+    }
+    dynamicSize += extra;
+    fixedSize += extra;
+
+    // The data of the block is only around while it's still in the window.
+    bool canStore = _blockStart >= 0;
+    usize storedLen = canStore ? _strstart - _blockStart : 0;
+    u64 storedSize = (storedLen / MAX_STORED + 1) * (3 + 7 + 32) + storedLen * 8;
+
+    if (_level == MIN_LEVEL or (canStore and storedSize <= min(fixedSize, dynamicSize))) {
+        _writeStored(sub(_window, (usize)_blockStart, _strstart), last);
+    } else if (fixedSize <= dynamicSize) {
+        Array<u16, FIXED_LIT_LENS.len()> litCodes;
+        Array<u16, DIST_CODES> distCodes;
+        _buildCodes(FIXED_LIT_LENS, litCodes);
+        _buildCodes(FIXED_DIST_LENS, distCodes);
+
+        _putBits(last | (toUnderlyingType(BlockType::FIXED) << 1), 3);
+        _writeSyms(FIXED_LIT_LENS, litCodes, FIXED_DIST_LENS, distCodes);
+    } else {
+        Array<u16, LIT_CODES> litCodes;
+        Array<u16, DIST_CODES> distCodes;
+        Array<u16, CODE_LEN_CODES> clCodes;
+        _buildCodes(litLens, litCodes);
+        _buildCodes(distLens, distCodes);
+        _buildCodes(clLens, clCodes);
+
+        _putBits(last | (toUnderlyingType(BlockType::DYNAMIC) << 1), 3);
+        _putBits(hlit - 257, 5);
+        _putBits(hdist - 1, 5);
+        _putBits(hclen - 4, 4);
+        for (usize i = 0; i < hclen; i++)
+            _putBits(clLens[CODE_LEN_ORDER[i]], 3);
+
+        for (usize i = 0; i < nrle; i++) {
+            u8 sym = rleSyms[i];
+            _putBits(clCodes[sym], clLens[sym]);
+            if (sym == REPEAT_PREV)
+                _putBits(rleExtra[i], 2);
+            else if (sym == REPEAT_ZERO)
+                _putBits(rleExtra[i], 3);
+            else if (sym == REPEAT_ZERO2)
+                _putBits(rleExtra[i], 7);
+        }
+
+        _writeSyms(litLens, litCodes, distLens, distCodes);
+    }
+
+    _syms.clear();
+    _litFreq = {};
+    _distFreq = {};
+    _blockStart = _strstart;
+
+    return _flushOut();
+}
+
+Res<> encode(Bytes bytes, Io::Writer &w, usize level) {
+    Encoder enc{w, level};
+    try$(enc.write(bytes));
+    return enc.finish();
+}
+
+} // namespace Deflate
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <karm-base/vec.h>
+#include <karm-io/traits.h>
+
+#include "spec.h"
+
+namespace Deflate {
+
+// Compression levels, on the same scale as zlib: 0 only stores the data,
+// 1 to 3 take the first match they find, 4 to 9 look for a longer one at
+// the next byte before taking it, and search further back the higher they go.
+static constexpr usize MIN_LEVEL = 0;
+static constexpr usize FAST_LEVEL = 1;
+static constexpr usize DEFAULT_LEVEL = 6;
+static constexpr usize MAX_LEVEL = 9;
+
+// Code lengths no longer than `limit` for the symbols with a frequency,
+// always at least two since some decoders don't like a tree with a single
+// leaf. There are at most LIT_CODES symbols.
+void buildLengths(Slice<u32> freqs, MutSlice<u8> lens, usize limit);
+
+struct Encoder : public Io::Writer {
+    static constexpr usize HASH_BITS = 15;
+    static constexpr usize HASH_SIZE = 1 << HASH_BITS;
+
+    // Matches are only looked for while enough data is buffered ahead to
+    // hold the longest one, and one more to hash.
+    static constexpr usize MIN_LOOKAHEAD = MAX_MATCH + MIN_MATCH + 1;
+    static constexpr usize MAX_DIST = WINDOW_SIZE - MIN_LOOKAHEAD;
+
+    static constexpr usize SYM_LIMIT = 16384; //< Symbols per block
+
+    struct Config {
+        usize good;  //< Search less once a match this long is found
+        usize lazy;  //< Don't look for a better match past this length
+        usize nice;  //< Stop searching once a match this long is found
+        usize chain; //< Number of candidates to try
+        bool greedy;
+    };
+
+    struct Sym {
+        u16 dist; //< Zero for a literal
+        u8 val;   //< The literal, or the length of the match minus 3
+    };
+
+    Io::Writer &_writer;
+    usize _level;
+    Config _config;
+
+    // Two windows worth of input, the upper half slides down when the
+    // lower one is out of reach.
+    Vec<u8> _window;
+    Vec<u16> _head; //< Last position of each hash, zero for none
+    Vec<u16> _prev; //< Previous position with the same hash
+    usize _strstart = 0;
+    usize _lookahead = 0;
+    isize _blockStart = 0; //< Negative when the start of the block slid out of the window
+
+    // Lazy matching
+    usize _matchLen = MIN_MATCH - 1;
+    usize _matchStart = 0;
+    usize _prevLen = MIN_MATCH - 1;
+    usize _prevMatch = 0;
+    bool _matchAvailable = false;
+
+    Vec<Sym> _syms;
+    Array<u32, LIT_CODES> _litFreq{};
+    Array<u32, DIST_CODES> _distFreq{};
+
+    Vec<u8> _out;
+    usize _outLen = 0;
+    u64 _bits = 0;
+    usize _count = 0;
+
+    bool _finished = false;
+
+    Encoder(Io::Writer &writer, usize level = DEFAULT_LEVEL);
+
+    usize level() const { return _level; }
+
+    Res<usize> write(Bytes bytes) override;
+
+    // Compress what's left and write the last block, the encoder can't be
+    // written to anymore.
+    Res<> finish();
+
+    // MARK: Matching ----------------------------------------------------------
+
+    void _slide();
+
+    usize _hash(usize pos) const;
+
+    usize _insertHash(usize pos);
+
+    usize _longestMatch(usize cur);
+
+    Res<> _compressStored(bool flush);
+
+    Res<> _compressFast(bool flush);
+
+    Res<> _compressLazy(bool flush);
+
+    Res<> _compress(bool flush);
+
+    // MARK: Blocks ------------------------------------------------------------
+
+    bool _tallyLit(u8 lit);
+
+    bool _tallyMatch(usize dist, usize len);
+
+    void _putBits(u32 bits, usize len);
+
+    void _alignBits();
+
+    Res<> _flushOut();
+
+    void _writeStored(Bytes data, bool last);
+
+    void _writeSyms(Slice<u8> litLens, Slice<u16> litCodes, Slice<u8> distLens, Slice<u16> distCodes);
+
+    Res<> _flushBlock(bool last);
+};
+
+// Compress `bytes` as a raw deflate stream.
+Res<> encode(Bytes bytes, Io::Writer &w, usize level = DEFAULT_LEVEL);
+
+} // namespace Deflate
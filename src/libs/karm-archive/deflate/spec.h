@@ -0,0 +1,64 @@
+#pragma once
+
+// DEFLATE Compressed Data Format
+// References:
+//  - https://www.rfc-editor.org/rfc/rfc1951
+
+#include <karm-base/array.h>
+
+namespace Deflate {
+
+enum struct BlockType : u8 {
+    STORED = 0,
+    FIXED = 1,
+    DYNAMIC = 2,
+};
+
+static constexpr usize WINDOW_SIZE = 32768;
+
+static constexpr usize MIN_MATCH = 3;
+static constexpr usize MAX_MATCH = 258;
+static constexpr usize MAX_STORED = 65535;
+
+static constexpr usize END_OF_BLOCK = 256;
+static constexpr usize LIT_CODES = 286; //< Literals, end of block and lengths
+static constexpr usize DIST_CODES = 30;
+static constexpr usize CODE_LEN_CODES = 19;
+
+static constexpr usize MAX_BITS = 15;
+static constexpr usize MAX_CODE_LEN_BITS = 7;
+
+// Repeat codes of the code length alphabet.
+enum : u8 {
+    REPEAT_PREV = 16,  //< Previous length, 3 to 6 times
+    REPEAT_ZERO = 17,  //< Zero, 3 to 10 times
+    REPEAT_ZERO2 = 18, //< Zero, 11 to 138 times
+};
+
+static constexpr Array<u16, 29> LENGTH_BASE = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static constexpr Array<u8, 29> LENGTH_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static constexpr Array<u16, 30> DIST_BASE = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+
+static constexpr Array<u8, 30> DIST_EXTRA = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// The order in which the lengths of the code length alphabet are stored.
+static constexpr Array<u8, CODE_LEN_CODES> CODE_LEN_ORDER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+} // namespace Deflate
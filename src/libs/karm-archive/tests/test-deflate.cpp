@@ -0,0 +1,290 @@
+#include <karm-archive/deflate/encoder.h>
+#include <karm-io/impls.h>
+#include <karm-test/macros.h>
+
+namespace Deflate::Tests {
+
+// Just enough of an inflater to check what the encoder writes, it
+// remembers the type of each block it reads.
+struct Inflater {
+    struct Huffman {
+        Array<u16, MAX_BITS + 1> count{};
+        Array<u16, 288> syms{};
+
+        Huffman(Slice<u8> lens) {
+            for (auto len : lens)
+                count[len]++;
+            count[0] = 0;
+
+            Array<u16, MAX_BITS + 1> offs{};
+            for (usize len = 1; len < MAX_BITS; len++)
+                offs[len + 1] = offs[len] + count[len];
+
+            for (usize i = 0; i < lens.len(); i++)
+                if (lens[i])
+                    syms[offs[lens[i]]++] = i;
+        }
+    };
+
+    Bytes _in;
+    usize _pos = 0;
+    u32 _bits = 0;
+    usize _count = 0;
+
+    Vec<u8> out;
+    Vec<BlockType> types;
+
+    Inflater(Bytes in) : _in(in) {}
+
+    Res<u32> _take(usize n) {
+        while (_count < n) {
+            if (_pos >= _in.len())
+                return Error::invalidData("unexpected end of data");
+            _bits |= (u32)_in[_pos++] << _count;
+            _count += 8;
+        }
+
+        u32 res = _bits & ((1u << n) - 1);
+        _bits >>= n;
+        _count -= n;
+        return Ok(res);
+    }
+
+    // Codes are read one bit at a time, most significant first.
+    Res<u16> _decode(Huffman const &h) {
+        isize code = 0, first = 0, index = 0;
+        for (usize len = 1; len <= MAX_BITS; len++) {
+            code |= try$(_take(1));
+            isize count = h.count[len];
+            if (code - count < first)
+                return Ok(h.syms[index + (code - first)]);
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return Error::invalidData("invalid code");
+    }
+
+    Res<> _stored() {
+        _bits = 0;
+        _count = 0;
+        if (_pos + 4 > _in.len())
+            return Error::invalidData("unexpected end of data");
+
+        usize len = _in[_pos] | (_in[_pos + 1] << 8);
+        usize nlen = _in[_pos + 2] | (_in[_pos + 3] << 8);
+        if (len != (~nlen & 0xffff))
+            return Error::invalidData("stored length mismatch");
+        _pos += 4;
+
+        if (_pos + len > _in.len())
+            return Error::invalidData("unexpected end of data");
+        for (usize i = 0; i < len; i++)
+            out.pushBack(_in[_pos++]);
+        return Ok();
+    }
+
+    Res<> _codes(Huffman const &lit, Huffman const &dist) {
+        while (true) {
+            usize sym = try$(_decode(lit));
+            if (sym < END_OF_BLOCK) {
+                out.pushBack(sym);
+                continue;
+            }
+            if (sym == END_OF_BLOCK)
+                return Ok();
+
+            sym -= END_OF_BLOCK + 1;
+            if (sym >= LENGTH_BASE.len())
+                return Error::invalidData("invalid length code");
+            usize len = LENGTH_BASE[sym] + try$(_take(LENGTH_EXTRA[sym]));
+
+            usize dsym = try$(_decode(dist));
+            if (dsym >= DIST_BASE.len())
+                return Error::invalidData("invalid distance code");
+            usize d = DIST_BASE[dsym] + try$(_take(DIST_EXTRA[dsym]));
+            if (d > out.len())
+                return Error::invalidData("distance too far back");
+
+            for (usize i = 0; i < len; i++)
+                out.pushBack(out[out.len() - d]);
+        }
+    }
+
+    Res<> _fixed() {
+        Array<u8, 288> litLens;
+        for (usize i = 0; i < litLens.len(); i++)
+            litLens[i] = i < 144 ? 8 : i < 256 ? 9
+                                   : i < 280   ? 7
+                                               : 8;
+
+        Array<u8, DIST_CODES> distLens;
+        for (auto &len : distLens)
+            len = 5;
+
+        return _codes(Huffman{litLens}, Huffman{distLens});
+    }
+
+    Res<> _dynamic() {
+        usize hlit = try$(_take(5)) + 257;
+        usize hdist = try$(_take(5)) + 1;
+        usize hclen = try$(_take(4)) + 4;
+
+        Array<u8, CODE_LEN_CODES> clLens{};
+        for (usize i = 0; i < hclen; i++)
+            clLens[CODE_LEN_ORDER[i]] = try$(_take(3));
+        Huffman cl{clLens};
+
+        Vec<u8> lens;
+        while (lens.len() < hlit + hdist) {
+            usize sym = try$(_decode(cl));
+            if (sym < REPEAT_PREV) {
+                lens.pushBack(sym);
+            } else if (sym == REPEAT_PREV) {
+                if (not lens.len())
+                    return Error::invalidData("nothing to repeat");
+                u8 prev = last(lens);
+                for (usize n = try$(_take(2)) + 3; n > 0; n--)
+                    lens.pushBack(prev);
+            } else if (sym == REPEAT_ZERO) {
+                for (usize n = try$(_take(3)) + 3; n > 0; n--)
+                    lens.pushBack(0);
+            } else {
+                for (usize n = try$(_take(7)) + 11; n > 0; n--)
+                    lens.pushBack(0);
+            }
+        }
+
+        return _codes(
+            Huffman{sub(lens, 0, hlit)},
+            Huffman{sub(lens, hlit, hlit + hdist)}
+        );
+    }
+
+    Res<> inflate() {
+        while (true) {
+            bool final = try$(_take(1));
+            auto type = (BlockType)try$(_take(2));
+            types.pushBack(type);
+
+            if (type == BlockType::STORED)
+                try$(_stored());
+            else if (type == BlockType::FIXED)
+                try$(_fixed());
+            else if (type == BlockType::DYNAMIC)
+                try$(_dynamic());
+            else
+                return Error::invalidData("invalid block type");
+
+            if (final)
+                return Ok();
+        }
+    }
+};
+
+test$("deflate-lengths-limit") {
+    // Fibonacci frequencies make the deepest possible tree, 29 bits here
+    // before it's limited.
+    Array<u32, LIT_CODES> freqs{};
+    u32 a = 1, b = 1;
+    for (usize i = 0; i < 30; i++) {
+        freqs[i * 7] = a;
+        u32 next = a + b;
+        a = b;
+        b = next;
+    }
+
+    Array<u8, LIT_CODES> lens{};
+    buildLengths(freqs, lens, MAX_BITS);
+
+    // The code is complete: the lengths satisfy Kraft's inequality as an
+    // equality.
+    usize kraft = 0;
+    for (usize i = 0; i < lens.len(); i++) {
+        expectLteq$(lens[i], MAX_BITS);
+        expectEq$(lens[i] != 0, freqs[i] != 0);
+        if (lens[i])
+            kraft += 1uz << (MAX_BITS - lens[i]);
+    }
+    expectEq$(kraft, 1uz << MAX_BITS);
+
+    // More frequent symbols never get longer codes.
+    for (usize i = 1; i < 30; i++)
+        expectLteq$(lens[i * 7], lens[(i - 1) * 7]);
+
+    return Ok();
+}
+
+test$("deflate-lengths-single-symbol") {
+    Array<u32, DIST_CODES> freqs{};
+    freqs[3] = 5;
+
+    Array<u8, DIST_CODES> lens{};
+    buildLengths(freqs, lens, MAX_BITS);
+
+    expectEq$(lens[0], 1);
+    expectEq$(lens[3], 1);
+    for (usize i = 4; i < lens.len(); i++)
+        expectEq$(lens[i], 0);
+
+    return Ok();
+}
+
+test$("deflate-stored") {
+    Str hello = "hello";
+    Io::BufferWriter out;
+    try$(encode(bytes(hello), out, MIN_LEVEL));
+
+    Array<u8, 10> expected = {0x01, 0x05, 0x00, 0xfa, 0xff, 'h', 'e', 'l', 'l', 'o'};
+    expect$(out.bytes() == Bytes{expected});
+
+    Io::BufferWriter empty;
+    try$(encode(Bytes{}, empty, MIN_LEVEL));
+
+    Array<u8, 5> expectedEmpty = {0x01, 0x00, 0x00, 0xff, 0xff};
+    expect$(empty.bytes() == Bytes{expectedEmpty});
+
+    return Ok();
+}
+
+test$("deflate-fixed") {
+    Str text = "hello hello hello hello";
+    auto input = bytes(text);
+
+    Io::BufferWriter out;
+    try$(encode(input, out));
+
+    Inflater inflater{out.bytes()};
+    try$(inflater.inflate());
+    expectEq$(inflater.types.len(), 1uz);
+    expect$(inflater.types[0] == BlockType::FIXED);
+    expect$(inflater.out == input);
+
+    return Ok();
+}
+
+test$("deflate-dynamic") {
+    // Four letters in a random order, their codes are much shorter than the
+    // eight bits of the fixed code.
+    Vec<u8> input;
+    u32 seed = 1;
+    for (usize i = 0; i < 4096; i++) {
+        seed = seed * 1103515245 + 12345;
+        input.pushBack("abcd"[(seed >> 16) & 3]);
+    }
+
+    for (usize level : {FAST_LEVEL, DEFAULT_LEVEL, MAX_LEVEL}) {
+        Io::BufferWriter out;
+        try$(encode(input, out, level));
+
+        Inflater inflater{out.bytes()};
+        try$(inflater.inflate());
+        expectEq$(inflater.types.len(), 1uz);
+        expect$(inflater.types[0] == BlockType::DYNAMIC);
+        expect$(inflater.out == input);
+    }
+
+    return Ok();
+}
+
+} // namespace Deflate::Tests
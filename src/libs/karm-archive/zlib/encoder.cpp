@@ -0,0 +1,56 @@
+#include <karm-crypto/adler32.h>
+
+#include "encoder.h"
+
+namespace Zlib {
+
+static constexpr u8 DEFLATE = 8;
+static constexpr u8 WINDOW_BITS = 15;
+
+Res<> Encoder::_writeHeader() {
+    if (_header)
+        return Ok();
+    _header = true;
+
+    // The level is only a hint of how the data was compressed.
+    usize level = _deflate.level();
+    u8 hint = level < 2 ? 0 : level < 6 ? 1
+                          : level == 6  ? 2
+                                        : 3;
+
+    u8 cmf = DEFLATE | ((WINDOW_BITS - 8) << 4);
+    u8 flg = hint << 6;
+    flg |= 31 - ((cmf << 8) | flg) % 31;
+
+    Array<u8, 2> header = {cmf, flg};
+    try$(_writer.write(header));
+    return Ok();
+}
+
+Res<usize> Encoder::write(Bytes bytes) {
+    try$(_writeHeader());
+    _adler = Karm::Crypto::adler32(bytes, _adler);
+    return _deflate.write(bytes);
+}
+
+Res<> Encoder::finish() {
+    try$(_writeHeader());
+    try$(_deflate.finish());
+
+    Array<u8, 4> trailer = {
+        (u8)(_adler >> 24),
+        (u8)(_adler >> 16),
+        (u8)(_adler >> 8),
+        (u8)_adler,
+    };
+    try$(_writer.write(trailer));
+    return Ok();
+}
+
+Res<> encode(Bytes bytes, Io::Writer &w, usize level) {
+    Encoder enc{w, level};
+    try$(enc.write(bytes));
+    return enc.finish();
+}
+
+} // namespace Zlib
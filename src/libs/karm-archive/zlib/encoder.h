@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../deflate/encoder.h"
+
+namespace Zlib {
+
+// A deflate stream with the zlib header in front and the Adler-32 checksum
+// of the data at the end.
+struct Encoder : public Io::Writer {
+    Io::Writer &_writer;
+    Deflate::Encoder _deflate;
+    u32 _adler = 1;
+    bool _header = false;
+
+    Encoder(Io::Writer &writer, usize level = Deflate::DEFAULT_LEVEL)
+        : _writer(writer), _deflate(writer, level) {}
+
+    Res<> _writeHeader();
+
+    Res<usize> write(Bytes bytes) override;
+
+    Res<> finish();
+};
+
+Res<> encode(Bytes bytes, Io::Writer &w, usize level = Deflate::DEFAULT_LEVEL);
+
+} // namespace Zlib
@@ -0,0 +1,79 @@
+#include <karm-base/rune.h>
+#include <karm-bench/bench.h>
+#include <karm-io/sscan.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static void benchRunes(Str name, Str text) {
+    Sys::println("--- {} ---", name);
+
+    Vec<Rune> runes;
+    runes.resize(countRunes(text));
+
+    Vec<u16> wide;
+    wide.resize(text.len());
+
+    Vec<char> units;
+    units.resize(text.len());
+
+    bench("iterRunes", 10, [&] {
+        usize count = 0;
+        for ([[maybe_unused]] auto r : iterRunes(text))
+            count++;
+        (void)count;
+    });
+
+    bench("countRunes", 10, [&] {
+        (void)countRunes(text);
+    });
+
+    bench("asciiLen", 10, [&] {
+        (void)asciiLen(text);
+    });
+
+    bench("validateUtf8", 10, [&] {
+        (void)validateUtf8(text);
+    });
+
+    bench("utf8ToRunes", 10, [&] {
+        (void)utf8ToRunes(text, runes);
+    });
+
+    bench("runesToUtf8", 10, [&] {
+        (void)runesToUtf8(runes, units);
+    });
+
+    bench("utf8ToUtf16", 10, [&] {
+        (void)utf8ToUtf16(text, wide);
+    });
+
+    bench("utf16ToUtf8", 10, [&] {
+        auto len = utf8ToUtf16(text, wide);
+        (void)utf16ToUtf8(sub(wide, 0, len), units);
+    });
+
+    bench("SScan next", 10, [&] {
+        Io::SScan s{text};
+        while (not s.ended())
+            s.next();
+    });
+
+    bench("SScan skip", 10, [&] {
+        Io::SScan s{text};
+        while (not s.ended())
+            if (not s.skip("the "))
+                s.next();
+    });
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto ascii = generateText("the quick brown fox jumps over the lazy dog\n", 16 * 1024 * 1024);
+    auto latin = generateText("Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis\n", 16 * 1024 * 1024);
+    auto cjk = generateText("天地玄黄宇宙洪荒日月盈昃辰宿列张\n", 16 * 1024 * 1024);
+
+    benchRunes("ascii 16MB", ascii);
+    benchRunes("latin 16MB", latin);
+    benchRunes("cjk 16MB", cjk);
+
+    co_return Ok();
+}
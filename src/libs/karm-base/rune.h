@@ -6,6 +6,7 @@
 #include "array.h"
 #include "buf.h"
 #include "cursor.h"
+#include "simd.h"
 
 namespace Karm {
 
@@ -451,6 +452,323 @@ usize transcodeUnits(Cursor<typename Source::Unit> input, MutCursor<typename Tar
     return result;
 }
 
+// MARK: Bulk ------------------------------------------------------------------
+
+// Helpers working on whole buffers. Most text is ASCII, so runs of ASCII are
+// checked and converted 16 units at a time, and everything else falls back
+// to one rune at a time. Outputs are preallocated by the caller, nothing
+// here allocates.
+
+#pragma clang unsafe_buffer_usage begin
+
+always_inline static u8x16 _loadU8x16(char const *ptr) {
+    u8x16 v;
+    __builtin_memcpy(&v, ptr, sizeof(v));
+    return v;
+}
+
+always_inline static bool _anyAbove7f(u8x16 v) {
+    auto w = (u64x2)(v & 0x80);
+    return (w[0] | w[1]) != 0;
+}
+
+always_inline static bool _anyAbove7f(Rune const *ptr) {
+    u32x4 v[4];
+    __builtin_memcpy(&v, ptr, sizeof(v));
+    auto w = (v[0] | v[1] | v[2] | v[3]) & ~0x7fu;
+    return (w[0] | w[1] | w[2] | w[3]) != 0;
+}
+
+always_inline static bool _anyAbove7f(u16 const *ptr) {
+    u16x8 v[2];
+    __builtin_memcpy(&v, ptr, sizeof(v));
+    auto w = (u64x2)((v[0] | v[1]) & 0xff80);
+    return (w[0] | w[1]) != 0;
+}
+
+always_inline static usize _putUtf8(Rune r, char *out) {
+    if (r > 0x10ffff)
+        r = REPLACEMENT;
+
+    if (r <= 0x7f) {
+        out[0] = r;
+        return 1;
+    } else if (r <= 0x7ff) {
+        out[0] = 0xc0 | (r >> 6);
+        out[1] = 0x80 | (r & 0x3f);
+        return 2;
+    } else if (r <= 0xffff) {
+        out[0] = 0xe0 | (r >> 12);
+        out[1] = 0x80 | ((r >> 6) & 0x3f);
+        out[2] = 0x80 | (r & 0x3f);
+        return 3;
+    } else {
+        out[0] = 0xf0 | (r >> 18);
+        out[1] = 0x80 | ((r >> 12) & 0x3f);
+        out[2] = 0x80 | ((r >> 6) & 0x3f);
+        out[3] = 0x80 | (r & 0x3f);
+        return 4;
+    }
+}
+
+// Decode the rune at `i`, advancing `i` past it, malformed sequences
+// decode as U+FFFD.
+always_inline static Rune _takeUtf8(Slice<char> in, usize &i) {
+    Cursor<char> c{in.buf() + i, in.buf() + in.len()};
+    Rune r;
+    if (not Utf8::decodeUnit(r, c))
+        r = REPLACEMENT;
+    i = c._begin - in.buf();
+    return r;
+}
+
+// Number of ASCII units at the start of `units`.
+inline usize asciiLen(Slice<char> units) {
+    auto buf = units.buf();
+    usize len = units.len();
+    usize i = 0;
+    while (i + 16 <= len and not _anyAbove7f(_loadU8x16(buf + i)))
+        i += 16;
+    while (i < len and (u8)buf[i] < 0x80)
+        i++;
+    return i;
+}
+
+inline bool isAscii(Slice<char> units) {
+    return asciiLen(units) == units.len();
+}
+
+// Number of runes in well-formed UTF-8, every unit that isn't a
+// continuation byte starts a rune.
+inline usize countRunes(Slice<char> units) {
+    auto buf = units.buf();
+    usize len = units.len();
+    usize res = 0;
+    usize i = 0;
+
+    while (i + 16 <= len) {
+        // Lanes are counted on 8 bits, flush them before they can overflow.
+        u8x16 acc{};
+        for (usize n = 0; n < 255 and i + 16 <= len; n++, i += 16) {
+            auto v = _loadU8x16(buf + i);
+            acc += (u8x16)((v & 0xc0) != 0x80) & 1;
+        }
+        for (usize k = 0; k < 16; k++)
+            res += acc[k];
+    }
+
+    for (; i < len; i++)
+        res += ((u8)buf[i] & 0xc0) != 0x80;
+
+    return res;
+}
+
+// Check that `units` is well-formed UTF-8: no truncated sequences, overlong
+// encodings, surrogates or runes above U+10FFFF.
+inline bool validateUtf8(Slice<char> units) {
+    auto buf = reinterpret_cast<u8 const *>(units.buf());
+    usize len = units.len();
+    usize i = 0;
+
+    while (i < len) {
+        if (buf[i] < 0x80) {
+            i += asciiLen(sub(units, i, len));
+            continue;
+        }
+
+        u8 first = buf[i];
+        usize n;
+        Rune min;
+        if ((first & 0xe0) == 0xc0) {
+            n = 2;
+            min = 0x80;
+        } else if ((first & 0xf0) == 0xe0) {
+            n = 3;
+            min = 0x800;
+        } else if ((first & 0xf8) == 0xf0) {
+            n = 4;
+            min = 0x10000;
+        } else {
+            return false;
+        }
+
+        if (i + n > len)
+            return false;
+
+        Rune r = first & (0x7f >> n);
+        for (usize k = 1; k < n; k++) {
+            if ((buf[i + k] & 0xc0) != 0x80)
+                return false;
+            r = (r << 6) | (buf[i + k] & 0x3f);
+        }
+
+        if (r < min or r > 0x10ffff or (r >= 0xd800 and r <= 0xdfff))
+            return false;
+
+        i += n;
+    }
+
+    return true;
+}
+
+// Decode UTF-8 into runes, returns the number of runes written. Stops when
+// `out` is full, size it with countRunes().
+inline usize utf8ToRunes(Slice<char> in, MutSlice<Rune> out) {
+    auto src = in.buf();
+    auto dst = out.buf();
+    usize i = 0, o = 0;
+
+    while (i < in.len() and o < out.len()) {
+        if ((u8)src[i] >= 0x80) {
+            dst[o++] = _takeUtf8(in, i);
+            continue;
+        }
+
+        while (i + 16 <= in.len() and o + 16 <= out.len()) {
+            auto v = _loadU8x16(src + i);
+            if (_anyAbove7f(v))
+                break;
+            for (usize k = 0; k < 16; k++)
+                dst[o + k] = v[k];
+            i += 16;
+            o += 16;
+        }
+
+        if (i < in.len() and o < out.len() and (u8)src[i] < 0x80)
+            dst[o++] = src[i++];
+    }
+
+    return o;
+}
+
+// Decode UTF-8 in chunks on the stack, cut at rune boundaries, and call `f`
+// with the runes of each, so ASCII goes through the bulk decoder without
+// any allocation.
+inline void forEachRuneChunk(Slice<char> in, auto f) {
+    Array<Rune, 256> buf;
+    usize i = 0;
+    while (i < in.len()) {
+        usize end = min(i + buf.len(), in.len());
+        while (end < in.len() and end > i and ((u8)in[end] & 0xc0) == 0x80)
+            end--;
+        if (end == i)
+            end = min(i + buf.len(), in.len());
+
+        auto len = utf8ToRunes(sub(in, i, end), buf);
+        f(sub(buf, 0, len));
+        i = end;
+    }
+}
+
+// Encode runes as UTF-8, returns the number of units written. Stops before
+// the first rune that doesn't fit in `out`.
+inline usize runesToUtf8(Slice<Rune> in, MutSlice<char> out) {
+    auto src = in.buf();
+    auto dst = out.buf();
+    usize i = 0, o = 0;
+
+    while (i < in.len()) {
+        while (i + 16 <= in.len() and o + 16 <= out.len() and not _anyAbove7f(src + i)) {
+            for (usize k = 0; k < 16; k++)
+                dst[o + k] = src[i + k];
+            i += 16;
+            o += 16;
+        }
+
+        if (i == in.len())
+            break;
+
+        auto r = src[i];
+        if (Utf8::runeLen(r) > out.len() - o)
+            break;
+        o += _putUtf8(r, dst + o);
+        i++;
+    }
+
+    return o;
+}
+
+// Transcode UTF-8 to UTF-16, returns the number of units written. Stops
+// before the first rune that doesn't fit in `out`.
+inline usize utf8ToUtf16(Slice<char> in, MutSlice<u16> out) {
+    auto src = in.buf();
+    auto dst = out.buf();
+    usize i = 0, o = 0;
+
+    while (i < in.len()) {
+        while (i + 16 <= in.len() and o + 16 <= out.len()) {
+            auto v = _loadU8x16(src + i);
+            if (_anyAbove7f(v))
+                break;
+            for (usize k = 0; k < 16; k++)
+                dst[o + k] = v[k];
+            i += 16;
+            o += 16;
+        }
+
+        if (i == in.len())
+            break;
+
+        auto start = i;
+        auto r = _takeUtf8(in, i);
+        if (Utf16::runeLen(r) > out.len() - o) {
+            i = start;
+            break;
+        }
+
+        if (r <= 0xffff) {
+            dst[o++] = r;
+        } else if (r <= 0x10ffff) {
+            dst[o++] = 0xd800 | ((r - 0x10000) >> 10);
+            dst[o++] = 0xdc00 | ((r - 0x10000) & 0x3ff);
+        } else {
+            dst[o++] = REPLACEMENT;
+        }
+    }
+
+    return o;
+}
+
+// Transcode UTF-16 to UTF-8, returns the number of units written. Stops
+// before the first rune that doesn't fit in `out`.
+inline usize utf16ToUtf8(Slice<u16> in, MutSlice<char> out) {
+    auto src = in.buf();
+    auto dst = out.buf();
+    usize i = 0, o = 0;
+
+    while (i < in.len()) {
+        while (i + 16 <= in.len() and o + 16 <= out.len() and not _anyAbove7f(src + i)) {
+            for (usize k = 0; k < 16; k++)
+                dst[o + k] = src[i + k];
+            i += 16;
+            o += 16;
+        }
+
+        if (i == in.len())
+            break;
+
+        usize n = 1;
+        Rune r = src[i];
+        if (r >= 0xd800 and r <= 0xdbff and
+            i + 1 < in.len() and
+            src[i + 1] >= 0xdc00 and src[i + 1] <= 0xdfff) {
+            r = 0x10000 + ((r - 0xd800) << 10) + (src[i + 1] - 0xdc00);
+            n = 2;
+        } else if (r >= 0xd800 and r <= 0xdfff) {
+            r = REPLACEMENT;
+        }
+
+        if (Utf8::runeLen(r) > out.len() - o)
+            break;
+        o += _putUtf8(r, dst + o);
+        i += n;
+    }
+
+    return o;
+}
+
+#pragma clang unsafe_buffer_usage end
+
 template <StaticEncoding T>
 using One = typename T::One;
 
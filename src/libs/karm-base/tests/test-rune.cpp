@@ -0,0 +1,104 @@
+#include <karm-base/rune.h>
+#include <karm-base/string.h>
+#include <karm-base/vec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("rune-ascii-len") {
+    expectEq$(asciiLen(""s), 0uz);
+    expectEq$(asciiLen("hello"s), 5uz);
+    expectEq$(asciiLen("the quick brown fox jumps over é"s), 31uz);
+    expect$(isAscii("the quick brown fox jumps over the lazy dog"s));
+    expect$(not isAscii("the quick brown fox jumps over the lazy dög"s));
+
+    return Ok();
+}
+
+test$("rune-count") {
+    expectEq$(countRunes(""s), 0uz);
+    expectEq$(countRunes("héllo"s), 5uz);
+    expectEq$(countRunes("一二三四五六七八九十一二三四五六七八九十"s), 20uz);
+    expectEq$(countRunes("the quick brown fox 😀 jumps over the lazy dog"s), 45uz);
+
+    return Ok();
+}
+
+test$("rune-validate-utf8") {
+    expect$(validateUtf8("the quick brown fox jumps over the lazy dog"s));
+    expect$(validateUtf8("héllo wörld 一二三 😀"s));
+
+    Str invalid[] = {
+        "\xc0\x80",         // Overlong
+        "\xed\xa0\x80",     // Surrogate
+        "\xf4\x90\x80\x80", // Above U+10FFFF
+        "\xe2\x82",         // Truncated
+        "\x80",             // Lone continuation
+        "abc\xff",
+    };
+
+    for (auto s : invalid)
+        expect$(not validateUtf8(s));
+
+    return Ok();
+}
+
+test$("rune-transcode-utf8-runes") {
+    Str str = "the quick brown fox jumps over the lazy dög 😀!";
+    Array<Rune, 64> runes{};
+    auto len = utf8ToRunes(str, runes);
+    expectEq$(len, countRunes(str));
+    expectEq$(runes[41], U'ö');
+    expectEq$(runes[44], U'😀');
+
+    Array<char, 64> units{};
+    expectEq$(runesToUtf8(sub(runes, 0, len), units), str.len());
+    expectEq$(Str{units.buf(), str.len()}, str);
+
+    // Output too small, stop before the rune that doesn't fit.
+    Array<char, 2> small{};
+    expectEq$(runesToUtf8(Array<Rune, 2>{'a', U'é'}, small), 1uz);
+
+    return Ok();
+}
+
+test$("rune-transcode-utf8-utf16") {
+    Str str = "the quick brown fox jumps over the lazy dög 😀!";
+    Array<u16, 64> wide{};
+    auto len = utf8ToUtf16(str, wide);
+    expectEq$(len, 47uz);
+    expectEq$(wide[44], 0xd83d);
+    expectEq$(wide[45], 0xde00);
+
+    Array<char, 64> units{};
+    expectEq$(utf16ToUtf8(sub(wide, 0, len), units), str.len());
+    expectEq$(Str{units.buf(), str.len()}, str);
+
+    return Ok();
+}
+
+test$("rune-for-each-chunk") {
+    // A two units rune straddling the end of the first chunk.
+    Array<char, 300> units{};
+    for (auto &u : units)
+        u = 'a';
+    units[255] = '\xc3';
+    units[256] = '\xa9';
+
+    Vec<Rune> runes;
+    usize chunks = 0;
+    forEachRuneChunk(units, [&](Slice<Rune> chunk) {
+        runes.pushBack(chunk);
+        chunks++;
+    });
+
+    expectEq$(chunks, 2uz);
+    expectEq$(runes.len(), 299uz);
+    expectEq$(runes[254], 'a');
+    expectEq$(runes[255], U'é');
+    expectEq$(runes[256], 'a');
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
@@ -0,0 +1,9 @@
+#pragma once
+
+#ifndef KARM_NO_TOP_LEVEL_USING
+namespace Karm::Bench {
+};
+
+using namespace Karm::Bench;
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <karm-base/string.h>
+#include <karm-math/rand.h>
+#include <karm-sys/chan.h>
+#include <karm-sys/time.h>
+
+namespace Karm::Bench {
+
+// Run `fn` `n` times and print the median, average, min and max of the
+// samples, returns the median.
+inline TimeSpan bench(Str name, isize n, auto fn) {
+    Vec<TimeSpan> samples;
+
+    Sys::println("{}:", name);
+    for (isize i = 0; i < n; i++) {
+        auto start = Sys::now();
+        fn();
+        auto elapsed = Sys::now() - start;
+        samples.pushBack(elapsed);
+
+        Sys::print("sampling {}/{}: {}\r", i + 1, n, elapsed);
+    }
+
+    // median
+    sort(samples, [](auto &a, auto &b) {
+        return a.toUSecs() <=> b.toUSecs();
+    });
+
+    // average
+    f64 sum = 0;
+    for (auto &s : samples)
+        sum += s.toUSecs();
+
+    Sys::println("\n");
+    Sys::println("median: {}", samples[samples.len() / 2]);
+    Sys::println("average: {}", TimeSpan::fromUSecs(sum / samples.len()));
+    Sys::println("min: {}", first(samples));
+    Sys::println("max: {}", last(samples));
+    Sys::println("");
+    return samples[samples.len() / 2];
+}
+
+inline Array<Str, 16> WORDS = {
+    "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+    "Waltz,", "nymph,", "for", "quick", "jigs", "vex", "Bud.", "AVATAR",
+};
+
+// Generate about `size` bytes of prose-like text with paragraphs.
+inline String generateText(usize size) {
+    Math::Rand rand{};
+    StringBuilder sb;
+    while (sb.len() < size) {
+        usize words = rand.nextInt(20, 120);
+        for (usize i = 0; i < words; i++) {
+            if (i > 0)
+                sb.append(' ');
+            sb.append(WORDS[rand.nextInt(0, WORDS.len())]);
+        }
+        sb.append('\n');
+    }
+    return sb.take();
+}
+
+// Repeat `pattern` until the text is about `size` bytes long.
+inline String generateText(Str pattern, usize size) {
+    StringBuilder sb;
+    while (sb.len() < size)
+        sb.append(pattern);
+    return sb.take();
+}
+
+} // namespace Karm::Bench
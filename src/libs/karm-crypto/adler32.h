@@ -4,6 +4,7 @@
 
 namespace Karm::Crypto {
 
-u32 adler32(Bytes bytes);
+// Pass the checksum of what came before `bytes` to continue it.
+u32 adler32(Bytes bytes, u32 adler = 1);
 
 } // namespace Karm::Crypto
@@ -19,4 +19,12 @@ test$("crypto-adler32") {
     return Ok();
 }
 
+test$("crypto-adler32-continued") {
+    auto adler = adler32(bytes(Str{"abcdefghijklm"}));
+    adler = adler32(bytes(Str{"nopqrstuvwxyz"}), adler);
+    expectEq$(adler, 0x90860b20u);
+
+    return Ok();
+}
+
 } // namespace Karm::Crypto::Tests
@@ -1,14 +1,13 @@
+#include <karm-bench/bench.h>
 #include <karm-cli/cursor.h>
 #include <karm-gfx/cpu/canvas.h>
 #include <karm-sys/entry.h>
 #include <karm-sys/time.h>
 
-Async::Task<> entryPointAsync(Sys::Context &) {
-    Vec<TimeSpan> samples;
+static void benchStroke() {
     auto surface = Gfx::Surface::alloc({1000, 1000});
 
-    for (isize i = 0; i < 100; i++) {
-        auto start = Sys::now();
+    bench("stroke ellipses", 100, [&] {
         for (isize size = 100; size < 1000; size += 10) {
             f64 scale = size / 100.0;
 
@@ -34,29 +33,87 @@ Async::Task<> entryPointAsync(Sys::Context &) {
                 );
                 g.stroke();
             }
+            g.end();
         }
+    });
+}
 
-        auto elapsed = Sys::now() - start;
-        samples.pushBack(elapsed);
-
-        Sys::print("sampling {}/100: {}\r", i + 1, elapsed);
+static void benchBlit() {
+    auto image = Gfx::Surface::alloc({3840, 2160});
+    {
+        Math::Rand rand{};
+        auto pixels = image->mutPixels();
+        for (isize y = 0; y < pixels.height(); y++)
+            for (isize x = 0; x < pixels.width(); x++)
+                pixels.storeUnsafe({x, y}, Gfx::randomColor(rand));
     }
 
-    // median
-    sort(samples, [](auto &a, auto &b) {
-        return a.toUSecs() <=> b.toUSecs();
-    });
+    auto blitInto = [&](Math::Vec2i size, bool useMips) {
+        auto surface = Gfx::Surface::alloc(size);
+        return [=] mutable {
+            Gfx::CpuCanvas g;
+            g.begin(surface->mutPixels());
+            if (useMips)
+                g.blit(image->bound(), surface->bound(), *image);
+            else
+                g.blit(image->bound(), surface->bound(), image->pixels());
+            g.end();
+        };
+    };
 
-    // average
-    f64 sum = 0;
-    for (auto &s : samples)
-        sum += s.toUSecs();
+    // Warm up the mip chain so the first sample isn't an outlier.
+    (void)image->mip(4);
+
+    bench("blit 4k to 4k", 20, blitInto({3840, 2160}, false));
+    bench("blit 4k to screen (box)", 20, blitInto({1920, 1080}, false));
+    bench("blit 4k to screen (mips)", 20, blitInto({1920, 1080}, true));
+    bench("blit 4k to thumbnail (box)", 20, blitInto({256, 144}, false));
+    bench("blit 4k to thumbnail (mips)", 20, blitInto({256, 144}, true));
+}
 
-    Sys::println("\n");
-    Sys::println("median: {}", samples[samples.len() / 2]);
-    Sys::println("average: {}", TimeSpan::fromUSecs(sum / samples.len()));
-    Sys::println("min: {}", first(samples));
-    Sys::println("max: {}", last(samples));
+// Outline of a lowercase "g" in font units (1000 units per em).
+static Str GLYPH_OUTLINE =
+    "M 496 -14 Q 412 -14 352 22 Q 292 58 260 124 Q 228 190 228 278 "
+    "Q 228 368 262 434 Q 296 500 356 536 Q 416 572 494 572 Q 556 572 602 546 "
+    "Q 648 520 676 474 L 684 558 L 784 558 L 784 22 Q 784 -92 716 -156 "
+    "Q 648 -220 522 -220 Q 438 -220 376 -190 Q 314 -160 280 -102 L 362 -52 "
+    "Q 386 -94 428 -114 Q 470 -134 524 -134 Q 598 -134 638 -94 Q 678 -54 678 20 "
+    "L 678 74 Q 650 32 604 9 Q 558 -14 496 -14 Z "
+    "M 508 78 Q 586 78 632 132 Q 678 186 678 278 Q 678 372 632 426 "
+    "Q 586 480 508 480 Q 430 480 384 426 Q 338 372 338 278 Q 338 186 384 132 "
+    "Q 430 78 508 78 Z";
 
+static void benchFlatten() {
+    auto flattenAt = [](f64 fontSize) {
+        return [=] {
+            f64 scale = fontSize / 1000.0;
+            for (isize i = 0; i < 1000; i++) {
+                Math::Path path;
+                path.tolerance(0.1 / scale);
+                path.evalSvg(GLYPH_OUTLINE);
+            }
+        };
+    };
+
+    bench("flatten glyph outlines at 12px", 20, flattenAt(12));
+    bench("flatten glyph outlines at 48px", 20, flattenAt(48));
+    bench("flatten glyph outlines at 512px", 20, flattenAt(512));
+
+    auto surface = Gfx::Surface::alloc({1920, 1080});
+    bench("fill large rounded rects", 20, [&] {
+        Gfx::CpuCanvas g;
+        g.begin(surface->mutPixels());
+        for (isize i = 0; i < 20; i++) {
+            g.fillStyle(Gfx::BLUE);
+            g.fill(Math::Recti{40 + i * 10, 40 + i * 10, 1600, 900}, 200);
+        }
+        g.end();
+    });
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    benchStroke();
+    benchFlatten();
+    benchBlit();
     co_return Ok();
 }
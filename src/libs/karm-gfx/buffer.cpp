@@ -1,7 +1,38 @@
+#include <karm-base/simd.h>
+
 #include "buffer.h"
 
 namespace Karm::Gfx {
 
+// MARK: Surface ---------------------------------------------------------------
+
+Pixels Surface::mip(usize level) const {
+    LockScope scope{_mipsLock};
+
+    while (_mips.len() < level) {
+        Pixels prev = _mips.len() ? last(_mips)->pixels() : pixels();
+        if (prev.width() <= 1 and prev.height() <= 1)
+            break;
+
+        auto next = Surface::alloc(
+            {
+                max(prev.width() / 2, 1),
+                max(prev.height() / 2, 1),
+            },
+            _fmt
+        );
+        downsampleUnsafe(next->mutPixels(), prev);
+        _mips.pushBack(next);
+    }
+
+    if (level == 0 or _mips.len() == 0)
+        return pixels();
+
+    return _mips[min(level, _mips.len()) - 1]->pixels();
+}
+
+// MARK: Blitting --------------------------------------------------------------
+
 [[gnu::flatten]] void blitUnsafe(MutPixels dst, Pixels src) {
     if (dst.width() != src.width() or dst.height() != src.height()) [[unlikely]]
         panic("blitUnsafe() called with buffers of different sizes");
@@ -18,4 +49,40 @@ namespace Karm::Gfx {
     });
 }
 
+[[gnu::flatten]] void downsampleUnsafe(MutPixels dst, Pixels src) {
+    if (dst._fmt.bpp() != 4 or src._fmt.bpp() != 4) [[unlikely]]
+        panic("downsampleUnsafe() called with unsupported formats");
+
+    // NOTE: Averaging works on each byte independently, so the channel
+    //       order doesn't matter as long as both buffers share the format.
+    for (isize y = 0; y < dst.height(); y++) {
+        auto const *r0 = static_cast<u8 const *>(src.scanline(min(y * 2, src.height() - 1)));
+        auto const *r1 = static_cast<u8 const *>(src.scanline(min(y * 2 + 1, src.height() - 1)));
+        auto *d = static_cast<u8 *>(dst.scanline(y));
+
+        isize x = 0;
+
+        // Two destination pixels at the time
+        for (; x + 2 <= dst.width() and x * 2 + 4 <= src.width(); x += 2) {
+            u8x16 a, b;
+            memcpy(&a, r0 + x * 8, 16);
+            memcpy(&b, r1 + x * 8, 16);
+
+            u16x16 sum = __builtin_convertvector(a, u16x16) + __builtin_convertvector(b, u16x16);
+            u16x8 even = __builtin_shufflevector(sum, sum, 0, 1, 2, 3, 8, 9, 10, 11);
+            u16x8 odd = __builtin_shufflevector(sum, sum, 4, 5, 6, 7, 12, 13, 14, 15);
+            u8x8 avg = __builtin_convertvector((even + odd + 2) >> 2, u8x8);
+
+            memcpy(d + x * 4, &avg, 8);
+        }
+
+        for (; x < dst.width(); x++) {
+            isize x0 = min(x * 2, src.width() - 1) * 4;
+            isize x1 = min(x * 2 + 1, src.width() - 1) * 4;
+            for (isize c = 0; c < 4; c++)
+                d[x * 4 + c] = (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2;
+        }
+    }
+}
+
 } // namespace Karm::Gfx
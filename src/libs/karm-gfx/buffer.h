@@ -1,7 +1,9 @@
 #pragma once
 
+#include <karm-base/lock.h>
 #include <karm-base/rc.h>
 #include <karm-base/union.h>
+#include <karm-base/vec.h>
 #include <karm-math/rect.h>
 
 #include "color.h"
@@ -248,6 +250,12 @@ struct Surface {
     usize _stride;
     Gfx::Fmt _fmt;
 
+    // NOTE: Built by mip() under the lock, surfaces are shared between
+    //       threads. Kept until invalidate() is called, writing to the
+    //       pixels doesn't drop them.
+    mutable Lock _mipsLock;
+    mutable Vec<Strong<Surface>> _mips{};
+
     static Strong<Surface> alloc(Math::Vec2i size, Gfx::Fmt fmt = Gfx::RGBA8888) {
         return makeStrong<Surface>(
             Buf<u8>::init(size.x * size.y * fmt.bpp()),
@@ -279,6 +287,18 @@ struct Surface {
         return {_buf.buf(), _size, _stride, _fmt};
     }
 
+    // Drop the mip levels, must be called once the pixels were written to
+    // if mip() might have been called before.
+    void invalidate() {
+        LockScope scope{_mipsLock};
+        _mips.clear();
+    }
+
+    // Get the pixels of the given mip level, each level is half the size
+    // of the previous one, level 0 being the surface itself.
+    // Levels past the end of the chain return the smallest one.
+    Gfx::Pixels mip(usize level) const;
+
     always_inline isize width() const {
         return _size.x;
     }
@@ -300,4 +320,8 @@ struct Surface {
 
 void blitUnsafe(MutPixels dst, Pixels src);
 
+// Downsample `src` into `dst` which must be half its size (rounded down),
+// each destination pixel being the average of a 2x2 block.
+void downsampleUnsafe(MutPixels dst, Pixels src);
+
 } // namespace Karm::Gfx
@@ -37,6 +37,14 @@ void Canvas::skew(Math::Vec2f pos) {
     transform(Math::Trans2f::makeSkew(pos));
 }
 
+Opt<Math::Trans2f> Canvas::deviceTransform() const {
+    return NONE;
+}
+
+Opt<Math::Recti> Canvas::deviceClip() const {
+    return NONE;
+}
+
 // MARK: Path Operations ---------------------------------------------------
 
 void Canvas::fill(Fill style, FillRule rule) {
@@ -133,6 +141,14 @@ void Canvas::blit(Math::Vec2i dest, Pixels pixels) {
     blit(pixels.bound(), Math::Recti(dest, pixels.size()), pixels);
 }
 
+void Canvas::blit(Math::Recti src, Math::Recti dest, Surface const &surface) {
+    blit(src, dest, surface.pixels());
+}
+
+void Canvas::blit(Math::Recti dest, Surface const &surface) {
+    blit(surface.bound(), dest, surface);
+}
+
 // MARK: Filter Operations -------------------------------------------------
 
 void Canvas::apply(Filter filter, Math::Rectf region, Math::Radiif radii) {
@@ -54,6 +54,15 @@ struct Canvas : Meta::NoCopy {
     // Skew subsequent drawing operations.
     virtual void skew(Math::Vec2f pos);
 
+    // Get the transform from user space to device pixels.
+    // Returns NONE if the canvas is not backed by pixels, in which case
+    // drawing operations can't be cached as bitmaps without losing quality.
+    virtual Opt<Math::Trans2f> deviceTransform() const;
+
+    // Get the clip rectangle in device pixels, or NONE if the canvas is not
+    // backed by pixels.
+    virtual Opt<Math::Recti> deviceClip() const;
+
     // MARK: Path Operations ---------------------------------------------------
 
     // Begin a new path.
@@ -197,6 +206,16 @@ struct Canvas : Meta::NoCopy {
     // Blit the given pixels to the current pixels at the given position.
     virtual void blit(Math::Vec2i dest, Pixels pixels);
 
+    // Blit the given surface to the current pixels
+    // using the given source and destination rectangles.
+    // NOTE: Unlike raw pixels, surfaces can cache downscaled versions of
+    //       themselves, prefer this overload for images drawn scaled.
+    virtual void blit(Math::Recti src, Math::Recti dest, Surface const &surface);
+
+    // Blit the given surface to the current pixels.
+    // The source rectangle is the entire surface.
+    virtual void blit(Math::Recti dest, Surface const &surface);
+
     // MARK: Filter Operations -------------------------------------------------
 
     // Apply a filter on the given region.
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <karm-base/simd.h>
+#include <karm-base/vec.h>
+#include <karm-math/funcs.h>
+
+#include "../buffer.h"
+
+namespace Karm::Gfx {
+
+enum struct BlitFilter {
+    COPY,     // 1:1, pixels are copied without resampling
+    BILINEAR, // Upscaling and mild downscaling
+    BOX,      // Strong downscaling, each destination pixel averages its footprint
+};
+
+// Resample rows of a source image for the blit operation.
+//
+// NOTE: The geometry (source column and weight for each destination column)
+//       is computed once per blit, rows are then produced on demand so the
+//       canvas can composite them with the clip and mask.
+struct CpuBlit {
+    BlitFilter _filter = BlitFilter::COPY;
+    Math::Rectf _src{};
+    Math::Recti _dest{};
+    Math::Recti _limit{};
+
+    Vec<isize> _x0{};
+    Vec<isize> _x1{};
+    Vec<f32> _tx{};
+    Vec<f32x4> _acc{};
+    Vec<Color> _row{};
+
+    static BlitFilter pick(Math::Rectf src, Math::Recti dest) {
+        bool aligned = Math::floor(src.x) == src.x and
+                       Math::floor(src.y) == src.y;
+
+        if (aligned and src.width == dest.width and src.height == dest.height)
+            return BlitFilter::COPY;
+
+        f64 rx = src.width / dest.width;
+        f64 ry = src.height / dest.height;
+        if (rx >= 1 and ry >= 1 and max(rx, ry) >= 2)
+            return BlitFilter::BOX;
+
+        return BlitFilter::BILINEAR;
+    }
+
+    always_inline static f32x4 unpack(Color c) {
+        return {(f32)c.red, (f32)c.green, (f32)c.blue, (f32)c.alpha};
+    }
+
+    always_inline static Color pack(f32x4 v) {
+        v += 0.5f;
+        return Color::fromRgba(v[0], v[1], v[2], v[3]);
+    }
+
+    // Prepare the column geometry for the destination columns in `cols`,
+    // relative to the start of the destination rectangle.
+    void prepare(BlitFilter filter, Pixels src, Math::Rectf srcRect, Math::Recti destRect, irange cols) {
+        _filter = filter;
+        _src = srcRect;
+        _dest = destRect;
+        _limit = srcRect.ceil().cast<isize>().clipTo(src.bound());
+
+        _x0.resize(cols.size);
+        _x1.resize(cols.size);
+        _tx.resize(cols.size);
+        _row.resize(cols.size);
+
+        f64 rx = srcRect.width / destRect.width;
+        isize minX = _limit.start();
+        isize maxX = _limit.end() - 1;
+
+        for (isize i = 0; i < cols.size; i++) {
+            isize x = cols.start + i;
+
+            if (filter == BlitFilter::COPY) {
+                _x0[i] = clamp(Math::floori(srcRect.x) + x, minX, maxX);
+            } else if (filter == BlitFilter::BILINEAR) {
+                f64 fx = srcRect.x + (x + 0.5) * rx - 0.5;
+                isize x0 = Math::floori(fx);
+                _tx[i] = fx - x0;
+                _x0[i] = clamp(x0, minX, maxX);
+                _x1[i] = clamp(x0 + 1, minX, maxX);
+            } else {
+                isize x0 = clamp(Math::floori(srcRect.x + x * rx), minX, maxX);
+                isize x1 = clamp(Math::floori(srcRect.x + (x + 1) * rx), x0 + 1, maxX + 1);
+                _x0[i] = x0;
+                _x1[i] = x1;
+            }
+        }
+
+        if (filter == BlitFilter::BOX and cols.size > 0)
+            _acc.resize(last(_x1) - first(_x0));
+    }
+
+    // Produce the destination row `y`, relative to the start of the
+    // destination rectangle.
+    Slice<Color> sample(Pixels src, auto srcFmt, isize y) {
+        if (_filter == BlitFilter::COPY)
+            _sampleCopy(src, srcFmt, y);
+        else if (_filter == BlitFilter::BILINEAR)
+            _sampleBilinear(src, srcFmt, y);
+        else
+            _sampleBox(src, srcFmt, y);
+        return _row;
+    }
+
+    void _sampleCopy(Pixels src, auto srcFmt, isize y) {
+        isize sy = clamp(Math::floori(_src.y) + y, _limit.top(), _limit.bottom() - 1);
+        auto const *row = static_cast<u8 const *>(src.scanline(sy));
+
+        for (usize i = 0; i < _row.len(); i++)
+            _row[i] = srcFmt.load(row + _x0[i] * srcFmt.bpp());
+    }
+
+    void _sampleBilinear(Pixels src, auto srcFmt, isize y) {
+        f64 ry = _src.height / _dest.height;
+        f64 fy = _src.y + (y + 0.5) * ry - 0.5;
+        isize y0 = Math::floori(fy);
+        f32 ty = fy - y0;
+
+        auto const *r0 = static_cast<u8 const *>(src.scanline(clamp(y0, _limit.top(), _limit.bottom() - 1)));
+        auto const *r1 = static_cast<u8 const *>(src.scanline(clamp(y0 + 1, _limit.top(), _limit.bottom() - 1)));
+
+        for (usize i = 0; i < _row.len(); i++) {
+            usize o0 = _x0[i] * srcFmt.bpp();
+            usize o1 = _x1[i] * srcFmt.bpp();
+
+            f32x4 a = unpack(srcFmt.load(r0 + o0));
+            f32x4 b = unpack(srcFmt.load(r0 + o1));
+            f32x4 c = unpack(srcFmt.load(r1 + o0));
+            f32x4 d = unpack(srcFmt.load(r1 + o1));
+
+            f32x4 top = a + (b - a) * _tx[i];
+            f32x4 bottom = c + (d - c) * _tx[i];
+            _row[i] = pack(top + (bottom - top) * ty);
+        }
+    }
+
+    void _sampleBox(Pixels src, auto srcFmt, isize y) {
+        f64 ry = _src.height / _dest.height;
+        isize y0 = clamp(Math::floori(_src.y + y * ry), _limit.top(), _limit.bottom() - 1);
+        isize y1 = clamp(Math::floori(_src.y + (y + 1) * ry), y0 + 1, _limit.bottom());
+
+        isize accStart = first(_x0);
+        isize accLen = _acc.len();
+
+        // Sum the footprint vertically, one source row at the time...
+        zeroFill<f32x4>(mutSub(_acc));
+        for (isize sy = y0; sy < y1; sy++) {
+            auto const *row = static_cast<u8 const *>(src.scanline(sy)) + accStart * srcFmt.bpp();
+            for (isize i = 0; i < accLen; i++)
+                _acc[i] += unpack(srcFmt.load(row + i * srcFmt.bpp()));
+        }
+
+        // ...then horizontally for each destination pixel.
+        for (usize i = 0; i < _row.len(); i++) {
+            f32x4 sum = {};
+            for (isize x = _x0[i]; x < _x1[i]; x++)
+                sum += _acc[x - accStart];
+            f32 n = (_x1[i] - _x0[i]) * (y1 - y0);
+            _row[i] = pack(sum / n);
+        }
+    }
+
+    // Copy a row of pixels of the same format, blending translucent ones.
+    // NOTE: All our 32-bit formats store the alpha in the last byte, this
+    //       allows checking four pixels at once and copying opaque ones as is.
+    static void copyRow(auto fmt, u8 *dest, u8 const *src, isize width) {
+        isize x = 0;
+
+        if constexpr (fmt.bpp() == 4) {
+            for (; x + 4 <= width; x += 4) {
+                u8x16 px;
+                memcpy(&px, src + x * 4, 16);
+
+                u8x4 alpha = __builtin_shufflevector(px, px, 3, 7, 11, 15);
+                u32 a;
+                memcpy(&a, &alpha, 4);
+
+                if (a == 0xFFFFFFFF) {
+                    memcpy(dest + x * 4, src + x * 4, 16);
+                    continue;
+                }
+
+                if (a == 0)
+                    continue;
+
+                for (isize i = x; i < x + 4; i++) {
+                    auto *d = dest + i * 4;
+                    fmt.store(d, fmt.load(src + i * 4).blendOver(fmt.load(d)));
+                }
+            }
+        }
+
+        for (; x < width; x++) {
+            auto *d = dest + x * fmt.bpp();
+            fmt.store(d, fmt.load(src + x * fmt.bpp()).blendOver(fmt.load(d)));
+        }
+    }
+};
+
+} // namespace Karm::Gfx
@@ -69,10 +69,25 @@ void CpuCanvas::transform(Math::Trans2f trans) {
     t = trans.multiply(t);
 }
 
+Opt<Math::Trans2f> CpuCanvas::deviceTransform() const {
+    return current().trans;
+}
+
+Opt<Math::Recti> CpuCanvas::deviceClip() const {
+    return current().clip;
+}
+
 // MARK: Path Operations -------------------------------------------------------
 
+void CpuCanvas::_rasterize(FillRule fillRule, auto cb) {
+    if (auto const &mask = current().mask)
+        _rast.fill(_poly, current().clip, fillRule, **mask, cb);
+    else
+        _rast.fill(_poly, current().clip, fillRule, cb);
+}
+
 void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
-    _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
+    _rasterize(fillRule, [&](CpuRast::Frag frag) {
         auto pixels = mutPixels();
         auto *pixel = pixels.pixelUnsafe(frag.xy);
         auto color = fill.sample(frag.uv);
@@ -88,7 +103,7 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
         _poly.offset(pos - last);
         last = pos;
 
-        _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
+        _rasterize(fillRule, [&](CpuRast::Frag frag) {
             u8 *pixel = static_cast<u8 *>(mutPixels().pixelUnsafe(frag.xy));
             auto color = fill.sample(frag.uv);
             auto c = format.load(pixel);
@@ -113,6 +128,16 @@ void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
     });
 }
 
+void CpuCanvas::flattenTolerance(f64 tolerance) {
+    _flattenTolerance = tolerance;
+}
+
+void CpuCanvas::_syncTolerance() {
+    auto const &t = current().trans;
+    f64 scale = Math::sqrt(max(t.xx * t.xx + t.xy * t.xy, t.yx * t.yx + t.yy * t.yy));
+    _path.tolerance(scale > 0 ? _flattenTolerance / scale : _flattenTolerance);
+}
+
 void CpuCanvas::beginPath() {
     _path.clear();
 }
@@ -138,14 +163,17 @@ void CpuCanvas::vlineTo(f64 y, Math::Path::Flags flags) {
 }
 
 void CpuCanvas::cubicTo(Math::Vec2f cp1, Math::Vec2f cp2, Math::Vec2f p, Math::Path::Flags flags) {
+    _syncTolerance();
     _path.cubicTo(cp1, cp2, p, flags);
 }
 
 void CpuCanvas::quadTo(Math::Vec2f cp, Math::Vec2f p, Math::Path::Flags flags) {
+    _syncTolerance();
     _path.quadTo(cp, p, flags);
 }
 
 void CpuCanvas::arcTo(Math::Vec2f radii, f64 angle, Math::Vec2f p, Math::Path::Flags flags) {
+    _syncTolerance();
     _path.arcTo(radii, angle, p, flags);
 }
 
@@ -154,10 +182,12 @@ void CpuCanvas::line(Math::Edgef line) {
 }
 
 void CpuCanvas::curve(Math::Curvef curve) {
+    _syncTolerance();
     _path.curve(curve);
 }
 
 void CpuCanvas::rect(Math::Rectf rect, Math::Radiif radii) {
+    _syncTolerance();
     _path.rect(rect, radii);
 }
 
@@ -166,6 +196,7 @@ void CpuCanvas::path(Math::Path const &path) {
 }
 
 void CpuCanvas::ellipse(Math::Ellipsef ellipse) {
+    _syncTolerance();
     _path.ellipse(ellipse);
 }
 
@@ -183,8 +214,35 @@ void CpuCanvas::stroke() {
     _fill(current().stroke.fill);
 }
 
-void CpuCanvas::clip(FillRule) {
-    notImplemented();
+void CpuCanvas::_clipMask(FillRule rule) {
+    auto bound = _poly.bound()
+                     .grow(CpuRast::UNIT)
+                     .ceil()
+                     .cast<isize>()
+                     .clipTo(current().clip);
+
+    // NOTE: The mask is rasterized through the current clip, so nested clips
+    //       end up with the intersection of all the masks.
+    auto mask = makeStrong<CpuMask>(bound);
+    _rasterize(rule, [&](CpuRast::Frag frag) {
+        mask->store(frag.xy, frag.a);
+    });
+    mask->updateSpans();
+
+    current().clip = mask->coverage();
+
+    // A fully covered mask is just a rectangle, there is no need to keep it around.
+    if (mask->opaque())
+        current().mask = NONE;
+    else
+        current().mask = mask;
+}
+
+void CpuCanvas::clip(FillRule rule) {
+    _poly.clear();
+    createSolid(_poly, _path);
+    _poly.transform(current().trans);
+    _clipMask(rule);
 }
 
 // MARK: Shape Operations ------------------------------------------------------
@@ -217,6 +275,7 @@ void CpuCanvas::fill(Math::Recti r, Math::Radiif radii) {
 
     bool isSuitableForFastFill =
         radii.zero() and
+        not current().mask and
         current().fill.is<Color>() and
         current().trans.isIdentity();
 
@@ -228,7 +287,19 @@ void CpuCanvas::fill(Math::Recti r, Math::Radiif radii) {
 }
 
 void CpuCanvas::clip(Math::Rectf rect) {
-    // FIXME: Properly handle offaxis rectangles
+    auto const &trans = current().trans;
+    if (trans.xy != 0 or trans.yx != 0) {
+        // Off-axis rectangles are clipped using a mask, the path being
+        // built isn't touched.
+        Math::Path path;
+        path.rect(rect);
+        _poly.clear();
+        createSolid(_poly, path);
+        _poly.transform(trans);
+        _clipMask(FillRule::NONZERO);
+        return;
+    }
+
     rect = current().trans.apply(rect.cast<f64>()).bound();
 
     current().clip = rect.cast<isize>().clipTo(current().clip);
@@ -265,6 +336,23 @@ void CpuCanvas::clear(Math::Recti rect, Color color) {
     rect = current().trans.apply(rect.cast<f64>()).bound().cast<isize>();
 
     rect = current().clip.clipTo(rect);
+
+    if (auto const &mask = current().mask) {
+        pixels().fmt().visit([&](auto f) {
+            for (isize y = rect.top(); y < rect.bottom(); y++) {
+                auto any = (*mask)->any(y);
+                auto const *row = (*mask)->row(y);
+                isize start = max(rect.start(), any.start);
+                isize end = min(rect.end(), any.end());
+                for (isize x = start; x < end; x++) {
+                    auto *pixel = mutPixels().pixelUnsafe({x, y});
+                    f.store(pixel, f.load(pixel).lerpWith(color, row[x] / 255.0));
+                }
+            }
+        });
+        return;
+    }
+
     mutPixels()
         .clip(rect)
         .clear(color);
@@ -275,6 +363,8 @@ void CpuCanvas::clear(Math::Recti rect, Color color) {
 void CpuCanvas::plot(Math::Vec2i point, Color color) {
     point = current().trans.apply(point.cast<f64>()).cast<isize>();
     if (current().clip.contains(point)) {
+        if (auto const &mask = current().mask)
+            color = color.withOpacity((*mask)->at(point) / 255.0);
         mutPixels().blend(point, color);
     }
 }
@@ -315,39 +405,81 @@ void CpuCanvas::plot(Math::Recti rect, Color color) {
 // MARK: Blit Operations -------------------------------------------------------
 
 [[gnu::flatten]] void CpuCanvas::_blit(
-    Pixels src, Math::Recti srcRect, auto srcFmt,
+    Pixels src, Math::Rectf srcRect, auto srcFmt,
     MutPixels dest, Math::Recti destRect, auto destFmt
 ) {
     // FIXME: Properly handle offaxis rectangles
-    destRect = current().trans.apply(destRect.cast<f64>()).bound().cast<isize>();
+    // NOTE: Rounded rather than truncated, a rectangle mapped back to device
+    //       space through an inverse transform lands a hair off the pixel
+    //       grid and would otherwise be shifted by one pixel.
+    destRect = current().trans.apply(destRect.cast<f64>()).bound().round().cast<isize>();
 
     auto clipDest = current().clip.clipTo(destRect);
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    auto const &mask = current().mask;
+    auto filter = CpuBlit::pick(srcRect, destRect);
+
+    // Fast path: unscaled blit between pixels of the same format.
+    if constexpr (Meta::Same<decltype(srcFmt), decltype(destFmt)>) {
+        if (filter == BlitFilter::COPY and not mask) {
+            isize sx = srcRect.x + (clipDest.x - destRect.x);
+            isize sy = srcRect.y + (clipDest.y - destRect.y);
+            isize width = min(clipDest.width, src.width() - sx);
+            isize height = min(clipDest.height, src.height() - sy);
+
+            for (isize y = 0; y < height; ++y) {
+                CpuBlit::copyRow(
+                    destFmt,
+                    static_cast<u8 *>(dest.pixelUnsafe({clipDest.x, clipDest.y + y})),
+                    static_cast<u8 const *>(src.pixelUnsafe({sx, sy + y})),
+                    width
+                );
+            }
+            return;
+        }
+    }
 
-    auto hratio = srcRect.height / (f64)destRect.height;
-    auto wratio = srcRect.width / (f64)destRect.width;
+    _blitter.prepare(
+        filter, src, srcRect, destRect,
+        {clipDest.x - destRect.x, clipDest.width}
+    );
 
     for (isize y = 0; y < clipDest.height; ++y) {
-        isize yy = clipDest.y - destRect.y + y;
-
-        auto srcY = srcRect.y + yy * hratio;
         auto destY = clipDest.y + y;
 
-        for (isize x = 0; x < clipDest.width; ++x) {
-            isize xx = clipDest.x - destRect.x + x;
+        isize startX = 0;
+        isize endX = clipDest.width;
+        irange full{};
+        u8 const *maskRow = nullptr;
+
+        if (mask) {
+            auto any = (*mask)->any(destY);
+            startX = max(startX, any.start - clipDest.x);
+            endX = min(endX, any.end() - clipDest.x);
+            if (startX >= endX)
+                continue;
+            full = (*mask)->full(destY);
+            maskRow = (*mask)->row(destY);
+        }
 
-            auto srcX = srcRect.x + xx * wratio;
+        auto row = _blitter.sample(src, srcFmt, destY - destRect.y);
+
+        for (isize x = startX; x < endX; ++x) {
             auto destX = clipDest.x + x;
 
-            u8 const *srcPx = static_cast<u8 const *>(src.pixelUnsafe({(isize)srcX, (isize)srcY}));
             u8 *destPx = static_cast<u8 *>(dest.pixelUnsafe({destX, destY}));
-            auto srcC = srcFmt.load(srcPx);
+            auto srcC = row[x];
+            if (maskRow and not full.contains(destX))
+                srcC = srcC.withOpacity(maskRow[destX] / 255.0);
             auto destC = destFmt.load(destPx);
             destFmt.store(destPx, srcC.blendOver(destC));
         }
     }
 }
 
-void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
+void CpuCanvas::_blit(Math::Rectf src, Math::Recti dest, Pixels p) {
     auto d = mutPixels();
     d.fmt().visit([&](auto dfmt) {
         p.fmt().visit([&](auto pfmt) {
@@ -356,6 +488,54 @@ void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
     });
 }
 
+void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Pixels p) {
+    _blit(src.cast<f64>(), dest, p);
+}
+
+void CpuCanvas::blit(Math::Recti src, Math::Recti dest, Surface const &surface) {
+    auto destBound = current().trans.apply(dest.cast<f64>()).bound();
+    if (destBound.width <= 0 or destBound.height <= 0 or src.width <= 0 or src.height <= 0)
+        return;
+
+    f64 scale = min(src.width / destBound.width, src.height / destBound.height);
+    if (Math::isNan(scale) or Math::isInf(scale))
+        return;
+
+    // Pick the smallest mip level that leaves at most a 4:1 reduction to
+    // the box filter, so each destination pixel averages a few samples
+    // instead of its whole footprint, but no smaller than the end of the
+    // mip chain.
+    usize maxLevel = 0;
+    for (isize size = max(surface.width(), surface.height()); size > 1; size /= 2)
+        maxLevel++;
+
+    usize level = 0;
+    while (scale >= 4 and level < maxLevel) {
+        scale /= 2;
+        level++;
+    }
+
+    if (level == 0) {
+        _blit(src.cast<f64>(), dest, surface.pixels());
+        return;
+    }
+
+    auto mip = surface.mip(level);
+    Math::Vec2f ratio = {
+        mip.width() / (f64)surface.width(),
+        mip.height() / (f64)surface.height(),
+    };
+
+    Math::Rectf mipSrc = {
+        src.x * ratio.x,
+        src.y * ratio.y,
+        src.width * ratio.x,
+        src.height * ratio.y,
+    };
+
+    _blit(mipSrc, dest, mip);
+}
+
 // MARK: Filter Operations -----------------------------------------------------
 
 void CpuCanvas::apply(Filter filter) {
@@ -368,7 +548,35 @@ void CpuCanvas::apply(Filter filter, Math::Recti r) {
 
     r = current().clip.clipTo(r);
 
+    auto const &mask = current().mask;
+    if (not mask) {
+        filter.apply(mutPixels().clip(r));
+        return;
+    }
+
+    // Filters work on whole rectangles, the pixels outside of the mask are
+    // put back afterward and the partially covered ones blended with the
+    // filtered result.
+    auto saved = Surface::alloc(r.wh, pixels().fmt());
+    blitUnsafe(saved->mutPixels(), pixels().clip(r));
     filter.apply(mutPixels().clip(r));
+
+    auto dst = mutPixels();
+    auto src = saved->pixels();
+    for (isize y = r.top(); y < r.bottom(); y++) {
+        auto full = (*mask)->full(y);
+        for (isize x = r.start(); x < r.end(); x++) {
+            if (full.contains(x))
+                continue;
+
+            auto a = (*mask)->at({x, y});
+            auto orig = src.loadUnsafe({x - r.x, y - r.y});
+            if (a == 0)
+                dst.storeUnsafe({x, y}, orig);
+            else
+                dst.storeUnsafe({x, y}, orig.lerpWith(dst.loadUnsafe({x, y}), a / 255.0));
+        }
+    }
 }
 
 } // namespace Karm::Gfx
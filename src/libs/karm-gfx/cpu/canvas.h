@@ -5,6 +5,7 @@
 #include "../fill.h"
 #include "../filters.h"
 #include "../stroke.h"
+#include "blit.h"
 #include "rast.h"
 
 namespace Karm::Gfx {
@@ -24,6 +25,7 @@ struct CpuCanvas : public Canvas {
         Fill fill = Gfx::WHITE;
         Stroke stroke{};
         Math::Recti clip{};
+        Opt<Strong<CpuMask>> mask = NONE;
         Math::Trans2f trans = Math::Trans2f::IDENTITY;
     };
 
@@ -32,9 +34,13 @@ struct CpuCanvas : public Canvas {
     Math::Path _path{};
     Math::Polyf _poly;
     CpuRast _rast{};
+    CpuBlit _blitter{};
     LcdLayout _lcdLayout = RGB;
     bool _useSpaa = false;
 
+    // Maximum distance between flattened curves and the ideal ones, in pixels.
+    f64 _flattenTolerance = 0.1;
+
     // MARK: Buffers -----------------------------------------------------------
 
     // Begin drawing operations on the given pixels.
@@ -67,14 +73,29 @@ struct CpuCanvas : public Canvas {
 
     void transform(Math::Trans2f trans) override;
 
+    Opt<Math::Trans2f> deviceTransform() const override;
+
+    Opt<Math::Recti> deviceClip() const override;
+
     // MARK: Path Operations ---------------------------------------------------
 
+    // (internal) Rasterize the current shape with respect to the clip rect and mask.
+    // NOTE: The shape must be flattened before calling this function.
+    void _rasterize(FillRule fillRule, auto cb);
+
     // (internal) Fill the current shape with the given fill.
     // NOTE: The shape must be flattened before calling this function.
     void _fillImpl(auto fill, auto format, FillRule fillRule);
     void _FillSmoothImpl(auto fill, auto format, FillRule fillRule);
     void _fill(Fill fill, FillRule rule = FillRule::NONZERO);
 
+    // Set the maximum distance in pixels between flattened curves and the ideal ones.
+    void flattenTolerance(f64 tolerance);
+
+    // (internal) Map the flattening tolerance to user space, so curves are
+    // subdivided according to their size on screen.
+    void _syncTolerance();
+
     void beginPath() override;
 
     void closePath() override;
@@ -107,6 +128,10 @@ struct CpuCanvas : public Canvas {
 
     void stroke() override;
 
+    // (internal) Clip the current context to the current polygon.
+    // NOTE: The shape must be flattened before calling this function.
+    void _clipMask(FillRule rule);
+
     void clip(FillRule rule) override;
 
     // MARK: Shape Operations --------------------------------------------------
@@ -141,7 +166,7 @@ struct CpuCanvas : public Canvas {
 
     void _blit(
         Pixels src,
-        Math::Recti srcRect,
+        Math::Rectf srcRect,
         auto srcFmt,
 
         MutPixels dest,
@@ -149,8 +174,12 @@ struct CpuCanvas : public Canvas {
         auto destFmt
     );
 
+    void _blit(Math::Rectf src, Math::Recti dest, Pixels pixels);
+
     void blit(Math::Recti src, Math::Recti dest, Pixels pixels) override;
 
+    void blit(Math::Recti src, Math::Recti dest, Surface const &surface) override;
+
     // MARK: Filter Operations -------------------------------------------------
 
     void apply(Filter filter) override;
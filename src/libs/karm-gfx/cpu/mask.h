@@ -0,0 +1,132 @@
+#pragma once
+
+#include <karm-base/clamp.h>
+#include <karm-base/range.h>
+#include <karm-base/vec.h>
+#include <karm-math/rect.h>
+
+namespace Karm::Gfx {
+
+// An 8-bit coverage mask used to clip drawing operations to an arbitrary path.
+//
+// NOTE: Alongside the coverage, each row remembers the span that has any
+//       coverage at all and the longest span that is fully covered. This lets
+//       the compositor drop fully outside spans early and skip the mask lookup
+//       for fully inside pixels.
+struct CpuMask {
+    Math::Recti _bound;
+    Vec<u8> _buf{};
+    Vec<irange> _any{};
+    Vec<irange> _full{};
+
+    CpuMask(Math::Recti bound)
+        : _bound(bound) {
+        _buf.resize(max(bound.width * bound.height, 0));
+        _any.resize(max(bound.height, 0));
+        _full.resize(max(bound.height, 0));
+    }
+
+    Math::Recti bound() const {
+        return _bound;
+    }
+
+    u8 *row(isize y) {
+        return _buf.buf() + (y - _bound.y) * _bound.width - _bound.x;
+    }
+
+    u8 const *row(isize y) const {
+        return _buf.buf() + (y - _bound.y) * _bound.width - _bound.x;
+    }
+
+    // Get the coverage at the given position, zero when outside of the mask.
+    always_inline u8 at(Math::Vec2i p) const {
+        if (not _bound.contains(p))
+            return 0;
+        return row(p.y)[p.x];
+    }
+
+    always_inline void store(Math::Vec2i p, f64 a) {
+        row(p.y)[p.x] = clamp01(a) * 255 + 0.5;
+    }
+
+    // Span of the row that has any coverage, in absolute coordinates.
+    always_inline irange any(isize y) const {
+        if (y < _bound.top() or y >= _bound.bottom())
+            return {};
+        return _any[y - _bound.y];
+    }
+
+    // Span of the row that is fully covered, in absolute coordinates.
+    always_inline irange full(isize y) const {
+        if (y < _bound.top() or y >= _bound.bottom())
+            return {};
+        return _full[y - _bound.y];
+    }
+
+    // Recompute the per-row spans, must be called after the coverage changed.
+    void updateSpans() {
+        for (isize y = _bound.top(); y < _bound.bottom(); y++) {
+            auto const *r = row(y);
+
+            isize first = _bound.end();
+            isize lastNonZero = _bound.start();
+            irange best{};
+            isize runStart = 0;
+            bool inRun = false;
+
+            for (isize x = _bound.start(); x < _bound.end(); x++) {
+                if (r[x] != 0) {
+                    first = min(first, x);
+                    lastNonZero = x + 1;
+                }
+
+                if (r[x] == 255) {
+                    if (not inRun) {
+                        runStart = x;
+                        inRun = true;
+                    }
+                    if (x + 1 - runStart > best.size)
+                        best = irange::fromStartEnd(runStart, x + 1);
+                } else {
+                    inRun = false;
+                }
+            }
+
+            _any[y - _bound.y] = first < lastNonZero
+                                     ? irange::fromStartEnd(first, lastNonZero)
+                                     : irange{};
+            _full[y - _bound.y] = best;
+        }
+    }
+
+    // Is every pixel of the mask fully covered?
+    bool opaque() const {
+        for (auto const &r : _full)
+            if (r.start != _bound.start() or r.size != _bound.width)
+                return false;
+        return true;
+    }
+
+    // Smallest rectangle containing all the covered pixels.
+    Math::Recti coverage() const {
+        isize top = _bound.bottom(), bottom = _bound.top();
+        isize start = _bound.end(), end = _bound.start();
+
+        for (isize y = _bound.top(); y < _bound.bottom(); y++) {
+            auto r = any(y);
+            if (r.empty())
+                continue;
+            top = min(top, y);
+            bottom = max(bottom, y + 1);
+            start = min(start, r.start);
+            end = max(end, r.end());
+        }
+
+        if (top >= bottom)
+            return {_bound.x, _bound.y, 0, 0};
+
+        return Math::Recti::fromTwoPoint({start, top}, {end, bottom});
+    }
+};
+
+} // namespace Karm::Gfx
@@ -4,6 +4,7 @@
 #include <karm-math/poly.h>
 
 #include "../types.h"
+#include "mask.h"
 
 namespace Karm::Gfx {
 
@@ -49,6 +50,15 @@ struct CpuRast {
     }
 
     void fill(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        _fill(poly, clip, fillRule, nullptr, cb);
+    }
+
+    // Fill the polygon, modulating the coverage by the given clip mask.
+    void fill(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, CpuMask const &mask, auto cb) {
+        _fill(poly, clip.clipTo(mask.bound()), fillRule, &mask, cb);
+    }
+
+    void _fill(Math::Polyf &poly, Math::Recti clip, FillRule fillRule, CpuMask const *mask, auto cb) {
         auto polyBound = poly.bound().grow(UNIT);
         auto clipBound = polyBound
                              .ceil()
@@ -58,6 +68,10 @@ struct CpuRast {
         _scanline.resize(clipBound.width + 1);
 
         for (isize y = clipBound.top(); y < clipBound.bottom(); y++) {
+            // Rows outside of the clip mask are dropped before being rasterized.
+            if (mask and mask->any(y).empty())
+                continue;
+
             zeroFill<f64>(mutSub(_scanline, 0, clipBound.width + 1));
             _ranges.clear();
 
@@ -130,6 +144,11 @@ struct CpuRast {
                 }
             }
 
+            if (mask) {
+                _emitMasked(y, clipBound, polyBound, *mask, cb);
+                continue;
+            }
+
             for (auto r : _ranges) {
                 for (isize x = r.start; x < r.end(); x++) {
                     auto xy = Math::Vec2i{x, y};
@@ -144,6 +163,37 @@ struct CpuRast {
             }
         }
     }
+
+    void _emitMasked(isize y, Math::Recti clipBound, Math::Rectf polyBound, CpuMask const &mask, auto cb) {
+        auto any = mask.any(y);
+        auto full = mask.full(y);
+        auto const *row = mask.row(y);
+
+        for (auto r : _ranges) {
+            isize start = max(r.start, any.start);
+            isize end = min(r.end(), any.end());
+
+            for (isize x = start; x < end; x++) {
+                f64 a = clamp01(_scanline[x - clipBound.x]);
+
+                // Pixels in the fully covered span don't need the mask lookup.
+                if (not full.contains(x)) {
+                    if (row[x] == 0)
+                        continue;
+                    a *= row[x] / 255.0;
+                }
+
+                auto xy = Math::Vec2i{x, y};
+
+                auto uv = Math::Vec2f{
+                    (x - polyBound.start()) / polyBound.width,
+                    (y - polyBound.top()) / polyBound.height,
+                };
+
+                cb(Frag{xy, uv, a});
+            }
+        }
+    }
 };
 
 } // namespace Karm::Gfx
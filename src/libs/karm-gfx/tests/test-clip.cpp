@@ -0,0 +1,137 @@
+#include <karm-gfx/colors.h>
+#include <karm-gfx/cpu/canvas.h>
+#include <karm-math/const.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+static Strong<Surface> _surface() {
+    auto surface = Surface::alloc({16, 16});
+    surface->mutPixels().clear(BLACK);
+    return surface;
+}
+
+test$("karm-gfx-clip-nested-paths") {
+    auto surface = _surface();
+    CpuCanvas cpu;
+    cpu.begin(surface->mutPixels());
+    Canvas &g = cpu;
+
+    g.beginPath();
+    g.ellipse({8, 8, 6});
+    g.clip();
+
+    g.beginPath();
+    g.rect({8.5, 0, 8, 16});
+    g.clip();
+
+    g.fillStyle(WHITE);
+    g.fill(Math::Recti{0, 0, 16, 16});
+    cpu.end();
+
+    auto pixels = surface->pixels();
+    expectEq$(pixels.loadUnsafe({11, 8}), WHITE);
+    expectEq$(pixels.loadUnsafe({4, 8}), BLACK);
+    expectEq$(pixels.loadUnsafe({15, 0}), BLACK);
+    expectEq$(pixels.loadUnsafe({15, 15}), BLACK);
+
+    // Partially covered along the edge of the rectangle.
+    auto edge = pixels.loadUnsafe({8, 8});
+    expect$(edge.red > 0 and edge.red < 255);
+
+    return Ok();
+}
+
+test$("karm-gfx-clip-offaxis-rect") {
+    auto surface = _surface();
+    CpuCanvas cpu;
+    cpu.begin(surface->mutPixels());
+    Canvas &g = cpu;
+
+    // Clipping to a rectangle leaves the path being built alone.
+    g.beginPath();
+    g.rect({6, 6, 4, 4});
+
+    g.push();
+    g.origin({8, 8});
+    g.rotate(Math::PI / 4);
+    g.clip(Math::Rectf{-4, -4, 8, 8});
+    g.pop();
+
+    g.fillStyle(WHITE);
+    g.fill();
+
+    auto pixels = surface->pixels();
+    expectEq$(pixels.loadUnsafe({7, 7}), WHITE);
+    expectEq$(pixels.loadUnsafe({8, 4}), BLACK);
+
+    g.push();
+    g.origin({8, 8});
+    g.rotate(Math::PI / 4);
+    g.clip(Math::Rectf{-4, -4, 8, 8});
+    g.fillStyle(WHITE);
+    g.fill(Math::Recti{-20, -20, 40, 40});
+    g.pop();
+    cpu.end();
+
+    expectEq$(pixels.loadUnsafe({8, 8}), WHITE);
+    expectEq$(pixels.loadUnsafe({8, 4}), WHITE);
+    expectEq$(pixels.loadUnsafe({8, 1}), BLACK);
+    expectEq$(pixels.loadUnsafe({1, 1}), BLACK);
+    expectEq$(pixels.loadUnsafe({14, 14}), BLACK);
+
+    return Ok();
+}
+
+test$("karm-gfx-clip-pop-restores-mask") {
+    auto surface = _surface();
+    CpuCanvas cpu;
+    cpu.begin(surface->mutPixels());
+    Canvas &g = cpu;
+
+    g.push();
+    g.beginPath();
+    g.ellipse({8, 8, 4});
+    g.clip();
+    expect$(cpu.current().mask.has());
+    g.pop();
+
+    expectNot$(cpu.current().mask.has());
+    g.fillStyle(WHITE);
+    g.fill(Math::Recti{0, 0, 16, 16});
+    cpu.end();
+
+    auto pixels = surface->pixels();
+    expectEq$(pixels.loadUnsafe({0, 0}), WHITE);
+    expectEq$(pixels.loadUnsafe({8, 8}), WHITE);
+    expectEq$(pixels.loadUnsafe({15, 15}), WHITE);
+
+    return Ok();
+}
+
+test$("karm-gfx-clip-filter") {
+    auto red = Color::fromHex(0xff0000);
+    auto surface = _surface();
+    surface->mutPixels().clear(red);
+    CpuCanvas cpu;
+    cpu.begin(surface->mutPixels());
+    Canvas &g = cpu;
+
+    g.push();
+    g.beginPath();
+    g.ellipse({8, 8, 4});
+    g.clip();
+    g.apply(GrayscaleFilter{});
+    g.pop();
+    cpu.end();
+
+    auto pixels = surface->pixels();
+    auto center = pixels.loadUnsafe({8, 8});
+    expectEq$(center.red, center.green);
+    expectEq$(pixels.loadUnsafe({0, 0}), red);
+    expectEq$(pixels.loadUnsafe({15, 8}), red);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,30 @@
+#include <karm-gfx/buffer.h>
+#include <karm-gfx/colors.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Gfx::Tests {
+
+test$("karm-gfx-surface-mips") {
+    auto surface = Surface::alloc({8, 4});
+    surface->mutPixels().clear(WHITE);
+
+    auto mip = surface->mip(1);
+    expectEq$(mip.size(), (Math::Vec2i{4, 2}));
+    expectEq$(mip.loadUnsafe({0, 0}), WHITE);
+
+    // Past the end of the chain, the smallest level is returned.
+    expectEq$(surface->mip(10).size(), (Math::Vec2i{1, 1}));
+
+    // Pixels written after the levels were built, even through pixels
+    // taken before, show up once the surface is invalidated.
+    auto pixels = surface->mutPixels();
+    (void)surface->mip(2);
+    pixels.clear(BLACK);
+    surface->invalidate();
+    expectEq$(surface->mip(1).loadUnsafe({0, 0}), BLACK);
+    expectEq$(surface->mip(3).loadUnsafe({0, 0}), BLACK);
+
+    return Ok();
+}
+
+} // namespace Karm::Gfx::Tests
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <karm-sys/mmap.h>
+
+#include "gif/decoder.h"
+#include "picture.h"
+
+namespace Karm::Image {
+
+// An image that plays, frames are only decoded when they are shown, on top
+// of what's left of the previous ones.
+struct Animation : public Meta::Pinned {
+    Sys::Mmap _map;
+    Gif::Player _player;
+    Strong<Gfx::Surface> _canvas;
+
+    Animation(Sys::Mmap &&map, Gif::Decoder dec)
+        : _map(std::move(map)),
+          _player(std::move(dec)),
+          _canvas(Gfx::Surface::alloc({_player.decoder().width(), _player.decoder().height()})) {}
+
+    Picture picture() const {
+        return _canvas;
+    }
+
+    Gfx::Surface const &surface() const {
+        return *_canvas;
+    }
+
+    Math::Recti bound() const {
+        return _canvas->bound();
+    }
+
+    usize frames() const {
+        return _player.decoder().frames().len();
+    }
+
+    // How long the current frame is shown for.
+    TimeSpan delay() const {
+        return _player.current().delay;
+    }
+
+    // Whether the animation played as many times as it should, it stays
+    // on its last frame.
+    bool done() const {
+        return _player.done() or frames() < 2;
+    }
+
+    Res<> next() {
+        return _player.next(_canvas->mutPixels());
+    }
+};
+
+} // namespace Karm::Image
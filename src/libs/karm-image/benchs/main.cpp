@@ -0,0 +1,121 @@
+#include <karm-bench/bench.h>
+#include <karm-image/gif/decoder.h>
+#include <karm-image/jpeg/decoder.h>
+#include <karm-image/loader.h>
+#include <karm-image/png/encoder.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
+
+static void throughput(TimeSpan median, usize pixels, usize bytes) {
+    f64 secs = median.toUSecs() / 1e6;
+    Sys::println("throughput: {} Mpx/s, {} MB/s", pixels / secs / 1e6, bytes / secs / 1e6);
+    Sys::println("");
+}
+
+static Res<> benchJpeg(Str name, Bytes bytes) {
+    auto jpeg = try$(Jpeg::Decoder::init(bytes));
+    Sys::println("--- {} ({}x{}, {} bytes) ---", name, jpeg.width(), jpeg.height(), bytes.len());
+
+    bench("parse", 20, [&] {
+        (void)Jpeg::Decoder::init(bytes);
+    });
+
+    auto img = Gfx::Surface::alloc({jpeg.width(), jpeg.height()});
+    bench("decode", 20, [&] {
+        (void)jpeg.decode(*img);
+    });
+
+    // Thumbnails, by halving the full image three times or by decoding
+    // straight to 1/8 of the size.
+    bench("decode + downscale to 1/8", 20, [&] {
+        auto full = Gfx::Surface::alloc({jpeg.width(), jpeg.height()});
+        (void)jpeg.decode(*full);
+
+        auto src = full;
+        for (usize i = 0; i < 3; i++) {
+            auto dst = Gfx::Surface::alloc({src->width() / 2, src->height() / 2});
+            Gfx::downsampleUnsafe(*dst, *src);
+            src = dst;
+        }
+    });
+
+    bench("scaled decode to 1/8", 20, [&] {
+        auto dec = Jpeg::Decoder::init(bytes).unwrap();
+        dec.scale(8).unwrap();
+        auto thumb = Gfx::Surface::alloc({dec.width(), dec.height()});
+        (void)dec.decode(*thumb);
+    });
+
+    return Ok();
+}
+
+static Res<> benchGif(Str name, Bytes bytes) {
+    auto gif = try$(Gif::Decoder::init(bytes));
+    auto frames = gif.frames().len();
+    Sys::println("--- {} ({}x{}, {} frames, {} bytes) ---", name, gif.width(), gif.height(), frames, bytes.len());
+
+    auto img = Gfx::Surface::alloc({gif.width(), gif.height()});
+    auto pixels = gif.width() * gif.height();
+
+    auto median = bench("decode first frame", 20, [&] {
+        (void)gif.decode(*img);
+    });
+    throughput(median, pixels, bytes.len() / frames);
+
+    // Every frame of one loop, composited like when it's played.
+    median = bench("play all frames", 20, [&] {
+        Gif::Player player{gif};
+        for (usize i = 0; i < frames; i++)
+            (void)player.next(*img);
+    });
+    throughput(median, pixels * frames, bytes.len());
+
+    return Ok();
+}
+
+// Encoding time against the size of the output, at every level.
+static Res<> benchPng(Str name, Gfx::Pixels pixels) {
+    usize raw = pixels.width() * pixels.height() * 4;
+    Sys::println("--- {} ({}x{}, encoded to png) ---", name, pixels.width(), pixels.height());
+
+    for (usize level = Deflate::FAST_LEVEL; level <= Deflate::MAX_LEVEL; level++) {
+        Io::BufferWriter out;
+        auto median = bench(try$(Io::format("encode at level {}", level)), 10, [&] {
+            out.clear();
+            Io::BEmit e{out};
+            (void)Png::encode(pixels, e, level);
+        });
+        Sys::println("size: {} bytes, {}% of raw", out.bytes().len(), out.bytes().len() * 100.0 / raw);
+        throughput(median, pixels.width() * pixels.height(), raw);
+    }
+
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto &args = useArgs(ctx);
+
+    if (args.len() == 0) {
+        Sys::println("usage: karm-image.benchs <jpeg|gif|image to encode as png>...");
+        co_return Ok();
+    }
+
+    for (usize i = 0; i < args.len(); i++) {
+        auto url = co_try$(Mime::parseUrlOrPath(args[i]));
+        auto file = co_try$(Sys::File::open(url));
+        auto map = co_try$(Sys::mmap().map(file));
+        if (Gif::Decoder::sniff(map.bytes())) {
+            co_try$(benchGif(args[i], map.bytes()));
+        } else if (Jpeg::Decoder::sniff(map.bytes())) {
+            co_try$(benchJpeg(args[i], map.bytes()));
+        } else {
+            // Screenshots, which are saved as QOI or BMP.
+            auto picture = co_try$(Image::load(std::move(map)));
+            co_try$(benchPng(args[i], picture.pixels()));
+        }
+    }
+
+    co_return Ok();
+}
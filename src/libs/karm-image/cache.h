@@ -0,0 +1,134 @@
+#pragma once
+
+#include <karm-base/list.h>
+#include <karm-base/map.h>
+#include <karm-base/time.h>
+#include <karm-mime/url.h>
+
+#include "picture.h"
+
+namespace Karm::Image {
+
+// Decoded images, dropping the least recently used ones to keep the memory
+// their pixels take under a budget.
+struct Cache {
+    static constexpr usize DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    struct Key {
+        Mime::Url url;
+        TimeStamp modified; //< The file changed if this did
+        Opt<Math::Vec2i> size;
+
+        bool operator==(Key const &) const = default;
+    };
+
+    struct Item {
+        Picture picture;
+        usize bytes;
+        LlItem<Item> item{};
+    };
+
+    usize _budget;
+    usize _used = 0;
+    Map<Key, Item *> _map;
+    Ll<Item> _ll;
+
+    usize _hits = 0;
+    usize _misses = 0;
+    usize _waits = 0;
+
+    Cache(usize budget = DEFAULT_BUDGET)
+        : _budget(budget) {}
+
+    ~Cache() {
+        clear();
+    }
+
+    void clear() {
+        _map.clear();
+        _ll.clearApply([](Item *item) {
+            delete item;
+        });
+        _used = 0;
+    }
+
+    void _evict() {
+        while (_used > _budget) {
+            auto *item = _ll.tail();
+            _ll.detach(item);
+            _map.removeFirst(item);
+            _used -= item->bytes;
+            delete item;
+        }
+    }
+
+    Opt<Picture> get(Key const &key) {
+        Opt<Item *> item = _map.tryGet(key);
+        if (not item) {
+            _misses++;
+            return NONE;
+        }
+
+        _hits++;
+        _ll.detach(*item);
+        _ll.prepend(*item, _ll.head());
+        return (*item)->picture;
+    }
+
+    // Images bigger than the whole budget are not kept.
+    void put(Key const &key, Picture picture) {
+        usize bytes = picture.pixels().bytes().len();
+        if (bytes > _budget)
+            return;
+
+        if (auto item = _map.tryGet(key)) {
+            _ll.detach(*item);
+            _used -= (*item)->bytes;
+            _map.del(key);
+            delete *item;
+        }
+
+        auto *item = new Item{picture, bytes};
+        _ll.prepend(item, _ll.head());
+        _map.put(key, item);
+        _used += bytes;
+        _evict();
+    }
+
+    // Calls that found their image already decoded.
+    usize hits() const {
+        return _hits;
+    }
+
+    usize misses() const {
+        return _misses;
+    }
+
+    // Loads that found their image being decoded and waited on it rather
+    // than calling `get()`.
+    void waited() {
+        _waits++;
+    }
+
+    usize waits() const {
+        return _waits;
+    }
+
+    // In percents, of all the calls to `get()` and waits, a wait is a hit
+    // since it didn't decode the image again.
+    usize hitRate() const {
+        usize hits = _hits + _waits;
+        usize total = hits + _misses;
+        return total ? (hits * 100) / total : 0;
+    }
+
+    usize used() const {
+        return _used;
+    }
+
+    usize len() const {
+        return _ll.len();
+    }
+};
+
+} // namespace Karm::Image
@@ -0,0 +1,394 @@
+#include "decoder.h"
+
+namespace Gif {
+
+enum : u8 {
+    EXTENSION = 0x21,
+    IMAGE = 0x2C,
+    TRAILER = 0x3B,
+
+    GRAPHIC_CONTROL = 0xF9,
+    APPLICATION = 0xFF,
+};
+
+static void _skipSubBlocks(Io::BScan &s) {
+    while (not s.ended()) {
+        u8 len = s.nextU8le();
+        if (len == 0)
+            break;
+        s.skip(len);
+    }
+}
+
+Res<Decoder> Decoder::init(Bytes slice) {
+    if (not sniff(slice)) {
+        logError("gif: invalid signature");
+        return Error::invalidData("invalid signature");
+    }
+
+    Decoder dec{};
+    Io::BScan s{slice};
+    s.skip(6);
+
+    try$(dec._readScreen(s));
+
+    // Graphic control extensions apply to the frame that follows them.
+    Frame pending{};
+    while (not s.ended()) {
+        u8 block = s.nextU8le();
+        if (block == EXTENSION) {
+            try$(dec._readExtension(s, pending));
+        } else if (block == IMAGE) {
+            try$(dec._readFrame(s, pending));
+            pending = {};
+        } else if (block == TRAILER) {
+            break;
+        } else {
+            logWarn("gif: unknown block: {:02x}", block);
+            break;
+        }
+    }
+
+    if (isEmpty(dec._frames)) {
+        logError("gif: no frames");
+        return Error::invalidData("no frames");
+    }
+
+    return Ok(dec);
+}
+
+Res<> Decoder::_readScreen(Io::BScan &s) {
+    if (s.rem() < 7) {
+        logError("gif: missing logical screen descriptor");
+        return Error::invalidData("missing logical screen descriptor");
+    }
+
+    _size.x = s.nextU16le();
+    _size.y = s.nextU16le();
+    u8 packed = s.nextU8le();
+    s.skip(2); // background color index and pixel aspect ratio
+
+    if (packed & 0x80) {
+        usize len = 3 * (2 << (packed & 0x7));
+        if (s.rem() < len) {
+            logError("gif: truncated global color table");
+            return Error::invalidData("truncated global color table");
+        }
+        _palette = s.nextBytes(len);
+    }
+
+    return Ok();
+}
+
+Res<> Decoder::_readExtension(Io::BScan &s, Frame &pending) {
+    u8 label = s.nextU8le();
+
+    if (label == GRAPHIC_CONTROL) {
+        Io::BScan block = s.nextBytes(s.nextU8le());
+        u8 packed = block.nextU8le();
+        usize delay = block.nextU16le();
+        u8 transparent = block.nextU8le();
+
+        u8 disposal = (packed >> 2) & 0x7;
+        pending.disposal = disposal <= 3 ? Disposal{disposal} : Disposal::NONE;
+        if (packed & 0x1)
+            pending.transparent = transparent;
+
+        // Like browsers, play the frames that don't have a delay at 10fps,
+        // a lot of GIFs are made with that in mind.
+        if (delay <= 1)
+            delay = 10;
+        pending.delay = TimeSpan::fromMSecs(delay * 10);
+    } else if (label == APPLICATION) {
+        Bytes id = s.nextBytes(s.nextU8le());
+        if (id == bytes(Str{"NETSCAPE2.0"}) or id == bytes(Str{"ANIMEXTS1.0"})) {
+            Io::BScan block = s.nextBytes(s.nextU8le());
+            if (block.rem() >= 3 and block.nextU8le() == 1) {
+                // This is the number of times the animation repeats after
+                // it played once, zero being forever.
+                usize loops = block.nextU16le();
+                if (loops == 0)
+                    _loops = NONE;
+                else
+                    _loops = loops + 1;
+            }
+        }
+    }
+
+    _skipSubBlocks(s);
+    return Ok();
+}
+
+Res<> Decoder::_readFrame(Io::BScan &s, Frame &pending) {
+    if (s.rem() < 10) {
+        logError("gif: truncated image descriptor");
+        return Error::invalidData("truncated image descriptor");
+    }
+
+    Frame frame = pending;
+    frame.bound.x = s.nextU16le();
+    frame.bound.y = s.nextU16le();
+    frame.bound.width = s.nextU16le();
+    frame.bound.height = s.nextU16le();
+    u8 packed = s.nextU8le();
+    frame.interlaced = packed & 0x40;
+
+    frame.palette = _palette;
+    if (packed & 0x80) {
+        usize len = 3 * (2 << (packed & 0x7));
+        if (s.rem() < len) {
+            logError("gif: truncated local color table");
+            return Error::invalidData("truncated local color table");
+        }
+        frame.palette = s.nextBytes(len);
+    }
+
+    frame.minCodeSize = s.nextU8le();
+    if (frame.minCodeSize < 1 or frame.minCodeSize > 11) {
+        logError("gif: invalid lzw code size: {}", frame.minCodeSize);
+        return Error::invalidData("invalid lzw code size");
+    }
+
+    auto start = s.remBytes();
+    _skipSubBlocks(s);
+    frame.data = sub(start, 0, start.len() - s.rem());
+
+    _frames.pushBack(frame);
+    return Ok();
+}
+
+// MARK: LZW -------------------------------------------------------------------
+
+// Read codes through the sub-blocks as one stream of bits, least
+// significant first.
+struct CodeReader {
+    Io::BScan s;
+    usize _left = 0; //< Bytes left in the current sub-block
+    bool _ended = false;
+    u64 _bits = 0;
+    usize _count = 0;
+
+    void refill() {
+        while (_count <= 56 and not _ended) {
+            if (_left == 0) {
+                _left = s.ended() ? 0 : s.nextU8le();
+                _ended = _left == 0;
+                continue;
+            }
+
+            if (s.ended()) {
+                _ended = true;
+                return;
+            }
+
+            _bits |= (u64)s.nextU8le() << _count;
+            _count += 8;
+            _left--;
+        }
+    }
+
+    always_inline Opt<usize> next(usize n) {
+        if (_count < n) {
+            refill();
+            if (_count < n)
+                return NONE;
+        }
+
+        usize code = _bits & ((1 << n) - 1);
+        _bits >>= n;
+        _count -= n;
+        return code;
+    }
+};
+
+Res<usize> Decoder::decodeIndices(Frame const &frame, MutSlice<u8> indices) const {
+    static constexpr usize MAX_CODES = 4096;
+
+    // Every code stands for a string that was already written out, in full:
+    // the string of the previous code followed by the first index of the
+    // next one. So the table only has to know where and how long it is,
+    // and decoding a code is a copy from earlier in the output.
+    Array<u32, MAX_CODES> offs;
+    Array<u16, MAX_CODES> lens;
+
+    CodeReader r{frame.data};
+    usize clear = 1 << frame.minCodeSize;
+    usize eoi = clear + 1;
+    usize next = eoi + 1;
+    usize size = frame.minCodeSize + 1;
+
+    u8 *out = indices.buf();
+    usize len = indices.len();
+    usize pos = 0;
+    Opt<usize> prev = NONE;
+    usize prevPos = 0;
+
+    while (pos < len) {
+        auto maybeCode = r.next(size);
+        if (not maybeCode)
+            break;
+        usize code = *maybeCode;
+
+        if (code == clear) {
+            next = eoi + 1;
+            size = frame.minCodeSize + 1;
+            prev = NONE;
+            continue;
+        }
+
+        if (code == eoi)
+            break;
+
+        usize start = pos;
+        if (code < clear) {
+            out[pos++] = code;
+        } else if (code < next and prev) {
+            usize n = min((usize)lens[code], len - pos);
+            memcpy(out + pos, out + offs[code], n);
+            pos += n;
+        } else if (code == next and prev) {
+            // The code being defined, it starts like the previous one.
+            usize n = min(pos - prevPos, len - pos);
+            memcpy(out + pos, out + prevPos, n);
+            pos += n;
+            if (pos < len)
+                out[pos++] = out[prevPos];
+        } else {
+            logError("gif: invalid lzw code: {}", code);
+            return Error::invalidData("invalid lzw code");
+        }
+
+        if (prev and next < MAX_CODES) {
+            offs[next] = prevPos;
+            lens[next] = start - prevPos + 1;
+            next++;
+            if (next == (1uz << size) and size < 12)
+                size++;
+        }
+
+        prev = code;
+        prevPos = start;
+    }
+
+    return Ok(pos);
+}
+
+// MARK: Decoding --------------------------------------------------------------
+
+Res<> Decoder::decode(Gfx::MutPixels pixels) {
+    Player player{*this};
+    return player.next(pixels);
+}
+
+// MARK: Player ----------------------------------------------------------------
+
+void Player::_dispose(Frame const &frame, Gfx::MutPixels canvas) {
+    auto bound = frame.bound.clipTo({0, 0, canvas.width(), canvas.height()});
+    usize rowLen = bound.width * 4;
+
+    if (frame.disposal == Disposal::BACKGROUND) {
+        // NOTE: Browsers clear to transparent rather than to the background
+        //       color, and so do we.
+        for (isize y = bound.y; y < bound.bottom(); ++y)
+            memset(static_cast<u8 *>(canvas.scanline(y)) + bound.x * 4, 0, rowLen);
+    } else if (frame.disposal == Disposal::PREVIOUS and any(_saved)) {
+        for (isize y = bound.y; y < bound.bottom(); ++y)
+            memcpy(static_cast<u8 *>(canvas.scanline(y)) + bound.x * 4, _saved.buf() + (y - bound.y) * rowLen, rowLen);
+    }
+}
+
+void Player::_save(Frame const &frame, Gfx::Pixels canvas) {
+    auto bound = frame.bound.clipTo({0, 0, canvas.width(), canvas.height()});
+    usize rowLen = bound.width * 4;
+
+    _saved.resize(rowLen * bound.height, 0);
+    for (isize y = bound.y; y < bound.bottom(); ++y)
+        memcpy(_saved.buf() + (y - bound.y) * rowLen, static_cast<u8 const *>(canvas.scanline(y)) + bound.x * 4, rowLen);
+}
+
+static isize _interlacedRow(isize row, isize height) {
+    // Rows are stored in four passes: every 8th row from 0, every 8th
+    // from 4, every 4th from 2 then every other one from 1.
+    static constexpr Array<isize, 4> START = {0, 4, 2, 1};
+    static constexpr Array<isize, 4> STEP = {8, 8, 4, 2};
+
+    for (usize pass = 0; pass < 4; ++pass) {
+        isize rows = (height - START[pass] + STEP[pass] - 1) / STEP[pass];
+        if (row < rows)
+            return START[pass] + row * STEP[pass];
+        row -= max(rows, 0);
+    }
+    return height;
+}
+
+void Player::_composite(Frame const &frame, usize len, Gfx::MutPixels canvas) {
+    // NOTE: Only 32-bit formats with the color channels in the first three
+    //       bytes exist, both are written directly.
+    bool bgra = canvas.fmt().is<Gfx::Bgra8888>();
+    Array<u32, 256> lut = {};
+    for (usize i = 0; i < frame.palette.len() / 3; ++i) {
+        u32 r = frame.palette[i * 3];
+        u32 g = frame.palette[i * 3 + 1];
+        u32 b = frame.palette[i * 3 + 2];
+        if (bgra)
+            std::swap(r, b);
+        lut[i] = r | (g << 8) | (b << 16) | 0xff000000;
+    }
+
+    auto const &bound = frame.bound;
+    isize x0 = max(bound.x, 0);
+    isize x1 = min(bound.end(), canvas.width());
+    if (x0 >= x1 or bound.width == 0)
+        return;
+
+    usize rows = (len + bound.width - 1) / bound.width;
+    for (usize row = 0; row < rows; ++row) {
+        isize y = bound.y + (frame.interlaced ? _interlacedRow(row, bound.height) : (isize)row);
+        if (y < 0 or y >= canvas.height())
+            continue;
+
+        u8 const *in = _indices.buf() + row * bound.width + (x0 - bound.x);
+        u32 *out = static_cast<u32 *>(canvas.scanline(y)) + x0;
+        isize n = min(x1, bound.x + (isize)(len - row * bound.width)) - x0;
+
+        if (not frame.transparent) {
+            for (isize x = 0; x < n; ++x)
+                out[x] = lut[in[x]];
+            continue;
+        }
+
+        u8 transparent = *frame.transparent;
+        for (isize x = 0; x < n; ++x)
+            if (in[x] != transparent)
+                out[x] = lut[in[x]];
+    }
+}
+
+Res<> Player::next(Gfx::MutPixels canvas) {
+    auto frames = _dec.frames();
+
+    if (_next > 0)
+        _dispose(frames[_next - 1], canvas);
+
+    if (_next == frames.len()) {
+        _next = 0;
+        _played++;
+    }
+
+    if (_next == 0)
+        canvas.clear();
+
+    auto const &frame = frames[_next++];
+    if (frame.disposal == Disposal::PREVIOUS)
+        _save(frame, canvas);
+    else
+        _saved.clear();
+
+    _indices.resize(frame.bound.width * frame.bound.height, 0);
+    usize len = try$(_dec.decodeIndices(frame, mutSub(_indices)));
+    _composite(frame, len, canvas);
+
+    return Ok();
+}
+
+} // namespace Gif
@@ -3,25 +3,37 @@
 // GIF Image decoder
 // References:
 //  - https://www.w3.org/Graphics/GIF/spec-gif89a.txt
+//  - https://www.matthewflickinger.com/lab/whatsinagif/
 
+#include <karm-base/time.h>
+#include <karm-base/vec.h>
 #include <karm-gfx/buffer.h>
 #include <karm-io/bscan.h>
+#include <karm-logger/logger.h>
 
 namespace Gif {
 
-struct Decoder {
-    struct Header {
-        Array<u8, 6> signature;
-    };
-
-    struct LogicalScreenDescriptor {
-        u16le width;
-        u16le height;
-        u8 packed;
-        u8 backgroundColorIndex;
-        u8 pixelAspectRatio;
-    };
+enum struct Disposal : u8 {
+    NONE = 0,       //< Not specified, same as KEEP
+    KEEP = 1,       //< Leave the frame in place
+    BACKGROUND = 2, //< Clear the area of the frame
+    PREVIOUS = 3,   //< Restore what was under the frame
+};
+
+struct Frame {
+    Math::Recti bound; //< Relative to the logical screen
+    bool interlaced;
+    Bytes palette; //< RGB triplets, either local to the frame or the global one
+    Opt<u8> transparent = NONE;
+    Disposal disposal = Disposal::NONE;
+    TimeSpan delay = TimeSpan::fromMSecs(100);
+    u8 minCodeSize;
+    Bytes data; //< LZW data, still split in sub-blocks
+};
 
+// MARK: Decoder ---------------------------------------------------------------
+
+struct Decoder {
     static bool sniff(Bytes slice) {
         bool isGif = slice.len() >= 6 and
                      slice[0] == 'G' and
@@ -41,34 +53,76 @@ struct Decoder {
         return isGif and (isGif89a or isGif87a);
     }
 
-    static Res<Decoder> init(Bytes slice) {
-        if (not sniff(slice))
-            return Error::invalidData("invalid signature");
+    // Only the blocks are indexed, frames are decoded when they are drawn.
+    static Res<Decoder> init(Bytes slice);
 
-        Decoder dec{};
-        Io::BScan scan{slice};
+    // MARK: Logical Screen ----------------------------------------------------
 
-        Header header{};
-        scan.readTo(&header);
+    Math::Vec2i _size;
+    Bytes _palette;
+    Opt<usize> _loops = 1; //< Number of times the animation plays, NONE for forever
 
-        LogicalScreenDescriptor lsd{};
-        scan.readTo(&lsd);
+    isize width() const { return _size.x; }
 
-        dec._size = {lsd.width, lsd.height};
+    isize height() const { return _size.y; }
 
-        return Ok(dec);
-    }
+    Opt<usize> loops() const { return _loops; }
 
-    Math::Vec2i _size;
+    Res<> _readScreen(Io::BScan &s);
 
-    isize width() const { return _size.x; }
+    // MARK: Frames ------------------------------------------------------------
 
-    isize height() const { return _size.y; }
+    Vec<Frame> _frames;
+
+    Slice<Frame> frames() const { return _frames; }
+
+    Res<> _readExtension(Io::BScan &s, Frame &pending);
 
-    Res<> decode(Gfx::MutPixels pixels) {
-        (void)pixels;
-        return Ok();
+    Res<> _readFrame(Io::BScan &s, Frame &pending);
+
+    // Decode the LZW data of a frame into the palette indices of its rows,
+    // in the order they are stored, returns how many were decoded.
+    Res<usize> decodeIndices(Frame const &frame, MutSlice<u8> indices) const;
+
+    // MARK: Decoding ----------------------------------------------------------
+
+    // Decode the first frame, use a `Player` for the others.
+    Res<> decode(Gfx::MutPixels pixels);
+};
+
+// MARK: Player ----------------------------------------------------------------
+
+// Draw the frames of an animation one after the other on a canvas of the
+// size of the logical screen, which is kept as it is between frames. Only
+// what's under the current frame is saved, if it has to be restored.
+struct Player {
+    Decoder _dec;
+    usize _next = 0;   //< Index of the next frame to draw
+    usize _played = 0; //< Number of times the animation played through
+    Vec<u8> _indices;
+    Vec<u8> _saved;
+
+    Player(Decoder dec) : _dec(std::move(dec)) {}
+
+    Decoder const &decoder() const { return _dec; }
+
+    // The frame last drawn.
+    Frame const &current() const { return _dec._frames[_next ? _next - 1 : 0]; }
+
+    // Whether the last frame is drawn, for the last time the animation
+    // should be played.
+    bool done() const {
+        return _dec._loops and _next == _dec._frames.len() and _played + 1 >= *_dec._loops;
     }
+
+    void _dispose(Frame const &frame, Gfx::MutPixels canvas);
+
+    void _save(Frame const &frame, Gfx::Pixels canvas);
+
+    void _composite(Frame const &frame, usize len, Gfx::MutPixels canvas);
+
+    // Draw the next frame, going back to the first one after the last.
+    Res<> next(Gfx::MutPixels canvas);
 };
 
 } // namespace Gif
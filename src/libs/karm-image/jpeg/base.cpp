@@ -1,3 +1,4 @@
+#include <karm-base/simd.h>
 #include <karm-math/funcs.h>
 
 #include "base.h"
@@ -314,6 +315,161 @@ void fdtc(Mcu &mcu) {
     }
 }
 
+// Samples go through the transform with AAN_BITS of fraction, scaled
+// quantization tables have QUANT_BITS and multipliers CONST_BITS. They are
+// kept small enough for the products to fit in 32 bits.
+static constexpr usize AAN_BITS = 6;
+static constexpr usize QUANT_BITS = 12;
+static constexpr usize CONST_BITS = 8;
+
+static constexpr i32 FIX_1_082392200 = 277;
+static constexpr i32 FIX_1_414213562 = 362;
+static constexpr i32 FIX_1_847759065 = 473;
+static constexpr i32 FIX_2_613125930 = 669;
+
+always_inline static i32x8 _mul(i32x8 v, i32 c) {
+    return (v * c) >> CONST_BITS;
+}
+
+// One dimensional transform of the 8 lanes of `v` at once.
+always_inline static void _idctAanPass(Array<i32x8, 8> &v) {
+    // Even part
+    i32x8 t10 = v[0] + v[4];
+    i32x8 t11 = v[0] - v[4];
+    i32x8 t13 = v[2] + v[6];
+    i32x8 t12 = _mul(v[2] - v[6], FIX_1_414213562) - t13;
+
+    i32x8 e0 = t10 + t13;
+    i32x8 e3 = t10 - t13;
+    i32x8 e1 = t11 + t12;
+    i32x8 e2 = t11 - t12;
+
+    // Odd part
+    i32x8 z13 = v[5] + v[3];
+    i32x8 z10 = v[5] - v[3];
+    i32x8 z11 = v[1] + v[7];
+    i32x8 z12 = v[1] - v[7];
+
+    i32x8 o7 = z11 + z13;
+    i32x8 o11 = _mul(z11 - z13, FIX_1_414213562);
+    i32x8 z5 = _mul(z10 + z12, FIX_1_847759065);
+    i32x8 o10 = _mul(z12, FIX_1_082392200) - z5;
+    i32x8 o12 = z5 - _mul(z10, FIX_2_613125930);
+
+    i32x8 o6 = o12 - o7;
+    i32x8 o5 = o11 - o6;
+    i32x8 o4 = o10 + o5;
+
+    v[0] = e0 + o7;
+    v[7] = e0 - o7;
+    v[1] = e1 + o6;
+    v[6] = e1 - o6;
+    v[2] = e2 + o5;
+    v[5] = e2 - o5;
+    v[4] = e3 + o4;
+    v[3] = e3 - o4;
+}
+
+always_inline static void _transpose(Array<i32x8, 8> &v) {
+    for (usize i = 0; i < 8; ++i) {
+        for (usize j = 0; j < i; ++j) {
+            i32 t = v[i][j];
+            v[i][j] = v[j][i];
+            v[j][i] = t;
+        }
+    }
+}
+
+// Level shift and clamp to a byte, `v` has AAN_BITS + 3 bits of fraction
+// since the transform leaves the samples scaled by 8.
+always_inline static u8x8 _descale(i32x8 v) {
+    v = (v + ((128 << (AAN_BITS + 3)) + (1 << (AAN_BITS + 2)))) >> (AAN_BITS + 3);
+    v = v & ~(v >> 31);
+    v = (v | ((255 - v) >> 31)) & 255;
+    return __builtin_convertvector(v, u8x8);
+}
+
+void idctAan(Mcu const &mcu, AanQuant const &quant, u8 *out, usize stride) {
+    Array<i32x8, 8> v;
+    for (usize y = 0; y < 8; ++y) {
+        i16x8 c;
+        i32x8 q;
+        memcpy(&c, &mcu[y * 8], sizeof(c));
+        memcpy(&q, &quant[y * 8], sizeof(q));
+        v[y] = (__builtin_convertvector(c, i32x8) * q + (1 << (QUANT_BITS - AAN_BITS - 1))) >> (QUANT_BITS - AAN_BITS);
+    }
+
+    // Lanes are columns, so this transforms the 8 columns at once, then
+    // the rows once transposed.
+    _idctAanPass(v);
+    _transpose(v);
+    _idctAanPass(v);
+    _transpose(v);
+
+    for (usize y = 0; y < 8; ++y) {
+        u8x8 line = _descale(v[y]);
+        memcpy(out + y * stride, &line, sizeof(line));
+    }
+}
+
+void idctAanDc(i16 dc, AanQuant const &quant, usize size, u8 *out, usize stride) {
+    i32 v = (dc * quant[0] + (1 << (QUANT_BITS - AAN_BITS - 1))) >> (QUANT_BITS - AAN_BITS);
+    u8x8 line = _descale(i32x8{} + v);
+    for (usize y = 0; y < size; ++y)
+        memcpy(out + y * stride, &line, size);
+}
+
+// The N lowest frequencies of a block, scaled by sqrt(N / 8), are the
+// coefficients of the N point DCT of the block scaled down. Rows go through
+// the table with REDUCED_BITS of fraction, and are brought back to
+// REDUCED_PASS_BITS before the columns.
+static constexpr usize REDUCED_BITS = 12;
+static constexpr usize REDUCED_PASS_BITS = 4;
+
+using ReducedTable = Array<i32, 16>;
+
+static ReducedTable _reducedTable(usize size) {
+    // Orthonormal N point inverse DCT, with the scaling of the coefficients
+    // folded in.
+    ReducedTable res = {};
+    for (usize k = 0; k < size; ++k) {
+        for (usize n = 0; n < size; ++n) {
+            f64 c = k == 0 ? Math::sqrt(0.5) : 1.0;
+            f64 v = c * Math::cos((2 * n + 1) * k * Math::PI / (2 * size)) / 2;
+            res[k * size + n] = v * (1 << REDUCED_BITS) + (v < 0 ? -0.5 : 0.5);
+        }
+    }
+    return res;
+}
+
+void idctReduced(Mcu const &mcu, Quant const &quant, usize size, u8 *out, usize stride) {
+    static ReducedTable const table4 = _reducedTable(4);
+    static ReducedTable const table2 = _reducedTable(2);
+    auto const &table = size == 4 ? table4 : table2;
+
+    // Rows
+    Array<i32, 16> tmp = {};
+    for (usize v = 0; v < size; ++v) {
+        for (usize x = 0; x < size; ++x) {
+            i32 sum = 0;
+            for (usize u = 0; u < size; ++u)
+                sum += mcu[v * 8 + u] * (i32)quant[v * 8 + u] * table[u * size + x];
+            tmp[v * size + x] = sum >> (REDUCED_BITS - REDUCED_PASS_BITS);
+        }
+    }
+
+    // Columns, then level shift and clamp
+    for (usize y = 0; y < size; ++y) {
+        for (usize x = 0; x < size; ++x) {
+            i32 sum = 0;
+            for (usize v = 0; v < size; ++v)
+                sum += tmp[v * size + x] * table[v * size + y];
+            sum = (sum + (1 << (REDUCED_BITS + REDUCED_PASS_BITS - 1))) >> (REDUCED_BITS + REDUCED_PASS_BITS);
+            out[y * stride + x] = clamp(sum + 128, 0, 255);
+        }
+    }
+}
+
 // MARK: Quantization ----------------------------------------------------------
 
 void quantize(Mcu &mcu, Quant const &quant) {
@@ -328,6 +484,66 @@ void dequantize(Mcu &mcu, Quant const &quant) {
     }
 }
 
+AanQuant aanQuant(Quant const &quant) {
+    // cos(k * pi / 16) * sqrt(2), and 1 for k = 0
+    static Array<f64, 8> const scale = {
+        1.0, 1.387039845, 1.306562965, 1.175875602,
+        1.0, 0.785694958, 0.541196100, 0.275899379
+    };
+
+    AanQuant res;
+    for (usize i = 0; i < 64; ++i)
+        res[i] = quant[i] * scale[i / 8] * scale[i % 8] * (1 << QUANT_BITS) + 0.5;
+    return res;
+}
+
+// MARK: Bit Reader ------------------------------------------------------------
+
+void BitReader::reset() {
+    _bits = 0;
+    _count = 0;
+    _marker = false;
+
+    while (s.rem() >= 2 and s.peekU8be() == 0xFF and s.peek(1).peekU8be() == 0xFF)
+        s.skip(1);
+
+    if (s.rem() >= 2 and s.peekU8be() == 0xFF) {
+        u8 marker = s.peek(1).peekU8be();
+        if (RST0 <= marker and marker <= RST7)
+            s.skip(2);
+    }
+}
+
+void BitReader::_refillSlow() {
+    while (_count <= 56) {
+        u64 byte = 0;
+
+        if (not _marker and not s.ended()) {
+            byte = s.peekU8be();
+            if (byte != 0xFF) {
+                s.skip(1);
+            } else {
+                // Any number of 0xFF can be used as fill before a marker.
+                auto after = s.peek(1);
+                while (not after.ended() and after.peekU8be() == 0xFF)
+                    after.skip(1);
+
+                if (not after.ended() and after.peekU8be() == 0x00) {
+                    after.skip(1);
+                    s = after;
+                } else {
+                    // Leave the marker to whoever comes after us.
+                    _marker = true;
+                    byte = 0;
+                }
+            }
+        }
+
+        _bits |= byte << (56 - _count);
+        _count += 8;
+    }
+}
+
 // MARK: Huffman Tables --------------------------------------------------------
 
 Array<usize, 256> const &Huff::codes() {
@@ -345,18 +561,60 @@ Array<usize, 256> const &Huff::codes() {
     return *_codes;
 }
 
-Res<Byte> Huff::next(BitReader &bs) {
-    usize code = 0;
-    for (usize i = 0; i < 16; ++i) {
-        code = (code << 1) | try$(bs.nextBit());
-        for (usize j = offs[i]; j < offs[i + 1]; ++j) {
-            if (code == codes()[j]) {
-                return Ok(syms[j]);
+void Huff::build() {
+    _fast = {};
+    _fastAc = {};
+
+    isize code = 0;
+    for (usize len = 1; len <= 16; ++len) {
+        isize count = offs[len] - offs[len - 1];
+        _delta[len] = (isize)offs[len - 1] - code;
+        _maxCode[len] = count ? code + count - 1 : -1;
+
+        for (usize j = offs[len - 1]; j < offs[len]; ++j, ++code) {
+            if (len > FAST_BITS or code >= (1 << len))
+                continue;
+
+            usize shift = FAST_BITS - len;
+            for (usize i = code << shift; i < (usize)(code + 1) << shift; ++i) {
+                _fast[i] = {(u8)len, syms[j]};
+
+                usize run = syms[j] >> 4;
+                usize size = syms[j] & 0xF;
+                if (size == 0 or len + size > FAST_BITS)
+                    continue;
+
+                usize bits = (i << len) & ((1 << FAST_BITS) - 1);
+                _fastAc[i] = {
+                    (i16)BitReader::extend(bits >> (FAST_BITS - size), size),
+                    (u8)run,
+                    (u8)(len + size),
+                };
             }
         }
+
+        code <<= 1;
+    }
+}
+
+Res<Byte> Huff::next(BitReader &bs) {
+    usize bits = bs.peek(16);
+
+    auto fast = _fast[bits >> (16 - FAST_BITS)];
+    if (fast.len) {
+        bs.consume(fast.len);
+        return Ok(fast.sym);
+    }
+
+    for (usize len = FAST_BITS + 1; len <= 16; ++len) {
+        isize code = bits >> (16 - len);
+        if (code <= _maxCode[len]) {
+            bs.consume(len);
+            return Ok(syms[code + _delta[len]]);
+        }
     }
 
-    logError("jpeg: invalid huffman code {x}", code);
+    logError("jpeg: invalid huffman code {x}", bits);
     return Error::invalidData("invalid huffman code");
 }
 
@@ -141,59 +141,71 @@ struct BitWriter {
 struct BitReader {
     Io::BScan &s;
 
-    u8 _buf = 0;
-    u8 _len = 0;
+    // The next bits of the stream, most significant first.
+    u64 _bits = 0;
+    usize _count = 0;
 
-    always_inline BitReader(Io::BScan &s) : s(s) {}
+    // The data ends at the first marker, only zeros are read past it.
+    bool _marker = false;
 
-    always_inline void reset() {
-        _buf = 0x0;
-        _len = 0x0;
-    }
+    always_inline BitReader(Io::BScan &s) : s(s) {}
 
-    always_inline Res<> fill() {
-        if (_len)
-            return Ok();
+    // Drop the bits left and skip the restart marker following them.
+    void reset();
+
+    void _refillSlow();
+
+    // Make sure there are at least 57 bits in the reservoir.
+    always_inline void refill() {
+        if (_count > 56)
+            return;
+
+        // Take as many whole bytes as fit at once, unless one of them is
+        // 0xFF, which is either a stuffed byte or the start of a marker.
+        if (not _marker and s.rem() >= 8) {
+            usize n = (64 - _count) / 8;
+            u64 chunk = s.peekU64be() >> (64 - n * 8);
+            u64 v = ~chunk;
+            if (((v - 0x0101010101010101) & ~v & 0x8080808080808080) == 0) {
+                _bits |= chunk << (64 - _count - n * 8);
+                _count += n * 8;
+                s.skip(n);
+                return;
+            }
+        }
 
-        _buf = s.nextU8be();
-        while (_buf == 0xFF) {
-            u8 marker = s.peekU8be();
+        _refillSlow();
+    }
 
-            while (marker == 0xFF) {
-                s.nextU8be();
-                marker = s.peekU8be();
-            }
+    always_inline usize peek(usize n) {
+        refill();
+        return _bits >> (64 - n);
+    }
 
-            if (marker == 0x00) {
-                s.nextU8be();
-                break;
-            } else if (RST0 <= marker and marker <= RST7) {
-                s.nextU8be();
-                _buf = s.nextU8be();
-            } else {
-                logError("jpeg: invalid marker");
-                return Error::invalidData("invalid marker");
-            }
-        }
+    always_inline void consume(usize n) {
+        _bits <<= n;
+        _count -= n;
+    }
 
-        _len = 8;
-        return Ok();
+    always_inline usize nextBits(usize n) {
+        if (n == 0)
+            return 0;
+        usize res = peek(n);
+        consume(n);
+        return res;
     }
 
-    always_inline Res<u8> nextBit() {
-        try$(fill());
-        u8 bit = _buf >> 7;
-        _buf <<= 1;
-        _len--;
-        return Ok(bit);
+    // Turn the `n` bits of an amplitude into the signed value they stand for.
+    static always_inline isize extend(usize v, usize n) {
+        if (n == 0)
+            return 0;
+        if (v < (1uz << (n - 1)))
+            return (isize)v - (1 << n) + 1;
+        return v;
     }
 
-    always_inline Res<usize> nextBits(u8 n) {
-        usize res = 0;
-        while (n--) {
-            res = (res << 1) | try$(nextBit());
-        }
-        return Ok(res);
+    always_inline isize receive(usize n) {
+        return extend(nextBits(n), n);
     }
 };
 
@@ -222,29 +234,70 @@ static inline Mcu mcuFetch(Gfx::Pixels pixels, usize mx, usize my, usize compone
     return mcu;
 }
 
+// MARK: Quantization Tables ---------------------------------------------------
+
+using Quant = Array<usize, 64>;
+
+// Quantization table scaled by the AAN factors, so that dequantizing is
+// folded into the first stage of `idctAan()`.
+using AanQuant = Array<i32, 64>;
+
+void quantize(Mcu &mcu, Quant const &quant);
+
+void dequantize(Mcu &mcu, Quant const &quant);
+
+AanQuant aanQuant(Quant const &quant);
+
 // MARK: Discrete Cosine Transform ---------------------------------------------
 
 void idct(Mcu &mcu);
 
 void fdtc(Mcu &mcu);
 
-// MARK: Quantization Tables ---------------------------------------------------
+// Fixed-point AAN inverse DCT of a quantized block, 8 columns at a time.
+// Samples are level shifted, clamped and written as 8 lines of 8 bytes.
+void idctAan(Mcu const &mcu, AanQuant const &quant, u8 *out, usize stride);
 
-using Quant = Array<usize, 64>;
+// Same as `idctAan()` for a block with only a DC coefficient, which is
+// written as `size` lines of `size` bytes.
+void idctAanDc(i16 dc, AanQuant const &quant, usize size, u8 *out, usize stride);
 
-void quantize(Mcu &mcu, Quant const &quant);
-
-void dequantize(Mcu &mcu, Quant const &quant);
+// Inverse DCT of the `size`x`size` lowest frequencies of a block, which
+// gives the block scaled down to 4x4 or 2x2 without computing all of it.
+void idctReduced(Mcu const &mcu, Quant const &quant, usize size, u8 *out, usize stride);
 
 // MARK: Huffman Tables --------------------------------------------------------
 
 struct Huff {
-    Array<u8, 17> offs = {};
-    Array<u8, 162> syms = {};
+    static constexpr usize FAST_BITS = 9;
+
+    struct Fast {
+        u8 len; //< Zero when the code is longer than FAST_BITS
+        u8 sym;
+    };
+
+    // An AC symbol and its amplitude bits when they fit together in
+    // FAST_BITS, with the amplitude already sign-extended.
+    struct FastAc {
+        i16 value;
+        u8 run;
+        u8 len;
+    };
+
+    Array<u16, 17> offs = {};
+    Array<u8, 256> syms = {};
     Opt<Array<usize, 256>> _codes = {};
 
+    Array<Fast, 1 << FAST_BITS> _fast = {};
+    Array<FastAc, 1 << FAST_BITS> _fastAc = {};
+    Array<isize, 17> _maxCode = {}; //< Largest code of each length, -1 if there are none
+    Array<isize, 17> _delta = {};   //< From a code to the index of its symbol
+
     Array<usize, 256> const &codes();
 
+    // Build the lookup tables, must be called before decoding.
+    void build();
+
     Res<Byte> next(BitReader &bs);
 
     bool getCode(u8 symbol, usize &code, usize &codeLength);
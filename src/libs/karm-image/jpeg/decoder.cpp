@@ -1,3 +1,5 @@
+#include <karm-base/simd.h>
+
 #include "decoder.h"
 
 namespace Jpeg {
@@ -14,10 +16,21 @@ Res<Decoder> Decoder::init(Bytes slice) {
 
     Decoder dec{};
     Io::BScan s{slice};
+    s.skip(2); // SOI
+
+    // NOTE: Only the headers are read here, the scans and the tables between
+    //       them are left to `decode()`, which also copes with images that
+    //       are cut short.
+    if (not try$(dec.nextScan(s))) {
+        logError("jpeg: missing scan");
+        return Error::invalidData("missing scan");
+    }
+    dec._scan = s.remBytes();
 
-    bool reachedEoi = false;
-    bool expectSoi = true;
+    return Ok(dec);
+};
 
+Res<bool> Decoder::nextScan(Io::BScan &s) {
     while (not s.ended()) {
         u8 first = s.nextU8be();
 
@@ -28,50 +41,59 @@ Res<Decoder> Decoder::init(Bytes slice) {
 
         u8 marker = s.nextU8be();
 
-        if (expectSoi) {
-            if (marker != SOI) {
-                logError("jpeg: missing SOI marker");
-                return Error::invalidData("missing SOI marker");
-            }
-            expectSoi = false;
-        } else if (APP0 <= marker and marker <= APP15) {
+        // Any number of 0xFF can be used as fill before a marker.
+        while (marker == 0xFF and not s.ended())
+            marker = s.nextU8be();
+
+        if (APP0 <= marker and marker <= APP15) {
             logWarn("jpeg: skipping APP{}", marker - APP0);
-            dec.skipMarker(s);
+            skipMarker(s);
         } else if (marker == DQT) {
-            try$(dec.defineQuantizationTable(s));
-        } else if (marker == SOF0) {
-            try$(dec.startOfFrame(s));
+            try$(defineQuantizationTable(s));
+        } else if (marker == SOF0 or marker == SOF1 or marker == SOF2) {
+            _progressive = marker == SOF2;
+            try$(startOfFrame(s));
         } else if (marker == DRI) {
-            try$(dec.defineRestartInterval(s));
+            try$(defineRestartInterval(s));
         } else if (marker == DHT) {
-            try$(dec.defineHuffmanTable(s));
+            try$(defineHuffmanTable(s));
+        } else if (SOF3 <= marker and marker <= SOF15 and marker != JPG and marker != DAC) {
+            logError("jpeg: unsupported frame type: {:02x}", marker);
+            return Error::invalidData("unsupported frame type");
         } else if (marker == SOS) {
-            try$(dec.startOfScan(s));
-            try$(dec.decodeHuffman(s));
+            try$(startOfScan(s));
+            return Ok(true);
         } else if (marker == EOI) {
-            reachedEoi = true;
+            return Ok(false);
         } else if (marker == TEM) {
             logWarn("jpeg: ignoring TEM marker");
         } else if (marker == COM) {
             logDebug("jpeg: skipping comment");
-            dec.skipMarker(s);
-        } else if (marker == 0xff) {
-            logDebug("jpeg: skipping padding byte");
-            while (marker == 0xff) {
-                marker = s.nextU8be();
-            }
+            skipMarker(s);
         } else {
             logWarn("jpeg: unknown marker: {:02x}", marker);
         }
     }
 
-    if (not reachedEoi) {
-        logError("jpeg: missing EOI marker");
-        return Error::invalidData("missing EOI marker");
+    return Ok(false);
+}
+
+Res<> Decoder::scale(isize scale) {
+    if (scale != 1 and scale != 2 and scale != 4 and scale != 8) {
+        logError("jpeg: unsupported scale: 1/{}", scale);
+        return Error::invalidInput("unsupported scale");
     }
+    _scale = scale;
+    return Ok();
+}
 
-    return Ok(dec);
-};
+void Decoder::scaleTo(Math::Vec2i size) {
+    _scale = 1;
+    while (_scale < 8 and
+           _width / (_scale * 2) >= size.x and
+           _height / (_scale * 2) >= size.y)
+        _scale *= 2;
+}
 
 void Decoder::skipMarker(Io::BScan &s) {
     u16 len = s.nextU16be();
@@ -153,13 +175,30 @@ Res<> Decoder::startOfFrame(Io::BScan &x) {
         u8 factors = s.nextU8be();
         u8 quantId = s.nextU8be();
 
+        u8 hFactor = factors >> 4;
+        u8 vFactor = factors & 0xF;
+
+        if (hFactor < 1 or hFactor > 4 or vFactor < 1 or vFactor > 4) {
+            logError("jpeg: invalid sampling factors: {}x{}", hFactor, vFactor);
+            return Error::invalidData("invalid sampling factors");
+        }
+
+        // A single component is coded one block at a time, whatever its
+        // sampling factors are.
+        if (componentCount == 1) {
+            hFactor = 1;
+            vFactor = 1;
+        }
+
         _components[id].emplace(Component{
-            (u8)(factors >> 4),
-            (u8)(factors & 0xF),
+            hFactor,
+            vFactor,
             quantId,
         });
 
         _componentCount = max(_componentCount, (usize)id + 1);
+        _hMax = max(_hMax, (usize)hFactor);
+        _vMax = max(_vMax, (usize)vFactor);
     }
 
     return Ok();
@@ -205,7 +244,9 @@ Res<> Decoder::defineHuffmanTable(Io::BScan &x) {
             table.offs[i] = sum;
         }
 
-        if (sum > 162) {
+        // Progressive AC tables have symbols for runs of end of bands on
+        // top of the 162 of sequential ones.
+        if (sum > 256) {
             logError("jpeg: invalid huffman table length: {}", sum);
             return Error::invalidData("invalid huffman table length");
         }
@@ -213,6 +254,8 @@ Res<> Decoder::defineHuffmanTable(Io::BScan &x) {
         for (usize i = 0; i < sum; ++i) {
             table.syms[i] = s.nextU8be();
         }
+
+        table.build();
     }
 
     return Ok();
@@ -229,12 +272,17 @@ Res<> Decoder::startOfScan(Io::BScan &x) {
     u16 len = x.nextU16be();
     Io::BScan s = x.nextBytes(len - 2);
 
+    // Scans after the first one can code only some of the components, or
+    // a single one which then isn't interleaved.
     u8 componentCount = s.nextU8be();
-    if (componentCount != _componentCount) {
+    if (componentCount < 1 or componentCount > _componentCount) {
         logError("jpeg: invalid component count: {}", componentCount);
         return Error::invalidData("invalid component count");
     }
 
+    _scanComponents = {};
+    _scanLen = 0;
+
     for (u8 i = 0; i < componentCount; ++i) {
         u8 id = s.nextU8be();
 
@@ -271,7 +319,13 @@ Res<> Decoder::startOfScan(Io::BScan &x) {
             return Error::invalidData("invalid ac huffman table id");
         }
 
+        if (_scanComponents[id]) {
+            logError("jpeg: duplicate scan component id: {}", id);
+            return Error::invalidData("duplicate scan component id");
+        }
+
         _scanComponents[id].emplace(ScanComponent{dcHuffId, acHuffId});
+        _scanOrder[_scanLen++] = id;
     }
 
     _ss = s.nextU8be();
@@ -280,14 +334,28 @@ Res<> Decoder::startOfScan(Io::BScan &x) {
     _ah = ahAl >> 4;
     _al = ahAl & 0xF;
 
-    if (_ss != 0 or _se != 63) {
-        logError("jpeg: unexpected spectral selection");
-        return Error::invalidData("unexpected spectral selection");
-    }
+    if (_progressive) {
+        // The DC coefficients are coded on their own, and AC bands one
+        // component at a time.
+        if (_se > 63 or _ss > _se or (_ss == 0 and _se != 0) or (_ss != 0 and componentCount != 1)) {
+            logError("jpeg: invalid spectral selection: {}..{}", _ss, _se);
+            return Error::invalidData("invalid spectral selection");
+        }
+
+        if (_ah > 13 or _al > 13) {
+            logError("jpeg: invalid successive approximation: {} {}", _ah, _al);
+            return Error::invalidData("invalid successive approximation");
+        }
+    } else {
+        if (_ss != 0 or _se != 63) {
+            logError("jpeg: unexpected spectral selection");
+            return Error::invalidData("unexpected spectral selection");
+        }
 
-    if (_ah != 0 or _al != 0) {
-        logError("jpeg: unexpected successive approximation");
-        return Error::invalidData("unexpected successive approximation");
+        if (_ah != 0 or _al != 0) {
+            logError("jpeg: unexpected successive approximation");
+            return Error::invalidData("unexpected successive approximation");
+        }
     }
 
     if (not s.ended()) {
@@ -298,138 +366,625 @@ Res<> Decoder::startOfScan(Io::BScan &x) {
     return Ok();
 }
 
-Res<> Decoder::decodeHuffman(Io::BScan &s) {
-    _mcus.resize(mcuWidth() * mcuHeight() * _componentCount);
+Res<> Decoder::_checkScan() {
+    for (usize i = 0; i < _scanLen; ++i) {
+        auto &sc = _scanComponents[_scanOrder[i]].unwrap();
 
-    Array<isize, 3> prevDc = {};
+        // Refining the DC coefficients only takes raw bits, and the DC
+        // scans of progressive images have no AC coefficients.
+        if (_ss == 0 and _ah == 0 and not _dcHuff[sc.dcHuffId]) {
+            logError("jpeg: undefined dc huffman table id: {}", sc.dcHuffId);
+            return Error::invalidData("undefined dc huffman table id");
+        }
 
-    BitReader bs{s};
+        if (_se != 0 and not _acHuff[sc.acHuffId]) {
+            logError("jpeg: undefined ac huffman table id: {}", sc.acHuffId);
+            return Error::invalidData("undefined ac huffman table id");
+        }
+    }
 
-    for (usize i = 0; i < _mcus.len(); ++i) {
-        Mcu &mcu = _mcus[i];
-        usize cid = i % _componentCount;
+    return Ok();
+}
 
-        // logDebug("jpeg: decoding mcu {} of {} (cid: {})", i + 1, _mcus.len(), cid);
+void Decoder::skipScan(Io::BScan &s) {
+    // The scan runs up to the first marker that isn't a stuffed byte or a
+    // restart marker.
+    while (not s.ended()) {
+        if (s.peekU8be() != 0xFF) {
+            s.skip(1);
+            continue;
+        }
 
-        // handle restart interval
-        if (_restartInterval > 0 and (i / _componentCount) % _restartInterval == 0) {
-            prevDc = {};
-            bs.reset();
+        u8 next = s.peek(1).peekU8be();
+        if (next != 0x00 and not(RST0 <= next and next <= RST7))
+            break;
+        s.skip(2);
+    }
+}
+
+Res<usize> Decoder::decodeBlock(BitReader &bs, usize cid, Mcu &mcu, isize &prevDc) {
+    auto &c = _scanComponents[cid].unwrap();
+    auto &dcHuff = _dcHuff[c.dcHuffId].unwrap();
+    auto &acHuff = _acHuff[c.acHuffId].unwrap();
+
+    Byte len = try$(dcHuff.next(bs));
+
+    if (len > 11) {
+        logError("jpeg: invalid dc huffman code length: {}", len);
+        return Error::invalidData("invalid dc huffman code length");
+    }
+
+    mcu[0] = prevDc + bs.receive(len);
+    prevDc = mcu[0];
+
+    usize end = 1;
+    usize k = 1;
+    while (k < 64) {
+        // Most symbols and their amplitude fit in the lookup table.
+        auto fast = acHuff._fastAc[bs.peek(Huff::FAST_BITS)];
+        if (fast.len) {
+            bs.consume(fast.len);
+            k += fast.run;
+            if (k >= 64) {
+                logError("jpeg: zero run length exceeds block size: {}", k);
+                return Error::invalidData("zero run length exceeds block size");
+            }
+            mcu[ZIGZAG[k++]] = fast.value;
+            end = k;
+            continue;
         }
 
-        if (not _scanComponents[cid]) {
-            logError("jpeg: undefined component id: {}", cid);
-            return Error::invalidData("undefined component id");
+        Byte sym = try$(acHuff.next(bs));
+
+        if (sym == 0) {
+            break;
         }
 
-        auto &c = _scanComponents[cid].unwrap();
+        Byte numZeroes = sym >> 4;
 
-        // logDebug("jpeg: decoding using huffman table (dc: {}, ac: {})", c.dcHuffId, c.acHuffId);
+        if (sym == 0xF0) {
+            numZeroes = 16;
+        }
 
-        if (not _dcHuff[c.dcHuffId]) {
-            logError("jpeg: undefined dc huffman table id: {}", c.dcHuffId);
-            return Error::invalidData("undefined dc huffman table id");
+        if (k + numZeroes >= 64) {
+            logError("jpeg: zero run length exceeds block size: {}", k + numZeroes);
+            return Error::invalidData("zero run length exceeds block size");
         }
 
-        auto &dcHuff = _dcHuff[c.dcHuffId].unwrap();
+        k += numZeroes;
 
-        if (not _acHuff[c.acHuffId]) {
-            logError("jpeg: undefined ac huffman table id: {}", c.acHuffId);
-            return Error::invalidData("undefined ac huffman table id");
+        Byte len = sym & 0xF;
+
+        if (len > 10) {
+            logError("jpeg: invalid ac huffman code length: {}", len);
+            return Error::invalidData("invalid ac huffman code length");
+        }
+
+        if (len) {
+            mcu[ZIGZAG[k++]] = bs.receive(len);
+            end = k;
+        }
+    }
+
+    return Ok(end);
+}
+
+// MARK: Progressive -----------------------------------------------------------
+
+Res<> Decoder::_decodeDcFirst(BitReader &bs, usize cid, Mcu &mcu, isize &prevDc) {
+    auto &dcHuff = _dcHuff[_scanComponents[cid]->dcHuffId].unwrap();
+
+    Byte len = try$(dcHuff.next(bs));
+
+    if (len > 11) {
+        logError("jpeg: invalid dc huffman code length: {}", len);
+        return Error::invalidData("invalid dc huffman code length");
+    }
+
+    prevDc += bs.receive(len);
+    mcu[0] = prevDc * (1 << _al);
+    return Ok();
+}
+
+void Decoder::_decodeDcRefine(BitReader &bs, Mcu &mcu) {
+    if (bs.nextBits(1))
+        mcu[0] |= 1 << _al;
+}
+
+Res<usize> Decoder::_decodeAcFirst(BitReader &bs, usize cid, Mcu &mcu) {
+    if (_eobRun > 0) {
+        _eobRun--;
+        return Ok(0uz);
+    }
+
+    auto &acHuff = _acHuff[_scanComponents[cid]->acHuffId].unwrap();
+
+    usize end = 0;
+    usize k = _ss;
+    while (k <= _se) {
+        auto fast = acHuff._fastAc[bs.peek(Huff::FAST_BITS)];
+        if (fast.len) {
+            bs.consume(fast.len);
+            k += fast.run;
+            if (k > _se) {
+                logError("jpeg: zero run length exceeds band: {}", k);
+                return Error::invalidData("zero run length exceeds band");
+            }
+            mcu[ZIGZAG[k++]] = fast.value * (1 << _al);
+            end = k;
+            continue;
         }
 
-        auto &acHuff = _acHuff[c.acHuffId].unwrap();
+        Byte sym = try$(acHuff.next(bs));
+        usize run = sym >> 4;
+        usize len = sym & 0xF;
 
-        Byte len = try$(dcHuff.next(bs));
+        if (len == 0) {
+            if (run == 15) {
+                k += 16;
+                continue;
+            }
 
-        if (len > 11) {
-            logError("jpeg: invalid dc huffman code length: {}", len);
-            return Error::invalidData("invalid dc huffman code length");
+            // The band ends here, for this block and the next `_eobRun` ones.
+            _eobRun = (1uz << run) - 1;
+            _eobRun += bs.nextBits(run);
+            break;
         }
 
-        isize coeff = try$(bs.nextBits(len));
+        k += run;
+        if (k > _se) {
+            logError("jpeg: zero run length exceeds band: {}", k);
+            return Error::invalidData("zero run length exceeds band");
+        }
 
-        if (len != 0 and coeff < (1 << (len - 1))) {
-            coeff -= (1 << len) - 1;
+        if (len > 10) {
+            logError("jpeg: invalid ac huffman code length: {}", len);
+            return Error::invalidData("invalid ac huffman code length");
         }
 
-        mcu[0] = prevDc[cid] + coeff;
-        prevDc[cid] = mcu[0];
+        mcu[ZIGZAG[k++]] = bs.receive(len) * (1 << _al);
+        end = k;
+    }
 
-        usize k = 1;
-        while (k < 64) {
+    return Ok(end);
+}
+
+Res<usize> Decoder::_decodeAcRefine(BitReader &bs, usize cid, Mcu &mcu) {
+    auto &acHuff = _acHuff[_scanComponents[cid]->acHuffId].unwrap();
+
+    short p1 = 1 << _al;
+    short m1 = -p1;
+
+    // Coefficients that are already known get one more bit each time they
+    // are passed over, new ones can only be 1 or -1 at this point.
+    auto refine = [&](short &coef) {
+        if (bs.nextBits(1) and (coef & p1) == 0)
+            coef += coef >= 0 ? p1 : m1;
+    };
+
+    usize end = 0;
+    usize k = _ss;
+    if (_eobRun == 0) {
+        for (; k <= _se; ++k) {
             Byte sym = try$(acHuff.next(bs));
+            usize run = sym >> 4;
+            usize len = sym & 0xF;
 
-            if (sym == 0) {
+            short value = 0;
+            if (len) {
+                value = bs.nextBits(1) ? p1 : m1;
+            } else if (run != 15) {
+                _eobRun = 1uz << run;
+                _eobRun += bs.nextBits(run);
                 break;
             }
 
-            Byte numZeroes = sym >> 4;
-
-            if (sym == 0xF0) {
-                numZeroes = 16;
+            // Skip `run` zero coefficients, the new one goes in the next.
+            for (; k <= _se; ++k) {
+                auto &coef = mcu[ZIGZAG[k]];
+                if (coef != 0)
+                    refine(coef);
+                else if (run-- == 0)
+                    break;
             }
 
-            if (k + numZeroes >= 64) {
-                logError("jpeg: zero run length exceeds block size: {}", k + numZeroes);
-                return Error::invalidData("zero run length exceeds block size");
+            if (value and k <= _se) {
+                mcu[ZIGZAG[k]] = value;
+                end = k + 1;
             }
+        }
+    }
+
+    if (_eobRun > 0) {
+        for (; k <= _se; ++k) {
+            auto &coef = mcu[ZIGZAG[k]];
+            if (coef != 0)
+                refine(coef);
+        }
+        _eobRun--;
+    }
 
-            k += numZeroes;
+    return Ok(end);
+}
 
-            Byte len = sym & 0xF;
+Res<> Decoder::_decodeCoefs(BitReader &bs, usize cid, usize bx, usize by, isize &prevDc) {
+    auto &c = _coefs[cid];
+    usize i = by * c.across + bx;
+    auto &mcu = c.blocks[i];
+
+    usize end = 0;
+    if (not _progressive)
+        end = try$(decodeBlock(bs, cid, mcu, prevDc));
+    else if (_ss == 0 and _ah == 0)
+        try$(_decodeDcFirst(bs, cid, mcu, prevDc));
+    else if (_ss == 0)
+        _decodeDcRefine(bs, mcu);
+    else if (_ah == 0)
+        end = try$(_decodeAcFirst(bs, cid, mcu));
+    else
+        end = try$(_decodeAcRefine(bs, cid, mcu));
+
+    c.ends[i] = max(c.ends[i], max(end, 1uz));
+    return Ok();
+}
 
-            if (len > 10) {
-                logError("jpeg: invalid ac huffman code length: {}", len);
-                return Error::invalidData("invalid ac huffman code length");
-            }
+Res<> Decoder::_decodeScan(Io::BScan &s) {
+    try$(_checkScan());
 
-            if (len) {
-                coeff = try$(bs.nextBits(len));
+    BitReader bs{s};
+    Array<isize, 4> prevDc = {};
+    _eobRun = 0;
 
-                if (coeff < (1 << (len - 1))) {
-                    coeff -= (1 << len) - 1;
+    auto restart = [&](usize i) {
+        if (_restartInterval > 0 and i % _restartInterval == 0) {
+            prevDc = {};
+            _eobRun = 0;
+            bs.reset();
+        }
+    };
+
+    if (_scanLen == 1) {
+        // A scan of a single component isn't interleaved, each of its
+        // blocks is an MCU, without the ones padding the MCUs of the frame.
+        usize cid = _scanOrder[0];
+        auto &comp = _components[cid].unwrap();
+        usize across = (_width * comp.hFactor + _hMax * 8 - 1) / (_hMax * 8);
+        usize down = (_height * comp.vFactor + _vMax * 8 - 1) / (_vMax * 8);
+
+        for (usize by = 0; by < down; ++by) {
+            for (usize bx = 0; bx < across; ++bx) {
+                restart(by * across + bx);
+                try$(_decodeCoefs(bs, cid, bx, by, prevDc[cid]));
+            }
+        }
+    } else {
+        for (isize my = 0; my < mcuHeight(); ++my) {
+            for (isize mx = 0; mx < mcuWidth(); ++mx) {
+                restart(my * mcuWidth() + mx);
+
+                for (usize i = 0; i < _scanLen; ++i) {
+                    usize cid = _scanOrder[i];
+                    auto &comp = _components[cid].unwrap();
+                    for (usize by = 0; by < comp.vFactor; ++by)
+                        for (usize bx = 0; bx < comp.hFactor; ++bx)
+                            try$(_decodeCoefs(bs, cid, mx * comp.hFactor + bx, my * comp.vFactor + by, prevDc[cid]));
                 }
-
-                mcu[ZIGZAG[k++]] = coeff;
             }
         }
     }
 
+    skipScan(s);
     return Ok();
 }
 
-Res<> Decoder::decode(Gfx::MutPixels pixels) {
-    for (usize i = 0; i < _mcus.len(); i += _componentCount) {
-        usize x = (i / _componentCount) % mcuWidth();
-        usize y = (i / _componentCount) / mcuWidth();
+// MARK: Decoding --------------------------------------------------------------
+
+Res<> Decoder::_setupPlanes() {
+    _planes.clear();
+
+    for (usize cid = 0; cid < _componentCount; ++cid) {
+        if (not _components[cid]) {
+            logError("jpeg: undefined component id: {}", cid);
+            return Error::invalidData("undefined component id");
+        }
+
+        auto &c = _components[cid].unwrap();
+
+        if (not _quant[c.quantId]) {
+            logError("jpeg: undefined quantization table id: {}", c.quantId);
+            return Error::invalidData("undefined quantization table id");
+        }
 
-        for (usize j = 0; j < _componentCount; j++) {
-            auto &mcu = _mcus[i + j];
+        Plane p{
+            .hFactor = c.hFactor,
+            .vFactor = c.vFactor,
+            .width = (isize)((width() * c.hFactor + _hMax - 1) / _hMax),
+            .height = (isize)((height() * c.vFactor + _vMax - 1) / _vMax),
+            // Lines are read 8 samples at a time, even when blocks are smaller.
+            .stride = alignUp(mcuWidth() * c.hFactor * _blockSize(), 8),
+            .lines = c.vFactor * _blockSize(),
+            .aanQuant = aanQuant(*_quant[c.quantId]),
+            .quant = *_quant[c.quantId],
+            .buf = {},
+            .sums = {},
+            .up = {},
+        };
+
+        p.buf.resize(p.stride * p.lines * 2, 0);
+        if (p.hFactor != _hMax or p.vFactor != _vMax) {
+            p.sums.resize(p.stride + 2, 0);
+            p.up.resize(alignUp(width(), 8) + 8, 0);
+        }
+        _planes.pushBack(std::move(p));
+    }
 
-            if (not _quant[_components[j]->quantId]) {
-                logError("jpeg: undefined quantization table id: {}", _components[j]->quantId);
-                return Error::invalidData("undefined quantization table id");
+    return Ok();
+}
+
+void Decoder::_idctBlock(Plane &p, Mcu const &mcu, usize end, u8 *out) {
+    usize size = _blockSize();
+    if (end <= 1 or size == 1)
+        idctAanDc(mcu[0], p.aanQuant, size, out, p.stride);
+    else if (size == 8)
+        idctAan(mcu, p.aanQuant, out, p.stride);
+    else
+        idctReduced(mcu, p.quant, size, out, p.stride);
+}
+
+Res<> Decoder::_decodeMcuRow(BitReader &bs, isize my, Array<isize, 4> &prevDc) {
+    usize size = _blockSize();
+
+    for (isize mx = 0; mx < mcuWidth(); ++mx) {
+        usize i = my * mcuWidth() + mx;
+
+        // handle restart interval
+        if (_restartInterval > 0 and i % _restartInterval == 0) {
+            prevDc = {};
+            bs.reset();
+        }
+
+        for (usize cid = 0; cid < _planes.len(); ++cid) {
+            auto &p = _planes[cid];
+            for (usize by = 0; by < p.vFactor; ++by) {
+                u8 *line = p.buf.buf() + ((my % 2) * p.lines + by * size) * p.stride;
+                for (usize bx = 0; bx < p.hFactor; ++bx) {
+                    Mcu mcu = {};
+                    usize end = try$(decodeBlock(bs, cid, mcu, prevDc[cid]));
+                    _idctBlock(p, mcu, end, line + (mx * p.hFactor + bx) * size);
+                }
             }
+        }
+    }
+
+    return Ok();
+}
 
-            auto &quant = _quant[_components[j]->quantId].unwrap();
-            dequantize(mcu, quant);
-            idct(mcu);
+void Decoder::_renderMcuRow(isize my) {
+    usize size = _blockSize();
+
+    for (usize cid = 0; cid < _planes.len(); ++cid) {
+        auto &p = _planes[cid];
+        auto &c = _coefs[cid];
+        for (usize by = 0; by < p.vFactor; ++by) {
+            u8 *line = p.buf.buf() + ((my % 2) * p.lines + by * size) * p.stride;
+            usize row = (my * p.vFactor + by) * c.across;
+            for (usize bx = 0; bx < c.across; ++bx)
+                _idctBlock(p, c.blocks[row + bx], c.ends[row + bx], line + bx * size);
         }
+    }
+}
+
+u8 const *Decoder::_upsample(Plane &p, isize y) {
+    if (p.hFactor == _hMax and p.vFactor == _vMax)
+        return p.line(y);
 
-        auto &yMcu = _mcus[i + 0];
-        auto &cbMcu = _mcus[i + 1];
-        auto &crMcu = _mcus[i + 2];
+    u8 *out = p.up.buf();
+    bool h2 = p.hFactor * 2 == _hMax;
+    bool v2 = p.vFactor * 2 == _vMax;
 
-        for (usize k = 0; k < 64; ++k) {
-            isize px = x * 8 + k % 8;
-            isize py = y * 8 + k / 8;
+    if ((not h2 and p.hFactor != _hMax) or (not v2 and p.vFactor != _vMax)) {
+        // Other ratios are rare enough to just replicate the samples.
+        u8 const *in = p.line(y * p.vFactor / _vMax);
+        for (isize x = 0; x < width(); ++x)
+            out[x] = in[x * p.hFactor / _hMax];
+        return out;
+    }
 
-            Gfx::YCbCr ycbcr{(float)yMcu[k], (float)cbMcu[k], (float)crMcu[k]};
-            pixels.storeUnsafe({px, py}, Gfx::yCbCrToRgb(ycbcr));
+    // Same "fancy" upsampling as libjpeg: each output sample is 3/4 of the
+    // nearest input sample and 1/4 of the next nearest one, in each
+    // direction. Samples are first summed vertically, with one sample of
+    // padding on each side of the line.
+    u16 *sums = p.sums.buf() + 1;
+    if (v2) {
+        u8 const *near = p.line(y / 2);
+        u8 const *far = p.line(y % 2 ? y / 2 + 1 : y / 2 - 1);
+        for (isize x = 0; x < p.width; x += 8) {
+            u8x8 n, f;
+            memcpy(&n, near + x, sizeof(n));
+            memcpy(&f, far + x, sizeof(f));
+            u16x8 s = __builtin_convertvector(n, u16x8) * 3 + __builtin_convertvector(f, u16x8);
+            memcpy(sums + x, &s, sizeof(s));
         }
+    } else {
+        u8 const *in = p.line(y);
+        for (isize x = 0; x < p.width; x += 8) {
+            u8x8 n;
+            memcpy(&n, in + x, sizeof(n));
+            u16x8 s = __builtin_convertvector(n, u16x8);
+            memcpy(sums + x, &s, sizeof(s));
+        }
+    }
+    sums[-1] = sums[0];
+    sums[p.width] = sums[p.width - 1];
+
+    if (not h2) {
+        u16 bias = y % 2 ? 2 : 1;
+        for (isize x = 0; x < p.width; x += 8) {
+            u16x8 s;
+            memcpy(&s, sums + x, sizeof(s));
+            u8x8 o = __builtin_convertvector((s + bias) >> 2, u8x8);
+            memcpy(out + x, &o, sizeof(o));
+        }
+        return out;
+    }
+
+    // The vertical sums are 4 times the samples, hence the larger shift.
+    u16 shift = v2 ? 4 : 2;
+    u16 even = v2 ? 8 : 1;
+    u16 odd = v2 ? 7 : 2;
+    for (isize x = 0; x < p.width; ++x) {
+        out[x * 2] = (sums[x] * 3 + sums[x - 1] + even) >> shift;
+        out[x * 2 + 1] = (sums[x] * 3 + sums[x + 1] + odd) >> shift;
+    }
+    return out;
+}
+
+always_inline static i32x8 _clampU8(i32x8 v) {
+    v = v & ~(v >> 31);
+    return (v | ((255 - v) >> 31)) & 255;
+}
+
+always_inline static i32x8 _loadU8x8(u8 const *p) {
+    u8x8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, i32x8);
+}
+
+always_inline static void _storePixels(u8 *out, isize n, u32x8 px) {
+    memcpy(out, &px, min(n, 8) * 4);
+}
+
+// Same fixed-point conversion as libjpeg, with 16 bits of fraction, 8
+// pixels at the time.
+static void _yCbCrToRgba(u8 const *lum, u8 const *cb, u8 const *cr, u8 *out, isize width, bool bgra) {
+    for (isize x = 0; x < width; x += 8) {
+        i32x8 y = _loadU8x8(lum + x);
+        i32x8 b = _loadU8x8(cb + x) - 128;
+        i32x8 r = _loadU8x8(cr + x) - 128;
+
+        u32x8 red = (u32x8)_clampU8(y + ((91881 * r + 32768) >> 16));
+        u32x8 green = (u32x8)_clampU8(y + ((-22554 * b - 46802 * r + 32768) >> 16));
+        u32x8 blue = (u32x8)_clampU8(y + ((116130 * b + 32768) >> 16));
+
+        if (bgra)
+            std::swap(red, blue);
+
+        _storePixels(out + x * 4, width - x, red | (green << 8) | (blue << 16) | 0xff000000);
+    }
+}
+
+static void _grayToRgba(u8 const *lum, u8 *out, isize width) {
+    for (isize x = 0; x < width; x += 8) {
+        u32x8 y = (u32x8)_loadU8x8(lum + x);
+        _storePixels(out + x * 4, width - x, y * 0x010101 | 0xff000000);
+    }
+}
+
+void Decoder::_storeRow(Gfx::MutPixels pixels, isize y) {
+    // NOTE: Only 32-bit formats with the color channels in the first three
+    //       bytes exist, both are written directly.
+    u8 *out = static_cast<u8 *>(pixels.scanline(y));
+    isize width = min(this->width(), pixels.width());
+
+    if (_planes.len() == 1) {
+        _grayToRgba(_upsample(_planes[0], y), out, width);
+        return;
+    }
+
+    _yCbCrToRgba(
+        _upsample(_planes[0], y),
+        _upsample(_planes[1], y),
+        _upsample(_planes[2], y),
+        out,
+        width,
+        pixels.fmt().is<Gfx::Bgra8888>()
+    );
+}
+
+void Decoder::_storeRows(Gfx::MutPixels pixels, isize my, isize &y) {
+    // Upsampling looks one line down, so the last line of the MCU row
+    // waits for the next one.
+    isize height = min(this->height(), pixels.height());
+    isize end = my + 1 < mcuHeight() ? (my + 1) * _vMax * _blockSize() - 1 : height;
+    for (; y < min(end, height); ++y)
+        _storeRow(pixels, y);
+}
+
+void Decoder::_render(Gfx::MutPixels pixels) {
+    isize y = 0;
+    for (isize my = 0; my < mcuHeight(); ++my) {
+        _renderMcuRow(my);
+        _storeRows(pixels, my, y);
+    }
+}
+
+Res<> Decoder::_decodeScans(Gfx::MutPixels pixels, Opt<OnScan> &onScan) {
+    try$(_setupPlanes());
+
+    _coefs.clear();
+    for (auto &p : _planes) {
+        Coefs c{
+            .across = mcuWidth() * p.hFactor,
+            .blocks = {},
+            .ends = {},
+        };
+        usize len = c.across * mcuHeight() * p.vFactor;
+        c.blocks.resize(len, Mcu{});
+        c.ends.resize(len, 0);
+        _coefs.pushBack(std::move(c));
+    }
+
+    Io::BScan s{*_scan};
+    usize scans = 0;
+    while (true) {
+        try$(_decodeScan(s));
+        scans++;
+
+        // Tables can be redefined between scans, and the image can be cut
+        // short, in which case whatever was decoded so far is shown.
+        bool more = try$(nextScan(s));
+        if (not more)
+            break;
+
+        if (onScan) {
+            _render(pixels);
+            (*onScan)(scans);
+        }
+    }
+
+    _render(pixels);
+    _coefs.clear();
+    _planes.clear();
+    return Ok();
+}
+
+Res<> Decoder::decode(Gfx::MutPixels pixels, Opt<OnScan> onScan) {
+    if (not _scan) {
+        logError("jpeg: missing scan");
+        return Error::invalidData("missing scan");
+    }
+
+    // Images with more than one scan are decoded on a copy, their tables
+    // can be redefined by the scans that come after the first one.
+    if (_progressive or _scanLen != _componentCount) {
+        Decoder dec = *this;
+        return dec._decodeScans(pixels, onScan);
+    }
+
+    try$(_setupPlanes());
+    try$(_checkScan());
+
+    Io::BScan s{*_scan};
+    BitReader bs{s};
+    Array<isize, 4> prevDc = {};
+
+    isize y = 0;
+    for (isize my = 0; my < mcuHeight(); ++my) {
+        try$(_decodeMcuRow(bs, my, prevDc));
+        _storeRows(pixels, my, y);
     }
 
+    _planes.clear();
     return Ok();
 }
 
@@ -438,6 +993,7 @@ void Decoder::repr(Io::Emit &e) {
     e.indentNewline();
     e.ln("width: {}", width());
     e.ln("height: {}", height());
+    e.ln("progressive: {}", _progressive);
 
     e("quantization tables:");
     e.indentNewline();
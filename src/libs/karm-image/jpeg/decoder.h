@@ -8,6 +8,7 @@
 //  - https://github.com/dannye/jed/blob/master/src/decoder.cpp
 //  - https://www.youtube.com/watch?v=CPT4FSkFUgs
 
+#include <karm-base/func.h>
 #include <karm-base/vec.h>
 #include <karm-gfx/buffer.h>
 #include <karm-gfx/colors.h>
@@ -28,6 +29,10 @@ struct Decoder {
 
     void skipMarker(Io::BScan &s);
 
+    // Read the markers up to the next scan, returns false once the image
+    // ends instead.
+    Res<bool> nextScan(Io::BScan &s);
+
     // MARK: Quantization Tables -----------------------------------------------
 
     Array<Opt<Quant>, 4> _quant;
@@ -39,14 +44,23 @@ struct Decoder {
 
     isize _width = 8;
     isize _height = 8;
+    isize _scale = 1;
+    bool _progressive = false;
+
+    // Size of the decoded image, smaller than the frame when scaled down.
+    isize width() const { return (_width + _scale - 1) / _scale; }
 
-    isize width() const { return _width; }
+    isize height() const { return (_height + _scale - 1) / _scale; }
 
-    isize height() const { return _height; }
+    // Decode at 1/2, 1/4 or 1/8 of the size. Blocks are decoded straight
+    // to that size from their lowest frequencies, which is a lot cheaper
+    // than decoding everything and scaling it down after.
+    Res<> scale(isize scale);
 
-    isize mcuWidth() const { return (_width + 7) / 8; }
+    // Pick the smallest scale that is still at least `size`.
+    void scaleTo(Math::Vec2i size);
 
-    isize mcuHeight() const { return (_height + 7) / 8; }
+    usize _blockSize() const { return 8 / _scale; }
 
     struct Component {
         u8 hFactor;
@@ -57,6 +71,15 @@ struct Decoder {
     Array<Opt<Component>, 4> _components;
     usize _componentCount = 0;
 
+    // Largest sampling factors, an MCU covers this many blocks
+    usize _hMax = 1;
+    usize _vMax = 1;
+
+    // Number of MCUs across and down the image
+    isize mcuWidth() const { return (_width + _hMax * 8 - 1) / (_hMax * 8); }
+
+    isize mcuHeight() const { return (_height + _vMax * 8 - 1) / (_vMax * 8); }
+
     Res<> startOfFrame(Io::BScan &x);
 
     // MARK: Restart interval --------------------------------------------------
@@ -80,22 +103,110 @@ struct Decoder {
     };
 
     Array<Opt<ScanComponent>, 4> _scanComponents;
+    Array<usize, 4> _scanOrder = {}; //< Components of the scan, in the order they are coded
+    usize _scanLen = 0;
     u8 _ss = 0;
     u8 _se = 0;
     u8 _ah = 0;
     u8 _al = 0;
 
+    Opt<Bytes> _scan; //< Everything from the data of the first scan, decoded by `decode()`
+
     Res<> startOfScan(Io::BScan &x);
 
+    // Check that the tables used by the scan are defined.
+    Res<> _checkScan();
+
+    void skipScan(Io::BScan &s);
+
     // MARK: Huffman Data ------------------------------------------------------
 
-    Vec<Mcu> _mcus;
+    // Decode the next block of a component, returns the number of
+    // coefficients up to the last one that isn't zero.
+    Res<usize> decodeBlock(BitReader &bs, usize cid, Mcu &mcu, isize &prevDc);
+
+    // MARK: Progressive -------------------------------------------------------
+
+    // Progressive scans each code a band of the coefficients, or one more
+    // bit of them, so the coefficients of the whole image are kept around
+    // until the last scan is decoded.
+    struct Coefs {
+        usize across; //< Blocks across, padded to whole MCUs
+        Vec<Mcu> blocks;
+        Vec<u8> ends; //< Number of coefficients up to the last one that isn't zero
+    };
+
+    Vec<Coefs> _coefs;
+    usize _eobRun = 0; //< Blocks left with nothing more in the band
+
+    Res<> _decodeDcFirst(BitReader &bs, usize cid, Mcu &mcu, isize &prevDc);
+
+    void _decodeDcRefine(BitReader &bs, Mcu &mcu);
+
+    Res<usize> _decodeAcFirst(BitReader &bs, usize cid, Mcu &mcu);
 
-    Res<> decodeHuffman(Io::BScan &s);
+    Res<usize> _decodeAcRefine(BitReader &bs, usize cid, Mcu &mcu);
+
+    Res<> _decodeCoefs(BitReader &bs, usize cid, usize bx, usize by, isize &prevDc);
+
+    Res<> _decodeScan(Io::BScan &s);
 
     // MARK: Decoding ----------------------------------------------------------
 
-    Res<> decode(Gfx::MutPixels pixels);
+    // The samples of a component for the MCU row being decoded and the one
+    // before it, which upsampling still needs for the rows in between.
+    struct Plane {
+        usize hFactor;
+        usize vFactor;
+        isize width;  //< Samples across, without the padding of the blocks
+        isize height; //< Samples down, without the padding of the blocks
+        usize stride;
+        usize lines; //< Lines in one MCU row
+        AanQuant aanQuant;
+        Quant quant;
+        Vec<u8> buf;
+
+        // Scratch space for upsampling
+        Vec<u16> sums;
+        Vec<u8> up;
+
+        u8 *line(isize y) {
+            y = clamp(y, 0, height - 1);
+            return buf.buf() + (y % (lines * 2)) * stride;
+        }
+    };
+
+    Vec<Plane> _planes;
+
+    Res<> _setupPlanes();
+
+    void _idctBlock(Plane &p, Mcu const &mcu, usize end, u8 *out);
+
+    Res<> _decodeMcuRow(BitReader &bs, isize my, Array<isize, 4> &prevDc);
+
+    void _renderMcuRow(isize my);
+
+    u8 const *_upsample(Plane &p, isize y);
+
+    void _storeRow(Gfx::MutPixels pixels, isize y);
+
+    void _storeRows(Gfx::MutPixels pixels, isize my, isize &y);
+
+    void _render(Gfx::MutPixels pixels);
+
+    // Called with the number of scans decoded so far, once the image they
+    // make up is in the pixels.
+    using OnScan = Func<void(usize scans)>;
+
+    Res<> _decodeScans(Gfx::MutPixels pixels, Opt<OnScan> &onScan);
+
+    // Decode the image one MCU row at a time, lines are color converted
+    // into `pixels` as soon as the chroma below them is decoded.
+    //
+    // Progressive images are only complete after their last scan, with
+    // `onScan` the image is also rendered after each of the ones before,
+    // so that it can be shown while the rest is still loading or decoding.
+    Res<> decode(Gfx::MutPixels pixels, Opt<OnScan> onScan = NONE);
 
     // MARK: Dumping -----------------------------------------------------------
 
@@ -1,4 +1,8 @@
+#include <karm-logger/logger.h>
 #include <karm-sys/file.h>
+#include <karm-sys/pool.h>
+#include <karm-sys/stat.h>
+#include <karm-sys/time.h>
 
 #include "bmp/decoder.h"
 #include "gif/decoder.h"
@@ -33,8 +37,10 @@ static Res<Picture> loadPng(Bytes bytes) {
     return Ok(img);
 }
 
-static Res<Picture> loadJpeg(Bytes bytes) {
+static Res<Picture> loadJpeg(Bytes bytes, Opt<Math::Vec2i> size) {
     auto jpeg = try$(Jpeg::Decoder::init(bytes));
+    if (size)
+        jpeg.scaleTo(*size);
     auto img = Gfx::Surface::alloc({jpeg.width(), jpeg.height()});
     try$(jpeg.decode(*img));
     return Ok(img);
@@ -54,7 +60,7 @@ static Res<Picture> loadGif(Bytes bytes) {
     return Ok(img);
 }
 
-Res<Picture> load(Sys::Mmap &&map) {
+Res<Picture> load(Sys::Mmap &&map, Opt<Math::Vec2i> size) {
     if (Bmp::Decoder::sniff(map.bytes())) {
         return loadBmp(map.bytes());
     } else if (Qoi::Decoder::sniff(map.bytes())) {
@@ -62,7 +68,7 @@ Res<Picture> load(Sys::Mmap &&map) {
     } else if (Png::Decoder::sniff(map.bytes())) {
         return loadPng(map.bytes());
     } else if (Jpeg::Decoder::sniff(map.bytes())) {
-        return loadJpeg(map.bytes());
+        return loadJpeg(map.bytes(), size);
     } else if (Tga::Decoder::sniff(map.bytes())) {
         return loadTga(map.bytes());
     } else if (Gif::Decoder::sniff(map.bytes())) {
@@ -72,10 +78,96 @@ Res<Picture> load(Sys::Mmap &&map) {
     }
 }
 
-Res<Picture> load(Mime::Url url) {
-    auto file = try$(Sys::File::open(url));
-    auto map = try$(Sys::mmap().map(file));
-    return load(std::move(map));
+// MARK: Cache -----------------------------------------------------------------
+
+Cache &cache() {
+    static Cache cache;
+    return cache;
+}
+
+// Images being decoded on the pool, for the callers asking for them in the
+// meantime to wait on.
+static Map<Cache::Key, Async::Promise<Picture>> &_inflight() {
+    static Map<Cache::Key, Async::Promise<Picture>> inflight;
+    return inflight;
+}
+
+static Opt<Cache::Key> _keyOf(Mime::Url const &url, Opt<Math::Vec2i> size) {
+    auto stat = Sys::stat(url);
+    if (not stat)
+        return NONE;
+    return Cache::Key{url, stat.unwrap().modifyTime, size};
+}
+
+struct _Decoded {
+    Res<Picture> picture;
+    TimeSpan time;
+};
+
+// Safe to call from a thread of the pool.
+static _Decoded _decode(Mime::Url const &url, Opt<Math::Vec2i> size) {
+    auto start = Sys::now();
+    auto picture = [&] -> Res<Picture> {
+        auto file = try$(Sys::File::open(url));
+        auto map = try$(Sys::mmap().map(file));
+        return load(std::move(map), size);
+    }();
+    return {picture, Sys::now() - start};
+}
+
+static void _store(Opt<Cache::Key> const &key, Mime::Url const &url, _Decoded const &decoded) {
+    if (not decoded.picture)
+        return;
+
+    auto &c = cache();
+    if (key)
+        c.put(*key, decoded.picture.unwrap());
+
+    logDebug(
+        "decoded {} in {}ms, {} images cached, {}% of loads hit the cache",
+        url, decoded.time.toMSecs(), c.len(), c.hitRate()
+    );
+}
+
+// MARK: Loading ---------------------------------------------------------------
+
+Res<Picture> load(Mime::Url url, Opt<Math::Vec2i> size) {
+    auto key = _keyOf(url, size);
+    if (key) {
+        if (auto picture = cache().get(*key))
+            return Ok(*picture);
+    }
+
+    auto decoded = _decode(url, size);
+    _store(key, url, decoded);
+    return decoded.picture;
+}
+
+Async::Task<Picture> loadAsync(Mime::Url url, Opt<Math::Vec2i> size) {
+    auto key = _keyOf(url, size);
+    if (key) {
+        // Checked first so that waiting isn't also counted as a miss, the
+        // image is never both in flight and cached.
+        if (auto promise = _inflight().access(*key)) {
+            cache().waited();
+            co_return co_await promise->future();
+        }
+
+        if (auto picture = cache().get(*key))
+            co_return Ok(*picture);
+
+        _inflight().put(*key, Async::Promise<Picture>{});
+    }
+
+    auto decoded = co_await Sys::globalPool().submit<_Decoded>([url, size] {
+        return _decode(url, size);
+    });
+    _store(key, url, decoded);
+
+    if (key)
+        _inflight().take(*key).resolve(decoded.picture);
+
+    co_return decoded.picture;
 }
 
 Res<Picture> loadOrFallback(Mime::Url url) {
@@ -84,4 +176,17 @@ Res<Picture> loadOrFallback(Mime::Url url) {
     return Ok(Gfx::Surface::fallback());
 }
 
+Res<Strong<Animation>> loadAnimation(Mime::Url url) {
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    if (not Gif::Decoder::sniff(map.bytes()))
+        return Error::invalidData("not an animated image");
+
+    // The frames point into the mapping, which moves along with them.
+    auto gif = try$(Gif::Decoder::init(map.bytes()));
+    auto anim = makeStrong<Animation>(std::move(map), std::move(gif));
+    try$(anim->next());
+    return Ok(anim);
+}
+
 } // namespace Karm::Image
@@ -1,15 +1,34 @@
 #pragma once
 
+#include <karm-async/task.h>
 #include <karm-sys/mmap.h>
 
+#include "animation.h"
+#include "cache.h"
 #include "picture.h"
 
 namespace Karm::Image {
 
-Res<Picture> load(Sys::Mmap &&map);
+// `size` is a hint of the size the image is going to be displayed at.
+// Decoders that can produce a smaller image for free (JPEG) do so, without
+// going under the hint. Other formats are always loaded at full size.
+Res<Picture> load(Sys::Mmap &&map, Opt<Math::Vec2i> size = NONE);
 
-Res<Picture> load(Mime::Url url);
+// The images loaded from a url, shared by `load()` and `loadAsync()`.
+Cache &cache();
+
+// Images are cached by url, modification time and `size`, the same image is
+// only decoded once for as long as it stays in the cache.
+Res<Picture> load(Mime::Url url, Opt<Math::Vec2i> size = NONE);
+
+// Like `load()`, but decoded on `Sys::globalPool()`. Concurrent loads of the
+// same image wait on the first one instead of decoding it again.
+Async::Task<Picture> loadAsync(Mime::Url url, Opt<Math::Vec2i> size = NONE);
 
 Res<Picture> loadOrFallback(Mime::Url url);
 
+// Only GIFs are animated, other formats are an error, for which `load()`
+// should be used instead.
+Res<Strong<Animation>> loadAnimation(Mime::Url url);
+
 } // namespace Karm::Image
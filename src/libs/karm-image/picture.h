@@ -22,6 +22,10 @@ struct Picture {
         return _surface->pixels();
     }
 
+    always_inline Gfx::Surface const &surface() const {
+        return *_surface;
+    }
+
     always_inline isize width() const {
         return _surface->width();
     }
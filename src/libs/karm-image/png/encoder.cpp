@@ -0,0 +1,209 @@
+#include <karm-archive/zlib/encoder.h>
+#include <karm-crypto/crc32.h>
+#include <karm-math/funcs.h>
+
+#include "decoder.h"
+#include "encoder.h"
+
+namespace Png {
+
+enum Filter : u8 {
+    NONE,
+    SUB,
+    UP,
+    AVERAGE,
+    PAETH,
+
+    _FILTER_LEN,
+};
+
+static constexpr usize IDAT_SIZE = 65536;
+
+static void _writeChunk(Io::BEmit &e, Str type, Bytes data) {
+    Karm::Crypto::Crc32 crc;
+    crc.update(bytes(type));
+    crc.update(data);
+
+    e.writeU32be(data.len());
+    e.writeStr(type);
+    e.writeBytes(data);
+    e.writeU32be(crc.digest());
+}
+
+// Split the compressed data in IDAT chunks as it comes.
+struct IdatWriter : public Io::Writer {
+    Io::BEmit &_e;
+    Vec<u8> _buf;
+
+    IdatWriter(Io::BEmit &e) : _e(e) {
+        _buf.ensure(IDAT_SIZE);
+    }
+
+    Res<usize> write(Bytes bytes) override {
+        for (usize off = 0; off < bytes.len();) {
+            usize n = min(IDAT_SIZE - _buf.len(), bytes.len() - off);
+            _buf.insertMany(_buf.len(), sub(bytes, off, off + n));
+            off += n;
+            if (_buf.len() == IDAT_SIZE)
+                flush();
+        }
+        return Ok(bytes.len());
+    }
+
+    void flush() {
+        if (isEmpty(_buf))
+            return;
+        _writeChunk(_e, Idat::SIG, _buf);
+        _buf.clear();
+    }
+};
+
+static void _loadRow(Gfx::Pixels pixels, isize y, usize channels, MutSlice<u8> row) {
+    bool bgra = pixels.fmt().is<Gfx::Bgra8888>();
+    u8 const *in = static_cast<u8 const *>(pixels.scanline(y));
+    u8 *out = row.buf();
+
+    for (isize x = 0; x < pixels.width(); x++) {
+        out[0] = in[bgra ? 2 : 0];
+        out[1] = in[1];
+        out[2] = in[bgra ? 0 : 2];
+        if (channels == 4)
+            out[3] = in[3];
+        in += 4;
+        out += channels;
+    }
+}
+
+static bool _isOpaque(Gfx::Pixels pixels) {
+    for (isize y = 0; y < pixels.height(); y++) {
+        u8 const *in = static_cast<u8 const *>(pixels.scanline(y));
+        for (isize x = 0; x < pixels.width(); x++)
+            if (in[x * 4 + 3] != 0xff)
+                return false;
+    }
+    return true;
+}
+
+static always_inline u8 _paeth(u8 a, u8 b, u8 c) {
+    isize p = (isize)a + b - c;
+    isize pa = Math::abs(p - a);
+    isize pb = Math::abs(p - b);
+    isize pc = Math::abs(p - c);
+    if (pa <= pb and pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+// Filter a row, `out` starts with the filter type, returns the sum of the
+// filtered bytes taken as signed, the smaller the better it should compress.
+static usize _filterRow(Filter filter, Bytes curr, Bytes prev, usize bpp, MutSlice<u8> out) {
+    usize len = curr.len();
+    u8 const *c = curr.buf();
+    u8 const *p = prev.buf();
+    u8 *o = out.buf() + 1;
+    out[0] = filter;
+
+    switch (filter) {
+    case NONE:
+        for (usize i = 0; i < len; i++)
+            o[i] = c[i];
+        break;
+
+    case SUB:
+        for (usize i = 0; i < bpp; i++)
+            o[i] = c[i];
+        for (usize i = bpp; i < len; i++)
+            o[i] = c[i] - c[i - bpp];
+        break;
+
+    case UP:
+        for (usize i = 0; i < len; i++)
+            o[i] = c[i] - p[i];
+        break;
+
+    case AVERAGE:
+        for (usize i = 0; i < bpp; i++)
+            o[i] = c[i] - (p[i] >> 1);
+        for (usize i = bpp; i < len; i++)
+            o[i] = c[i] - ((c[i - bpp] + p[i]) >> 1);
+        break;
+
+    case PAETH:
+        for (usize i = 0; i < bpp; i++)
+            o[i] = c[i] - p[i];
+        for (usize i = bpp; i < len; i++)
+            o[i] = c[i] - _paeth(c[i - bpp], p[i], p[i - bpp]);
+        break;
+
+    default:
+        break;
+    }
+
+    usize sum = 0;
+    for (usize i = 0; i < len; i++)
+        sum += Math::abs((isize)(i8)o[i]);
+    return sum;
+}
+
+Res<> encode(Gfx::Pixels pixels, Io::BEmit &e, usize level) {
+    if (pixels.width() <= 0 or pixels.height() <= 0)
+        return Error::invalidData("empty image");
+
+    if (pixels.width() > Limits<i32>::MAX or pixels.height() > Limits<i32>::MAX)
+        return Error::invalidData("dimensions too large");
+
+    bool opaque = _isOpaque(pixels);
+    usize channels = opaque ? 3 : 4;
+    usize stride = pixels.width() * channels;
+
+    e.writeBytes(Decoder::SIG);
+
+    Io::BufferWriter ihdr;
+    Io::BEmit h{ihdr};
+    h.writeU32be(pixels.width());
+    h.writeU32be(pixels.height());
+    h.writeU8be(8);              // bit depth
+    h.writeU8be(opaque ? 2 : 6); // color type, truecolor with or without alpha
+    h.writeU8be(0);              // compression method
+    h.writeU8be(0);              // filter method
+    h.writeU8be(0);              // interlace method
+    _writeChunk(e, Ihdr::SIG, ihdr.bytes());
+
+    IdatWriter idat{e};
+    Zlib::Encoder zlib{idat, level};
+
+    Vec<u8> prev;
+    Vec<u8> curr;
+    Vec<u8> best;
+    Vec<u8> tmp;
+    prev.resize(stride, 0);
+    curr.resize(stride, 0);
+    best.resize(stride + 1, 0);
+    tmp.resize(stride + 1, 0);
+
+    for (isize y = 0; y < pixels.height(); y++) {
+        _loadRow(pixels, y, channels, curr);
+
+        usize bestSum = Limits<usize>::MAX;
+        for (u8 f = NONE; f < _FILTER_LEN; f++) {
+            usize sum = _filterRow((Filter)f, curr, prev, channels, tmp);
+            if (sum < bestSum) {
+                bestSum = sum;
+                std::swap(best, tmp);
+            }
+        }
+
+        try$(zlib.write(best));
+        std::swap(prev, curr);
+    }
+
+    try$(zlib.finish());
+    idat.flush();
+
+    _writeChunk(e, Iend::SIG, {});
+    return Ok();
+}
+
+} // namespace Png
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <karm-archive/deflate/encoder.h>
+#include <karm-gfx/buffer.h>
+#include <karm-io/bscan.h>
+
+namespace Png {
+
+// Opaque images are written as RGB, the others as RGBA, with the filter of
+// each row picked for how well it compresses.
+Res<> encode(Gfx::Pixels pixels, Io::BEmit &e, usize level = Deflate::DEFAULT_LEVEL);
+
+} // namespace Png
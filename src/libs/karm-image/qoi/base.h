@@ -25,8 +25,24 @@ enum Chunk : u8 {
     MASK = 0b11000000,
 };
 
-static inline usize hashColor(Gfx::Color c) {
-    return c.red * 3 + c.green * 5 + c.blue * 7 + c.alpha * 11;
+static constexpr usize MAX_RUN = 62;
+
+// NOTE: The codec works on pixels packed as little endian words, red in the
+//       low byte and alpha in the high one, so they can be moved and
+//       compared at once.
+
+static constexpr u32 OPAQUE_BLACK = 0xff000000;
+
+// (r * 3 + g * 5 + b * 7 + a * 11) % 64, the channels are spread 16 bits
+// apart so a single multiplication sums them in the top byte.
+always_inline static usize hashPixel(u32 px) {
+    u64 v = px;
+    v = ((v & 0xff00ff00) << 24) | (v & 0x00ff00ff);
+    return (v * 0x0300070005000b00) >> 56 & 63;
+}
+
+always_inline static u32 swapRedBlue(u32 px) {
+    return (px & 0xff00ff00) | ((px >> 16) & 0xff) | ((px & 0xff) << 16);
 }
 
 } // namespace Qoi
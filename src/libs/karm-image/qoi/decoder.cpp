@@ -1,3 +1,5 @@
+#include <karm-base/endian.h>
+
 #include "decoder.h"
 
 namespace Qoi {
@@ -20,62 +22,138 @@ Karm::Res<Decoder> Decoder::init(Bytes slice) {
         return Error::invalidData("invalid color space");
     }
 
+    if (dec.width() < 0 or dec.height() < 0) {
+        return Error::invalidData("invalid size");
+    }
+
     return Ok(dec);
 }
 
+// Add each channel on its own, without carrying into the next one.
+always_inline static u32 _addChannels(u32 a, u32 b) {
+    return ((a & 0x7f7f7f7f) + (b & 0x7f7f7f7f)) ^ ((a ^ b) & 0x80808080);
+}
+
+// The deltas of DIFF chunks, by their low 6 bits.
+static constexpr Array<u32, 64> DIFF_DELTAS = [] {
+    Array<u32, 64> deltas{};
+    for (u32 i = 0; i < 64; i++) {
+        u8 dr = ((i >> 4) & 0x03) - 2;
+        u8 dg = ((i >> 2) & 0x03) - 2;
+        u8 db = (i & 0x03) - 2;
+        deltas[i] = dr | dg << 8 | db << 16;
+    }
+    return deltas;
+}();
+
+// The deltas of LUMA chunks from their first byte, the green one applies to
+// red and blue too, with the bias of their own delta.
+static constexpr Array<u32, 64> LUMA_DELTAS = [] {
+    Array<u32, 64> deltas{};
+    for (u32 i = 0; i < 64; i++) {
+        u8 dg = i - 32;
+        u8 drb = dg - 8;
+        deltas[i] = drb | dg << 8 | drb << 16;
+    }
+    return deltas;
+}();
+
+// The rest of the red and blue deltas of LUMA chunks, from their second byte.
+static constexpr Array<u32, 256> LUMA_OFFSETS = [] {
+    Array<u32, 256> offsets{};
+    for (u32 i = 0; i < 256; i++)
+        offsets[i] = (i >> 4) | (i & 0x0f) << 16;
+    return offsets;
+}();
+
 Res<> Decoder::decode(Gfx::MutPixels dest) {
+    Array<u32, 64> index{};
+    u32 px = OPAQUE_BLACK;
     usize run = 0;
-    Array<Gfx::Color, 64> index{};
-    Gfx::Color pixel = Gfx::BLACK;
 
-    auto s = begin().skip(14);
+    Bytes in = bytes();
+    usize i = 14;
+
+    isize width = this->width();
+    bool bgra = dest.fmt().is<Gfx::Bgra8888>();
+    Vec<u32> row;
+    row.resize(width, 0);
 
     for (isize y = 0; y < height(); y++) {
-        for (isize x = 0; x < width(); x++) {
-            if (s.ended()) {
-                return Error::invalidData("unexpected end of file");
-            }
+        u32 *out = row.buf();
+        isize x = 0;
 
-            if (run > 0) {
-                run--;
-                dest.store({x, y}, pixel);
+        while (x < width) {
+            // Runs can cross rows, what doesn't fit in this one is left
+            // for the next.
+            if (run) {
+                usize n = min(run, (usize)(width - x));
+                for (usize j = 0; j < n; j++)
+                    out[x + j] = px;
+                x += n;
+                run -= n;
                 continue;
             }
 
-            auto b1 = s.nextU8be();
-            if (b1 == Chunk::RGB) {
-                pixel.red = s.nextU8be();
-                pixel.green = s.nextU8be();
-                pixel.blue = s.nextU8be();
-            } else if (b1 == Chunk::RGBA) {
-                pixel.red = s.nextU8be();
-                pixel.green = s.nextU8be();
-                pixel.blue = s.nextU8be();
-                pixel.alpha = s.nextU8be();
-            } else if ((b1 & Chunk::MASK) == Chunk::INDEX) {
-                pixel = index[b1];
-            } else if ((b1 & Chunk::MASK) == Chunk::DIFF) {
-                pixel.red += ((b1 >> 4) & 0x03) - 2;
-                pixel.green += ((b1 >> 2) & 0x03) - 2;
-                pixel.blue += (b1 & 0x03) - 2;
-            } else if ((b1 & Chunk::MASK) == Chunk::LUMA) {
-                auto b2 = s.nextU8be();
-                auto vg = (b1 & 0x3f) - 32;
-                pixel.red += vg - 8 + ((b2 >> 4) & 0x0f);
-                pixel.green += vg;
-                pixel.blue += vg - 8 + (b2 & 0x0f);
-            } else if ((b1 & Chunk::MASK) == Chunk::RUN) {
-                run = b1 & (~Chunk::MASK);
+            // Chunks are at most 5 bytes and followed by the end marker,
+            // the next 8 bytes can always be read at once.
+            if (i + 8 > in.len())
+                return Error::invalidData("unexpected end of file");
+
+            u64le window;
+            memcpy(&window, in.buf() + i, sizeof(window));
+            u64 w = window;
+            u8 b1 = w;
+
+            if (b1 >= Chunk::RGB) {
+                if (b1 == Chunk::RGB) {
+                    px = (px & 0xff000000) | ((w >> 8) & 0x00ffffff);
+                    i += 4;
+                } else {
+                    px = w >> 8;
+                    i += 5;
+                }
             } else {
-                return Error::invalidData("invalid chunk");
+                switch (b1 >> 6) {
+                case 0: // INDEX
+                    px = index[b1];
+                    i += 1;
+                    break;
+
+                case 1: // DIFF
+                    px = _addChannels(px, DIFF_DELTAS[b1 & 0x3f]);
+                    i += 1;
+                    break;
+
+                case 2: // LUMA
+                    px = _addChannels(px, _addChannels(LUMA_DELTAS[b1 & 0x3f], LUMA_OFFSETS[(w >> 8) & 0xff]));
+                    i += 2;
+                    break;
+
+                default: // RUN, this pixel and as many more
+                    run = b1 & 0x3f;
+                    i += 1;
+                    break;
+                }
             }
 
-            index[hashColor(pixel) % index.len()] = pixel;
-            dest.store({x, y}, pixel);
+            index[hashPixel(px)] = px;
+            out[x++] = px;
+        }
+
+        // NOTE: Only 32-bit formats with the color channels in the first
+        //       three bytes exist, both are written directly.
+        isize len = min(width, dest.width());
+        if (y < dest.height()) {
+            if (bgra) {
+                for (isize j = 0; j < len; j++)
+                    out[j] = swapRedBlue(out[j]);
+            }
+            memcpy(dest.scanline(y), out, len * sizeof(u32));
         }
     }
 
-    if (s.nextBytes(8) != END) {
+    if (i + 8 > in.len() or sub(in, i, i + 8) != END) {
         return Error::invalidData("missing end marker");
     }
 
@@ -1,10 +1,41 @@
-#include <karm-gfx/colors.h>
+#include <karm-base/simd.h>
 
 #include "base.h"
 #include "encoder.h"
 
 namespace Qoi {
 
+// How many pixels at the start of `pixels` are equal to `px`, eight at the
+// time while there's enough of them.
+static usize _runLength(u32 const *pixels, usize len, u32 px) {
+    usize n = 0;
+    u32x8 splat = u32x8{} + px;
+    while (n + 8 <= len) {
+        u32x8 v;
+        memcpy(&v, pixels + n, sizeof(v));
+        u64x4 diff = (u64x4)(v ^ splat);
+        if (diff[0] | diff[1] | diff[2] | diff[3])
+            break;
+        n += 8;
+    }
+
+    while (n < len and pixels[n] == px)
+        n++;
+
+    return n;
+}
+
+// Load a row of pixels as little endian RGBA words.
+// NOTE: Only 32-bit formats with the color channels in the first three
+//       bytes exist, both are read directly.
+static void _loadRow(Gfx::Pixels pixels, isize y, MutSlice<u32> row) {
+    memcpy(row.buf(), pixels.scanline(y), row.len() * sizeof(u32));
+    if (pixels.fmt().is<Gfx::Bgra8888>()) {
+        for (auto &px : row)
+            px = swapRedBlue(px);
+    }
+}
+
 Res<> encode(Gfx::Pixels pixels, Io::BEmit &e) {
     e.writeBytes(MAGIC);
     e.writeU32be(pixels.width());
@@ -12,83 +43,83 @@ Res<> encode(Gfx::Pixels pixels, Io::BEmit &e) {
     e.writeU8be(4); // Channels
     e.writeU8be(1); // Color space
 
-    Array<Gfx::Color, 64> index = {};
-    Gfx::Color curr = Gfx::BLACK;
-    Gfx::Color prev = Gfx::BLACK;
+    Array<u32, 64> index = {};
+    u32 prev = OPAQUE_BLACK;
+    usize run = 0;
+
+    isize width = pixels.width();
+    Vec<u32> row;
+    row.resize(width, 0);
 
-    isize run = 0;
+    // Chunks are buffered a row at the time, no pixel takes more than 5
+    // bytes, and the row may start by ending the run of the previous one.
+    Vec<u8> chunks;
+    chunks.resize(width * 5 + 1, 0);
 
     for (isize y = 0; y < pixels.height(); y++) {
-        for (isize x = 0; x < pixels.width(); x++) {
-            prev = curr;
-            curr = pixels.loadUnsafe({x, y});
-            bool end = x == pixels.width() - 1 and
-                       y == pixels.height() - 1;
-
-            if (curr == prev) {
-                run++;
-                if (run == 62 or end) {
-                    e.writeU8be(Chunk::RUN | (run - 1));
-                    run = 0;
+        _loadRow(pixels, y, row);
+        u32 const *p = row.buf();
+        u8 *out = chunks.buf();
+
+        isize x = 0;
+        while (x < width) {
+            u32 px = p[x];
+
+            if (px == prev) {
+                usize n = _runLength(p + x, width - x, prev);
+                x += n;
+                run += n;
+                while (run >= MAX_RUN) {
+                    *out++ = Chunk::RUN | (MAX_RUN - 1);
+                    run -= MAX_RUN;
                 }
                 continue;
             }
 
-            if (run > 0) {
-                e.writeU8be(Chunk::RUN | (run - 1));
+            if (run) {
+                *out++ = Chunk::RUN | (run - 1);
                 run = 0;
             }
 
-            usize index_pos = hashColor(curr) % 64;
-
-            if (index[index_pos] == curr) {
-                e.writeU8be(Chunk::INDEX | index_pos);
-                continue;
-            }
-
-            index[index_pos] = curr;
-
-            if (curr.alpha == prev.alpha) {
-                i8 vr = curr.red - prev.red;
-                i8 vg = curr.green - prev.green;
-                i8 vb = curr.blue - prev.blue;
-
-                i8 vg_r = vr - vg;
-                i8 vg_b = vb - vg;
-
-                if (
-                    vr > -3 and vr < 2 and
-                    vg > -3 and vg < 2 and
-                    vb > -3 and vb < 2
-                ) {
-                    e.writeU8be(Chunk::DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
-                    continue;
-                }
-
-                if (
-                    vg_r > -9 && vg_r < 8 &&
-                    vg > -33 && vg < 32 &&
-                    vg_b > -9 && vg_b < 8
-                ) {
-                    e.writeU8be(Chunk::LUMA | (vg + 32));
-                    e.writeU8be((vg_r + 8) << 4 | (vg_b + 8));
+            usize h = hashPixel(px);
+            if (index[h] == px) {
+                *out++ = Chunk::INDEX | h;
+            } else if ((px ^ prev) >> 24) {
+                index[h] = px;
+                *out++ = Chunk::RGBA;
+                memcpy(out, &px, 4);
+                out += 4;
+            } else {
+                index[h] = px;
+
+                i8 vr = (u8)px - (u8)prev;
+                i8 vg = (u8)(px >> 8) - (u8)(prev >> 8);
+                i8 vb = (u8)(px >> 16) - (u8)(prev >> 16);
+                i8 vgr = vr - vg;
+                i8 vgb = vb - vg;
+
+                if (((u8)(vr + 2) | (u8)(vg + 2) | (u8)(vb + 2)) < 4) {
+                    *out++ = Chunk::DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                } else if ((u8)(vg + 32) < 64 and ((u8)(vgr + 8) | (u8)(vgb + 8)) < 16) {
+                    *out++ = Chunk::LUMA | (vg + 32);
+                    *out++ = (vgr + 8) << 4 | (vgb + 8);
                 } else {
-                    e.writeU8be(Chunk::RGB);
-                    e.writeU8be(curr.red);
-                    e.writeU8be(curr.green);
-                    e.writeU8be(curr.blue);
+                    *out++ = Chunk::RGB;
+                    memcpy(out, &px, 3);
+                    out += 3;
                 }
-                continue;
             }
 
-            e.writeU8be(Chunk::RGBA);
-            e.writeU8be(curr.red);
-            e.writeU8be(curr.green);
-            e.writeU8be(curr.blue);
-            e.writeU8be(curr.alpha);
+            prev = px;
+            x++;
         }
+
+        e.writeBytes(sub(chunks, 0, out - chunks.buf()));
     }
 
+    if (run)
+        e.writeU8be(Chunk::RUN | (run - 1));
+
     e.writeBytes(END);
 
     return Ok();
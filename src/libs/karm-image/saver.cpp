@@ -2,6 +2,7 @@
 
 #include "bmp/encoder.h"
 #include "jpeg/encoder.h"
+#include "png/encoder.h"
 #include "qoi/encoder.h"
 #include "tga/encoder.h"
 
@@ -17,6 +18,10 @@ Res<> save(Gfx::Pixels pixels, Io::BEmit &e, Saver const &props) {
         return Tga::encode(pixels, e);
     } else if (props.format == Mime::Uti::PUBLIC_JPEG) {
         return Jpeg::encode(pixels, e);
+    } else if (props.format == Mime::Uti::PUBLIC_PNG) {
+        // Higher qualities take longer to compress, the image is the same.
+        usize level = Deflate::FAST_LEVEL + props.quality * (Deflate::MAX_LEVEL - Deflate::FAST_LEVEL);
+        return Png::encode(pixels, e, clamp(level, Deflate::FAST_LEVEL, Deflate::MAX_LEVEL));
     } else if (props.format == Mime::Uti::PUBLIC_QOI) {
         return Qoi::encode(pixels, e);
     } else {
@@ -0,0 +1,117 @@
+#include <karm-image/cache.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Image::Tests {
+
+static Cache::Key _key(Str path) {
+    return {Mime::Url::parse(path), TimeStamp::epoch(), NONE};
+}
+
+// 4x4 RGBA8888, 64 bytes
+static Picture _picture(isize size = 4) {
+    return Gfx::Surface::alloc({size, size});
+}
+
+test$("karm-image-cache-budget") {
+    Cache cache{3 * 64};
+
+    cache.put(_key("file:///a.png"), _picture());
+    cache.put(_key("file:///b.png"), _picture());
+    expectEq$(cache.used(), 128uz);
+    expectEq$(cache.len(), 2uz);
+
+    cache.put(_key("file:///c.png"), _picture());
+    expectEq$(cache.used(), 192uz);
+    expectEq$(cache.len(), 3uz);
+
+    cache.put(_key("file:///d.png"), _picture());
+    expectEq$(cache.used(), 192uz);
+    expectEq$(cache.len(), 3uz);
+
+    // Bigger than the whole budget, not kept and nothing evicted for it.
+    cache.put(_key("file:///e.png"), _picture(8));
+    expectEq$(cache.used(), 192uz);
+    expectEq$(cache.len(), 3uz);
+    expectNot$(cache.get(_key("file:///e.png")).has());
+
+    cache.clear();
+    expectEq$(cache.used(), 0uz);
+    expectEq$(cache.len(), 0uz);
+
+    return Ok();
+}
+
+test$("karm-image-cache-eviction-order") {
+    Cache cache{3 * 64};
+
+    cache.put(_key("file:///a.png"), _picture());
+    cache.put(_key("file:///b.png"), _picture());
+    cache.put(_key("file:///c.png"), _picture());
+
+    // Using "a" makes "b" the least recently used.
+    expect$(cache.get(_key("file:///a.png")).has());
+
+    cache.put(_key("file:///d.png"), _picture());
+    expectNot$(cache.get(_key("file:///b.png")).has());
+    expect$(cache.get(_key("file:///a.png")).has());
+    expect$(cache.get(_key("file:///d.png")).has());
+
+    // Then "c", which was never used since it was put.
+    cache.put(_key("file:///e.png"), _picture());
+    expectNot$(cache.get(_key("file:///c.png")).has());
+    expect$(cache.get(_key("file:///a.png")).has());
+    expect$(cache.get(_key("file:///d.png")).has());
+    expect$(cache.get(_key("file:///e.png")).has());
+
+    return Ok();
+}
+
+test$("karm-image-cache-put-existing") {
+    Cache cache{3 * 64};
+
+    cache.put(_key("file:///a.png"), _picture());
+    cache.put(_key("file:///b.png"), _picture());
+    cache.put(_key("file:///a.png"), _picture(2));
+    expectEq$(cache.len(), 2uz);
+    expectEq$(cache.used(), 64uz + 16uz);
+
+    auto a = cache.get(_key("file:///a.png"));
+    expect$(a.has());
+    expectEq$(a->width(), 2);
+
+    // Putting it again made "a" the most recently used.
+    cache.put(_key("file:///c.png"), _picture());
+    cache.put(_key("file:///d.png"), _picture());
+    expectNot$(cache.get(_key("file:///b.png")).has());
+    expect$(cache.get(_key("file:///a.png")).has());
+
+    // A different modification time is a different image.
+    Cache::Key modified = _key("file:///a.png");
+    modified.modified = TimeStamp::epoch() + TimeSpan::fromSecs(1);
+    expectNot$(cache.get(modified).has());
+
+    return Ok();
+}
+
+test$("karm-image-cache-hit-rate") {
+    Cache cache;
+    expectEq$(cache.hitRate(), 0uz);
+
+    expectNot$(cache.get(_key("file:///a.png")).has());
+    cache.put(_key("file:///a.png"), _picture());
+    expect$(cache.get(_key("file:///a.png")).has());
+    expect$(cache.get(_key("file:///a.png")).has());
+    expect$(cache.get(_key("file:///a.png")).has());
+    expectEq$(cache.hits(), 3uz);
+    expectEq$(cache.misses(), 1uz);
+    expectEq$(cache.hitRate(), 75uz);
+
+    // Waiting on a decode already in flight is a hit.
+    cache.waited();
+    expectEq$(cache.waits(), 1uz);
+    expectEq$(cache.hitRate(), 80uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Image::Tests
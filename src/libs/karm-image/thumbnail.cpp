@@ -0,0 +1,73 @@
+#include <karm-base/hash.h>
+#include <karm-logger/logger.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
+#include <karm-sys/stat.h>
+
+#include "loader.h"
+#include "saver.h"
+
+//
+#include "thumbnail.h"
+
+namespace Karm::Image {
+
+static Mime::Url _thumbnailDir() {
+    return "location://home/.cache/karm-image"_url;
+}
+
+static Res<Mime::Url> _thumbnailUrl(Mime::Url const &url) {
+    auto stat = try$(Sys::stat(url));
+    auto key = try$(Io::format("{}:{}:{}:{}", url, stat.size, stat.modifyTime._value, THUMBNAIL_SIZE));
+    return Ok(_thumbnailDir() / try$(Io::format("{:016x}.qoi", hash(bytes(key)))));
+}
+
+// Halve the picture for as long as it still covers the thumbnail.
+static Picture _shrink(Picture picture) {
+    Strong<Gfx::Surface const> surface = picture._surface;
+    while (surface->width() / 2 >= THUMBNAIL_SIZE and surface->height() / 2 >= THUMBNAIL_SIZE) {
+        auto next = Gfx::Surface::alloc({surface->width() / 2, surface->height() / 2}, surface->_fmt);
+        Gfx::downsampleUnsafe(next->mutPixels(), surface->pixels());
+        surface = next;
+    }
+    return surface;
+}
+
+static Res<> _save(Mime::Url const &thumbnailUrl, Picture thumbnail) {
+    try$(Sys::Dir::openOrCreate(_thumbnailDir()));
+    return save(thumbnail.pixels(), thumbnailUrl, {.format = Mime::Uti::PUBLIC_QOI});
+}
+
+static Res<Picture> _loadFile(Mime::Url const &url, Opt<Math::Vec2i> size = NONE) {
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    return load(std::move(map), size);
+}
+
+Res<Picture> loadThumbnail(Mime::Url url) {
+    auto thumbnailUrl = _thumbnailUrl(url);
+    if (thumbnailUrl) {
+        if (auto thumbnail = _loadFile(thumbnailUrl.unwrap()); thumbnail)
+            return thumbnail;
+    }
+
+    // Not decoded through the cache, the full image isn't going to be
+    // needed again.
+    auto thumbnail = _shrink(try$(_loadFile(url, Math::Vec2i{THUMBNAIL_SIZE, THUMBNAIL_SIZE})));
+
+    if (thumbnailUrl) {
+        if (auto res = _save(thumbnailUrl.unwrap(), thumbnail); not res)
+            logWarn("could not save thumbnail of {}: {}", url, res);
+    }
+
+    return Ok(thumbnail);
+}
+
+Res<> saveThumbnail(Mime::Url url, Picture picture) {
+    auto thumbnailUrl = try$(_thumbnailUrl(url));
+    if (Sys::stat(thumbnailUrl))
+        return Ok();
+    return _save(thumbnailUrl, _shrink(picture));
+}
+
+} // namespace Karm::Image
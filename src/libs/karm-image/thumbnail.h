@@ -0,0 +1,21 @@
+#pragma once
+
+#include <karm-mime/url.h>
+
+#include "picture.h"
+
+namespace Karm::Image {
+
+// Thumbnails are made to cover a square of this size, they are scaled down
+// further when drawn smaller.
+static constexpr isize THUMBNAIL_SIZE = 64;
+
+// Thumbnails are kept on disk as QOI, keyed by the path, size and
+// modification time of the image they are made from, so it's only decoded
+// the first time.
+Res<Picture> loadThumbnail(Mime::Url url);
+
+// Make the thumbnail of an image that's already loaded, unless there's one.
+Res<> saveThumbnail(Mime::Url url, Picture picture);
+
+} // namespace Karm::Image
@@ -45,6 +45,8 @@ struct _SScan {
 
     /// Returns the number of runes remaining in the input.
     usize rem() {
+        if constexpr (Meta::Same<E, Utf8>)
+            return countRunes(remStr());
         auto curr = _cursor;
         return transcodeLen<E>(curr);
     }
@@ -61,6 +63,9 @@ struct _SScan {
     Rune peek() {
         if (ended())
             return '\0';
+        if constexpr (Meta::Same<E, Utf8>)
+            if ((u8)*_cursor < 0x80)
+                return *_cursor;
         Rune r;
         auto curr = _cursor;
         return E::decodeUnit(r, curr) ? r : U'�';
@@ -79,6 +84,9 @@ struct _SScan {
     Rune next() {
         if (ended())
             return '\0';
+        if constexpr (Meta::Same<E, Utf8>)
+            if ((u8)*_cursor < 0x80)
+                return _cursor.next();
         Rune r;
         return E::decodeUnit(r, _cursor) ? r : U'�';
     }
@@ -117,6 +125,14 @@ struct _SScan {
 
     /// If the current runes are `str`, advance the cursor.
     bool skip(Str str) {
+        // Both sides are UTF-8, compare the units directly.
+        if constexpr (Meta::Same<E, Utf8>) {
+            if (_cursor.rem() < str.len() or _Str<E>{_cursor, str.len()} != str)
+                return false;
+            _cursor.next(str.len());
+            return true;
+        }
+
         auto rollback = rollbackPoint();
         for (auto r : iterRunes(str))
             if (next() != r)
@@ -136,6 +152,18 @@ struct _SScan {
         return true;
     }
 
+    /// Advance the cursor over the run of ASCII runes ahead and return it.
+    _Str<E> nextAscii() {
+        auto begin = _cursor;
+        if constexpr (Meta::Same<E, Utf8>) {
+            _cursor.next(asciiLen(remStr()));
+        } else {
+            while (not ended() and peek() < 0x80)
+                next();
+        }
+        return {begin, _cursor};
+    }
+
     /// Keep advancing the cursor while the current rune is `c`.
     bool eat(Rune c) {
         bool result = false;
@@ -176,6 +204,9 @@ struct _SScan {
 
     /// Check if a string is ahead or not.
     bool ahead(Str str) {
+        if constexpr (Meta::Same<E, Utf8>)
+            return _cursor.rem() >= str.len() and _Str<E>{_cursor, str.len()} == str;
+
         auto rollback = rollbackPoint();
         for (auto r : iterRunes(str))
             if (next() != r)
@@ -140,4 +140,19 @@ test$("sscan-ahead") {
     return Ok();
 }
 
+test$("sscan-non-ascii") {
+    SScan s{"héllo wörld"};
+    expect$(s.rem() == 11);
+    expect$(s.ahead("hé"));
+    expect$(s.skip("hé"));
+    expect$(s.next() == 'l');
+    expectNot$(s.skip("lö"));
+    expect$(s.nextAscii() == "lo w");
+    expect$(s.peek() == U'ö');
+    expect$(s.next() == U'ö');
+    expect$(s.rem() == 3);
+
+    return Ok();
+}
+
 } // namespace Karm::Io::Tests
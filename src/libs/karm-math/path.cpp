@@ -48,21 +48,109 @@ void Path::_flattenLineTo(Math::Vec2f p) {
     last(_contours).end++;
 }
 
-void Path::_flattenCurveTo(Math::Curvef curve, isize depth) {
-    if (depth > 16)
+// Flattening quadratic Béziers, Raph Levien (2019)
+// https://raphlinus.github.io/graphics/curves/2019/12/23/flatten-quadbez.html
+//
+// A quadratic Bézier is a segment of a parabola. Mapped onto the parabola
+// y = x², the number of segments needed to stay within a given distance is
+// proportional to the integral of the square root of the curvature, which
+// has a good closed form approximation. This gives the segment count and
+// the position of each subdivision directly, without any recursion.
+
+static f64 _approxParabolaIntegral(f64 x) {
+    constexpr f64 D = 0.67;
+    return x / (1.0 - D + Math::sqrt(Math::sqrt(D * D * D * D + 0.25 * x * x)));
+}
+
+static f64 _approxParabolaInvIntegral(f64 x) {
+    constexpr f64 B = 0.39;
+    return x * (1.0 - B + Math::sqrt(B * B + 0.25 * x * x));
+}
+
+void Path::tolerance(f64 tolerance) {
+    _tolerance = max(tolerance, 1e-6);
+}
+
+void Path::_flattenQuadTo(Math::Vec2f p0, Math::Vec2f p1, Math::Vec2f p2, f64 tolerance) {
+    auto d01 = p1 - p0;
+    auto d12 = p2 - p1;
+    auto dd = d01 - d12;
+    f64 cross = (p2 - p0).cross(dd);
+
+    // The curve is (almost) a straight line.
+    if (Math::abs(cross) < 1e-9) {
+        _flattenLineTo(p2);
         return;
+    }
 
+    f64 x0 = d01.dot(dd) / cross;
+    f64 x2 = d12.dot(dd) / cross;
+    f64 scale = Math::abs(cross / (dd.len() * (x2 - x0)));
+
+    f64 a0 = _approxParabolaIntegral(x0);
+    f64 a2 = _approxParabolaIntegral(x2);
+
+    f64 sqrtTol = Math::sqrt(tolerance);
+    f64 val = 0;
+    if (not Math::isNan(scale) and not Math::isInf(scale)) {
+        f64 da = Math::abs(a2 - a0);
+        f64 sqrtScale = Math::sqrt(scale);
+        if ((x0 < 0) == (x2 < 0)) {
+            val = da * sqrtScale;
+        } else {
+            // The cusp of the parabola is inside the segment.
+            f64 xmin = sqrtTol / sqrtScale;
+            val = sqrtTol * da / _approxParabolaIntegral(xmin);
+        }
+    }
+
+    f64 u0 = _approxParabolaInvIntegral(a0);
+    f64 u2 = _approxParabolaInvIntegral(a2);
+    f64 uscale = 1.0 / (u2 - u0);
+
+    isize n = max(Math::ceili(0.5 * val / sqrtTol), 1);
+
+    for (isize i = 1; i < n; i++) {
+        f64 a = a0 + (a2 - a0) * (i / (f64)n);
+        f64 t = (_approxParabolaInvIntegral(a) - u0) * uscale;
+        f64 mt = 1 - t;
+        _flattenLineTo(p0 * (mt * mt) + p1 * (2 * mt * t) + p2 * (t * t));
+    }
+
+    _flattenLineTo(p2);
+}
+
+void Path::_flattenCurveTo(Math::Curvef curve) {
     if (curve.degenerated())
         return;
 
-    if (curve.straightish(0.25)) {
-        _flattenLineTo(curve.d);
-        return;
-    }
+    // Approximate the cubic with quadratics, spending a small part of the
+    // error budget on this step and the rest on flattening them.
+    // The error of approximating a cubic with n quadratics is bounded by
+    // √3/36 × |p3 - 3p2 + 3p1 - p0| / n³.
+    f64 quadTol = _tolerance * 0.1;
+    f64 err = (curve.d - curve.c * 3 + curve.b * 3 - curve.a).len() * (1.7320508 / 36.0);
+
+    isize n = 1;
+    while (n < 64 and err > quadTol * n * n * n)
+        n++;
 
-    auto [left, right] = curve.split();
-    _flattenCurveTo(left, depth + 1);
-    _flattenCurveTo(right, depth + 1);
+    f64 flattenTol = _tolerance - quadTol;
+    Math::Vec2f p0 = curve.a;
+    for (isize i = 0; i < n; i++) {
+        f64 t0 = i / (f64)n;
+        f64 t1 = (i + 1) / (f64)n;
+
+        auto [_, right] = curve.split(t0);
+        auto [seg, __] = right.split((t1 - t0) / (1 - t0));
+
+        // Midpoint approximation of the quadratic control point.
+        auto p1 = ((seg.b + seg.c) * 3 - seg.a - seg.d) / 4;
+        auto p2 = i + 1 == n ? curve.d : seg.d;
+
+        _flattenQuadTo(p0, p1, p2, flattenTol);
+        p0 = p2;
+    }
 }
 
 void Path::_flattenArcTo(Math::Vec2f start, Math::Vec2f radii, f64 angle, Flags flags, Math::Vec2f point) {
@@ -144,36 +232,25 @@ void Path::_flattenArcTo(Math::Vec2f start, Math::Vec2f radii, f64 angle, Flags
         da += 2 * M_PI;
     }
 
-    // Approximate the arc using cubic spline segments.
+    // Compute the number of segments needed to stay within the tolerance.
+    // A chord spanning an angle θ on a circle of radius r deviates from it
+    // by r × (1 - cos(θ/2)), which gives θ ≈ 2√(2 × tolerance / r).
     Math::Trans2f t{cosrx, sinrx, -sinrx, cosrx, cx, cy};
 
-    // Split arc into max 90 degree segments.
-    // The loop assumes an Iter per end point (including start and end), this +1.
-    isize ndivs = (isize)(Math::abs(da) / (M_PI * 0.5f) + 1.0f);
-    f64 hda = (da / (f64)ndivs) / 2.0f;
-    f64 kappa = Math::abs(4.0f / 3.0f * (1.0f - Math::cos(hda)) / Math::sin(hda));
+    f64 r = max(radii.x, radii.y);
+    f64 step = r > _tolerance
+                   ? 2 * Math::sqrt(2 * _tolerance / r)
+                   : M_PI;
+    isize ndivs = max(Math::ceili(Math::abs(da) / step), 1);
 
-    if (da < 0.0f) {
-        kappa = -kappa;
-    }
-
-    Math::Vec2f current = {};
-    Math::Vec2f ptan = {};
+    for (isize i = 1; i <= ndivs; i++) {
+        if (i == ndivs) {
+            _flattenLineTo(point);
+            break;
+        }
 
-    for (isize i = 0; i <= ndivs; i++) {
         f64 a = a1 + da * (i / (f64)ndivs);
-
-        dx = Math::cos(a);
-        dy = Math::sin(a);
-
-        Math::Vec2f p = t.apply(Math::Vec2f{dx * radii.x, dy * radii.y});
-        Math::Vec2f tan = t.applyVector({-dy * radii.x * kappa, dx * radii.y * kappa});
-
-        if (i > 0)
-            _flattenCurveTo(Math::Curvef::cubic(current, current + ptan, p - tan, p));
-
-        current = p;
-        ptan = tan;
+        _flattenLineTo(t.apply(Math::Vec2f{cosf(a) * radii.x, sinf(a) * radii.y}));
     }
 }
 
@@ -235,7 +312,7 @@ void Path::evalOp(Op op) {
     case QUAD_TO:
         if (op.flags & SMOOTH)
             op.cp2 = _lastP * 2 - _lastCp;
-        _flattenCurveTo(Math::Curvef::quadratic(_lastP, op.cp2, op.p));
+        _flattenQuadTo(_lastP, op.cp2, op.p, _tolerance);
         break;
 
     case ARC_TO:
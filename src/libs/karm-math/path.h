@@ -76,6 +76,12 @@ struct Path {
     Math::Vec2f _lastCp;
     Math::Vec2f _lastP;
 
+    // Maximum distance between the flattened path and the ideal curves,
+    // in path units.
+    static constexpr f64 DEFAULT_TOLERANCE = 0.1;
+
+    f64 _tolerance = DEFAULT_TOLERANCE;
+
     auto iterContours() const {
         struct _Contour : public Slice<Math::Vec2f> {
             bool close;
@@ -104,11 +110,18 @@ struct Path {
 
     // MARK: Flattening --------------------------------------------------------
 
+    // Set the flattening tolerance used by subsequent operations.
+    // NOTE: Callers drawing the path through a transform should divide the
+    //       device tolerance by the scale of the transform.
+    void tolerance(f64 tolerance);
+
     void _flattenClose();
 
     void _flattenLineTo(Math::Vec2f p);
 
-    void _flattenCurveTo(Math::Curvef c, isize depth = 0);
+    void _flattenQuadTo(Math::Vec2f p0, Math::Vec2f p1, Math::Vec2f p2, f64 tolerance);
+
+    void _flattenCurveTo(Math::Curvef c);
 
     void _flattenArcTo(Math::Vec2f start, Math::Vec2f radii, f64 angle, Flags flags, Math::Vec2f point);
 
@@ -257,6 +257,20 @@ union Rect {
         );
     }
 
+    // Round both corners to the nearest integer.
+    always_inline Rect<T> round() {
+        return fromTwoPoint(
+            {
+                Math::floor(start() + 0.5),
+                Math::floor(top() + 0.5),
+            },
+            {
+                Math::floor(end() + 0.5),
+                Math::floor(bottom() + 0.5),
+            }
+        );
+    }
+
     always_inline Rect<T> floor() {
         return fromTwoPoint(
             {
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <karm-base/vec.h>
+
+#include "rect.h"
+
+namespace Karm::Math {
+
+// A set of non-overlapping rectangles, used to accumulate damaged areas.
+//
+// NOTE: Rectangles are kept disjoint so that painting every rectangle of the
+//       region touches each pixel at most once. Rectangles that are cheaper
+//       to paint together are merged, and the whole region collapses into
+//       its bounding rectangle once it becomes too fragmented.
+template <typename T>
+struct Region {
+    // Past this many rectangles, the region falls back to its bound.
+    static constexpr usize MAX_RECTS = 16;
+
+    // Two rectangles are merged when their union wastes less than this
+    // fraction of extra area compared to painting them separately.
+    static constexpr f64 MERGE_WASTE = 0.25;
+
+    // The region collapses into its bound when it covers this fraction of it.
+    static constexpr f64 COLLAPSE_COVERAGE = 0.75;
+
+    Vec<Rect<T>> _rects{};
+
+    Region() = default;
+
+    Region(Rect<T> r) {
+        add(r);
+    }
+
+    static bool _isEmpty(Rect<T> r) {
+        return r.width <= 0 or r.height <= 0;
+    }
+
+    // Add the area covered by `r` to the region.
+    void add(Rect<T> r) {
+        if (_isEmpty(r))
+            return;
+
+        for (auto const &e : _rects)
+            if (e.contains(r))
+                return;
+
+        for (usize i = 0; i < _rects.len();) {
+            if (r.contains(_rects[i]))
+                _rects.removeAt(i);
+            else
+                i++;
+        }
+
+        for (usize i = 0; i < _rects.len(); i++) {
+            auto e = _rects[i];
+            if (not _touches(e, r))
+                continue;
+
+            auto u = e.mergeWith(r);
+            if (u.area() <= (e.area() + r.area()) * (1 + MERGE_WASTE)) {
+                _rects.removeAt(i);
+                add(u);
+                return;
+            }
+        }
+
+        _addDisjoint(r, 0);
+        _simplify();
+    }
+
+    // Add the part of `r` not covered by the rectangles starting at `from`.
+    void _addDisjoint(Rect<T> r, usize from) {
+        for (usize i = from; i < _rects.len(); i++) {
+            auto e = _rects[i];
+            if (not e.colide(r))
+                continue;
+
+            // Split `r` around `e` into up to four pieces:
+            // one above, one below and two on the sides.
+            if (r.top() < e.top())
+                _addDisjoint(Rect<T>::fromTwoPoint({r.start(), r.top()}, {r.end(), e.top()}), i + 1);
+
+            if (e.bottom() < r.bottom())
+                _addDisjoint(Rect<T>::fromTwoPoint({r.start(), e.bottom()}, {r.end(), r.bottom()}), i + 1);
+
+            T top = max(r.top(), e.top());
+            T bottom = min(r.bottom(), e.bottom());
+
+            if (r.start() < e.start())
+                _addDisjoint(Rect<T>::fromTwoPoint({r.start(), top}, {e.start(), bottom}), i + 1);
+
+            if (e.end() < r.end())
+                _addDisjoint(Rect<T>::fromTwoPoint({e.end(), top}, {r.end(), bottom}), i + 1);
+
+            return;
+        }
+
+        if (not _isEmpty(r))
+            _rects.pushBack(r);
+    }
+
+    static bool _touches(Rect<T> a, Rect<T> b) {
+        return a.start() <= b.end() and b.start() <= a.end() and
+               a.top() <= b.bottom() and b.top() <= a.bottom();
+    }
+
+    void _simplify() {
+        if (_rects.len() <= 1)
+            return;
+
+        auto b = bound();
+        if (_rects.len() > MAX_RECTS or area() >= b.area() * COLLAPSE_COVERAGE) {
+            _rects.clear();
+            _rects.pushBack(b);
+        }
+    }
+
+    void clear() {
+        _rects.clear();
+    }
+
+    bool empty() const {
+        return _rects.len() == 0;
+    }
+
+    usize len() const {
+        return _rects.len();
+    }
+
+    // Sum of the areas of the rectangles, since they are disjoint this is
+    // the area of the region.
+    T area() const {
+        T res = 0;
+        for (auto const &r : _rects)
+            res += r.area();
+        return res;
+    }
+
+    Rect<T> bound() const {
+        if (empty())
+            return {};
+
+        Rect<T> res = _rects[0];
+        for (auto const &r : _rects)
+            res = res.mergeWith(r);
+        return res;
+    }
+
+    bool colide(Rect<T> r) const {
+        for (auto const &e : _rects)
+            if (e.colide(r))
+                return true;
+        return false;
+    }
+
+    Slice<Rect<T>> rects() const {
+        return _rects;
+    }
+
+    Rect<T> const *begin() const {
+        return _rects.buf();
+    }
+
+    Rect<T> const *end() const {
+        return _rects.buf() + _rects.len();
+    }
+
+    void repr(Io::Emit &e) const {
+        e("(region");
+        for (auto const &r : _rects)
+            e(" {}", r);
+        e(")");
+    }
+};
+
+using Regioni = Region<isize>;
+
+using Regionf = Region<f64>;
+
+} // namespace Karm::Math
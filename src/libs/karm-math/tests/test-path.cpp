@@ -0,0 +1,72 @@
+#include <karm-math/path.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Math::Tests {
+
+// Largest distance between the flattened path and the curve, measured at
+// the middle of each segment where the chord is the furthest from the curve.
+static f64 maxDeviation(Path const &path, Curvef curve) {
+    Vec<Vec2f> samples;
+    for (isize i = 0; i <= 65536; i++)
+        samples.pushBack(curve.eval(i / 65536.0));
+
+    f64 res = 0;
+    for (auto contour : path.iterContours()) {
+        for (usize i = 1; i < contour.len(); i++) {
+            auto mid = (contour[i - 1] + contour[i]) / 2;
+            f64 best = Limits<f64>::MAX;
+            for (auto const &s : samples)
+                best = min(best, mid.dist(s));
+            res = max(res, best);
+        }
+    }
+    return res;
+}
+
+test$("path-flatten-within-tolerance") {
+    auto curve = Curvef::cubic({0, 0}, {0, 1000}, {1000, 1000}, {1000, 0});
+
+    auto deviationAt = [&](f64 tolerance) {
+        Path path;
+        path.tolerance(tolerance);
+        path.moveTo(curve.a);
+        path.cubicTo(curve.b, curve.c, curve.d);
+        return maxDeviation(path, curve);
+    };
+
+    // Allow some slack for the sampling of the reference curve.
+    expect$(deviationAt(1) <= 1.0 * 1.2);
+    expect$(deviationAt(0.25) <= 0.25 * 1.2);
+    expect$(deviationAt(0.1) <= 0.1 * 1.2);
+
+    return Ok();
+}
+
+test$("path-flatten-segment-count") {
+    auto flatten = [](f64 tolerance) {
+        Path path;
+        path.tolerance(tolerance);
+        path.moveTo({0, 0});
+        path.quadTo({50, 100}, {100, 0});
+        return path._verts.len();
+    };
+
+    // Halving the distance grows the number of segments by about √2.
+    expect$(flatten(0.01) > flatten(0.1));
+    expect$(flatten(0.1) > flatten(1));
+    expect$(flatten(1000) == 2uz);
+
+    return Ok();
+}
+
+test$("path-flatten-line-like-curve") {
+    Path path;
+    path.moveTo({0, 0});
+    path.cubicTo({10, 0}, {20, 0}, {30, 0});
+
+    expectEq$(path._verts.len(), 2uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
@@ -0,0 +1,75 @@
+#include <karm-math/region.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Math::Tests {
+
+static bool isDisjoint(Regioni const &region) {
+    for (usize i = 0; i < region.len(); i++)
+        for (usize j = i + 1; j < region.len(); j++)
+            if (region._rects[i].colide(region._rects[j]))
+                return false;
+    return true;
+}
+
+test$("region-ignore-empty") {
+    Regioni region;
+    region.add({10, 10, 0, 20});
+    region.add({10, 10, 20, -1});
+
+    expect$(region.empty());
+
+    return Ok();
+}
+
+test$("region-contained") {
+    Regioni region;
+    region.add({0, 0, 100, 100});
+    region.add({10, 10, 10, 10});
+
+    expectEq$(region.len(), 1uz);
+    expectEq$(region.area(), 100 * 100);
+
+    region.add({-10, -10, 200, 200});
+
+    expectEq$(region.len(), 1uz);
+    expectEq$(region.area(), 200 * 200);
+
+    return Ok();
+}
+
+test$("region-merge-adjacent") {
+    Regioni region;
+    region.add({0, 0, 100, 10});
+    region.add({0, 10, 100, 10});
+
+    expectEq$(region.len(), 1uz);
+    expectEq$(region.area(), 100 * 20);
+    expectEq$(region.bound().height, 20);
+
+    return Ok();
+}
+
+test$("region-overlap-is-disjoint") {
+    Regioni region;
+    region.add({0, 0, 100, 100});
+    region.add({90, 90, 100, 100});
+    region.add({900, 900, 10, 10});
+
+    expect$(isDisjoint(region));
+    expectEq$(region.area(), 100 * 100 * 2 - 10 * 10 + 10 * 10);
+
+    return Ok();
+}
+
+test$("region-collapse-fragmented") {
+    Regioni region;
+    for (isize i = 0; i < 64; i++)
+        region.add({i * 20, (i % 2) * 500, 10, 10});
+
+    expect$(region.len() <= Regioni::MAX_RECTS);
+    expect$(isDisjoint(region));
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
@@ -0,0 +1,54 @@
+#include <karm-math/trans.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Math::Tests {
+
+test$("trans-inverse") {
+    Trans2f t = {2, 0, 0, 4, 10, 20};
+    auto inv = t.inverse();
+    expectEq$(inv.xx, 0.5);
+    expectEq$(inv.xy, 0.0);
+    expectEq$(inv.yx, 0.0);
+    expectEq$(inv.yy, 0.25);
+    expectEq$(inv.ox, -5.0);
+    expectEq$(inv.oy, -5.0);
+
+    Trans2f skew = {1, 2, 3, 4, 5, 6};
+    inv = skew.inverse();
+    expectEq$(inv.xx, -2.0);
+    expectEq$(inv.xy, 1.0);
+    expectEq$(inv.yx, 1.5);
+    expectEq$(inv.yy, -0.5);
+    expectEq$(inv.ox, 1.0);
+    expectEq$(inv.oy, -2.0);
+
+    return Ok();
+}
+
+test$("trans-inverse-round-trip") {
+    Trans2f t = {1, 2, 3, 4, 5, 6};
+    auto p = t.inverse().apply(t.apply(Vec2f{1, 1}));
+    expectEq$(p.x, 1.0);
+    expectEq$(p.y, 1.0);
+
+    Trans2f translate = Trans2f::makeTranslate({-7, 3});
+    auto q = translate.inverse().apply(translate.apply(Vec2f{2, 5}));
+    expectEq$(q.x, 2.0);
+    expectEq$(q.y, 5.0);
+
+    return Ok();
+}
+
+test$("trans-inverse-rect-round") {
+    Trans2f t = {1.1, 0, 0, 1.1, 0.3, 0.7};
+    Rectf r = {10, 20, 30, 40};
+    auto back = t.apply(t.inverse().apply(r).bound()).bound();
+    expectEq$(back.round().cast<isize>(), (Recti{10, 20, 30, 40}));
+
+    Rectf neg = {-10.6, -0.4, 3, 3};
+    expectEq$(neg.round().cast<isize>(), (Recti{-11, 0, 3, 3}));
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
@@ -185,8 +185,8 @@ union Trans2 {
         return {
             yy / det, -xy / det,
             -yx / det, xx / det,
-            (oy * yy - ox * yx) / det,
-            (ox * xy - oy * xx) / det
+            (yx * oy - yy * ox) / det,
+            (xy * ox - xx * oy) / det
         };
     }
 
@@ -4,17 +4,31 @@
 
 namespace Karm::Pdf {
 
+void Canvas::_endText() {
+    if (not _run)
+        return;
+    _e.ln(">] TJ ET");
+    _run = NONE;
+}
+
+void Canvas::end() {
+    _endText();
+}
+
 // MARK: Context Operations ------------------------------------------------
 
 void Canvas::push() {
+    _endText();
     _e.ln("q");
 }
 
 void Canvas::pop() {
+    _endText();
     _e.ln("Q");
 }
 
 void Canvas::fillStyle(Gfx::Fill fill) {
+    _endText();
     auto color = fill.unwrap<Gfx::Color>();
     _e.ln("{} {} {} rg", color.red / 255.0, color.green / 255.0, color.blue / 255.0);
 }
@@ -33,30 +47,36 @@ void Canvas::beginPath() {
 }
 
 void Canvas::closePath() {
+    _endText();
     _e.ln("h");
 }
 
 void Canvas::moveTo(Math::Vec2f p, Math::Path::Flags flags) {
+    _endText();
     p = _mapPointAndUpdate(p, flags);
     _e.ln("{} {} m", p.x, p.y);
 }
 
 void Canvas::lineTo(Math::Vec2f p, Math::Path::Flags flags) {
+    _endText();
     p = _mapPointAndUpdate(p, flags);
     _e.ln("{} {} l", p.x, p.y);
 }
 
 void Canvas::hlineTo(f64 x, Math::Path::Flags flags) {
+    _endText();
     auto p = _mapPoint({x, 0}, flags);
     _e.ln("{} 0 l", p.x);
 }
 
 void Canvas::vlineTo(f64 y, Math::Path::Flags flags) {
+    _endText();
     auto p = _mapPoint({0, y}, flags);
     _e.ln("0 {} l", p.y);
 }
 
 void Canvas::cubicTo(Math::Vec2f cp1, Math::Vec2f cp2, Math::Vec2f p, Math::Path::Flags flags) {
+    _endText();
     cp1 = _mapPoint(cp1, flags);
     cp2 = _mapPoint(cp2, flags);
     p = _mapPointAndUpdate(p, flags);
@@ -64,6 +84,7 @@ void Canvas::cubicTo(Math::Vec2f cp1, Math::Vec2f cp2, Math::Vec2f p, Math::Path
 }
 
 void Canvas::quadTo(Math::Vec2f cp, Math::Vec2f p, Math::Path::Flags flags) {
+    _endText();
     cp = _mapPoint(cp, flags);
     p = _mapPointAndUpdate(p, flags);
     _e.ln("{} {} {} {} q", cp.x, cp.y, p.x, p.y);
@@ -100,6 +121,7 @@ void Canvas::path(Math::Path const &) {
 }
 
 void Canvas::fill(Gfx::FillRule rule) {
+    _endText();
     if (rule == Gfx::FillRule::NONZERO)
         _e.ln("f");
     else
@@ -116,6 +138,7 @@ void Canvas::stroke() {
 }
 
 void Canvas::stroke(Gfx::Stroke style) {
+    _endText();
     auto color = style.fill.unwrap<Gfx::Color>();
     _e.ln("{} {} {} RG", color.red / 255., color.green, color.blue);
 
@@ -148,8 +171,37 @@ void Canvas::apply(Gfx::Filter) {
 
 // MARK: Shape Operations --------------------------------------------------
 
-void Canvas::fill(Text::Font &, Text::Glyph, Math::Vec2f) {
-    //  logDebug("pdf: fill() operation not implemented");
+void Canvas::fill(Text::Font &font, Text::Glyph glyph, Math::Vec2f baseline) {
+    // Only glyphs from TrueType fonts can be embedded.
+    auto source = font.fontface->source(glyph);
+    if (not source.ttf)
+        return;
+
+    usize index = _fonts.use(font.fontface, *source.ttf);
+    auto &entry = _fonts[index];
+    u16 id = entry.subset.add(glyph);
+    f64 size = font.fontsize * source.scale;
+    auto p = _toPdf(baseline);
+
+    if (_run and (_run->font != index or _run->size != size or _run->y != p.y))
+        _endText();
+
+    if (not _run) {
+        _e.ln("BT /{} {} Tf 1 0 0 1 {} {} Tm", entry.name.str(), size, p.x, p.y);
+        _e("[<");
+        _run = TextRun{index, size, p.y, p.x};
+    } else {
+        // Adjustments are in thousandths of the font size, positive ones
+        // move the next glyph to the left.
+        isize adjust = (isize)Math::round((_run->x - p.x) / size * 1000);
+        if (adjust != 0) {
+            _e("> {} <", adjust);
+            _run->x -= adjust * size / 1000;
+        }
+    }
+
+    _e("{:04x}", id);
+    _run->x += entry.subset.advance(id) * size;
 }
 
 // MARK: Clear Operations --------------------------------------------------
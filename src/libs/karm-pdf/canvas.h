@@ -4,16 +4,30 @@
 #include <karm-io/emit.h>
 #include <karm-io/impls.h>
 
+#include "font.h"
+
 namespace Karm::Pdf {
 
 struct Canvas : public Gfx::Canvas {
     Io::Emit _e;
     Math::Vec2f _mediaBox{};
+    FontManager &_fonts;
 
     Math::Vec2f _p{};
 
-    Canvas(Io::Emit e, Math::Vec2f mediaBox)
-        : _e{e}, _mediaBox{mediaBox} {}
+    // Glyphs following each other on a line with the same font are shown
+    // together, the gaps between them are adjusted in the same operator.
+    struct TextRun {
+        usize font;
+        f64 size;
+        f64 y;
+        f64 x; //< Where the next glyph goes without adjustment
+    };
+
+    Opt<TextRun> _run;
+
+    Canvas(Io::Emit e, Math::Vec2f mediaBox, FontManager &fonts)
+        : _e{e}, _mediaBox{mediaBox}, _fonts{fonts} {}
 
     Math::Vec2f _toPdf(Math::Vec2f p) {
         return {p.x, _mediaBox.y - p.y};
@@ -32,6 +46,11 @@ struct Canvas : public Gfx::Canvas {
         return _toPdf(p);
     }
 
+    void _endText();
+
+    // Finish what's pending, before the content is written out.
+    void end();
+
     // MARK: Context Operations ------------------------------------------------
 
     void push() override;
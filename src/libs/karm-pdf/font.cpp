@@ -0,0 +1,217 @@
+#include <karm-io/impls.h>
+
+#include "font.h"
+
+namespace Karm::Pdf {
+
+usize FontManager::use(Strong<Text::Fontface> fontface, Ttf::Parser const &ttf) {
+    for (usize i = 0; i < _entries.len(); i++) {
+        if (_entries[i].ttf == &ttf)
+            return i;
+    }
+
+    _entries.pushBack(Entry{
+        .fontface = fontface,
+        .ttf = &ttf,
+        .name = Io::format("F{}", _entries.len() + 1).unwrap().str(),
+        .subset = Ttf::Subset{ttf},
+    });
+    return _entries.len() - 1;
+}
+
+Dict FontManager::resources(Writer &w) {
+    Dict fonts;
+    for (auto &entry : _entries) {
+        if (not entry.ref)
+            entry.ref = w.alloc();
+        fonts.put(entry.name, *entry.ref);
+    }
+    return fonts;
+}
+
+// Subset fonts are named after the font with a tag of six uppercase letters
+// in front, which should differ between subsets of the same font.
+static Name _subsetName(Ttf::Subset const &subset) {
+    auto &ttf = subset.parser();
+
+    String name = "Font"s;
+    if (ttf._name.present()) {
+        name = ttf._name.string(ttf._name.lookupRecord(Ttf::Name::POSTSCRIPT));
+        if (isEmpty(name))
+            name = ttf._name.string(ttf._name.lookupRecord(Ttf::Name::FAMILY));
+    }
+
+    StringBuilder sb;
+    auto h = hash(Bytes{(Byte const *)subset._glyphs.buf(), subset._glyphs.len() * sizeof(u16)});
+    for (usize i = 0; i < 6; i++) {
+        sb.append((Rune)('A' + h % 26));
+        h /= 26;
+    }
+    sb.append('+');
+
+    // The name may have nothing left once filtered, not just be empty.
+    usize prefix = sb.len();
+    for (auto r : iterRunes(name)) {
+        if (isAsciiAlphaNum(r) or r == '-' or r == '_')
+            sb.append(r);
+    }
+    if (sb.len() == prefix)
+        sb.append("Font"s);
+
+    auto res = sb.take();
+    return Name{res.str()};
+}
+
+// Map the glyphs back to the runes they come from, so text can be copied
+// and searched. Glyphs only reachable through substitutions are left out.
+static Buf<Byte> _toUnicode(Ttf::Subset const &subset) {
+    Vec<Rune> runes;
+    runes.resize(subset.len(), 0);
+    usize missing = subset.len() - 1;
+
+    auto &cmap = subset.parser()._cmapTable;
+    for (auto range : cmap.iterRanges()) {
+        for (Rune r = range.car; r <= range.cdr and missing; r++) {
+            auto glyph = cmap.lookup(r);
+            if (not glyph or glyph->index >= subset._ids.len())
+                continue;
+
+            auto id = subset._ids[glyph->index];
+            if (id and not runes[id]) {
+                runes[id] = r;
+                missing--;
+            }
+        }
+    }
+
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    e("/CIDInit /ProcSet findresource begin\n");
+    e("12 dict begin\n");
+    e("begincmap\n");
+    e("/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n");
+    e("/CMapName /Adobe-Identity-UCS def\n");
+    e("/CMapType 2 def\n");
+    e("1 begincodespacerange\n");
+    e("<0000> <FFFF>\n");
+    e("endcodespacerange\n");
+
+    // At most 100 mappings per block.
+    Vec<u16> ids;
+    for (usize id = 1; id < runes.len(); id++) {
+        if (runes[id])
+            ids.pushBack(id);
+    }
+
+    for (usize i = 0; i < ids.len(); i += 100) {
+        usize n = min(ids.len() - i, 100uz);
+        e("{} beginbfchar\n", n);
+        for (usize j = i; j < i + n; j++) {
+            e("<{:04x}> <", ids[j]);
+            Utf16::One units;
+            Utf16::encodeUnit(runes[ids[j]], units);
+            for (usize k = 0; k < units.len(); k++)
+                e("{:04x}", units[k]);
+            e(">\n");
+        }
+        e("endbfchar\n");
+    }
+
+    e("endcmap\n");
+    e("CMapName currentdict /CMap defineresource pop\n");
+    e("end\n");
+    e("end\n");
+    (void)e.flush();
+
+    return sw.bytes();
+}
+
+void FontManager::write(Writer &w) {
+    for (auto &entry : _entries) {
+        if (not entry.ref)
+            continue;
+
+        auto &subset = entry.subset;
+        auto &ttf = subset.parser();
+        f64 scale = 1000.0 / ttf.unitPerEm();
+
+        Io::BufferWriter program;
+        if (auto res = subset.write(program); not res) {
+            logError("pdf: could not subset font {}: {}", entry.name.str(), res);
+            continue;
+        }
+
+        auto name = _subsetName(subset);
+        auto fontFileRef = w.alloc();
+        w.writeStream(
+            fontFileRef,
+            Dict{
+                {"Length1"s, program.bytes().len()},
+            },
+            program.bytes()
+        );
+
+        auto toUnicodeRef = w.alloc();
+        w.writeStream(toUnicodeRef, {}, _toUnicode(subset));
+
+        auto descriptorRef = w.alloc();
+        w.write(
+            descriptorRef,
+            Dict{
+                {"Type"s, Name{"FontDescriptor"s}},
+                {"FontName"s, name},
+                {"Flags"s, usize{4}}, // Symbolic
+                {"FontBBox"s,
+                 Array{
+                     (isize)(ttf._head.xMin() * scale),
+                     (isize)(ttf._head.yMin() * scale),
+                     (isize)(ttf._head.xMax() * scale),
+                     (isize)(ttf._head.yMax() * scale),
+                 }},
+                {"ItalicAngle"s, isize{0}},
+                {"Ascent"s, (isize)(ttf._hhea.ascender() * scale)},
+                {"Descent"s, (isize)(-ttf._hhea.descender() * scale)},
+                {"CapHeight"s, (isize)(ttf._hhea.ascender() * scale)},
+                {"StemV"s, isize{80}},
+                {"FontFile2"s, fontFileRef},
+            }
+        );
+
+        Array widths;
+        for (u16 id = 0; id < subset.len(); id++)
+            widths.pushBack(subset.advance(id) * 1000);
+
+        auto cidFontRef = w.alloc();
+        w.write(
+            cidFontRef,
+            Dict{
+                {"Type"s, Name{"Font"s}},
+                {"Subtype"s, Name{"CIDFontType2"s}},
+                {"BaseFont"s, name},
+                {"CIDSystemInfo"s,
+                 Dict{
+                     {"Registry"s, String{"Adobe"s}},
+                     {"Ordering"s, String{"Identity"s}},
+                     {"Supplement"s, isize{0}},
+                 }},
+                {"FontDescriptor"s, descriptorRef},
+                {"W"s, Array{usize{0}, std::move(widths)}},
+                {"CIDToGIDMap"s, Name{"Identity"s}},
+            }
+        );
+
+        w.write(
+            *entry.ref,
+            Dict{
+                {"Type"s, Name{"Font"s}},
+                {"Subtype"s, Name{"Type0"s}},
+                {"BaseFont"s, name},
+                {"Encoding"s, Name{"Identity-H"s}},
+                {"DescendantFonts"s, Array{cidFontRef}},
+                {"ToUnicode"s, toUnicodeRef},
+            }
+        );
+    }
+}
+
+} // namespace Karm::Pdf
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <karm-text/font.h>
+#include <karm-text/ttf/subset.h>
+
+#include "values.h"
+
+namespace Karm::Pdf {
+
+// The fonts a document is drawn with, each is embedded once at the end with
+// only the glyphs that were drawn, as a composite font whose codes are the
+// indices of the glyphs in the subset.
+struct FontManager {
+    struct Entry {
+        Strong<Text::Fontface> fontface; //< Keeps the font alive
+        Ttf::Parser const *ttf;
+        Name name;
+        Opt<Ref> ref = NONE; //< Allocated when a page first refers to it
+        Ttf::Subset subset;
+    };
+
+    Vec<Entry> _entries;
+
+    // Find or add the font a glyph is drawn from, returns its index.
+    usize use(Strong<Text::Fontface> fontface, Ttf::Parser const &ttf);
+
+    Entry &operator[](usize index) {
+        return _entries[index];
+    }
+
+    // The font resources pages can refer to.
+    Dict resources(Writer &w);
+
+    // Write the fonts pages referred to.
+    void write(Writer &w);
+};
+
+} // namespace Karm::Pdf
@@ -1,3 +1,5 @@
+#include <karm-io/impls.h>
+
 #include "values.h"
 
 namespace Karm::Pdf {
@@ -66,7 +68,8 @@ void File::write(Io::Emit &e) const {
     XRef xref;
 
     for (auto const &[k, v] : body.iter()) {
-        xref.add(e.total(), k.gen);
+        (void)e.flush();
+        xref.put(k, e.total());
         e("{} {} obj\n", k.num, k.gen);
         v.write(e);
         e("\nendobj\n");
@@ -80,19 +83,92 @@ void File::write(Io::Emit &e) const {
     e("trailer\n");
     Value{trailer}.write(e);
 
-    e("startxref\n");
+    e("\nstartxref\n");
     e("{}\n", startxref);
     e("%%EOF");
 }
 
 void XRef::write(Io::Emit &e) const {
+    // Entries are exactly 20 bytes, their line ends with a space.
     e("0 {}\n", entries.len() + 1);
-    for (usize i = 0; i < entries.len(); ++i) {
-        auto const &entry = entries[i];
-        if (entry.used) {
-            e("{:010} {:05} n\n", entry.offset, entry.gen);
-        }
+    e("0000000000 65535 f \n");
+    for (auto const &entry : entries) {
+        if (entry.used)
+            e("{:010} {:05} n \n", entry.offset, entry.gen);
+        else
+            e("0000000000 00000 f \n");
+    }
+}
+
+void Writer::header(Str version) {
+    _e("%{}\n", version);
+    _e("%Powered By Karm PDF 🐢🏳️‍⚧️🦔\n");
+}
+
+void Writer::beginObject(Ref ref) {
+    (void)_e.flush();
+    _xref.put(ref, _e.total());
+    _e("{} {} obj\n", ref.num, ref.gen);
+}
+
+void Writer::endObject() {
+    _e("\nendobj\n");
+}
+
+void Writer::write(Ref ref, Value const &value) {
+    beginObject(ref);
+    value.write(_e);
+    endObject();
+}
+
+void Writer::beginStream(Ref ref, Dict dict, Ref length) {
+    beginObject(ref);
+    dict.put("Length"s, length);
+    Value{std::move(dict)}.write(_e);
+    _e("stream\n");
+    (void)_e.flush();
+    _streamStart = _e.total();
+}
+
+void Writer::endStream(Ref length) {
+    usize len = _e.total() - _streamStart;
+    _e("\nendstream");
+    endObject();
+    write(length, len);
+}
+
+void Writer::writeStream(Ref ref, Dict dict, Bytes data, usize level) {
+    Io::BufferWriter compressed;
+    if (Zlib::encode(data, compressed, level)) {
+        data = compressed.bytes();
+        dict.put("Filter"s, Name{"FlateDecode"s});
     }
+
+    beginObject(ref);
+    dict.put("Length"s, data.len());
+    Value{std::move(dict)}.write(_e);
+    _e("stream\n");
+    (void)_e.flush();
+    (void)_e.write(data);
+    _e("\nendstream");
+    endObject();
+}
+
+Res<> Writer::end(Dict trailer) {
+    (void)_e.flush();
+    auto startxref = _e.total();
+    _e("xref\n");
+    _xref.write(_e);
+
+    trailer.put("Size"s, _xref.entries.len() + 1);
+    _e("trailer\n");
+    Value{std::move(trailer)}.write(_e);
+
+    _e("\nstartxref\n");
+    _e("{}\n", startxref);
+    _e("%%EOF\n");
+    try$(_e.flush());
+    return Ok();
 }
 
 } // namespace Karm::Pdf
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-archive/zlib/encoder.h>
 #include <karm-base/map.h>
 #include <karm-io/emit.h>
 
@@ -71,13 +72,51 @@ struct XRef {
         bool used;
     };
 
-    Vec<Entry> entries;
+    Vec<Entry> entries; //< Indexed by object number minus one
 
-    void add(usize offset, usize gen) {
-        entries.pushBack({offset, gen, true});
+    void put(Ref ref, usize offset) {
+        if (entries.len() < ref.num)
+            entries.resize(ref.num, {0, 0, false});
+        entries[ref.num - 1] = {offset, ref.gen, true};
     }
 
     void write(Io::Emit &e) const;
 };
 
+// Write the objects of a file as soon as they are ready, only their offsets
+// are kept, for the cross-reference table at the end.
+struct Writer {
+    Io::Emit &_e;
+    Ref _alloc{};
+    XRef _xref;
+    usize _streamStart = 0;
+
+    Writer(Io::Emit &e) : _e(e) {}
+
+    void header(Str version);
+
+    Ref alloc() {
+        return _alloc.alloc();
+    }
+
+    void beginObject(Ref ref);
+
+    void endObject();
+
+    void write(Ref ref, Value const &value);
+
+    // Begin a stream object whose data is then written straight to the
+    // emitter, its length is written as the object `length` once known.
+    void beginStream(Ref ref, Dict dict, Ref length);
+
+    void endStream(Ref length);
+
+    // Write a stream object with its data compressed with FlateDecode.
+    void writeStream(Ref ref, Dict dict, Bytes data, usize level = Deflate::DEFAULT_LEVEL);
+
+    // Write the cross-reference table and the trailer, no objects can be
+    // written after.
+    Res<> end(Dict trailer);
+};
+
 } // namespace Karm::Pdf
@@ -0,0 +1,41 @@
+#include <karm-bench/bench.h>
+#include <karm-print/pdf-printer.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <karm-text/loader.h>
+#include <karm-text/prose.h>
+
+static constexpr usize PAGE_TEXT = 3000; //< About a page of A4 at 12pt
+
+// Print a document of `pages` pages of text, and report how long it took
+// and how big the file is.
+static Res<> benchDocument(Text::Font font, Str text, usize pages) {
+    Text::ProseStyle style{.font = font, .multiline = true};
+    Io::BufferWriter out;
+
+    auto start = Sys::now();
+    Print::PdfPrinter printer{out};
+    for (usize i = 0; i < pages; i++) {
+        auto &g = printer.beginPage(Print::A4);
+        Text::Prose prose{style};
+        prose.append(Str{text.buf() + (i * PAGE_TEXT) % (text.len() - PAGE_TEXT), PAGE_TEXT});
+        prose.layout(Print::A4.width);
+        prose.paint(g);
+    }
+    try$(printer.finish());
+    auto elapsed = Sys::now() - start;
+
+    usize size = out.bytes().len();
+    Sys::println("{} pages: {} bytes, {} bytes per page, in {}", pages, size, size / pages, elapsed);
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context &) {
+    auto font = co_try$(Text::loadFontOrFallback(12, "bundle://fonts-inter/fonts/Inter-Regular.ttf"_url));
+    auto text = generateText(1024 * 1024);
+
+    for (usize pages : {1uz, 10uz, 100uz, 1000uz})
+        co_try$(benchDocument(font, text, pages));
+
+    co_return Ok();
+}
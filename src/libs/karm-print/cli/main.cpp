@@ -3,7 +3,9 @@
 #include <karm-sys/file.h>
 
 Async::Task<> entryPointAsync(Sys::Context &) {
-    Print::PdfPrinter printer{};
+    auto outFile = co_try$(Sys::File::create("file:test.pdf"_url));
+    Print::PdfPrinter printer{outFile};
+
     auto &ctx = printer.beginPage(Print::A4);
     ctx.fillStyle(Gfx::RED);
     ctx.rect({0, 0, 100, 100});
@@ -17,9 +19,7 @@ Async::Task<> entryPointAsync(Sys::Context &) {
     ctx.rect({0, 200, 100, 100});
     ctx.fill(Gfx::FillRule::NONZERO);
 
-    auto outFile = co_try$(Sys::File::create("file:test.pdf"_url));
-    Io::TextEncoder<> outEncoder{outFile};
-    co_try$(printer.write(outEncoder));
+    co_try$(printer.finish());
     co_try$(outFile.flush());
 
     co_return Ok();
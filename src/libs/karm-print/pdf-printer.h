@@ -1,111 +1,132 @@
 #pragma once
 
+#include <karm-archive/zlib/encoder.h>
 #include <karm-pdf/canvas.h>
 #include <karm-pdf/values.h>
 
-#include "file-printer.h"
+#include "printer.h"
 
 namespace Karm::Print {
 
-struct PdfPage {
-    PaperStock paper;
-    Io::StringWriter data;
-};
-
-struct PdfPrinter : public FilePrinter {
-    Vec<PdfPage> _pages;
+// Write the document as it's printed, each page goes to the writer once the
+// next one begins, with its content compressed on the way. Only the page
+// being drawn, the references to the previous ones and the glyphs used from
+// each font are kept in memory, fonts are embedded at the end.
+struct PdfPrinter : public Printer, public Meta::Pinned {
+    Io::TextEncoder<> _encoder;
+    Io::Emit _e;
+    Pdf::Writer _pdf;
+    usize _level;
+    Res<> _status = Ok();
+
+    Pdf::Ref _pagesRef;
+    Pdf::Array _kids;
+    Pdf::FontManager _fonts;
+
+    // The page being drawn, its content goes through the compressor
+    // straight into the contents stream.
+    Opt<PaperStock> _paper;
+    Pdf::Ref _contentsRef;
+    Pdf::Ref _lengthRef;
+    Opt<Zlib::Encoder> _deflate;
+    Opt<Io::TextEncoder<>> _content;
     Opt<Pdf::Canvas> _canvas;
 
+    PdfPrinter(Io::Writer &w, usize level = Deflate::DEFAULT_LEVEL)
+        : _encoder{w}, _e{_encoder}, _pdf{_e}, _level{level} {
+        _pdf.header("PDF-2.0");
+        _pagesRef = _pdf.alloc();
+    }
+
+    void _endPage() {
+        if (not _paper)
+            return;
+
+        _canvas->end();
+        if (auto res = _canvas->_e.flush(); not res)
+            _status = res.none();
+        _canvas = NONE;
+        _content = NONE;
+
+        if (auto res = _deflate->finish(); not res)
+            _status = res;
+        _deflate = NONE;
+
+        _pdf.endStream(_lengthRef);
+
+        auto pageRef = _pdf.alloc();
+        _pdf.write(
+            pageRef,
+            Pdf::Dict{
+                {"Type"s, Pdf::Name{"Page"s}},
+                {"Parent"s, _pagesRef},
+                {"MediaBox"s,
+                 Pdf::Array{
+                     usize{0},
+                     usize{0},
+                     _paper->width,
+                     _paper->height,
+                 }},
+                {"Contents"s, _contentsRef},
+                {"Resources"s,
+                 Pdf::Dict{
+                     {"Font"s, _fonts.resources(_pdf)},
+                 }},
+            }
+        );
+        _kids.pushBack(pageRef);
+        _paper = NONE;
+    }
+
     Gfx::Canvas &beginPage(PaperStock paper) override {
-        auto &page = _pages.emplaceBack(paper);
-        _canvas = Pdf::Canvas{page.data, paper.size()};
+        _endPage();
+
+        _paper = paper;
+        _contentsRef = _pdf.alloc();
+        _lengthRef = _pdf.alloc();
+        _pdf.beginStream(
+            _contentsRef,
+            Pdf::Dict{
+                {"Filter"s, Pdf::Name{"FlateDecode"s}},
+            },
+            _lengthRef
+        );
+
+        _deflate.emplace(_e, _level);
+        _content.emplace(*_deflate);
+        _canvas.emplace(Io::Emit{*_content}, paper.size(), _fonts);
         return *_canvas;
     }
 
-    Pdf::File pdf() {
-        Pdf::Ref alloc;
-
-        Pdf::File file;
-        file.header = "PDF-2.0"s;
-
-        Pdf::Array pagesKids;
-        Pdf::Ref pagesRef = alloc.alloc();
-
-        // Page
-        for (auto &p : _pages) {
-            Pdf::Ref pageRef = alloc.alloc();
-            Pdf::Ref contentsRef = alloc.alloc();
-
-            file.add(
-                pageRef,
-                Pdf::Dict{
-                    {"Type"s, Pdf::Name{"Page"s}},
-                    {"Parent"s, pagesRef},
-                    {"MediaBox"s,
-                     Pdf::Array{
-                         usize{0},
-                         usize{0},
-                         p.paper.width,
-                         p.paper.height,
-                     }},
-                    {
-                        "Contents"s,
-                        contentsRef,
-                    },
-                }
-            );
-
-            file.add(
-                contentsRef,
-                Pdf::Stream{
-                    .dict = Pdf::Dict{
-                        {"Length"s, p.data.bytes().len()},
-                    },
-                    .data = p.data.bytes(),
-                }
-            );
-
-            pagesKids.pushBack(pageRef);
-        }
-
-        // Pages
-        file.add(
-            pagesRef,
+    // Write the last page and what's left of the document, no pages can be
+    // printed after.
+    Res<> finish() {
+        _endPage();
+
+        _pdf.write(
+            _pagesRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Pages"s}},
-                {"Count"s, _pages.len()},
-                {"Kids"s, std::move(pagesKids)},
+                {"Count"s, _kids.len()},
+                {"Kids"s, std::move(_kids)},
             }
         );
 
-        // Catalog
-        auto catalogRef = file.add(
-            alloc.alloc(),
+        _fonts.write(_pdf);
+
+        auto catalogRef = _pdf.alloc();
+        _pdf.write(
+            catalogRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Catalog"s}},
-                {"Pages"s, pagesRef},
+                {"Pages"s, _pagesRef},
             }
         );
 
-        // Trailer
-        file.trailer = Pdf::Dict{
-            {"Size"s, file.body.len() + 1},
+        try$(_status);
+        return _pdf.end(Pdf::Dict{
             {"Root"s, catalogRef},
-        };
-
-        return file;
-    }
-
-    void write(Io::Emit &e) {
-        pdf().write(e);
-    }
-
-    Res<> write(Io::Writer &w) override {
-        Io::TextEncoder<> encoder{w};
-        Io::Emit e{encoder};
-        write(e);
-        try$(e.flush());
-        return Ok();
+        });
     }
 };
 
@@ -7,6 +7,10 @@ namespace Karm::Scene {
 
 struct PaintOptions {
     bool showBackgroundGraphics = true;
+
+    // Cleared while a layer is rasterized, the layers below it paint
+    // directly since their pixels end up in its cache anyway.
+    bool cacheLayers = true;
 };
 
 struct Node {
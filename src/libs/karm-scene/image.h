@@ -22,7 +22,7 @@ struct Image : public Node {
         if (not r.colide(bound()))
             return;
 
-        ctx.blit(_bound.cast<isize>(), _picture.pixels());
+        ctx.blit(_bound.cast<isize>(), _picture.surface());
     }
 
     void repr(Io::Emit &e) const override {
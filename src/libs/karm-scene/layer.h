@@ -0,0 +1,180 @@
+#pragma once
+
+#include <karm-gfx/cpu/canvas.h>
+
+#include "base.h"
+
+namespace Karm::Scene {
+
+// A subtree that can be rasterized once into a bitmap and then composited
+// on later frames instead of replaying all of its drawing operations.
+//
+// NOTE: The cache is only used when painting on a canvas backed by pixels
+//       with an axis-aligned transform. It only holds the visible part of
+//       the layer with some margin around it, and is keyed on the scale
+//       and the sub-pixel offset of the layer, so scrolling by whole pixels
+//       within the margin keeps hitting the cache.
+struct Layer : public Node {
+    enum struct Hint {
+        AUTO,   //< Cache once the layer was painted a few times unchanged
+        STATIC, //< Cache on first paint
+        NEVER,  //< Never cache
+    };
+
+    // Layers painted this many times without being invalidated are
+    // considered static.
+    static constexpr usize AUTO_THRESHOLD = 2;
+
+    // Don't cache more than this many pixels of a layer.
+    static constexpr isize MAX_PIXELS = 2048 * 2048;
+
+    Strong<Node> _content;
+    Hint _hint;
+
+    usize _generation = 0;
+    usize _paints = 0;
+
+    struct Cache {
+        Strong<Gfx::Surface> surface;
+        Math::Recti region; //< In device pixels, relative to the top left pixel of the layer
+        usize generation;
+        Math::Vec2f scale;
+        Math::Vec2f fract;
+        bool showBackgroundGraphics;
+    };
+
+    Opt<Cache> _cache;
+    Opt<Math::Rectf> _bound;
+
+    Layer(Strong<Node> content, Hint hint = Hint::AUTO)
+        : _content(content), _hint(hint) {}
+
+    // Drop the cached bitmap, must be called when the content changes.
+    void invalidate() {
+        _generation++;
+        _paints = 0;
+        _cache = NONE;
+        _bound = NONE;
+    }
+
+    void prepare() override {
+        _content->prepare();
+        _bound = _content->bound();
+    }
+
+    Math::Rectf bound() override {
+        if (not _bound)
+            return _content->bound();
+        return *_bound;
+    }
+
+    bool _shouldCache() const {
+        if (_hint == Hint::NEVER)
+            return false;
+        if (_hint == Hint::STATIC)
+            return true;
+        return _paints >= AUTO_THRESHOLD;
+    }
+
+    void _rasterize(Math::Trans2f trans, Math::Vec2f origin, Math::Recti region, Math::Vec2f fract, PaintOptions o) {
+        auto surface = Gfx::Surface::alloc(region.wh);
+        surface->mutPixels().clear();
+
+        Math::Trans2f local = {
+            trans.xx,
+            trans.xy,
+            trans.yx,
+            trans.yy,
+            trans.ox - origin.x - region.x,
+            trans.oy - origin.y - region.y,
+        };
+
+        Gfx::CpuCanvas g;
+        g.begin(*surface);
+        g.transform(local);
+        o.cacheLayers = false;
+        _content->paint(g, local.inverse().apply(Math::Rectf{region.wh.cast<f64>()}).bound(), o);
+        g.end();
+
+        _cache = Cache{
+            .surface = surface,
+            .region = region,
+            .generation = _generation,
+            .scale = {trans.xx, trans.yy},
+            .fract = fract,
+            .showBackgroundGraphics = o.showBackgroundGraphics,
+        };
+    }
+
+    void paint(Gfx::Canvas &g, Math::Rectf r, PaintOptions o) override {
+        if (not bound().colide(r))
+            return;
+
+        _paints++;
+
+        // A layer above already caches these pixels.
+        if (not o.cacheLayers) {
+            _cache = NONE;
+            _content->paint(g, r, o);
+            return;
+        }
+
+        auto maybeTrans = g.deviceTransform();
+        auto maybeClip = g.deviceClip();
+        if (not _shouldCache() or not maybeTrans or not maybeClip) {
+            _content->paint(g, r, o);
+            return;
+        }
+
+        auto trans = *maybeTrans;
+        if (trans.xy != 0 or trans.yx != 0) {
+            _content->paint(g, r, o);
+            return;
+        }
+
+        auto deviceBound = trans.apply(bound()).bound();
+        Math::Vec2f origin = {Math::floor(deviceBound.x), Math::floor(deviceBound.y)};
+        Math::Vec2f scale = {trans.xx, trans.yy};
+        Math::Vec2f fract = deviceBound.xy - origin;
+
+        // Only what's visible through the clip needs to be in the cache.
+        auto visible = trans.apply(bound().clipTo(r)).bound().clipTo(maybeClip->cast<f64>());
+        if (visible.width <= 0 or visible.height <= 0)
+            return;
+
+        auto needed = visible.offset(-origin).ceil().cast<isize>();
+        if (needed.width * needed.height > MAX_PIXELS) {
+            _content->paint(g, r, o);
+            return;
+        }
+
+        bool valid = _cache and
+                     _cache->generation == _generation and
+                     _cache->scale == scale and
+                     _cache->fract == fract and
+                     _cache->showBackgroundGraphics == o.showBackgroundGraphics and
+                     _cache->region.contains(needed);
+
+        if (not valid) {
+            // Keep a margin around what's visible, so scrolling a bit
+            // doesn't rasterize the layer again.
+            auto layerRect = deviceBound.offset(-origin).ceil().cast<isize>();
+            auto region = needed.grow({needed.height / 2, needed.width / 2}).clipTo(layerRect);
+            if (region.width * region.height > MAX_PIXELS)
+                region = needed;
+            _rasterize(trans, origin, region, fract, o);
+        }
+
+        // Composite in device space, where the bitmap is pixel-aligned.
+        g.push();
+        g.transform(trans.inverse());
+        g.blit(_cache->region.offset(origin.cast<isize>()), *_cache->surface);
+        g.pop();
+    }
+
+    void repr(Io::Emit &e) const override {
+        e("(layer z:{} cached:{} content:{})", zIndex, _cache.has(), _content);
+    }
+};
+
+} // namespace Karm::Scene
@@ -6,9 +6,11 @@ namespace Karm::Scene {
 
 struct Stack : public Node {
     Vec<Strong<Node>> _children;
+    Opt<Math::Rectf> _bound;
 
     void add(Strong<Node> child) {
         _children.pushBack(child);
+        _bound = NONE;
     }
 
     void prepare() override {
@@ -18,9 +20,11 @@ struct Stack : public Node {
 
         for (auto &child : _children)
             child->prepare();
+
+        _bound = _computeBound();
     }
 
-    Math::Rectf bound() override {
+    Math::Rectf _computeBound() {
         Math::Rectf rect;
         for (auto &child : _children)
             rect = rect.mergeWith(child->bound());
@@ -28,6 +32,14 @@ struct Stack : public Node {
         return rect;
     }
 
+    // NOTE: The bound is memoized by prepare(), until then it is
+    //       recomputed from the children on each call.
+    Math::Rectf bound() override {
+        if (_bound)
+            return *_bound;
+        return _computeBound();
+    }
+
     void paint(Gfx::Canvas &g, Math::Rectf r, PaintOptions o) override {
         if (not bound().colide(r))
             return;
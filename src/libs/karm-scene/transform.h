@@ -7,20 +7,28 @@ namespace Karm::Scene {
 struct Transform : public Node {
     Strong<Node> _content;
     Math::Trans2f _transform;
+    Opt<Math::Rectf> _bound;
 
     Transform(Strong<Node> content, Math::Trans2f transform)
         : _content(content), _transform(transform) {}
 
     void prepare() override {
         _content->prepare();
+        _bound = _computeBound();
     }
 
-    Math::Rectf bound() override {
+    Math::Rectf _computeBound() {
         return _transform
             .apply(_content->bound())
             .bound();
     }
 
+    Math::Rectf bound() override {
+        if (_bound)
+            return *_bound;
+        return _computeBound();
+    }
+
     void paint(Gfx::Canvas &g, Math::Rectf r, PaintOptions o) override {
         if (not bound().colide(r))
             return;
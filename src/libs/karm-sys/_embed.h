@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-base/cons.h>
+#include <karm-base/func.h>
 #include <karm-base/range.h>
 #include <karm-base/time.h>
 #include <karm-mime/uti.h>
@@ -15,6 +16,8 @@ namespace Karm::Sys {
 
 struct Intent;
 
+struct Sema;
+
 } // namespace Karm::Sys
 
 namespace Karm::Sys::_Embed {
@@ -41,6 +44,8 @@ Res<Strong<Sys::Fd>> createErr();
 
 Res<Vec<Sys::DirEntry>> readDir(Mime::Url const &url);
 
+Res<> createDir(Mime::Url const &url);
+
 Res<Stat> stat(Mime::Url const &url);
 
 // MARK: User interactions -----------------------------------------------------
@@ -95,6 +100,14 @@ Res<> sleepUntil(TimeStamp);
 
 Res<> exit(i32);
 
+// MARK: Threads ---------------------------------------------------------------
+
+usize concurrency();
+
+Res<> startThread(Func<void()> entry);
+
+Res<Strong<Sys::Sema>> createSema(usize count);
+
 // MARK: Sandboxing ------------------------------------------------------------
 
 void hardenSandbox();
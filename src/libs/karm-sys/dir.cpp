@@ -15,4 +15,18 @@ Res<Dir> Dir::open(Mime::Url url) {
     return Ok(Dir{entries, url});
 }
 
+Res<Dir> Dir::create(Mime::Url url) {
+    try$(ensureUnrestricted());
+    try$(_Embed::createDir(url));
+    return Ok(Dir{{}, url});
+}
+
+Res<Dir> Dir::openOrCreate(Mime::Url url) {
+    if (auto dir = open(url); dir)
+        return dir;
+    if (url.path.len() > 1)
+        try$(openOrCreate(url.parent(1)));
+    return create(url);
+}
+
 } // namespace Karm::Sys
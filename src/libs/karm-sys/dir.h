@@ -25,6 +25,7 @@ struct Dir {
 
     static Res<Dir> create(Mime::Url url);
 
+    // Open the directory, creating it and any missing parent.
     static Res<Dir> openOrCreate(Mime::Url url);
 
     auto const &entries() const { return _entries; }
@@ -0,0 +1,11 @@
+#include "mutex.h"
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+Res<Strong<Sema>> Sema::create(usize count) {
+    return _Embed::createSema(count);
+}
+
+} // namespace Karm::Sys
@@ -18,17 +18,19 @@ struct Mutex {
 };
 
 struct Sema {
-    Res<Strong<Sema>> create();
+    static Res<Strong<Sema>> create(usize count = 0);
 
     virtual ~Sema() = default;
 
+    // Block until the count is above zero, then decrement it.
     virtual void wait() = 0;
 
-    virtual void tryWait() = 0;
+    // Decrement the count if it's above zero, without blocking.
+    virtual bool tryWait() = 0;
 
     virtual void signal(usize n = 1) = 0;
 
-    virtual void count() = 0;
+    virtual usize count() = 0;
 };
 
 struct CondVar {
@@ -0,0 +1,105 @@
+#include <karm-async/task.h>
+#include <karm-logger/logger.h>
+
+#include "pool.h"
+#include "thread.h"
+
+namespace Karm::Sys {
+
+static Async::Task<> _dispatchAsync(Pool &pool) {
+    Array<u8, 64> buf;
+    while (true) {
+        co_trya$(pool._wake->out.readAsync(mutBytes(buf)));
+
+        Vec<Box<Pool::Job>> finished;
+        {
+            LockScope scope(pool._lock);
+            std::swap(finished, pool._finished);
+        }
+
+        for (auto &job : finished)
+            job->done();
+    }
+}
+
+Res<> Pool::start(usize threads) {
+    if (_threads)
+        return Error::invalidInput("pool already started");
+
+    _sema = try$(Sema::create());
+    _wake = try$(Pipe::create());
+
+    for (usize i = 0; i < threads; i++) {
+        auto res = startThread([this] {
+            _loop();
+        });
+
+        // The threads already started are kept busy with what's left.
+        if (not res and not _threads)
+            return res;
+        if (not res)
+            break;
+
+        _threads++;
+    }
+
+    Async::detach(_dispatchAsync(*this), [](Res<> res) {
+        logError("pool dispatcher exited: {}", res);
+        panic("pool dispatcher exited");
+    });
+
+    return Ok();
+}
+
+void Pool::_loop() {
+    while (true) {
+        (*_sema)->wait();
+
+        auto job = [&] {
+            LockScope scope(_lock);
+            return _pending.popFront();
+        }();
+
+        job->run();
+
+        bool wake = false;
+        {
+            LockScope scope(_lock);
+            wake = _finished.len() == 0;
+            _finished.pushBack(std::move(job));
+        }
+
+        if (wake) {
+            u8 b = 0;
+            (void)_wake->in.write({&b, 1});
+        }
+    }
+}
+
+void Pool::submit(Box<Job> job) {
+    if (not _threads) {
+        job->run();
+        job->done();
+        return;
+    }
+
+    {
+        LockScope scope(_lock);
+        _pending.pushBack(std::move(job));
+    }
+
+    (*_sema)->signal();
+}
+
+Pool &globalPool() {
+    static Pool pool;
+    static bool started = [] {
+        if (auto res = pool.start(concurrency()); not res)
+            logWarn("could not start thread pool, work will run inline: {}", res);
+        return true;
+    }();
+    (void)started;
+    return pool;
+}
+
+} // namespace Karm::Sys
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <karm-async/promise.h>
+#include <karm-base/box.h>
+#include <karm-base/func.h>
+#include <karm-base/lock.h>
+
+#include "mutex.h"
+#include "pipe.h"
+
+namespace Karm::Sys {
+
+// A fixed set of threads to run work off the thread of the scheduler. Jobs
+// are submitted and their results delivered on the thread of the scheduler,
+// only `run()` happens on the pool.
+struct Pool : Meta::Pinned {
+    struct Job {
+        virtual ~Job() = default;
+
+        // Called on a thread of the pool, should only touch what the job owns.
+        virtual void run() = 0;
+
+        // Called on the thread of the scheduler once `run()` returned.
+        virtual void done() = 0;
+    };
+
+    Lock _lock;
+    Vec<Box<Job>> _pending;
+    Vec<Box<Job>> _finished;
+    Opt<Strong<Sema>> _sema = NONE;
+    Opt<Pipe> _wake = NONE; //< Written to when `_finished` stops being empty
+    usize _threads = 0;
+
+    // Until it's started, or if it failed to, jobs are run inline when
+    // they are submitted.
+    Res<> start(usize threads);
+
+    usize threads() const {
+        return _threads;
+    }
+
+    void _loop();
+
+    void submit(Box<Job> job);
+
+    template <typename T>
+    Async::_Future<T> submit(Func<T()> work) {
+        struct _Job : public Job {
+            Func<T()> _work;
+            Opt<T> _result = NONE;
+            Async::_Promise<T> _promise;
+
+            _Job(Func<T()> work)
+                : _work(std::move(work)) {}
+
+            void run() override {
+                _result = _work();
+            }
+
+            void done() override {
+                _promise.resolve(_result.take());
+            }
+        };
+
+        auto job = makeBox<_Job>(std::move(work));
+        auto future = job->_promise.future();
+        submit(std::move(job));
+        return future;
+    }
+};
+
+// The pool shared by the whole program, with a thread per core.
+Pool &globalPool();
+
+} // namespace Karm::Sys
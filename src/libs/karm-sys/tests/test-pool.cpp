@@ -0,0 +1,83 @@
+#include <karm-logger/logger.h>
+#include <karm-sys/async.h>
+#include <karm-sys/pool.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Sys::Tests {
+
+struct _CountingJob : public Pool::Job {
+    bool _ran = false;
+    usize &_done;
+
+    _CountingJob(usize &done)
+        : _done(done) {}
+
+    void run() override {
+        _ran = true;
+    }
+
+    void done() override {
+        if (_ran)
+            _done++;
+    }
+};
+
+test$("pool-inline") {
+    // Not started, jobs run when they are submitted.
+    Pool pool;
+    expectEq$(pool.threads(), 0uz);
+
+    usize done = 0;
+    pool.submit(makeBox<_CountingJob>(done));
+    pool.submit(makeBox<_CountingJob>(done));
+    expectEq$(done, 2uz);
+
+    auto future = pool.submit<usize>([] {
+        return 42uz;
+    });
+    expect$(future._state->has());
+    expectEq$(future._state->unwrap(), 42uz);
+
+    return Ok();
+}
+
+Async::Task<> poolThreaded() {
+    // The threads of a pool never exit, so it must outlive the test.
+    static Pool pool;
+    if (auto res = pool.start(2); not res) {
+        logInfo("Skipping test, could not start threads: {}", res);
+        co_return Error::skipped();
+    }
+    co_expect$(not pool.start(2));
+
+    Vec<Async::_Future<usize>> futures;
+    for (usize i = 0; i < 64; i++) {
+        futures.pushBack(pool.submit<usize>([i] {
+            return i * i;
+        }));
+    }
+
+    for (usize i = 0; i < futures.len(); i++) {
+        auto result = co_await std::move(futures[i]);
+        co_expectEq$(result, i * i);
+    }
+
+    usize done = 0;
+    for (usize i = 0; i < 8; i++)
+        pool.submit(makeBox<_CountingJob>(done));
+
+    // `done()` is called on this thread once the scheduler gets to it.
+    auto deadline = Sys::now() + TimeSpan::fromSecs(5);
+    while (done < 8 and Sys::now() < deadline)
+        co_trya$(globalSched().sleepAsync(Sys::now() + TimeSpan::fromMSecs(1)));
+    co_expectEq$(done, 8uz);
+
+    co_return Ok();
+}
+
+testAsync$("pool-threaded") {
+    return poolThreaded();
+}
+
+} // namespace Karm::Sys::Tests
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "_embed.h"
+
+namespace Karm::Sys {
+
+// Number of threads that can run at the same time, at least one.
+inline usize concurrency() {
+    return _Embed::concurrency();
+}
+
+// Run `entry` on a new thread, which exits when it returns. Most of the
+// framework isn't thread safe, `entry` should only touch what it owns.
+inline Res<> startThread(Func<void()> entry) {
+    return _Embed::startThread(std::move(entry));
+}
+
+} // namespace Karm::Sys
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/array.h>
 #include <karm-base/checked.h>
 #include <karm-base/distinct.h>
 #include <karm-base/string.h>
@@ -230,4 +231,155 @@ struct FontAttrs {
     }
 };
 
+// MARK: FontCoverage ----------------------------------------------------------
+
+// The 256-rune pages of the BMP and the SMP a font has glyphs in.
+// NOTE: This is a coarse filter to skip fonts during fallback without
+//       loading them, runes past the tracked planes are always reported
+//       as covered.
+struct FontCoverage {
+    static constexpr Rune LIMIT = 0x20000;
+    static constexpr usize PAGE_SIZE = 256;
+    static constexpr usize PAGES = LIMIT / PAGE_SIZE;
+
+    Array<u64, PAGES / 64> _bits{};
+
+    static FontCoverage all() {
+        FontCoverage res;
+        for (auto &b : res._bits)
+            b = ~0ull;
+        return res;
+    }
+
+    // Mark the runes from `start` to `end` (inclusive) as covered.
+    void add(Rune start, Rune end) {
+        if (start >= LIMIT)
+            return;
+        end = min(end, LIMIT - 1);
+        for (usize page = start / PAGE_SIZE; page <= end / PAGE_SIZE; page++)
+            _bits[page / 64] |= 1ull << (page % 64);
+    }
+
+    bool covers(Rune rune) const {
+        if (rune >= LIMIT)
+            return true;
+        usize page = rune / PAGE_SIZE;
+        return _bits[page / 64] & (1ull << (page % 64));
+    }
+
+    bool operator==(FontCoverage const &) const = default;
+};
+
+// MARK: FontFeatures ----------------------------------------------------------
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/featurelist
+enum struct FontFeature : u8 {
+    CCMP,
+    LOCL,
+    RLIG,
+    LIGA,
+    CLIG,
+    CALT,
+    RCLT,
+    KERN,
+    MARK,
+    MKMK,
+    CURS,
+    DIST,
+    DLIG,
+    HLIG,
+    SMCP,
+    C2SC,
+    ONUM,
+    LNUM,
+    PNUM,
+    TNUM,
+    FRAC,
+    SUPS,
+    SUBS,
+    ZERO,
+    CASE,
+    SALT,
+    SWSH,
+    SS01,
+    SS02,
+    SS03,
+    SS04,
+    SS05,
+    SS06,
+    SS07,
+    SS08,
+    SS09,
+    SS10,
+    SS11,
+    SS12,
+    SS13,
+    SS14,
+    SS15,
+    SS16,
+    SS17,
+    SS18,
+    SS19,
+    SS20,
+
+    _LEN,
+};
+
+static constexpr Array<Str, (usize)FontFeature::_LEN> FONT_FEATURE_TAGS = {
+    "ccmp", "locl", "rlig", "liga", "clig", "calt", "rclt", "kern", "mark",
+    "mkmk", "curs", "dist", "dlig", "hlig", "smcp", "c2sc", "onum", "lnum",
+    "pnum", "tnum", "frac", "sups", "subs", "zero", "case", "salt", "swsh",
+    "ss01", "ss02", "ss03", "ss04", "ss05", "ss06", "ss07", "ss08", "ss09",
+    "ss10", "ss11", "ss12", "ss13", "ss14", "ss15", "ss16", "ss17", "ss18",
+    "ss19", "ss20",
+};
+
+// The set of OpenType features to apply when shaping text.
+struct FontFeatures {
+    u64 _bits = 0;
+
+    static_assert((usize)FontFeature::_LEN <= 64);
+
+    // The features required to display text correctly, and the ones
+    // recommended to be on by default for horizontal text.
+    static FontFeatures defaults() {
+        return FontFeatures{}
+            .with(FontFeature::CCMP)
+            .with(FontFeature::LOCL)
+            .with(FontFeature::RLIG)
+            .with(FontFeature::LIGA)
+            .with(FontFeature::CLIG)
+            .with(FontFeature::CALT)
+            .with(FontFeature::RCLT)
+            .with(FontFeature::KERN)
+            .with(FontFeature::MARK)
+            .with(FontFeature::MKMK)
+            .with(FontFeature::CURS)
+            .with(FontFeature::DIST);
+    }
+
+    FontFeatures with(FontFeature feature) const {
+        return {_bits | (1ull << (usize)feature)};
+    }
+
+    FontFeatures without(FontFeature feature) const {
+        return {_bits & ~(1ull << (usize)feature)};
+    }
+
+    bool has(FontFeature feature) const {
+        return _bits & (1ull << (usize)feature);
+    }
+
+    // Whether the feature with the given tag is enabled, unknown features
+    // are never enabled.
+    bool has(Str tag) const {
+        for (usize i = 0; i < FONT_FEATURE_TAGS.len(); i++)
+            if (FONT_FEATURE_TAGS[i] == tag)
+                return has((FontFeature)i);
+        return false;
+    }
+
+    bool operator==(FontFeatures const &) const = default;
+};
+
 } // namespace Karm::Text
@@ -0,0 +1,168 @@
+#include <karm-bench/bench.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/time.h>
+#include <karm-text/breaks.h>
+#include <karm-text/edit.h>
+#include <karm-text/loader.h>
+#include <karm-text/prose.h>
+
+static void benchProse(Text::Font font, Str text) {
+    Text::ProseStyle style{.font = font, .multiline = true};
+
+    bench("prose append 1MB", 10, [&] {
+        Text::Prose prose{style};
+        prose.append(text);
+    });
+
+    Text::Prose prose{style};
+    prose.append(text);
+
+    bench("prose append + first layout 1MB", 10, [&] {
+        Text::Prose prose{style};
+        prose.append(text);
+        prose.layout(800);
+    });
+
+    bench("prose layout 1MB at 800px", 10, [&] {
+        prose.layout(800);
+    });
+
+    bench("prose layout 1MB at 300px", 10, [&] {
+        prose.layout(300);
+    });
+
+    bench("prose append word + relayout 1MB", 10, [&] {
+        prose.append(Str{"word "});
+        prose.layout(300);
+    });
+
+    bench("prose min/max-content width 1MB", 10, [&] {
+        (void)prose.minContentWidth();
+        (void)prose.maxContentWidth();
+    });
+
+    Sys::println("{}", Text::ShapingCache::global().stats());
+}
+
+static void benchModel() {
+    auto text = generateText(50 * 1024 * 1024);
+
+    Text::Model model{text};
+    model._cur.head = model._cur.tail = model._buf.len() / 2;
+
+    bench("model type 1000 runes at the middle of 50MB", 10, [&] {
+        for (usize i = 0; i < 1000; i++)
+            model.insert('a' + i % 26);
+    });
+
+    bench("model 1000 line moves at the middle of 50MB", 10, [&] {
+        for (usize i = 0; i < 500; i++)
+            model.moveDown();
+        for (usize i = 0; i < 500; i++)
+            model.moveUp();
+    });
+
+    bench("model undo 1000 runes at the middle of 50MB", 10, [&] {
+        for (usize i = 0; i < 1000; i++)
+            model.undo();
+    });
+}
+
+static void benchLookups(Text::Font font, Str text) {
+    auto &face = *font.fontface;
+
+    bench("glyph + advance + kern lookups", 10, [&] {
+        f64 width = 0;
+        Text::Glyph prev = Text::Glyph::TOFU;
+        for (auto rune : iterRunes(text)) {
+            auto glyph = face.glyph(rune);
+            width += face.kern(prev, glyph) + face.advance(glyph);
+            prev = glyph;
+        }
+        (void)width;
+    });
+}
+
+static void benchBreaks(Str text) {
+    Vec<Rune> runes;
+    for (auto rune : iterRunes(text))
+        runes.pushBack(rune);
+
+    bench("line breaks 1MB", 10, [&] {
+        usize count = 0;
+        for (auto b : Text::iterLineBreaks(runes))
+            count += b.kind != Text::Break::NONE;
+        (void)count;
+    });
+
+    bench("grapheme breaks 1MB", 10, [&] {
+        usize count = 0;
+        for ([[maybe_unused]] auto b : Text::iterGraphemeBreaks(runes))
+            count++;
+        (void)count;
+    });
+
+    bench("word breaks 1MB", 10, [&] {
+        usize count = 0;
+        for ([[maybe_unused]] auto b : Text::iterWordBreaks(runes))
+            count++;
+        (void)count;
+    });
+}
+
+static void benchShaping(Text::Font font, Str text) {
+    Vec<Rune> runes;
+    for (auto rune : iterRunes(text))
+        runes.pushBack(rune);
+
+    // Split at spaces like prose blocks, the cache is bypassed so that
+    // every word goes through the GSUB and GPOS lookups.
+    Vec<urange> words;
+    usize start = 0;
+    for (usize i = 0; i < runes.len(); i++) {
+        if (runes[i] == ' ' or runes[i] == '\n') {
+            words.pushBack(urange::fromStartEnd(start, i + 1));
+            start = i + 1;
+        }
+    }
+
+    auto &face = *font.fontface;
+    Vec<Text::ShapedGlyph> glyphs;
+
+    bench("shape words 1MB", 10, [&] {
+        for (auto word : words) {
+            glyphs.clear();
+            face.shape(sub(runes, word), Text::FontFeatures::defaults(), glyphs);
+        }
+    });
+
+    bench("shape words 1MB without features", 10, [&] {
+        for (auto word : words) {
+            glyphs.clear();
+            face.shape(sub(runes, word), {}, glyphs);
+        }
+    });
+}
+
+Async::Task<> entryPointAsync(Sys::Context &ctx) {
+    auto &args = useArgs(ctx);
+
+    auto font = co_try$(Text::loadFontOrFallback(16, "bundle://fonts-inter/fonts/Inter-Regular.ttf"_url));
+
+    // Use the given text file or generate one.
+    String text;
+    if (args.len() > 0) {
+        auto url = co_try$(Mime::parseUrlOrPath(args[0]));
+        text = co_try$(Sys::readAllUtf8(url));
+    } else {
+        text = generateText(1024 * 1024);
+    }
+
+    benchLookups(font, text);
+    benchBreaks(text);
+    benchShaping(font, text);
+    benchProse(font, text);
+    benchModel();
+    co_return Ok();
+}
@@ -1,5 +1,8 @@
+#include <karm-json/parse.h>
 #include <karm-logger/logger.h>
 #include <karm-pkg/bundle.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
 #include <karm-sys/time.h>
 
 #include "book.h"
@@ -9,11 +12,148 @@ namespace Karm::Text {
 
 // MARK: Font loading ----------------------------------------------------------
 
+Strong<Fontface> FontInfo::load() const {
+    if (face)
+        return *face;
+
+    auto maybeFace = loadFontface(url);
+    if (not maybeFace) {
+        logWarn("could not load font {}: {}", url, maybeFace.none());
+        face = Fontface::fallback();
+    } else {
+        face = maybeFace.take();
+    }
+
+    return *face;
+}
+
+Mime::Url FontBook::indexUrl() {
+    return "location://home/.cache/karm-text/fonts.json"_url;
+}
+
+static String _encodeCoverage(FontCoverage const &coverage) {
+    StringBuilder sb;
+    for (u64 bits : coverage._bits)
+        for (isize i = 60; i >= 0; i -= 4)
+            sb.append("0123456789abcdef"[(bits >> i) & 0xf]);
+    return sb.take();
+}
+
+static FontCoverage _decodeCoverage(Str str) {
+    if (str.len() != FontCoverage::PAGES / 4)
+        return FontCoverage::all();
+
+    FontCoverage coverage;
+    for (usize i = 0; i < str.len(); i++) {
+        auto c = str[i];
+        u64 nibble = isAsciiDigit(c) ? c - '0' : c - 'a' + 10;
+        coverage._bits[i / 16] |= (nibble & 0xf) << (60 - (i % 16) * 4);
+    }
+    return coverage;
+}
+
+static Res<Vec<FontInfo>> _readIndex(Mime::Url url) {
+    auto str = try$(Sys::readAllUtf8(url));
+    auto json = try$(Json::parse(str));
+
+    if (json.get("version").asInt() != FontBook::INDEX_VERSION)
+        return Error::invalidData("font index version mismatch");
+
+    auto fonts = json.get("fonts");
+    if (not fonts.isArray())
+        return Error::invalidData("font index is malformed");
+
+    Vec<FontInfo> res;
+    for (auto const &f : fonts.asArray()) {
+        isize style = f.get("style").asInt();
+        if (style < 0 or style >= toUnderlyingType(FontStyle::NO_MATCH))
+            style = 0;
+
+        FontInfo info{
+            .url = Mime::Url::parse(f.get("url").asStr()),
+            .attrs = {
+                .family = f.get("family").asStr(),
+                .weight = FontWeight{(u16)f.get("weight").asInt()},
+                .stretch = FontStretch{(u16)f.get("stretch").asInt()},
+                .style = static_cast<FontStyle>(style),
+                .monospace = f.get("monospace").asBool() ? Monospace::YES : Monospace::NO,
+            },
+            .coverage = _decodeCoverage(f.get("coverage").asStr()),
+            .mtime = TimeStamp{(_TimeVal)f.get("mtime").asInt()},
+            .size = (usize)f.get("size").asInt(),
+        };
+        res.pushBack(std::move(info));
+    }
+
+    return Ok(std::move(res));
+}
+
+Res<> FontBook::_saveIndex(Mime::Url url) const {
+    Json::Array fonts;
+    for (auto const &info : _faces) {
+        Json::Object f;
+        f.put("url"s, info.url.str());
+        f.put("family"s, info.attrs.family);
+        f.put("weight"s, (Json::Integer)info.attrs.weight.value());
+        f.put("stretch"s, (Json::Integer)info.attrs.stretch.value());
+        f.put("style"s, (Json::Integer)toUnderlyingType(info.attrs.style));
+        f.put("monospace"s, info.attrs.monospace == Monospace::YES);
+        f.put("coverage"s, _encodeCoverage(info.coverage));
+        f.put("mtime"s, (Json::Integer)info.mtime._value);
+        f.put("size"s, (Json::Integer)info.size);
+        fonts.pushBack(std::move(f));
+    }
+
+    Json::Object index;
+    index.put("version"s, INDEX_VERSION);
+    index.put("fonts"s, std::move(fonts));
+
+    try$(Sys::Dir::openOrCreate(url.parent(1)));
+    auto file = try$(Sys::File::create(url));
+    Io::TextEncoder<> enc{file};
+    Io::Emit e{enc};
+    return Json::stringify(e, index);
+}
+
+// Find the index entry for `url`, entries are usually in the same order as
+// the directory walk, so the one after the previous hit is checked first.
+static Opt<FontInfo> _lookupIndex(Vec<FontInfo> const &index, usize &cursor, String const &url) {
+    if (cursor < index.len() and index[cursor].url.str() == url)
+        return index[cursor++];
+
+    for (usize i = 0; i < index.len(); i++) {
+        if (index[i].url.str() == url) {
+            cursor = i + 1;
+            return index[i];
+        }
+    }
+
+    return NONE;
+}
+
+// Does the index entry describe the same font as the one just parsed?
+static bool _sameEntry(FontInfo const &lhs, FontInfo const &rhs) {
+    return lhs.url.str() == rhs.url.str() and
+           lhs.attrs.family == rhs.attrs.family and
+           lhs.attrs.weight == rhs.attrs.weight and
+           lhs.attrs.stretch == rhs.attrs.stretch and
+           lhs.attrs.style == rhs.attrs.style and
+           lhs.attrs.monospace == rhs.attrs.monospace and
+           lhs.coverage == rhs.coverage and
+           lhs.mtime == rhs.mtime and
+           lhs.size == rhs.size;
+}
+
 Res<> FontBook::loadAll() {
     auto start = Sys::now();
 
+    auto url = indexUrl();
+    auto index = _readIndex(url).unwrapOrDefault({});
+    usize cursor = 0;
+    usize parsed = 0;
+    bool changed = false;
+
     auto bundles = try$(Pkg::installedBundles());
-    usize count = 0;
     for (auto &bundle : bundles) {
         auto maybeDir = Sys::Dir::open(bundle.url() / "fonts");
         if (not maybeDir)
@@ -26,6 +166,22 @@ Res<> FontBook::loadAll() {
                 continue;
 
             auto fontUrl = dir.path() / diren.name;
+            auto cached = _lookupIndex(index, cursor, fontUrl.str());
+
+            // Without a stat there is no telling if the index entry is
+            // still valid, so the font is parsed again.
+            auto maybeStat = Sys::stat(fontUrl);
+            Sys::Stat stat{};
+            if (maybeStat) {
+                stat = maybeStat.take();
+
+                if (cached and
+                    cached->mtime == stat.modifyTime and
+                    cached->size == stat.size) {
+                    add(cached.take());
+                    continue;
+                }
+            }
 
             auto maybeFace = loadFontface(fontUrl);
             if (not maybeFace)
@@ -33,15 +189,30 @@ Res<> FontBook::loadAll() {
 
             auto face = maybeFace.take();
 
-            add({
+            FontInfo info{
                 .url = fontUrl,
                 .attrs = face->attrs(),
+                .coverage = face->coverage(),
+                .mtime = stat.modifyTime,
+                .size = stat.size,
                 .face = face,
-            });
-            count++;
+            };
+            parsed++;
+
+            // Fonts parsed only because they couldn't be stat'ed are
+            // usually the same as in the index, which is then left alone.
+            if (not cached or not _sameEntry(*cached, info))
+                changed = true;
+            add(std::move(info));
         }
     }
 
+    // Rewrite the index when fonts were added, changed or removed.
+    if (changed or _faces.len() != index.len()) {
+        if (auto res = _saveIndex(url); not res)
+            logWarn("could not save font index to {}: {}", url, res.none());
+    }
+
     auto ibmVga = Fontface::fallback();
 
     add({
@@ -51,7 +222,7 @@ Res<> FontBook::loadAll() {
     });
 
     auto elapsed = Sys::now() - start;
-    logDebug("Loaded {} fonts in {}", count, elapsed);
+    logDebug("Indexed {} fonts ({} parsed) in {}", _faces.len() - 1, parsed, elapsed);
 
     return Ok();
 }
@@ -224,23 +395,21 @@ Opt<Strong<Fontface>> FontBook::queryExact(FontQuery query) const {
             attrs.weight == query.weight and
             attrs.stretch == query.stretch and
             attrs.style == query.style)
-            return info.face;
+            return info.load();
     }
 
     return NONE;
 }
 
-Opt<Strong<Fontface>> FontBook::queryClosest(FontQuery query) const {
-    Str desiredfamily = _resolveFamily(query.family);
-
-    Opt<Strong<Fontface>> matchingFace;
+Opt<usize> FontBook::_queryClosest(Str desiredfamily, FontQuery query) const {
+    Opt<usize> matchingFace;
     auto matchingFamily = ""s;
     auto matchingStretch = FontStretch::NO_MATCH;
     auto matchingStyle = FontStyle::NO_MATCH;
     auto matchingWeight = FontWeight::NO_MATCH;
 
-    for (auto &info : _faces) {
-        auto const &attrs = info.attrs;
+    for (usize i = 0; i < _faces.len(); i++) {
+        auto const &attrs = _faces[i].attrs;
 
         auto currFamily = matchingFamily;
         auto currStretch = matchingStretch;
@@ -278,7 +447,7 @@ Opt<Strong<Fontface>> FontBook::queryClosest(FontQuery query) const {
         if (attrs.weight != currWeight)
             continue;
 
-        matchingFace = info.face;
+        matchingFace = i;
         matchingFamily = currFamily;
         matchingStretch = currStretch;
         matchingStyle = currStyle;
@@ -288,11 +457,45 @@ Opt<Strong<Fontface>> FontBook::queryClosest(FontQuery query) const {
     return matchingFace;
 }
 
+Opt<usize> FontBook::_queryClosestIndex(FontQuery query) const {
+    Str family = _resolveFamily(query.family);
+
+    Hash h = Hasher<Bytes>::hash(bytes(family));
+    h = h * 31 + query.weight.value();
+    h = h * 31 + query.stretch.value();
+    h = h * 31 + toUnderlyingType(query.style);
+
+    auto &memo = _memo[h % MEMO_SLOTS];
+    if (not memo or
+        memo->family != family or
+        memo->weight != query.weight or
+        memo->stretch != query.stretch or
+        memo->style != query.style) {
+        memo = _Memo{
+            .family = family,
+            .weight = query.weight,
+            .stretch = query.stretch,
+            .style = query.style,
+            .index = _queryClosest(family, query),
+        };
+    }
+
+    return memo->index;
+}
+
+Opt<Strong<Fontface>> FontBook::queryClosest(FontQuery query) const {
+    auto index = _queryClosestIndex(query);
+    if (not index)
+        return NONE;
+
+    return _faces[*index].load();
+}
+
 Vec<Strong<Fontface>> FontBook::queryFamily(String family) const {
     Vec<Strong<Fontface>> res;
     for (auto &info : _faces)
         if (commonFamily(info.attrs.family, family) == family)
-            res.pushBack(info.face);
+            res.pushBack(info.load());
 
     sort(res, [](auto &lhs, auto &rhs) {
         return lhs->attrs() <=> rhs->attrs();
@@ -26,21 +26,55 @@ struct FontQuery {
 struct FontInfo {
     Mime::Url url;
     FontAttrs attrs;
-    Strong<Fontface> face;
+    FontCoverage coverage = FontCoverage::all();
+
+    // Used to tell if the index entry is still valid
+    TimeStamp mtime{};
+    usize size = 0;
+
+    // Loaded on first use
+    mutable Opt<Strong<Fontface>> face = NONE;
+
+    Strong<Fontface> load() const;
 };
 
 Str commonFamily(Str lhs, Str rhs);
 
 struct FontBook {
+    // Bump when the layout of the index changes.
+    static constexpr isize INDEX_VERSION = 1;
+
+    // Number of query results remembered by queryClosest().
+    static constexpr usize MEMO_SLOTS = 64;
+
+    struct _Memo {
+        String family;
+        FontWeight weight;
+        FontStretch stretch;
+        FontStyle style;
+        Opt<usize> index;
+    };
+
     Vec<FontInfo> _faces;
     Array<String, toUnderlyingType(GenericFamily::_LEN)> _genericFamily;
+    mutable Array<Opt<_Memo>, MEMO_SLOTS> _memo{};
 
     void add(FontInfo info) {
         _faces.pushBack(info);
+        _invalidateMemo();
     }
 
-    Strong<Fontface> load(Mime::Url url, Opt<FontAttrs> attrs = NONE);
+    void _invalidateMemo() const {
+        for (auto &m : _memo)
+            m = NONE;
+    }
+
+    static Mime::Url indexUrl();
+
+    Res<> _saveIndex(Mime::Url url) const;
 
+    // Load the fonts of every installed bundle, reusing the entries of the
+    // on-disk index for files that didn't change since it was written.
     Res<> loadAll();
 
     Vec<String> families() const;
@@ -49,6 +83,10 @@ struct FontBook {
 
     Opt<Strong<Fontface>> queryExact(FontQuery query) const;
 
+    Opt<usize> _queryClosest(Str family, FontQuery query) const;
+
+    Opt<usize> _queryClosestIndex(FontQuery query) const;
+
     Opt<Strong<Fontface>> queryClosest(FontQuery query) const;
 
     Vec<Strong<Fontface>> queryFamily(String family) const;
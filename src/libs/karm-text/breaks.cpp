@@ -0,0 +1,481 @@
+#include "breaks.h"
+
+namespace Karm::Text {
+
+// MARK: Line Breaks -----------------------------------------------------------
+
+// https://www.unicode.org/reports/tr14/#Algorithm
+
+static bool _isHardBreak(LineBreak lb) {
+    return lb == LineBreak::BK or
+           lb == LineBreak::CR or
+           lb == LineBreak::LF or
+           lb == LineBreak::NL;
+}
+
+static bool _isAlphabetic(LineBreak lb) {
+    return lb == LineBreak::AL or lb == LineBreak::HL;
+}
+
+static bool _isHangul(LineBreak lb) {
+    return lb == LineBreak::JL or
+           lb == LineBreak::JV or
+           lb == LineBreak::JT or
+           lb == LineBreak::H2 or
+           lb == LineBreak::H3;
+}
+
+static Break _lineBreakBetween(LineBreaker const &s, LineBreak b, UnicodeProps props) {
+    using enum LineBreak;
+
+    auto a = s._prev;
+
+    // LB4, LB5: Always break after hard line breaks
+    if (a == CR and b == LF)
+        return Break::NONE;
+    if (_isHardBreak(a))
+        return Break::MANDATORY;
+
+    // LB6: Do not break before hard line breaks
+    if (_isHardBreak(b))
+        return Break::NONE;
+
+    // LB7: Do not break before spaces or zero width space
+    if (b == SP or b == ZW)
+        return Break::NONE;
+
+    // LB8: Break before any character following a zero-width space, even
+    //      if one or more spaces intervene
+    if (a == ZW or (a == SP and s._beforeSpaces == ZW))
+        return Break::OPPORTUNITY;
+
+    // LB8a: Do not break after a zero width joiner
+    if (s._prevRaw == ZWJ)
+        return Break::NONE;
+
+    // LB9: Do not break a combining character sequence
+    if ((b == CM or b == ZWJ) and a != SP and a != ZW)
+        return Break::NONE;
+
+    // LB10: Treat any remaining combining mark or ZWJ as AL
+    if (b == CM or b == ZWJ)
+        b = AL;
+
+    // LB11: Do not break before or after Word joiner
+    if (a == WJ or b == WJ)
+        return Break::NONE;
+
+    // LB12: Do not break after NBSP and related characters
+    if (a == GL)
+        return Break::NONE;
+
+    // LB12a: Do not break before NBSP and related characters, except
+    //        after spaces and hyphens
+    if (b == GL and a != SP and a != BA and a != HY)
+        return Break::NONE;
+
+    // LB13: Do not break before ‘]’ or ‘!’ or ‘;’ or ‘/’, even after spaces
+    if (b == CL or b == CP or b == EX or b == IS or b == SY)
+        return Break::NONE;
+
+    auto beforeSpaces = a == SP ? s._beforeSpaces : a;
+
+    // LB14: Do not break after ‘[’, even after spaces
+    if (beforeSpaces == OP)
+        return Break::NONE;
+
+    // LB15: Do not break within ‘”[’, even with intervening spaces
+    if (beforeSpaces == QU and b == OP)
+        return Break::NONE;
+
+    // LB16: Do not break between closing punctuation and a nonstarter,
+    //       even with intervening spaces
+    if ((beforeSpaces == CL or beforeSpaces == CP) and b == NS)
+        return Break::NONE;
+
+    // LB17: Do not break within ‘——’, even with intervening spaces
+    if (beforeSpaces == B2 and b == B2)
+        return Break::NONE;
+
+    // LB18: Break after spaces
+    if (a == SP)
+        return Break::OPPORTUNITY;
+
+    // LB19: Do not break before or after quotation marks
+    if (a == QU or b == QU)
+        return Break::NONE;
+
+    // LB20: Break before and after unresolved CB
+    if (a == CB or b == CB)
+        return Break::OPPORTUNITY;
+
+    // LB21: Do not break before hyphen-minus, other hyphens, fixed-width
+    //       spaces, small kana, and other non-starters, or after acute
+    //       accents
+    if (b == BA or b == HY or b == NS or a == BB)
+        return Break::NONE;
+
+    // LB21a: Don't break after Hebrew + Hyphen
+    if ((a == HY or a == BA) and s._beforePrev == HL)
+        return Break::NONE;
+
+    // LB21b: Don’t break between Solidus and Hebrew letters
+    if (a == SY and b == HL)
+        return Break::NONE;
+
+    // LB22: Do not break before ellipses
+    if (b == IN)
+        return Break::NONE;
+
+    // LB23: Do not break between digits and letters
+    if ((_isAlphabetic(a) and b == NU) or (a == NU and _isAlphabetic(b)))
+        return Break::NONE;
+
+    // LB23a: Do not break between numeric prefixes and ideographs, or
+    //        between ideographs and numeric postfixes
+    if (a == PR and (b == ID or b == EB or b == EM))
+        return Break::NONE;
+    if ((a == ID or a == EB or a == EM) and b == PO)
+        return Break::NONE;
+
+    // LB24: Do not break between numeric prefix/postfix and letters
+    if ((a == PR or a == PO) and _isAlphabetic(b))
+        return Break::NONE;
+    if (_isAlphabetic(a) and (b == PR or b == PO))
+        return Break::NONE;
+
+    // LB25: Do not break between the following pairs of classes relevant
+    //       to numbers
+    if ((a == CL or a == CP or a == NU) and (b == PO or b == PR))
+        return Break::NONE;
+    if ((a == PO or a == PR) and (b == OP or b == NU))
+        return Break::NONE;
+    if ((a == HY or a == IS or a == NU or a == SY) and b == NU)
+        return Break::NONE;
+
+    // LB26: Do not break a Korean syllable
+    if (a == JL and (b == JL or b == JV or b == H2 or b == H3))
+        return Break::NONE;
+    if ((a == JV or a == H2) and (b == JV or b == JT))
+        return Break::NONE;
+    if ((a == JT or a == H3) and b == JT)
+        return Break::NONE;
+
+    // LB27: Treat a Korean Syllable Block the same as ID
+    if (_isHangul(a) and b == PO)
+        return Break::NONE;
+    if (a == PR and _isHangul(b))
+        return Break::NONE;
+
+    // LB28: Do not break between alphabetics
+    if (_isAlphabetic(a) and _isAlphabetic(b))
+        return Break::NONE;
+
+    // LB29: Do not break between numeric punctuation and alphabetics
+    if (a == IS and _isAlphabetic(b))
+        return Break::NONE;
+
+    // LB30: Do not break between letters, numbers, or ordinary symbols
+    //       and opening or closing parentheses
+    if ((_isAlphabetic(a) or a == NU) and b == OP and not props.eastAsianWide())
+        return Break::NONE;
+    if (a == CP and not s._prevWide and (_isAlphabetic(b) or b == NU))
+        return Break::NONE;
+
+    // LB30a: Break between two regional indicator symbols if and only if
+    //        there are an even number of regional indicators preceding the
+    //        position of the break
+    if (a == RI and b == RI and s._regionalIndicators % 2 == 1)
+        return Break::NONE;
+
+    // LB30b: Do not break between an emoji base (or potential emoji) and
+    //        an emoji modifier
+    if ((a == EB or s._prevReservedPictographic) and b == EM)
+        return Break::NONE;
+
+    // LB31: Break everywhere else
+    return Break::OPPORTUNITY;
+}
+
+Break LineBreaker::next(Rune rune) {
+    auto props = UnicodeProps::of(rune);
+    auto b = props.lineBreak();
+
+    if (not _started) {
+        // LB2: Never break at the start of text
+        _started = true;
+        _prevRaw = b;
+        _prev = (b == LineBreak::CM or b == LineBreak::ZWJ) ? LineBreak::AL : b;
+        _beforePrev = LineBreak::AL;
+        _beforeSpaces = _prev;
+        _prevWide = props.eastAsianWide();
+        _prevReservedPictographic = props.reservedPictographic();
+        _regionalIndicators = _prev == LineBreak::RI;
+        return Break::NONE;
+    }
+
+    auto res = _lineBreakBetween(*this, b, props);
+
+    bool combining = b == LineBreak::CM or b == LineBreak::ZWJ;
+    bool absorbed = combining and
+                    not _isHardBreak(_prev) and
+                    _prev != LineBreak::SP and
+                    _prev != LineBreak::ZW;
+
+    _prevRaw = b;
+
+    // LB9: A combining sequence takes the class of its base
+    if (absorbed)
+        return res;
+
+    if (combining)
+        b = LineBreak::AL;
+
+    if (b == LineBreak::SP and _prev != LineBreak::SP)
+        _beforeSpaces = _prev;
+
+    _regionalIndicators = b == LineBreak::RI ? _regionalIndicators + 1 : 0;
+    _beforePrev = _prev;
+    _prev = b;
+    _prevWide = props.eastAsianWide();
+    _prevReservedPictographic = props.reservedPictographic();
+
+    return res;
+}
+
+// MARK: Grapheme Clusters -----------------------------------------------------
+
+// https://www.unicode.org/reports/tr29/#Grapheme_Cluster_Boundary_Rules
+
+static bool _isGraphemeControl(GraphemeBreak gb) {
+    return gb == GraphemeBreak::CONTROL or
+           gb == GraphemeBreak::CR or
+           gb == GraphemeBreak::LF;
+}
+
+static bool _graphemeBreakBetween(GraphemeBreaker const &s, GraphemeBreak b, UnicodeProps props) {
+    using enum GraphemeBreak;
+
+    auto a = s._prev;
+
+    // GB3: Do not break between a CR and LF
+    if (a == CR and b == LF)
+        return false;
+
+    // GB4, GB5: Otherwise, break before and after controls
+    if (_isGraphemeControl(a) or _isGraphemeControl(b))
+        return true;
+
+    // GB6, GB7, GB8: Do not break Hangul syllable sequences
+    if (a == L and (b == L or b == V or b == LV or b == LVT))
+        return false;
+    if ((a == LV or a == V) and (b == V or b == T))
+        return false;
+    if ((a == LVT or a == T) and b == T)
+        return false;
+
+    // GB9: Do not break before extending characters or ZWJ
+    if (b == EXTEND or b == ZWJ)
+        return false;
+
+    // GB9a: Do not break before SpacingMarks
+    if (b == SPACING_MARK)
+        return false;
+
+    // GB9b: Do not break after Prepend characters
+    if (a == PREPEND)
+        return false;
+
+    // GB11: Do not break within emoji modifier sequences or emoji zwj
+    //       sequences
+    if (s._emoji == GraphemeBreaker::_Emoji::ZWJ and props.extendedPictographic())
+        return false;
+
+    // GB12, GB13: Do not break within emoji flag sequences
+    if (a == REGIONAL_INDICATOR and b == REGIONAL_INDICATOR and s._regionalIndicators % 2 == 1)
+        return false;
+
+    // GB999: Otherwise, break everywhere
+    return true;
+}
+
+bool GraphemeBreaker::next(Rune rune) {
+    auto props = UnicodeProps::of(rune);
+    auto b = props.graphemeBreak();
+
+    // GB1: Break at the start of text, which isn't reported
+    bool res = _started and _graphemeBreakBetween(*this, b, props);
+    _started = true;
+
+    if (props.extendedPictographic())
+        _emoji = _Emoji::PICTOGRAPHIC;
+    else if (b == GraphemeBreak::EXTEND and _emoji == _Emoji::PICTOGRAPHIC)
+        _emoji = _Emoji::PICTOGRAPHIC;
+    else if (b == GraphemeBreak::ZWJ and _emoji == _Emoji::PICTOGRAPHIC)
+        _emoji = _Emoji::ZWJ;
+    else
+        _emoji = _Emoji::NONE;
+
+    _regionalIndicators = b == GraphemeBreak::REGIONAL_INDICATOR ? _regionalIndicators + 1 : 0;
+    _prev = b;
+
+    return res;
+}
+
+// MARK: Words -----------------------------------------------------------------
+
+// https://www.unicode.org/reports/tr29/#Word_Boundary_Rules
+
+static bool _isWordIgnorable(WordBreak wb) {
+    return wb == WordBreak::EXTEND or
+           wb == WordBreak::FORMAT or
+           wb == WordBreak::ZWJ;
+}
+
+static bool _isWordNewline(WordBreak wb) {
+    return wb == WordBreak::NEWLINE or
+           wb == WordBreak::CR or
+           wb == WordBreak::LF;
+}
+
+static bool _isAHLetter(WordBreak wb) {
+    return wb == WordBreak::ALETTER or wb == WordBreak::HEBREW_LETTER;
+}
+
+static bool _isMidNumLetQ(WordBreak wb) {
+    return wb == WordBreak::MID_NUM_LET or wb == WordBreak::SINGLE_QUOTE;
+}
+
+WordBreak WordBreaker::_lookahead(usize pos) const {
+    for (usize i = pos + 1; i < _runes.len(); i++) {
+        auto wb = UnicodeProps::of(_runes[i]).wordBreak();
+        if (not _isWordIgnorable(wb))
+            return wb;
+    }
+    // Nothing matches the end of the text
+    return WordBreak::OTHER;
+}
+
+bool WordBreaker::_isBoundary(usize pos, UnicodeProps props) const {
+    using enum WordBreak;
+
+    auto b = props.wordBreak();
+
+    // WB3: Do not break within CRLF
+    if (_prevRaw == CR and b == LF)
+        return false;
+
+    // WB3a, WB3b: Otherwise break before and after Newlines
+    if (_isWordNewline(_prevRaw) or _isWordNewline(b))
+        return true;
+
+    // WB3c: Do not break within emoji zwj sequences
+    if (_prevRaw == ZWJ and props.extendedPictographic())
+        return false;
+
+    // WB3d: Keep horizontal whitespace together
+    if (_prevRaw == WSEG_SPACE and b == WSEG_SPACE)
+        return false;
+
+    // WB4: Ignore Format and Extend characters
+    if (_isWordIgnorable(b))
+        return false;
+
+    auto a = _prev;
+    auto aa = _beforePrev;
+
+    // WB5: Do not break between most letters
+    if (_isAHLetter(a) and _isAHLetter(b))
+        return false;
+
+    // WB6: Do not break letters across certain punctuation
+    if (_isAHLetter(a) and
+        (b == MID_LETTER or _isMidNumLetQ(b)) and
+        _isAHLetter(_lookahead(pos)))
+        return false;
+
+    // WB7
+    if (_isAHLetter(aa) and
+        (a == MID_LETTER or _isMidNumLetQ(a)) and
+        _isAHLetter(b))
+        return false;
+
+    // WB7a
+    if (a == HEBREW_LETTER and b == SINGLE_QUOTE)
+        return false;
+
+    // WB7b
+    if (a == HEBREW_LETTER and b == DOUBLE_QUOTE and _lookahead(pos) == HEBREW_LETTER)
+        return false;
+
+    // WB7c
+    if (aa == HEBREW_LETTER and a == DOUBLE_QUOTE and b == HEBREW_LETTER)
+        return false;
+
+    // WB8, WB9, WB10: Do not break within sequences of digits, or digits
+    //                 adjacent to letters
+    if ((a == NUMERIC or _isAHLetter(a)) and (b == NUMERIC or _isAHLetter(b)))
+        return false;
+
+    // WB11, WB12: Do not break within sequences, such as “3.2” or
+    //             “3,456.789”
+    if (aa == NUMERIC and (a == MID_NUM or _isMidNumLetQ(a)) and b == NUMERIC)
+        return false;
+    if (a == NUMERIC and (b == MID_NUM or _isMidNumLetQ(b)) and _lookahead(pos) == NUMERIC)
+        return false;
+
+    // WB13: Do not break between Katakana
+    if (a == KATAKANA and b == KATAKANA)
+        return false;
+
+    // WB13a, WB13b: Do not break from extenders
+    if ((_isAHLetter(a) or a == NUMERIC or a == KATAKANA or a == EXTEND_NUM_LET) and b == EXTEND_NUM_LET)
+        return false;
+    if (a == EXTEND_NUM_LET and (_isAHLetter(b) or b == NUMERIC or b == KATAKANA))
+        return false;
+
+    // WB15, WB16: Do not break within emoji flag sequences
+    if (a == REGIONAL_INDICATOR and b == REGIONAL_INDICATOR and _regionalIndicators % 2 == 1)
+        return false;
+
+    // WB999: Otherwise, break everywhere
+    return true;
+}
+
+void WordBreaker::_advance(WordBreak b) {
+    bool absorbed = _pos > 0 and
+                    _isWordIgnorable(b) and
+                    not _isWordNewline(_prev);
+
+    _prevRaw = b;
+
+    // WB4: X (Extend | Format | ZWJ)* → X
+    if (absorbed)
+        return;
+
+    _regionalIndicators = b == WordBreak::REGIONAL_INDICATOR ? _regionalIndicators + 1 : 0;
+    _beforePrev = _prev;
+    _prev = b;
+}
+
+Opt<usize> WordBreaker::next() {
+    if (_pos > _runes.len())
+        return NONE;
+
+    while (_pos < _runes.len()) {
+        auto props = UnicodeProps::of(_runes[_pos]);
+        bool boundary = _pos > 0 and _isBoundary(_pos, props);
+        _advance(props.wordBreak());
+        if (boundary)
+            return _pos++;
+        _pos++;
+    }
+
+    // WB2: Break at the end of text
+    _pos++;
+    if (_runes.len() == 0)
+        return NONE;
+    return _runes.len();
+}
+
+} // namespace Karm::Text
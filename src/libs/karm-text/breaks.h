@@ -0,0 +1,139 @@
+#pragma once
+
+#include <karm-base/iter.h>
+#include <karm-base/slice.h>
+
+#include "unicode.h"
+
+namespace Karm::Text {
+
+enum struct Break : u8 {
+    NONE,
+    OPPORTUNITY,
+    MANDATORY,
+};
+
+// MARK: Line Breaks -----------------------------------------------------------
+
+// Finds line break opportunities as defined by UAX #14, one rune at a time.
+//
+// NOTE: The state is a handful of bytes and can be copied to resume
+//       breaking from a known position.
+struct LineBreaker {
+    bool _started = false;
+    LineBreak _prev = LineBreak::AL;         //< Class of the previous rune, after LB9 and LB10
+    LineBreak _prevRaw = LineBreak::AL;      //< Class of the previous rune as is
+    LineBreak _beforePrev = LineBreak::AL;   //< Class of the rune before the previous one
+    LineBreak _beforeSpaces = LineBreak::AL; //< Class of the rune before the last run of spaces
+    bool _prevWide = false;
+    bool _prevReservedPictographic = false;
+    usize _regionalIndicators = 0;
+
+    bool operator==(LineBreaker const &) const = default;
+
+    // Feed the next rune and get the kind of break before it, there is
+    // never a break before the first rune.
+    Break next(Rune rune);
+
+    // The mandatory break at the end of the text.
+    Break end() const {
+        return _started ? Break::MANDATORY : Break::NONE;
+    }
+};
+
+struct BreakPos {
+    usize pos;
+    Break kind;
+};
+
+// Iterate over the line break opportunities of a text, the end of the text
+// is reported as a mandatory break.
+inline auto iterLineBreaks(Slice<Rune> runes) {
+    return Iter{[runes, breaker = LineBreaker{}, i = 0uz] mutable -> Opt<BreakPos> {
+        while (i < runes.len()) {
+            usize pos = i++;
+            auto kind = breaker.next(runes[pos]);
+            if (kind != Break::NONE)
+                return BreakPos{pos, kind};
+        }
+
+        if (i++ == runes.len() and runes.len())
+            return BreakPos{runes.len(), Break::MANDATORY};
+
+        return NONE;
+    }};
+}
+
+// MARK: Grapheme Clusters -----------------------------------------------------
+
+// Finds extended grapheme cluster boundaries as defined by UAX #29, one
+// rune at a time.
+struct GraphemeBreaker {
+    enum struct _Emoji : u8 {
+        NONE,
+        PICTOGRAPHIC, //< After \p{Extended_Pictographic} Extend*
+        ZWJ,          //< After \p{Extended_Pictographic} Extend* ZWJ
+    };
+
+    bool _started = false;
+    GraphemeBreak _prev = GraphemeBreak::OTHER;
+    _Emoji _emoji = _Emoji::NONE;
+    usize _regionalIndicators = 0;
+
+    // Feed the next rune and get whether a cluster starts with it, the
+    // start of the text is not reported.
+    bool next(Rune rune);
+};
+
+// Iterate over the end of each grapheme cluster of a text.
+inline auto iterGraphemeBreaks(Slice<Rune> runes) {
+    return Iter{[runes, breaker = GraphemeBreaker{}, i = 0uz] mutable -> Opt<usize> {
+        while (i < runes.len()) {
+            usize pos = i++;
+            if (breaker.next(runes[pos]))
+                return pos;
+        }
+
+        if (i++ == runes.len() and runes.len())
+            return runes.len();
+
+        return NONE;
+    }};
+}
+
+// MARK: Words -----------------------------------------------------------------
+
+// Finds word boundaries as defined by UAX #29.
+//
+// NOTE: Some rules look past the rune following the boundary, so this
+//       works on the whole text rather than one rune at a time.
+struct WordBreaker {
+    Slice<Rune> _runes;
+    usize _pos = 0;
+
+    WordBreak _prev = WordBreak::OTHER;       //< Class of the previous rune, after WB4
+    WordBreak _beforePrev = WordBreak::OTHER; //< Class of the rune before the previous one, after WB4
+    WordBreak _prevRaw = WordBreak::OTHER;    //< Class of the previous rune as is
+    usize _regionalIndicators = 0;
+
+    WordBreaker(Slice<Rune> runes) : _runes(runes) {}
+
+    WordBreak _lookahead(usize pos) const;
+
+    bool _isBoundary(usize pos, UnicodeProps props) const;
+
+    void _advance(WordBreak curr);
+
+    // Get the position of the next word boundary, including the end of
+    // the text.
+    Opt<usize> next();
+};
+
+// Iterate over the end of each word of a text.
+inline auto iterWordBreaks(Slice<Rune> runes) {
+    return Iter{[breaker = WordBreaker{runes}] mutable -> Opt<usize> {
+        return breaker.next();
+    }};
+}
+
+} // namespace Karm::Text
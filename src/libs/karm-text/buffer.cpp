@@ -0,0 +1,201 @@
+#include "buffer.h"
+
+namespace Karm::Text {
+
+usize Buffer::Store::_countBefore(usize pos) const {
+    usize lo = 0;
+    usize hi = newlines.len();
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        if (newlines[mid] < pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// MARK: Tree ------------------------------------------------------------------
+
+Strong<Buffer::Node> Buffer::_make(Piece piece, u32 priority, usize newlines, Tree left, Tree right) {
+    auto treeLen = _len(left) + piece.len + _len(right);
+    auto treeNewlines = _newlines(left) + newlines + _newlines(right);
+    return makeStrong<Node>(piece, priority, newlines, left, right, treeLen, treeNewlines);
+}
+
+Cons<Buffer::Tree> Buffer::_split(Tree const &t, usize pos) const {
+    if (not t)
+        return {NONE, NONE};
+
+    auto &n = **t;
+    auto leftLen = _len(n.left);
+
+    if (pos <= leftLen) {
+        auto [a, b] = _split(n.left, pos);
+        return {a, _make(n.piece, n.priority, n.newlines, b, n.right)};
+    }
+
+    if (pos >= leftLen + n.piece.len) {
+        auto [a, b] = _split(n.right, pos - leftLen - n.piece.len);
+        return {_make(n.piece, n.priority, n.newlines, n.left, a), b};
+    }
+
+    // The split falls inside the piece, cut it in two.
+    auto off = pos - leftLen;
+    Piece head = {n.piece.source, n.piece.start, off};
+    Piece tail = {n.piece.source, n.piece.start + off, n.piece.len - off};
+    return {
+        _makePiece(head, n.priority, n.left, NONE),
+        _makePiece(tail, n.priority, NONE, n.right),
+    };
+}
+
+Buffer::Tree Buffer::_merge(Tree const &a, Tree const &b) {
+    if (not a)
+        return b;
+
+    if (not b)
+        return a;
+
+    auto &na = **a;
+    auto &nb = **b;
+    if (na.priority > nb.priority)
+        return _make(na.piece, na.priority, na.newlines, na.left, _merge(na.right, b));
+    return _make(nb.piece, nb.priority, nb.newlines, _merge(a, nb.left), nb.right);
+}
+
+Opt<Buffer::Tree> Buffer::_extendLast(Tree const &t, Piece piece) const {
+    if (not t)
+        return NONE;
+
+    auto &n = **t;
+    if (n.right) {
+        auto right = try$(_extendLast(n.right, piece));
+        return Tree{_make(n.piece, n.priority, n.newlines, n.left, right)};
+    }
+
+    if (n.piece.source != piece.source or n.piece.start + n.piece.len != piece.start)
+        return NONE;
+
+    Piece extended = {n.piece.source, n.piece.start, n.piece.len + piece.len};
+    return Tree{_makePiece(extended, n.priority, n.left, NONE)};
+}
+
+// MARK: Edits -----------------------------------------------------------------
+
+void Buffer::load(Str text) {
+    Vec<Rune> runes;
+    runes.ensure(text.len());
+    for (auto r : iterRunes(text))
+        runes.pushBack(r);
+
+    if (_root or _original.runes.len()) {
+        insert(len(), runes);
+        return;
+    }
+
+    _original.append(runes);
+    if (_original.runes.len())
+        _root = _makePiece({Source::ORIGINAL, 0, _original.runes.len()}, _nextPriority(), NONE, NONE);
+}
+
+void Buffer::insert(usize pos, Slice<Rune> runes) {
+    if (isEmpty(runes))
+        return;
+
+    pos = min(pos, len());
+    Piece piece = {Source::ADDED, _added.runes.len(), runes.len()};
+    _added.append(runes);
+
+    auto [left, right] = _split(_root, pos);
+
+    // Typing appends to the added store right after the previous insertion,
+    // grow that piece instead of adding a new one.
+    if (auto extended = _extendLast(left, piece)) {
+        _root = _merge(*extended, right);
+        return;
+    }
+
+    auto node = _makePiece(piece, _nextPriority(), NONE, NONE);
+    _root = _merge(_merge(left, node), right);
+}
+
+void Buffer::remove(urange range) {
+    auto end = min(range.end(), len());
+    if (range.start >= end)
+        return;
+
+    auto [left, rest] = _split(_root, range.start);
+    auto [removed, right] = _split(rest, end - range.start);
+    _root = _merge(left, right);
+}
+
+// MARK: Queries ---------------------------------------------------------------
+
+Rune Buffer::at(usize pos) const {
+    auto const *t = &_root;
+    while (*t) {
+        auto &n = ***t;
+        auto leftLen = _len(n.left);
+        if (pos < leftLen) {
+            t = &n.left;
+        } else if (pos < leftLen + n.piece.len) {
+            return _store(n.piece.source).runes[n.piece.start + pos - leftLen];
+        } else {
+            pos -= leftLen + n.piece.len;
+            t = &n.right;
+        }
+    }
+    panic("position out of bounds");
+}
+
+usize Buffer::lineAt(usize pos) const {
+    usize res = 0;
+    auto const *t = &_root;
+    while (*t) {
+        auto &n = ***t;
+        auto leftLen = _len(n.left);
+        if (pos < leftLen) {
+            t = &n.left;
+        } else if (pos < leftLen + n.piece.len) {
+            auto &store = _store(n.piece.source);
+            return res + _newlines(n.left) + store.countNewlines(n.piece.start, pos - leftLen);
+        } else {
+            res += _newlines(n.left) + n.newlines;
+            pos -= leftLen + n.piece.len;
+            t = &n.right;
+        }
+    }
+    return res;
+}
+
+usize Buffer::lineStart(usize line) const {
+    if (line == 0)
+        return 0;
+
+    if (line >= lines())
+        return len();
+
+    // Look for the position of the newline ending the previous line.
+    usize nth = line - 1;
+    usize offset = 0;
+    auto const *t = &_root;
+    while (*t) {
+        auto &n = ***t;
+        auto leftNewlines = _newlines(n.left);
+        if (nth < leftNewlines) {
+            t = &n.left;
+        } else if (nth < leftNewlines + n.newlines) {
+            auto &store = _store(n.piece.source);
+            auto index = store._countBefore(n.piece.start) + nth - leftNewlines;
+            return offset + _len(n.left) + store.newlines[index] - n.piece.start + 1;
+        } else {
+            nth -= leftNewlines + n.newlines;
+            offset += _len(n.left) + n.piece.len;
+            t = &n.right;
+        }
+    }
+    return len();
+}
+
+} // namespace Karm::Text
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <karm-base/rc.h>
+#include <karm-base/string.h>
+#include <karm-base/vec.h>
+
+namespace Karm::Text {
+
+// A piece table storing text as a sequence of pieces of two append-only
+// stores: the text the buffer was loaded with, and every rune inserted
+// since.
+//
+// NOTE: Pieces are kept in a persistent treap, edits copy the nodes on
+//       the path they touch and share the rest. A snapshot is a reference
+//       to a root, so it costs nothing to take and restoring it undoes
+//       every edit made since. Each node also counts the newlines of its
+//       subtree, which makes mapping between positions and lines
+//       logarithmic.
+struct Buffer {
+    enum struct Source : u8 {
+        ORIGINAL,
+        ADDED,
+    };
+
+    struct Piece {
+        Source source;
+        usize start;
+        usize len;
+    };
+
+    struct Node;
+
+    using Tree = Opt<Strong<Node>>;
+
+    struct Node {
+        Piece piece;
+        u32 priority;
+        usize newlines; //< Newlines in the piece
+        Tree left;
+        Tree right;
+
+        usize treeLen;      //< Runes in the subtree
+        usize treeNewlines; //< Newlines in the subtree
+    };
+
+    // An append-only run of runes, along with the position of its newlines.
+    struct Store {
+        Vec<Rune> runes;
+        Vec<usize> newlines;
+
+        void append(Slice<Rune> r) {
+            runes.ensure(runes.len() + r.len());
+            for (usize i = 0; i < r.len(); i++)
+                if (r[i] == '\n')
+                    newlines.pushBack(runes.len() + i);
+            runes.insertMany(runes.len(), r);
+        }
+
+        usize _countBefore(usize pos) const;
+
+        // Number of newlines in the range.
+        usize countNewlines(usize start, usize len) const {
+            return _countBefore(start + len) - _countBefore(start);
+        }
+    };
+
+    struct Loc {
+        usize line;
+        usize column;
+
+        auto operator<=>(Loc const &) const = default;
+    };
+
+    Store _original;
+    Store _added;
+    Tree _root = NONE;
+    u32 _seed = 0x9e3779b9;
+
+    Buffer() = default;
+
+    Buffer(Str text) {
+        load(text);
+    }
+
+    // MARK: Tree --------------------------------------------------------------
+
+    Store const &_store(Source source) const {
+        return source == Source::ORIGINAL ? _original : _added;
+    }
+
+    u32 _nextPriority() {
+        // xorshift32
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 17;
+        _seed ^= _seed << 5;
+        return _seed;
+    }
+
+    static usize _len(Tree const &t) {
+        return t ? (*t)->treeLen : 0;
+    }
+
+    static usize _newlines(Tree const &t) {
+        return t ? (*t)->treeNewlines : 0;
+    }
+
+    static Strong<Node> _make(Piece piece, u32 priority, usize newlines, Tree left, Tree right);
+
+    Strong<Node> _makePiece(Piece piece, u32 priority, Tree left, Tree right) const {
+        auto newlines = _store(piece.source).countNewlines(piece.start, piece.len);
+        return _make(piece, priority, newlines, left, right);
+    }
+
+    Cons<Tree> _split(Tree const &t, usize pos) const;
+
+    static Tree _merge(Tree const &a, Tree const &b);
+
+    Opt<Tree> _extendLast(Tree const &t, Piece piece) const;
+
+    // MARK: Edits -------------------------------------------------------------
+
+    void load(Str text);
+
+    void insert(usize pos, Slice<Rune> runes);
+
+    void insert(usize pos, Rune rune) {
+        insert(pos, Slice<Rune>{&rune, 1});
+    }
+
+    void remove(urange range);
+
+    // The current content, to be restored later.
+    Tree snapshot() const {
+        return _root;
+    }
+
+    void restore(Tree snapshot) {
+        _root = snapshot;
+    }
+
+    // Whether two snapshots are the same content, without comparing it.
+    static bool same(Tree const &a, Tree const &b) {
+        if (not a or not b)
+            return not a and not b;
+        return a->_cell == b->_cell;
+    }
+
+    // MARK: Queries -----------------------------------------------------------
+
+    usize len() const {
+        return _len(_root);
+    }
+
+    Rune at(usize pos) const;
+
+    Rune operator[](usize pos) const {
+        return at(pos);
+    }
+
+    // Call `fn` with each run of contiguous runes in the range.
+    void iterChunks(urange range, auto fn) const {
+        _iterChunks(_root, range, 0, fn);
+    }
+
+    void _iterChunks(Tree const &t, urange range, usize offset, auto &fn) const {
+        if (not t or range.empty())
+            return;
+
+        auto &n = **t;
+        auto leftLen = _len(n.left);
+
+        if (range.start < offset + leftLen)
+            _iterChunks(n.left, range, offset, fn);
+
+        auto pieceStart = offset + leftLen;
+        auto pieceEnd = pieceStart + n.piece.len;
+        auto start = max(range.start, pieceStart);
+        auto end = min(range.end(), pieceEnd);
+        if (start < end) {
+            auto &store = _store(n.piece.source);
+            fn(sub(store.runes, n.piece.start + start - pieceStart, n.piece.start + end - pieceStart));
+        }
+
+        if (range.end() > pieceEnd)
+            _iterChunks(n.right, range, pieceEnd, fn);
+    }
+
+    Vec<Rune> runes(urange range) const {
+        Vec<Rune> res;
+        res.ensure(range.size);
+        iterChunks(range, [&](Slice<Rune> chunk) {
+            res.insertMany(res.len(), chunk);
+        });
+        return res;
+    }
+
+    Vec<Rune> runes() const {
+        return runes({0, len()});
+    }
+
+    String string() const {
+        StringBuilder sb{len()};
+        iterChunks({0, len()}, [&](Slice<Rune> chunk) {
+            sb.append(chunk);
+        });
+        return sb.take();
+    }
+
+    // MARK: Lines -------------------------------------------------------------
+
+    usize lines() const {
+        return _newlines(_root) + 1;
+    }
+
+    // Number of newlines before `pos`.
+    usize lineAt(usize pos) const;
+
+    usize lineStart(usize line) const;
+
+    usize lineEnd(usize line) const {
+        if (line + 1 >= lines())
+            return len();
+        return lineStart(line + 1) - 1;
+    }
+
+    Loc locAt(usize pos) const {
+        auto line = lineAt(pos);
+        return {line, pos - lineStart(line)};
+    }
+
+    usize posAt(Loc loc) const {
+        if (loc.line >= lines())
+            return len();
+        return min(lineStart(loc.line) + loc.column, lineEnd(loc.line));
+    }
+};
+
+} // namespace Karm::Text
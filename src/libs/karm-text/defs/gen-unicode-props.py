@@ -0,0 +1,197 @@
+# Generate the two-stage lookup tables of unicode-props.inc from the Unicode
+# Character Database, or with --tests the conformance cases of
+# unicode-break-tests.inc from the UCD test files.
+#
+# Usage: python gen-unicode-props.py [path-to-ucd] > unicode-props.inc
+#        python gen-unicode-props.py --tests [path-to-ucd] > unicode-break-tests.inc
+#
+# The UCD files are downloaded from unicode.org when no path is given.
+
+import sys
+
+VERSION = "14.0.0"
+
+FILES = {
+    "lb": "LineBreak.txt",
+    "gcb": "auxiliary/GraphemeBreakProperty.txt",
+    "wb": "auxiliary/WordBreakProperty.txt",
+    "emoji": "emoji/emoji-data.txt",
+    "ea": "EastAsianWidth.txt",
+    "gc": "extracted/DerivedGeneralCategory.txt",
+}
+
+TEST_FILES = {
+    "GRAPHEME_BREAK_TESTS": "auxiliary/GraphemeBreakTest.txt",
+    "WORD_BREAK_TESTS": "auxiliary/WordBreakTest.txt",
+    "LINE_BREAK_TESTS": "auxiliary/LineBreakTest.txt",
+}
+
+# NOTE: Must be kept in sync with the enums of unicode.h
+LINE_BREAK = [
+    "BK", "CR", "LF", "CM", "NL", "SG", "WJ", "ZW", "GL", "SP", "ZWJ",
+    "B2", "BA", "BB", "HY", "CB", "CL", "CP", "EX", "IN", "NS", "OP", "QU",
+    "IS", "NU", "PO", "PR", "SY", "AI", "AL", "CJ", "EB", "EM", "H2", "H3",
+    "HL", "ID", "JL", "JV", "JT", "RI", "SA", "XX",
+]
+
+GRAPHEME_BREAK = [
+    "Other", "CR", "LF", "Control", "Extend", "ZWJ", "Regional_Indicator",
+    "Prepend", "SpacingMark", "L", "V", "T", "LV", "LVT",
+]
+
+WORD_BREAK = [
+    "Other", "CR", "LF", "Newline", "Extend", "ZWJ", "Regional_Indicator",
+    "Format", "Katakana", "Hebrew_Letter", "ALetter", "Single_Quote",
+    "Double_Quote", "MidNumLet", "MidLetter", "MidNum", "Numeric",
+    "ExtendNumLet", "WSegSpace",
+]
+
+LIMIT = 0x110000
+
+
+def load(ucd, path):
+    if ucd:
+        with open(f"{ucd}/{path}", encoding="utf-8") as f:
+            return f.read()
+    import requests
+
+    url = f"https://www.unicode.org/Public/{VERSION}/ucd/{path}"
+    res = requests.get(url)
+    res.raise_for_status()
+    return res.text
+
+
+def parse(text, default):
+    values = [default] * LIMIT
+
+    def assign(codepoints, value):
+        if ".." in codepoints:
+            start, end = codepoints.split("..")
+        else:
+            start = end = codepoints
+        for cp in range(int(start, 16), int(end, 16) + 1):
+            values[cp] = value
+
+    # Defaults for ranges of unassigned code points come first.
+    for line in text.splitlines():
+        if line.startswith("# @missing:"):
+            codepoints, value = line[len("# @missing:"):].split(";")[:2]
+            assign(codepoints.strip(), value.strip())
+
+    for line in text.splitlines():
+        line = line.split("#")[0].strip()
+        if not line:
+            continue
+        codepoints, value = line.split(";")[:2]
+        assign(codepoints.strip(), value.strip())
+
+    return values
+
+
+def resolveLineBreak(lb, gc):
+    # UAX #14, LB1: Resolve the classes that depend on the context or
+    # require a dictionary.
+    if lb in ("AI", "SG", "XX"):
+        return "AL"
+    if lb == "SA":
+        return "CM" if gc in ("Mn", "Mc") else "AL"
+    if lb == "CJ":
+        return "NS"
+    return lb
+
+
+def tests(ucd):
+    print(f"// Generated by gen-unicode-props.py --tests from the Unicode Character Database {VERSION}")
+    print("// DO NOT EDIT")
+
+    # Every line of the test files is kept, in their notation, with the
+    # rules they exercise as a comment.
+    for name, path in TEST_FILES.items():
+        cases = []
+        for line in load(ucd, path).splitlines():
+            case, _, comment = line.partition("#")
+            case = case.strip()
+            if case:
+                cases.append((case, comment.strip()))
+
+        print()
+        print(f"// {path}")
+        print(f"static constexpr Array<Str, {len(cases)}> {name} = {{")
+        for case, comment in cases:
+            print(f'    "{case}", // {comment}')
+        print("};")
+
+
+def tables(ucd):
+    lb = parse(load(ucd, FILES["lb"]), "XX")
+    gcb = parse(load(ucd, FILES["gcb"]), "Other")
+    wb = parse(load(ucd, FILES["wb"]), "Other")
+    emoji = parse(load(ucd, FILES["emoji"]), "")
+    ea = parse(load(ucd, FILES["ea"]), "N")
+    gc = parse(load(ucd, FILES["gc"]), "Cn")
+
+    props = []
+    for cp in range(LIMIT):
+        extPict = emoji[cp] == "Extended_Pictographic"
+        record = LINE_BREAK.index(resolveLineBreak(lb[cp], gc[cp]))
+        record |= GRAPHEME_BREAK.index(gcb[cp]) << 6
+        record |= WORD_BREAK.index(wb[cp]) << 10
+        record |= int(extPict) << 15
+        record |= int(ea[cp] in ("F", "W", "H")) << 16
+        record |= int(extPict and gc[cp] == "Cn") << 17
+        props.append(record)
+
+    records = sorted(set(props))
+    index = {r: i for i, r in enumerate(records)}
+    assert len(records) <= 256
+
+    # Pick the block size giving the smallest tables.
+    best = None
+    for shift in range(4, 11):
+        size = 1 << shift
+        blocks = {}
+        stage1 = []
+        for start in range(0, LIMIT, size):
+            block = tuple(index[r] for r in props[start : start + size])
+            stage1.append(blocks.setdefault(block, len(blocks)))
+        total = len(stage1) * (1 if len(blocks) <= 256 else 2) + len(blocks) * size
+        if best is None or total < best[0]:
+            best = (total, shift, stage1, list(blocks))
+
+    _, shift, stage1, blocks = best
+
+    print(f"// Generated by gen-unicode-props.py from the Unicode Character Database {VERSION}")
+    print("// DO NOT EDIT")
+    print()
+    print(f"static constexpr usize SHIFT = {shift};")
+    print()
+    stage1Type = "u8" if len(blocks) <= 256 else "u16"
+    print(f"static constexpr Array<{stage1Type}, {len(stage1)}> STAGE1 = {{")
+    for i in range(0, len(stage1), 16):
+        print("    " + ", ".join(str(v) for v in stage1[i : i + 16]) + ",")
+    print("};")
+    print()
+    print(f"static constexpr Array<u8, {len(blocks) << shift}> STAGE2 = {{")
+    for block in blocks:
+        for i in range(0, len(block), 32):
+            print("    " + ", ".join(str(v) for v in block[i : i + 32]) + ",")
+    print("};")
+    print()
+    print(f"static constexpr Array<u32, {len(records)}> RECORDS = {{")
+    for i in range(0, len(records), 8):
+        print("    " + ", ".join(f"0x{v:05x}" for v in records[i : i + 8]) + ",")
+    print("};")
+
+
+def main():
+    args = sys.argv[1:]
+    if args and args[0] == "--tests":
+        ucd = args[1] if len(args) > 1 else None
+        tests(ucd)
+    else:
+        ucd = args[0] if args else None
+        tables(ucd)
+
+
+if __name__ == "__main__":
+    main()
@@ -97,6 +97,8 @@ Opt<Action> Action::fromEvent(App::Event &e) {
 void Model::_do(Record &r) {
     switch (r.op) {
     case INSERT:
+        r.before = _buf.snapshot();
+        _changed({r.pos, 0});
         _buf.insert(r.pos, r.rune);
         break;
 
@@ -112,14 +114,14 @@ void Model::_do(Record &r) {
     case DELETE:
         auto start = min(_cur.head, r.pos);
         auto end = max(_cur.head, r.pos);
-        auto slice = sub(_buf, start, end);
-        r.buf = slice;
+        r.before = _buf.snapshot();
         r.pos = start;
 
         _cur.head = start;
         _cur.tail = start;
 
-        _buf.removeRange(start, end - start);
+        _changed(urange::fromStartEnd(start, end));
+        _buf.remove(urange::fromStartEnd(start, end));
         break;
     }
 }
@@ -127,15 +129,17 @@ void Model::_do(Record &r) {
 void Model::_undo(Record &r) {
     switch (r.op) {
     case INSERT:
-        _buf.removeAt(r.pos);
+        _changed({r.pos, 1});
+        _buf.restore(r.before);
         break;
 
-    case MOVE:
-    case SELECT:
+    case DELETE:
+        _changed({r.pos, 0});
+        _buf.restore(r.before);
         break;
 
-    case DELETE:
-        _buf.insertMany(r.pos, r.buf);
+    case MOVE:
+    case SELECT:
         break;
     }
 
@@ -243,17 +247,11 @@ usize Model::_nextWord(usize pos) const {
 }
 
 usize Model::_lineStart(usize pos) const {
-    while (pos != 0 and _buf[pos - 1] != '\n')
-        pos--;
-
-    return pos;
+    return _buf.lineStart(_buf.lineAt(pos));
 }
 
 usize Model::_lineEnd(usize pos) const {
-    while (pos != _buf.len() and _buf[pos] != '\n')
-        pos++;
-
-    return pos;
+    return _buf.lineEnd(_buf.lineAt(pos));
 }
 
 usize Model::_prevLine(usize pos) const {
@@ -402,7 +400,7 @@ void Model::selectAll() {
 
 String Model::copy() {
     StringBuilder sb;
-    sb.append(sub(_buf, _cur.head, _cur.tail));
+    sb.append(_buf.runes(urange::fromStartEnd(min(_cur.head, _cur.tail), max(_cur.head, _cur.tail))));
     return sb.take();
 }
 
@@ -2,6 +2,8 @@
 
 #include <karm-app/inputs.h>
 
+#include "buffer.h"
+
 namespace Karm::Text {
 
 struct Action {
@@ -79,34 +81,58 @@ struct Model {
         usize pos;
         Rune rune;
         Cur cur;
-        Vec<Rune> buf;
+        Buffer::Tree before = NONE; //< Content before the edit, shared with the buffer
         usize group;
     };
 
-    Vec<Rune> _buf;
+    // What changed since it was last taken, as the number of runes left
+    // untouched at each end of the text.
+    struct Change {
+        usize prefix;
+        usize suffix;
+    };
+
+    Buffer _buf;
     Vec<Record> _records;
     usize _index{};
     usize _group{};
     Cur _cur{};
+    Opt<Change> _change = Change{}; //< Everything is new to whoever looks first
+
+    Model(Str text = "") : _buf(text) {}
+
+    usize len() const {
+        return _buf.len();
+    }
 
-    Model(Str text = "") {
-        for (auto r : iterRunes(text))
-            _buf.pushBack(r);
+    void iterChunks(urange range, auto fn) const {
+        _buf.iterChunks(range, fn);
     }
 
-    Slice<Rune> runes() const {
-        return _buf;
+    Vec<Rune> runes(urange range) const {
+        return _buf.runes(range);
     }
 
     String string() const {
-        StringBuilder sb;
-        sb.append(runes());
-        return sb.take();
+        return _buf.string();
     }
 
     void load(Str text) {
-        for (auto r : iterRunes(text))
-            _buf.pushBack(r);
+        _changed({0, _buf.len()});
+        _buf.load(text);
+    }
+
+    // Mark `range` of the current text as about to be replaced.
+    void _changed(urange range) {
+        usize suffix = _buf.len() - range.end();
+        if (not _change)
+            _change = Change{range.start, suffix};
+        else
+            _change = Change{min(_change->prefix, range.start), min(_change->suffix, suffix)};
+    }
+
+    Opt<Change> takeChange() {
+        return std::exchange(_change, NONE);
     }
 
     // MARK: Operations
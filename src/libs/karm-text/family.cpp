@@ -12,17 +12,19 @@ FontAdjust FontAdjust::combine(FontAdjust other) const {
 }
 
 FontFamily::Builder &FontFamily::Builder::add(FontQuery query) {
-    auto face = book.queryClosest(query);
+    auto index = book._queryClosestIndex(query);
 
-    if (not face) {
+    if (not index) {
         logWarn("failed to find font for query: {}", query);
         return *this;
     }
 
+    auto const &info = book._faces[*index];
     members.pushBack({
         .adjust = {},
-        .face = *face,
+        .face = info.load(),
         .ranges = NONE,
+        .coverage = info.coverage,
     });
 
     return *this;
@@ -95,6 +97,11 @@ Glyph FontFamily::glyph(Rune rune) {
             continue;
         }
 
+        // The index tells which fonts can't have the rune, without asking
+        // them.
+        if (not member.coverage.covers(rune))
+            continue;
+
         res = member.face->glyph(rune);
         if (res != Glyph::TOFU) {
             res.font = i;
@@ -128,4 +135,40 @@ void FontFamily::contour(Gfx::Canvas &g, Glyph glyph) const {
     g.scale(_adjust.sizeAdjust * member.adjust.sizeAdjust);
     member.face->contour(g, glyph);
 }
+
+void FontFamily::shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out) {
+    // Runs of runes covered by the same member are shaped together so that
+    // substitutions and positioning can see across runes.
+    usize start = 0;
+    while (start < runes.len()) {
+        auto font = glyph(runes[start] == '\n' ? ' ' : runes[start]).font;
+        usize end = start + 1;
+        while (end < runes.len() and glyph(runes[end] == '\n' ? ' ' : runes[end]).font == font)
+            end++;
+
+        auto &member = _members[font];
+        f64 scale = member.adjust.sizeAdjust * _adjust.sizeAdjust;
+
+        usize first = out.len();
+        member.face->shape(sub(runes, start, end), features, out);
+        for (usize i = first; i < out.len(); i++) {
+            auto &g = out[i];
+            g.glyph.font = font;
+            g.cluster += start;
+            g.advance *= scale;
+            g.xOffset *= scale;
+            g.yOffset *= scale;
+        }
+
+        start = end;
+    }
+}
+
+GlyphSource FontFamily::source(Glyph glyph) const {
+    auto &member = _members[glyph.font];
+    auto source = member.face->source(glyph);
+    source.scale *= _adjust.sizeAdjust * member.adjust.sizeAdjust;
+    return source;
+}
+
 } // namespace Karm::Text
@@ -22,6 +22,7 @@ struct FontFamily : public Fontface {
         FontAdjust adjust;
         Strong<Fontface> face;
         Opt<Ranges<Range<Rune>>> ranges;
+        FontCoverage coverage = FontCoverage::all(); //< Runes outside of it aren't looked up
     };
 
     FontAdjust _adjust;
@@ -60,6 +61,10 @@ struct FontFamily : public Fontface {
     f64 kern(Glyph prev, Glyph curr) override;
 
     void contour(Gfx::Canvas &g, Glyph glyph) const override;
+
+    void shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out) override;
+
+    GlyphSource source(Glyph glyph) const override;
 };
 
 } // namespace Karm::Text
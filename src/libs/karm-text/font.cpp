@@ -10,6 +10,22 @@ Strong<Fontface> Fontface::fallback() {
     return makeStrong<VgaFontface>();
 }
 
+void Fontface::shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out) {
+    for (usize i = 0; i < runes.len(); i++) {
+        auto g = glyph(runes[i] == '\n' ? ' ' : runes[i]);
+        if (i > 0 and features.has(FontFeature::KERN)) {
+            auto &prev = last(out);
+            prev.advance += kern(prev.glyph, g);
+        }
+
+        out.pushBack({
+            .glyph = g,
+            .cluster = (u32)i,
+            .advance = advance(g),
+        });
+    }
+}
+
 Font Font::fallback() {
     return {
         .fontface = Fontface::fallback(),
@@ -5,6 +5,10 @@
 
 #include "base.h"
 
+namespace Ttf {
+struct Parser;
+} // namespace Ttf
+
 namespace Karm::Text {
 
 /**
@@ -52,6 +56,23 @@ struct FontMeasure {
     Math::Vec2f baseline;
 };
 
+// A glyph produced by shaping, advances and offsets are in ems with y
+// pointing up.
+struct ShapedGlyph {
+    Glyph glyph;
+    u32 cluster; //< Index of the first rune the glyph comes from
+    f64 advance = 0;
+    f64 xOffset = 0;
+    f64 yOffset = 0;
+};
+
+// Where a glyph comes from once families are looked through, for embedding
+// its font in documents.
+struct GlyphSource {
+    Ttf::Parser const *ttf = nullptr; //< nullptr if it isn't from a TrueType font
+    f64 scale = 1;                    //< Size it's drawn at, relative to the fontface
+};
+
 struct Fontface {
     static Strong<Fontface> fallback();
 
@@ -68,6 +89,18 @@ struct Fontface {
     virtual f64 kern(Glyph prev, Glyph curr) = 0;
 
     virtual void contour(Gfx::Canvas &g, Glyph glyph) const = 0;
+
+    // Turn a run of runes into positioned glyphs, newlines are shaped as
+    // spaces. The default maps runes one to one and applies pair kerning.
+    virtual void shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out);
+
+    virtual FontCoverage coverage() const {
+        return FontCoverage::all();
+    }
+
+    virtual GlyphSource source(Glyph) const {
+        return {};
+    }
 };
 
 struct Font {
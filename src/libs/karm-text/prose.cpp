@@ -17,156 +17,346 @@ void Prose::_beginBlock() {
         .prose = this,
         .runeRange = {_runes.len(), 0},
         .cellRange = {_cells.len(), 0},
+        .breaker = _breaker,
     });
 }
 
-void Prose::append(Rune rune) {
-    if (any(_blocks) and last(_blocks).newline())
-        _beginBlock();
-
-    if (any(_blocks) and last(_blocks).spaces())
+void Prose::_append(Rune rune, MutCursor<Span> span) {
+    // Blocks span from one line break opportunity to the next.
+    auto breaker = _breaker;
+    if (breaker.next(rune) != Break::NONE and not last(_blocks).empty())
         _beginBlock();
+    _breaker = breaker;
 
-    auto glyph = _style.font.glyph(rune == '\n' ? ' ' : rune);
-
+    // Glyphs are resolved a whole block at a time when measuring.
     _cells.pushBack({
         .prose = this,
-        .span = _currentSpan,
+        .span = span,
         .runeRange = {_runes.len(), 1},
-        .glyph = glyph,
     });
 
     _runes.pushBack(rune);
     last(_blocks).cellRange.size++;
     last(_blocks).runeRange.end(_runes.len());
+    _invalidate(_blocks.len() - 1);
+}
+
+void Prose::append(Rune rune) {
+    _append(rune, _currentSpan);
 }
 
 void Prose::clear() {
     _runes.clear();
     _cells.clear();
+    _glyphs.clear();
     _blocks.clear();
-    _blocksMeasured = false;
+    _breaker = {};
     _beginBlock();
     _lines.clear();
+
+    _measuredBlocks = 0;
+    _blockStarts.clear();
+    _blockStarts.pushBack(0);
+    _widestBlocks.clear();
+    _widestBlocks.pushBack(0);
+    _newlines.clear();
+    _wrapWidth = NONE;
+}
+
+void Prose::append(Str str) {
+    forEachRuneChunk(str, [&](Slice<Rune> runes) {
+        append(runes);
+    });
 }
 
 void Prose::append(Slice<Rune> runes) {
     _runes.ensure(_runes.len() + runes.len());
+    _cells.ensure(_cells.len() + runes.len());
     for (auto rune : runes) {
         append(rune);
     }
 }
 
-// MARK: Layout -------------------------------------------------------------
+usize Prose::_blockAt(usize runeIndex) const {
+    usize lo = 0;
+    usize hi = _blocks.len();
+    while (hi - lo > 1) {
+        usize mid = lo + (hi - lo) / 2;
+        if (_blocks[mid].runeRange.start <= runeIndex)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
 
-void Prose::_measureBlocks() {
-    for (auto &block : _blocks) {
-        auto adv = 0.0f;
-        bool first = true;
-        Glyph prev = Glyph::TOFU;
-        for (auto &cell : block.cells()) {
-            if (not first)
-                adv += _style.font.kern(prev, cell.glyph);
-            else
-                first = false;
-
-            cell.pos = adv;
-            cell.adv = _style.font.advance(cell.glyph);
-            adv += cell.adv;
-            prev = cell.glyph;
+void Prose::replace(urange range, Slice<Rune> runes) {
+    // Every block before the one containing the edit stays the same, the
+    // text is appended again from there. The edit can remove the break
+    // opportunity before its block, so start one block earlier.
+    usize bi = _blockAt(range.start);
+    if (bi > 0)
+        bi--;
+    usize from = _blocks[bi].runeRange.start;
+
+    MutCursor<Span> span = _currentSpan;
+    if (range.start > 0 and range.start <= _cells.len())
+        span = _cells[range.start - 1].span;
+
+    // Past the edit, the blocks stay the same from the first one the line
+    // breaker reaches in the state it was in before it, they are only
+    // moved. Find it, only the text before it is appended again.
+    usize resync = _blocks.len();
+    {
+        LineBreaker breaker = _blocks[bi].breaker;
+        bool fed = false;
+        for (usize i = from; i < range.start; i++, fed = true)
+            (void)breaker.next(_runes[i]);
+        for (usize i = 0; i < runes.len(); i++, fed = true)
+            (void)breaker.next(runes[i]);
+
+        usize ob = _blockAt(range.end());
+        if (_blocks[ob].runeRange.start < range.end())
+            ob++;
+
+        for (usize i = range.end(); i < _runes.len() and ob < _blocks.len(); i++, fed = true) {
+            if (i == _blocks[ob].runeRange.start) {
+                if (fed and breaker == _blocks[ob].breaker) {
+                    resync = ob;
+                    break;
+                }
+                ob++;
+            }
+            (void)breaker.next(_runes[i]);
         }
-        block.width = adv;
     }
+    usize until = resync < _blocks.len() ? _blocks[resync].runeRange.start : _runes.len();
+
+    Vec<Cons<Rune, MutCursor<Span>>> tail;
+    tail.ensure(until - from - range.size + runes.len());
+    for (usize i = from; i < range.start; i++)
+        tail.pushBack({_runes[i], _cells[i].span});
+    for (auto rune : runes)
+        tail.pushBack({rune, span});
+    for (usize i = range.end(); i < until; i++)
+        tail.pushBack({_runes[i], _cells[i].span});
+
+    Vec<Rune> keptRunes = sub(_runes, until, _runes.len());
+    Vec<Cell> keptCells = sub(_cells, until, _cells.len());
+    Vec<Block> keptBlocks = sub(_blocks, resync, _blocks.len());
+    auto breaker = _breaker;
+
+    // Invalidate first, the glyphs of the block are dropped along with it.
+    _invalidate(bi);
+    _runes.trunc(from);
+    _cells.trunc(from);
+    _breaker = _blocks[bi].breaker;
+    _blocks.trunc(bi);
+    _beginBlock();
+
+    for (auto &t : tail)
+        _append(t.car, t.cdr);
+
+    if (not keptBlocks.len())
+        return;
+
+    // Cells and runes go one to one, the blocks that were kept start where
+    // they were, less what was removed, plus what was appended again.
+    usize base = _runes.len();
+    _runes.insertMany(base, keptRunes);
+    for (auto &cell : keptCells) {
+        cell.runeRange.start = _cells.len();
+        _cells.pushBack(cell);
+    }
+    for (auto &block : keptBlocks) {
+        block.runeRange.start = block.runeRange.start - until + base;
+        block.cellRange.start = block.cellRange.start - until + base;
+        _blocks.pushBack(block);
+    }
+    _breaker = breaker;
 }
 
-void Prose::_wrapLines(f64 width) {
-    _lines.clear();
+void Prose::assign(Slice<Rune> runes) {
+    usize prefix = 0;
+    while (prefix < runes.len() and
+           prefix < _runes.len() and
+           runes[prefix] == _runes[prefix])
+        prefix++;
+
+    if (prefix == runes.len() and prefix == _runes.len())
+        return;
+
+    usize suffix = 0;
+    while (suffix < runes.len() - prefix and
+           suffix < _runes.len() - prefix and
+           runes[runes.len() - suffix - 1] == _runes[_runes.len() - suffix - 1])
+        suffix++;
+
+    replace(
+        {prefix, _runes.len() - prefix - suffix},
+        sub(runes, prefix, runes.len() - suffix)
+    );
+}
+
+// MARK: Layout -------------------------------------------------------------
+
+void Prose::_invalidate(usize blockIndex) {
+    if (blockIndex < _measuredBlocks) {
+        _measuredBlocks = blockIndex;
+        _glyphs.trunc(_blocks[blockIndex].glyphRange.start);
+        _blockStarts.trunc(blockIndex + 1);
+        _widestBlocks.trunc(blockIndex + 1);
+        while (any(_newlines) and last(_newlines) >= blockIndex)
+            _newlines.popBack();
+    }
+
+    // The line ending right before the block might now fit more of it.
+    while (any(_lines) and last(_lines).blockRange.end() >= blockIndex)
+        _lines.popBack();
+}
+
+void Prose::_measureBlocks() {
+    auto &cache = ShapingCache::global();
+    auto fontsize = _style.font.fontsize;
 
-    Line line{this, {}, {}};
-    bool first = true;
-    f64 adv = 0;
-    for (usize i = 0; i < _blocks.len(); i++) {
+    for (usize i = _measuredBlocks; i < _blocks.len(); i++) {
         auto &block = _blocks[i];
-        if (adv + block.width > width and _style.wordwrap and _style.multiline and not first) {
-            _lines.pushBack(line);
-            line = {this, block.runeRange, {i, 1}};
-            adv = block.width;
-
-            if (block.newline()) {
-                _lines.pushBack(line);
-                line = {
-                    this,
-                    {block.runeRange.end(), 0},
-                    {i + 1, 0},
-                };
-                adv = 0;
-            }
-        } else {
-            line.blockRange.size++;
-            line.runeRange.end(block.runeRange.end());
-
-            if (block.newline() and _style.multiline) {
-                _lines.pushBack(line);
-                line = {
-                    this,
-                    {block.runeRange.end(), 0},
-                    {i + 1, 0},
-                };
-                adv = 0;
-            } else {
-                adv += block.width;
-            }
+        auto const &word = cache.shape(_style.font.fontface, sub(_runes, block.runeRange), _style.features);
+        auto cells = block.cells();
+        for (usize j = 0; j < cells.len(); j++) {
+            cells[j].pos = word.pos[j] * fontsize;
+            cells[j].adv = word.adv[j] * fontsize;
         }
-        first = false;
+
+        block.glyphRange = {_glyphs.len(), word.glyphs.len()};
+        f64 pen = 0;
+        for (auto const &g : word.glyphs) {
+            _glyphs.pushBack({
+                .glyph = g.glyph,
+                .cell = block.cellRange.start + min((usize)g.cluster, cells.len() - 1),
+                .pos = {(pen + g.xOffset) * fontsize, -g.yOffset * fontsize},
+            });
+            pen += g.advance;
+        }
+        block.width = word.width * fontsize;
+
+        _blockStarts.pushBack(last(_blockStarts) + block.width);
+        _widestBlocks.pushBack(max(last(_widestBlocks), _blockWidth(i)));
+        if (block.newline())
+            _newlines.pushBack(i);
     }
 
-    _lines.pushBack(line);
+    _measuredBlocks = _blocks.len();
 }
 
-f64 Prose::_layoutVerticaly() {
-    auto m = _style.font.metrics();
-    f64 baseline = m.linegap / 2;
-    for (auto &line : _lines) {
-        baseline += m.ascend;
-        line.baseline = baseline;
-        baseline += m.linegap + m.descend;
+Opt<usize> Prose::_nextNewline(usize blockIndex) const {
+    if (not _style.multiline)
+        return NONE;
+
+    usize lo = 0;
+    usize hi = _newlines.len();
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        if (_newlines[mid] < blockIndex)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    return baseline - m.linegap / 2;
+
+    if (lo == _newlines.len())
+        return NONE;
+    return _newlines[lo];
 }
 
-f64 Prose::_layoutHorizontaly(f64 width) {
-    f64 maxWidth = 0;
-    for (auto &line : _lines) {
-        if (not line.blockRange.any())
+usize Prose::_lineEnd(usize start, f64 width) const {
+    usize end = _blocks.len() - 1;
+    if (auto newline = _nextNewline(start))
+        end = *newline;
+
+    if (not _style.wordwrap or not _style.multiline)
+        return end;
+
+    // Find the last block that fits, the first one always does.
+    usize lo = start;
+    usize hi = end + 1;
+    while (hi - lo > 1) {
+        usize mid = lo + (hi - lo) / 2;
+        if (_blockStarts[mid + 1] - _blockStarts[start] <= width)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+usize Prose::_wrapLines(f64 width) {
+    if (not _wrapWidth or *_wrapWidth != width) {
+        _lines.clear();
+        _wrapWidth = width;
+    }
+
+    usize firstLine = _lines.len();
+    usize start = any(_lines) ? last(_lines).blockRange.end() : 0;
+    if (any(_lines) and start == _blocks.len())
+        return firstLine;
+
+    while (true) {
+        usize end = _lineEnd(start, width);
+        _lines.pushBack({
+            this,
+            urange::fromStartEnd(_blocks[start].runeRange.start, _blocks[end].runeRange.end()),
+            urange::fromStartEnd(start, end + 1),
+        });
+
+        start = end + 1;
+        if (start < _blocks.len())
             continue;
 
-        f64 pos = 0;
-        for (auto &block : line.blocks()) {
-            block.pos = pos;
-            pos += block.width;
+        // Leave an empty line after a trailing newline for the caret.
+        if (_style.multiline and _blocks[end].newline()) {
+            _lines.pushBack({
+                this,
+                {_blocks[end].runeRange.end(), 0},
+                {start, 0},
+            });
         }
+        break;
+    }
 
-        auto lastBlock = _blocks[line.blockRange.end() - 1];
-        line.width = lastBlock.pos + lastBlock.width;
-        maxWidth = max(maxWidth, line.width);
-        auto free = width - line.width;
+    return firstLine;
+}
 
+f64 Prose::_layoutVerticaly(usize firstLine) {
+    auto m = _style.font.metrics();
+    for (usize i = firstLine; i < _lines.len(); i++)
+        _lines[i].baseline = m.linegap / 2 + m.ascend + i * (m.ascend + m.descend + m.linegap);
+    return _lines.len() * (m.ascend + m.descend + m.linegap);
+}
+
+f64 Prose::_layoutHorizontaly(usize firstLine, f64 width) {
+    for (usize i = firstLine; i < _lines.len(); i++) {
+        auto &line = _lines[i];
+        line.width = _blockStarts[line.blockRange.end()] - _blockStarts[line.blockRange.start];
+
+        auto free = width - line.width;
         switch (_style.align) {
         case TextAlign::LEFT:
+            line.offset = 0;
             break;
 
         case TextAlign::CENTER:
-            for (auto &block : line.blocks())
-                block.pos += free / 2;
+            line.offset = free / 2;
             break;
 
         case TextAlign::RIGHT:
-            for (auto &block : line.blocks())
-                block.pos += free;
+            line.offset = free;
             break;
         }
     }
 
+    f64 maxWidth = 0;
+    for (auto const &line : _lines)
+        maxWidth = max(maxWidth, line.width);
     return maxWidth;
 }
 
@@ -174,20 +364,39 @@ Math::Vec2f Prose::layout(f64 width) {
     if (isEmpty(_blocks))
         return {};
 
-    // Blocks measurements can be reused between layouts changes
-    // only line wrapping need to be re-done
-    if (not _blocksMeasured) {
-        _measureBlocks();
-        _blocksMeasured = true;
-    }
+    // Only the blocks added or edited since the last layout need to be
+    // measured, and the lines before them wrapped again.
+    _measureBlocks();
 
-    _wrapLines(width);
-    auto textHeight = _layoutVerticaly();
-    auto textWidth = _layoutHorizontaly(width);
+    auto firstLine = _wrapLines(width);
+    auto textHeight = _layoutVerticaly(firstLine);
+    auto textWidth = _layoutHorizontaly(firstLine, width);
     _size = {textWidth, textHeight};
     return {textWidth, textHeight};
 }
 
+f64 Prose::minContentWidth() {
+    if (not _style.wordwrap or not _style.multiline)
+        return maxContentWidth();
+
+    _measureBlocks();
+    return last(_widestBlocks);
+}
+
+f64 Prose::maxContentWidth() {
+    _measureBlocks();
+
+    f64 res = 0;
+    usize start = 0;
+    if (_style.multiline) {
+        for (auto newline : _newlines) {
+            res = max(res, _blockStarts[newline + 1] - _blockStarts[start]);
+            start = newline + 1;
+        }
+    }
+    return max(res, _blockStarts[_blocks.len()] - _blockStarts[start]);
+}
+
 // MARK: Paint -------------------------------------------------------------
 
 void Prose::paint(Gfx::Canvas &g) {
@@ -197,15 +406,18 @@ void Prose::paint(Gfx::Canvas &g) {
         g.fillStyle(*_style.color);
 
     for (auto const &line : _lines) {
-        for (auto &block : line.blocks()) {
-            for (auto &cell : block.cells()) {
+        for (usize i : line.blockRange.iter()) {
+            auto pos = _blockPos(line, i);
+            for (auto &glyph : _blocks[i].glyphs()) {
+                auto &cell = _cells[glyph.cell];
+                Math::Vec2f at = {pos + glyph.pos.x, line.baseline + glyph.pos.y};
                 if (cell.span and cell.span->color) {
                     g.push();
                     g.fillStyle(*cell.span->color);
-                    g.fill(_style.font, cell.glyph, {block.pos + cell.pos, line.baseline});
+                    g.fill(_style.font, glyph.glyph, at);
                     g.pop();
                 } else {
-                    g.fill(_style.font, cell.glyph, {block.pos + cell.pos, line.baseline});
+                    g.fill(_style.font, glyph.glyph, at);
                 }
             }
         }
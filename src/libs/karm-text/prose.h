@@ -3,7 +3,9 @@
 #include <karm-gfx/canvas.h>
 #include <karm-logger/logger.h>
 
+#include "breaks.h"
 #include "font.h"
+#include "shaping.h"
 
 namespace Karm::Text {
 
@@ -19,6 +21,7 @@ struct ProseStyle {
     Opt<Gfx::Color> color = NONE;
     bool wordwrap = true;
     bool multiline = false;
+    FontFeatures features = FontFeatures::defaults();
 
     ProseStyle withSize(f64 size) const {
         ProseStyle style = *this;
@@ -55,6 +58,12 @@ struct ProseStyle {
         style.multiline = multiline;
         return style;
     }
+
+    ProseStyle withFeatures(FontFeatures features) const {
+        ProseStyle style = *this;
+        style.features = features;
+        return style;
+    }
 };
 
 struct Prose : public Meta::Pinned {
@@ -68,9 +77,8 @@ struct Prose : public Meta::Pinned {
         MutCursor<Span> span;
 
         urange runeRange;
-        Glyph glyph;
-        f64 pos = 0; //< Position of the glyph within the block
-        f64 adv = 0; //< Advance of the glyph
+        f64 pos = 0; //< Caret position of the rune within the block
+        f64 adv = 0; //< Advance of the rune
 
         MutSlice<Rune> runes() {
             return mutSub(prose->_runes, runeRange);
@@ -95,15 +103,25 @@ struct Prose : public Meta::Pinned {
         }
     };
 
+    // Shaping doesn't map runes to glyphs one to one, glyphs are kept apart
+    // from the cells they come from.
+    struct PlacedGlyph {
+        Glyph glyph;
+        usize cell;
+        Math::Vec2f pos; //< Relative to the origin of the block, on the baseline
+    };
+
     struct Block {
         MutCursor<Prose> prose;
 
         urange runeRange;
         urange cellRange;
+        urange glyphRange = {}; //< Only valid once measured
 
-        f64 pos = 0; // Position of the block within the line
         f64 width = 0;
 
+        LineBreaker breaker; //< State of the line breaker before the block
+
         MutSlice<Cell> cells() {
             return mutSub(prose->_cells, cellRange);
         }
@@ -112,6 +130,10 @@ struct Prose : public Meta::Pinned {
             return sub(prose->_cells, cellRange);
         }
 
+        Slice<PlacedGlyph> glyphs() const {
+            return sub(prose->_glyphs, glyphRange);
+        }
+
         bool empty() const {
             return cellRange.empty();
         }
@@ -136,6 +158,7 @@ struct Prose : public Meta::Pinned {
         urange blockRange;
         f64 baseline = 0; // Baseline of the line within the text
         f64 width = 0;
+        f64 offset = 0; // Position of the first block, depends on the alignment
 
         Slice<Block> blocks() const {
             return sub(prose->_blocks, blockRange);
@@ -150,11 +173,21 @@ struct Prose : public Meta::Pinned {
 
     Vec<Rune> _runes;
     Vec<Cell> _cells;
+    Vec<PlacedGlyph> _glyphs;
     Vec<Block> _blocks;
     Vec<Line> _lines;
 
+    LineBreaker _breaker;
+
+    // Blocks before this index are measured and have their width summed in
+    // _blockStarts, so that line breaks can be found by binary search.
+    usize _measuredBlocks = 0;
+    Vec<f64> _blockStarts;  //< Position of each block if all were on one line
+    Vec<f64> _widestBlocks; //< Width of the widest block before each block
+    Vec<usize> _newlines;   //< Index of the blocks ending with a newline
+    Opt<f64> _wrapWidth;
+
     // Various cached values
-    bool _blocksMeasured = false;
     f64 _spaceWidth{};
     f64 _lineHeight{};
 
@@ -170,6 +203,8 @@ struct Prose : public Meta::Pinned {
 
     void _beginBlock();
 
+    void _append(Rune rune, MutCursor<Span> span);
+
     void append(Rune rune);
 
     void clear();
@@ -180,8 +215,19 @@ struct Prose : public Meta::Pinned {
             append(rune);
     }
 
+    void append(Str str);
+
     void append(Slice<Rune> runes);
 
+    usize _blockAt(usize runeIndex) const;
+
+    // Replace the runes in `range`, only the text following the first edited
+    // block is measured and wrapped again.
+    void replace(urange range, Slice<Rune> runes);
+
+    // Replace the whole text, keeping the layout of the unchanged prefix.
+    void assign(Slice<Rune> runes);
+
     // MARK: Span --------------------------------------------------------------
 
     Vec<Box<Span>> _spans;
@@ -206,16 +252,36 @@ struct Prose : public Meta::Pinned {
 
     // MARK: Layout ------------------------------------------------------------
 
+    void _invalidate(usize blockIndex);
+
     void _measureBlocks();
 
-    void _wrapLines(f64 width);
+    f64 _blockWidth(usize blockIndex) const {
+        return _blockStarts[blockIndex + 1] - _blockStarts[blockIndex];
+    }
 
-    f64 _layoutVerticaly();
+    f64 _blockPos(Line const &line, usize blockIndex) const {
+        return line.offset + _blockStarts[blockIndex] - _blockStarts[line.blockRange.start];
+    }
 
-    f64 _layoutHorizontaly(f64 width);
+    Opt<usize> _nextNewline(usize blockIndex) const;
+
+    usize _lineEnd(usize start, f64 width) const;
+
+    usize _wrapLines(f64 width);
+
+    f64 _layoutVerticaly(usize firstLine);
+
+    f64 _layoutHorizontaly(usize firstLine, f64 width);
 
     Math::Vec2f layout(f64 width);
 
+    // Width of the text if it was wrapped at every opportunity.
+    f64 minContentWidth();
+
+    // Width of the text if it was only broken at newlines.
+    f64 maxContentWidth();
+
     // MARK: Paint -------------------------------------------------------------
 
     void paint(Gfx::Canvas &g);
@@ -297,19 +363,20 @@ struct Prose : public Meta::Pinned {
             return {0, line.baseline};
 
         auto &block = line.blocks()[bi];
+        auto pos = _blockPos(line, line.blockRange.start + bi);
 
         if (isEmpty(block.cells()))
-            return {block.pos, line.baseline};
+            return {pos, line.baseline};
 
         if (ci >= block.cells().len()) {
             // Handle the case where the rune is the last of the text
             auto &cell = last(block.cells());
-            return {block.pos + cell.pos + cell.adv, line.baseline};
+            return {pos + cell.pos + cell.adv, line.baseline};
         }
 
         auto &cell = block.cells()[ci];
 
-        return {block.pos + cell.pos, line.baseline};
+        return {pos + cell.pos, line.baseline};
     }
 };
 
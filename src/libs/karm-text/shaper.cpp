@@ -0,0 +1,579 @@
+#include "shaper.h"
+
+#include "unicode.h"
+
+namespace Karm::Text {
+
+// MARK: Plan ------------------------------------------------------------------
+
+static bool _enabled(FontFeatures features, u32 tag) {
+    for (usize i = 0; i < FONT_FEATURE_TAGS.len(); i++)
+        if (Ttf::tagOf(FONT_FEATURE_TAGS[i]) == tag)
+            return features.has((FontFeature)i);
+    return false;
+}
+
+static Vec<u16> _planTable(Ttf::Layout::Table const &table, u32 script, FontFeatures features, bool &kern) {
+    Vec<u16> res;
+
+    auto scriptIndex = table.script(script);
+    if (not scriptIndex)
+        return res;
+    auto const &s = table.scripts[*scriptIndex];
+
+    auto addFeature = [&](usize featureIndex) {
+        if (featureIndex >= table.features.len())
+            return;
+        for (auto lookup : table.features[featureIndex].lookups)
+            if (lookup < table.lookups.len())
+                res.pushBack(lookup);
+    };
+
+    if (s.required)
+        addFeature(*s.required);
+
+    for (auto featureIndex : s.features) {
+        if (featureIndex >= table.features.len())
+            continue;
+
+        auto tag = table.features[featureIndex].tag;
+        if (not _enabled(features, tag))
+            continue;
+
+        if (tag == Ttf::tagOf("kern"))
+            kern = true;
+        addFeature(featureIndex);
+    }
+
+    // Lookups are applied in the order of the lookup list, once each.
+    sort(res);
+    usize len = 0;
+    for (usize i = 0; i < res.len(); i++)
+        if (len == 0 or res[len - 1] != res[i])
+            res[len++] = res[i];
+    res.trunc(len);
+
+    return res;
+}
+
+ShapingPlan ShapingPlan::build(Ttf::Layout const &layout, u32 script, FontFeatures features) {
+    ShapingPlan plan{
+        .script = script,
+        .features = features,
+        .gsub = {},
+        .gpos = {},
+    };
+
+    bool ignored = false;
+    plan.gsub = _planTable(layout.gsub, script, features, ignored);
+    plan.gpos = _planTable(layout.gpos, script, features, plan.kern);
+    return plan;
+}
+
+// MARK: Buffer ----------------------------------------------------------------
+
+u32 Shaper::scriptOf(Slice<Rune> runes) {
+    struct ScriptRange {
+        Rune start;
+        Rune end;
+        Str tag;
+    };
+
+    static constexpr Array<ScriptRange, 17> SCRIPTS = {
+        ScriptRange{0x0041, 0x005A, "latn"},
+        ScriptRange{0x0061, 0x007A, "latn"},
+        ScriptRange{0x00C0, 0x024F, "latn"},
+        ScriptRange{0x0370, 0x03FF, "grek"},
+        ScriptRange{0x0400, 0x052F, "cyrl"},
+        ScriptRange{0x0590, 0x05FF, "hebr"},
+        ScriptRange{0x0600, 0x06FF, "arab"},
+        ScriptRange{0x0900, 0x097F, "deva"},
+        ScriptRange{0x0E00, 0x0E7F, "thai"},
+        ScriptRange{0x1100, 0x11FF, "hang"},
+        ScriptRange{0x1E00, 0x1EFF, "latn"},
+        ScriptRange{0x1F00, 0x1FFF, "grek"},
+        ScriptRange{0x3040, 0x30FF, "kana"},
+        ScriptRange{0x3400, 0x4DBF, "hani"},
+        ScriptRange{0x4E00, 0x9FFF, "hani"},
+        ScriptRange{0xAC00, 0xD7AF, "hang"},
+        ScriptRange{0x20000, 0x2FFFF, "hani"},
+    };
+
+    for (auto rune : runes)
+        for (auto const &s : SCRIPTS)
+            if (s.start <= rune and rune <= s.end)
+                return Ttf::tagOf(s.tag);
+
+    return Ttf::tagOf("DFLT");
+}
+
+void Shaper::load(Slice<Rune> runes, Slice<u16> glyphs) {
+    _slots.clear();
+    _slots.ensure(glyphs.len());
+    for (usize i = 0; i < glyphs.len(); i++) {
+        Slot slot{.glyph = glyphs[i], .cluster = (u32)i};
+        _setGlyph(slot, glyphs[i]);
+
+        // Without a GDEF table, tell marks apart using the properties of
+        // their rune.
+        if (not _layout.hasGlyphClasses() and i < runes.len()) {
+            auto gb = UnicodeProps::of(runes[i]).graphemeBreak();
+            slot.klass = gb == GraphemeBreak::EXTEND
+                             ? Ttf::Gdef::MARK
+                             : Ttf::Gdef::BASE;
+        }
+
+        _slots.pushBack(slot);
+    }
+}
+
+void Shaper::_setGlyph(Slot &slot, u16 glyph) {
+    slot.glyph = glyph;
+    if (_layout.hasGlyphClasses()) {
+        slot.klass = _layout.glyphClasses.classOf(glyph);
+        slot.markAttachClass = _layout.markAttachClasses.classOf(glyph);
+    }
+}
+
+// MARK: Matching --------------------------------------------------------------
+
+bool Shaper::_ignored(Slot const &slot, Ttf::Lookup const &lookup) const {
+    auto flags = lookup.flags;
+
+    if (slot.klass == Ttf::Gdef::MARK) {
+        if (flags & Ttf::LookupTable::IGNORE_MARKS)
+            return true;
+
+        if (flags & Ttf::LookupTable::USE_MARK_FILTERING_SET) {
+            auto set = lookup.markFilteringSet;
+            return set >= _layout.markGlyphSets.len() or
+                   not _layout.markGlyphSets[set].has(slot.glyph);
+        }
+
+        if (flags & MARK_ATTACHMENT_TYPE)
+            return slot.markAttachClass != (flags >> 8);
+
+        return false;
+    }
+
+    if (slot.klass == Ttf::Gdef::BASE and (flags & Ttf::LookupTable::IGNORE_BASE_GLYPHS))
+        return true;
+
+    if (slot.klass == Ttf::Gdef::LIGATURE and (flags & Ttf::LookupTable::IGNORE_LIGATURES))
+        return true;
+
+    return false;
+}
+
+Opt<usize> Shaper::_next(usize i, Ttf::Lookup const &lookup) const {
+    for (usize j = i + 1; j < _slots.len(); j++)
+        if (not _ignored(_slots[j], lookup))
+            return j;
+    return NONE;
+}
+
+Opt<usize> Shaper::_prev(usize i, Ttf::Lookup const &lookup) const {
+    for (usize j = i; j > 0; j--)
+        if (not _ignored(_slots[j - 1], lookup))
+            return j - 1;
+    return NONE;
+}
+
+Opt<usize> Shaper::_applyContext(Ttf::ContextSubst const &t, Ttf::Lookup const &lookup, usize i, bool gpos, usize depth) {
+    using Seq = Ttf::ContextSubst::Seq;
+
+    if (not t.coverage.has(_slots[i].glyph))
+        return NONE;
+
+    for (auto const &rule : t.rulesFor(_slots[i].glyph)) {
+        if (rule.input.len() + 1 > MAX_CONTEXT)
+            continue;
+
+        Array<usize, MAX_CONTEXT> positions;
+        usize count = 0;
+        positions[count++] = i;
+
+        bool matched = true;
+        for (auto value : rule.input) {
+            auto next = _next(positions[count - 1], lookup);
+            if (not next or not t.matches(Seq::INPUT, value, _slots[*next].glyph)) {
+                matched = false;
+                break;
+            }
+            positions[count++] = *next;
+        }
+
+        usize j = i;
+        for (usize k = 0; matched and k < rule.backtrack.len(); k++) {
+            auto prev = _prev(j, lookup);
+            if (not prev or not t.matches(Seq::BACKTRACK, rule.backtrack[k], _slots[*prev].glyph))
+                matched = false;
+            else
+                j = *prev;
+        }
+
+        j = positions[count - 1];
+        for (usize k = 0; matched and k < rule.lookahead.len(); k++) {
+            auto next = _next(j, lookup);
+            if (not next or not t.matches(Seq::LOOKAHEAD, rule.lookahead[k], _slots[*next].glyph))
+                matched = false;
+            else
+                j = *next;
+        }
+
+        if (not matched)
+            continue;
+
+        usize end = positions[count - 1] + 1;
+        auto const &lookups = gpos ? _layout.gpos.lookups : _layout.gsub.lookups;
+        for (auto const &seqLookup : rule.lookups) {
+            if (seqLookup.sequenceIndex >= count or
+                seqLookup.lookupIndex >= lookups.len() or
+                depth >= MAX_NESTING)
+                continue;
+
+            auto before = _slots.len();
+            _applyAt(lookups[seqLookup.lookupIndex], positions[seqLookup.sequenceIndex], gpos, depth + 1);
+
+            // Glyphs might have been merged or split, keep the remaining
+            // positions pointing at the same glyphs.
+            isize delta = (isize)_slots.len() - (isize)before;
+            if (delta == 0)
+                continue;
+
+            for (usize k = seqLookup.sequenceIndex + 1; k < count; k++)
+                positions[k] = (usize)clamp((isize)positions[k] + delta, (isize)positions[seqLookup.sequenceIndex], (isize)_slots.len() - 1);
+            end = (usize)clamp((isize)end + delta, (isize)positions[seqLookup.sequenceIndex] + 1, (isize)_slots.len());
+        }
+
+        return end;
+    }
+
+    return NONE;
+}
+
+Opt<usize> Shaper::_applyAt(Ttf::Lookup const &lookup, usize i, bool gpos, usize depth) {
+    if (i >= _slots.len() or
+        not lookup.starts.has(_slots[i].glyph) or
+        _ignored(_slots[i], lookup))
+        return NONE;
+
+    return gpos
+               ? _applyGpos(lookup, i, depth)
+               : _applyGsub(lookup, i, depth);
+}
+
+// MARK: Substitution ----------------------------------------------------------
+
+void Shaper::_ligate(usize i, Slice<usize> components, u16 glyph) {
+    u16 ligId = _nextLigId++;
+    if (_nextLigId == 0)
+        _nextLigId = 1;
+
+    // Marks skipped while matching go with the component before them.
+    usize component = 1;
+    usize next = 0;
+    for (usize j = i + 1; j <= last(components); j++) {
+        if (next < components.len() and components[next] == j) {
+            component++;
+            next++;
+            continue;
+        }
+        _slots[j].ligId = ligId;
+        _slots[j].ligComponent = component;
+    }
+
+    auto &slot = _slots[i];
+    _setGlyph(slot, glyph);
+    if (not _layout.hasGlyphClasses())
+        slot.klass = Ttf::Gdef::LIGATURE;
+    slot.ligId = ligId;
+    slot.ligComponent = 0;
+
+    for (usize k = components.len(); k > 0; k--) {
+        auto j = components[k - 1];
+        slot.cluster = min(slot.cluster, _slots[j].cluster);
+        _slots.removeAt(j);
+    }
+}
+
+Opt<usize> Shaper::_applyGsub(Ttf::Lookup const &lookup, usize i, usize depth) {
+    using Kind = Ttf::Lookup::Kind;
+
+    auto glyph = _slots[i].glyph;
+
+    for (auto const &subtable : lookup.subtables) {
+        auto res = subtable.visit(Visitor{
+            [&](Ttf::SingleSubst const &t) -> Opt<usize> {
+                auto subst = try$(t.apply(glyph));
+                _setGlyph(_slots[i], subst);
+                return i + 1;
+            },
+            [&](Ttf::MultipleSubst const &t) -> Opt<usize> {
+                auto index = try$(t.coverage.indexOf(glyph));
+                if (index >= t.sequences.len())
+                    return NONE;
+
+                auto const &seq = t.sequences[index];
+                if (lookup.kind == Kind::ALTERNATE_SUBST) {
+                    if (isEmpty(seq))
+                        return NONE;
+                    _setGlyph(_slots[i], first(seq));
+                    return i + 1;
+                }
+
+                // An empty sequence deletes the glyph.
+                if (isEmpty(seq)) {
+                    _slots.removeAt(i);
+                    return i;
+                }
+
+                auto slot = _slots[i];
+                _setGlyph(_slots[i], seq[0]);
+                for (usize k = 1; k < seq.len(); k++) {
+                    _setGlyph(slot, seq[k]);
+                    _slots.insert(i + k, slot);
+                }
+                return i + seq.len();
+            },
+            [&](Ttf::LigatureSubst const &t) -> Opt<usize> {
+                auto index = try$(t.coverage.indexOf(glyph));
+                if (index >= t.sets.len())
+                    return NONE;
+
+                for (auto const &ligature : t.sets[index]) {
+                    if (ligature.components.len() > MAX_CONTEXT)
+                        continue;
+
+                    Array<usize, MAX_CONTEXT> components;
+                    usize count = 0;
+                    usize j = i;
+                    for (auto component : ligature.components) {
+                        auto next = _next(j, lookup);
+                        if (not next or _slots[*next].glyph != component)
+                            break;
+                        components[count++] = j = *next;
+                    }
+
+                    if (count != ligature.components.len())
+                        continue;
+
+                    if (count == 0) {
+                        _setGlyph(_slots[i], ligature.glyph);
+                        return i + 1;
+                    }
+
+                    _ligate(i, sub(components, 0, count), ligature.glyph);
+                    return i + 1;
+                }
+
+                return NONE;
+            },
+            [&](Ttf::ContextSubst const &t) -> Opt<usize> {
+                return _applyContext(t, lookup, i, false, depth);
+            },
+            [&](Ttf::ReverseChainSubst const &t) -> Opt<usize> {
+                auto index = try$(t.coverage.indexOf(glyph));
+                if (index >= t.substitutes.len())
+                    return NONE;
+
+                usize j = i;
+                for (auto const &coverage : t.backtrack) {
+                    auto prev = _prev(j, lookup);
+                    if (not prev or not coverage.has(_slots[*prev].glyph))
+                        return NONE;
+                    j = *prev;
+                }
+
+                j = i;
+                for (auto const &coverage : t.lookahead) {
+                    auto next = _next(j, lookup);
+                    if (not next or not coverage.has(_slots[*next].glyph))
+                        return NONE;
+                    j = *next;
+                }
+
+                _setGlyph(_slots[i], t.substitutes[index]);
+                return i + 1;
+            },
+            [&](auto const &) -> Opt<usize> {
+                return NONE;
+            },
+        });
+
+        if (res)
+            return res;
+    }
+
+    return NONE;
+}
+
+void Shaper::substitute(ShapingPlan const &plan) {
+    for (auto lookupIndex : plan.gsub) {
+        auto const &lookup = _layout.gsub.lookups[lookupIndex];
+
+        // Reverse chaining substitutions are applied from the end of the
+        // run, one glyph at a time.
+        if (lookup.kind == Ttf::Lookup::Kind::REVERSE_CHAIN_SUBST) {
+            for (usize i = _slots.len(); i > 0; i--)
+                _applyAt(lookup, i - 1, false, 0);
+            continue;
+        }
+
+        usize i = 0;
+        while (i < _slots.len()) {
+            // A deleted glyph leaves the next one at the same index.
+            auto next = _applyAt(lookup, i, false, 0);
+            i = next.unwrapOrDefault(i + 1);
+        }
+    }
+}
+
+// MARK: Positioning -----------------------------------------------------------
+
+void Shaper::_adjust(Slot &slot, Ttf::Value const &value) {
+    slot.xOffset += value.xPlacement;
+    slot.yOffset += value.yPlacement;
+    slot.advance += value.xAdvance;
+}
+
+void Shaper::_attach(usize mark, usize base, Cons<isize> offset) {
+    auto &slot = _slots[mark];
+    slot.attach = base;
+    slot.xOffset = offset.car;
+    slot.yOffset = offset.cdr;
+}
+
+Opt<usize> Shaper::_applyGpos(Ttf::Lookup const &lookup, usize i, usize depth) {
+    using Kind = Ttf::Lookup::Kind;
+
+    auto glyph = _slots[i].glyph;
+
+    // The base a mark attaches to is the closest glyph before it that
+    // isn't a mark.
+    auto findBase = [&]() -> Opt<usize> {
+        for (usize j = i; j > 0; j--)
+            if (_slots[j - 1].klass != Ttf::Gdef::MARK)
+                return j - 1;
+        return NONE;
+    };
+
+    for (auto const &subtable : lookup.subtables) {
+        auto res = subtable.visit(Visitor{
+            [&](Ttf::SingleAdjust const &t) -> Opt<usize> {
+                auto value = try$(t.get(glyph));
+                _adjust(_slots[i], value);
+                return i + 1;
+            },
+            [&](Ttf::PairAdjust const &t) -> Opt<usize> {
+                auto next = try$(_next(i, lookup));
+                auto values = try$(t.get(glyph, _slots[next].glyph));
+                _adjust(_slots[i], values.car);
+                _adjust(_slots[next], values.cdr);
+                return t.hasSecond ? next + 1 : next;
+            },
+            [&](Ttf::CursiveAttach const &t) -> Opt<usize> {
+                auto index = try$(t.coverage.indexOf(glyph));
+                if (index >= t.entryExits.len())
+                    return NONE;
+                auto exit = try$(t.entryExits[index].cdr);
+
+                auto next = try$(_next(i, lookup));
+                auto nextIndex = try$(t.coverage.indexOf(_slots[next].glyph));
+                if (nextIndex >= t.entryExits.len())
+                    return NONE;
+                auto entry = try$(t.entryExits[nextIndex].car);
+
+                auto &curr = _slots[i];
+                auto &other = _slots[next];
+                curr.advance = exit.x + curr.xOffset;
+                f64 d = entry.x + other.xOffset;
+                other.advance -= d;
+                other.xOffset -= d;
+                other.yOffset = curr.yOffset + exit.y - entry.y;
+                return i + 1;
+            },
+            [&](Ttf::MarkAttach const &t) -> Opt<usize> {
+                Opt<usize> base = NONE;
+                if (lookup.kind == Kind::MARK_TO_MARK) {
+                    base = _prev(i, lookup);
+                    if (base and _slots[*base].klass != Ttf::Gdef::MARK)
+                        return NONE;
+                } else {
+                    base = findBase();
+                }
+
+                auto b = try$(base);
+                auto offset = try$(t.offset(glyph, _slots[b].glyph));
+                _attach(i, b, offset);
+                return i + 1;
+            },
+            [&](Ttf::MarkLigatureAttach const &t) -> Opt<usize> {
+                auto b = try$(findBase());
+                auto const &mark = _slots[i];
+                auto const &lig = _slots[b];
+
+                Opt<usize> component = NONE;
+                if (mark.ligId != 0 and mark.ligId == lig.ligId and mark.ligComponent > 0)
+                    component = mark.ligComponent - 1;
+
+                auto offset = try$(t.offset(glyph, lig.glyph, component));
+                _attach(i, b, offset);
+                return i + 1;
+            },
+            [&](Ttf::ContextSubst const &t) -> Opt<usize> {
+                return _applyContext(t, lookup, i, true, depth);
+            },
+            [&](auto const &) -> Opt<usize> {
+                return NONE;
+            },
+        });
+
+        if (res)
+            return res;
+    }
+
+    return NONE;
+}
+
+void Shaper::position(ShapingPlan const &plan) {
+    for (auto lookupIndex : plan.gpos) {
+        auto const &lookup = _layout.gpos.lookups[lookupIndex];
+        usize i = 0;
+        while (i < _slots.len()) {
+            auto next = _applyAt(lookup, i, true, 0);
+            i = next ? max(*next, i + 1) : i + 1;
+        }
+    }
+
+    _resolveAttachments();
+}
+
+void Shaper::_resolveAttachments() {
+    // Attached marks don't take any room on their own.
+    for (auto &slot : _slots)
+        if (slot.attach)
+            slot.advance = 0;
+
+    f64 pen = 0;
+    Vec<f64> pens;
+    pens.ensure(_slots.len());
+    for (auto const &slot : _slots) {
+        pens.pushBack(pen);
+        pen += slot.advance;
+    }
+
+    // Bases always come before the marks attached to them, so they are
+    // resolved first.
+    for (usize i = 0; i < _slots.len(); i++) {
+        auto &slot = _slots[i];
+        if (not slot.attach)
+            continue;
+
+        auto base = *slot.attach;
+        slot.xOffset += _slots[base].xOffset + pens[base] - pens[i];
+        slot.yOffset += _slots[base].yOffset;
+    }
+}
+
+} // namespace Karm::Text
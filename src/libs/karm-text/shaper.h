@@ -0,0 +1,100 @@
+#pragma once
+
+#include "base.h"
+#include "ttf/layout.h"
+
+namespace Karm::Text {
+
+// The lookups to apply for a script and a set of features, in the order
+// of the lookup list.
+struct ShapingPlan {
+    u32 script;
+    FontFeatures features;
+    Vec<u16> gsub;
+    Vec<u16> gpos;
+    bool kern = false; //< Whether GPOS has a kern feature for the script
+
+    static ShapingPlan build(Ttf::Layout const &layout, u32 script, FontFeatures features);
+};
+
+// Applies the GSUB and GPOS lookups of a plan to a run of glyphs.
+//
+// NOTE: Only the lookups themselves are implemented, there is no script
+//       specific shaping (Arabic joining, Indic reordering, ...) and text
+//       is assumed to be left-to-right.
+struct Shaper {
+    static constexpr u16 MARK_ATTACHMENT_TYPE = 0xFF00;
+    static constexpr usize MAX_CONTEXT = 64;
+    static constexpr usize MAX_NESTING = 8;
+
+    struct Slot {
+        u16 glyph;
+        u32 cluster;
+        u16 klass = Ttf::Gdef::UNCLASSIFIED;
+        u16 markAttachClass = 0;
+
+        // Marks between or after the components of a ligature remember
+        // which component they belong to, starting at 1.
+        u16 ligId = 0;
+        u16 ligComponent = 0;
+
+        // In font units, the offsets of an attached mark are relative to
+        // the glyph it's attached to until resolved.
+        f64 advance = 0;
+        f64 xOffset = 0;
+        f64 yOffset = 0;
+        Opt<usize> attach = NONE;
+    };
+
+    Ttf::Layout const &_layout;
+    Vec<Slot> _slots;
+    u16 _nextLigId = 1;
+
+    Shaper(Ttf::Layout const &layout) : _layout(layout) {}
+
+    // Guess the OpenType script tag of a run from its first letter.
+    static u32 scriptOf(Slice<Rune> runes);
+
+    void load(Slice<Rune> runes, Slice<u16> glyphs);
+
+    void _setGlyph(Slot &slot, u16 glyph);
+
+    // MARK: Matching ----------------------------------------------------------
+
+    bool _ignored(Slot const &slot, Ttf::Lookup const &lookup) const;
+
+    Opt<usize> _next(usize i, Ttf::Lookup const &lookup) const;
+
+    Opt<usize> _prev(usize i, Ttf::Lookup const &lookup) const;
+
+    Opt<usize> _applyContext(Ttf::ContextSubst const &t, Ttf::Lookup const &lookup, usize i, bool gpos, usize depth);
+
+    Opt<usize> _applyAt(Ttf::Lookup const &lookup, usize i, bool gpos, usize depth);
+
+    // MARK: Substitution ------------------------------------------------------
+
+    void _ligate(usize i, Slice<usize> components, u16 glyph);
+
+    Opt<usize> _applyGsub(Ttf::Lookup const &lookup, usize i, usize depth);
+
+    // Apply the GSUB lookups of the plan, glyphs can be replaced, merged or
+    // split.
+    void substitute(ShapingPlan const &plan);
+
+    // MARK: Positioning -------------------------------------------------------
+
+    static void _adjust(Slot &slot, Ttf::Value const &value);
+
+    void _attach(usize mark, usize base, Cons<isize> offset);
+
+    Opt<usize> _applyGpos(Ttf::Lookup const &lookup, usize i, usize depth);
+
+    // Apply the GPOS lookups of the plan, advances must be set beforehand.
+    void position(ShapingPlan const &plan);
+
+    // Turn the offsets of attached glyphs into offsets from their own
+    // origin.
+    void _resolveAttachments();
+};
+
+} // namespace Karm::Text
@@ -0,0 +1,184 @@
+#include "shaping.h"
+
+namespace Karm::Text {
+
+ShapingCache &ShapingCache::global() {
+    static ShapingCache cache;
+    return cache;
+}
+
+Hash ShapingCache::_hash(Fontface const &fontface, FontFeatures features, Slice<Rune> runes) {
+    Hash h = hash(reinterpret_cast<usize>(&fontface));
+    h = (1000003 * h) ^ hash(features._bits);
+    h = (1000003 * h) ^ Hasher<Bytes>::hash({
+                            reinterpret_cast<Byte const *>(runes.buf()),
+                            runes.len() * sizeof(Rune),
+                        });
+    return h;
+}
+
+ShapedWord ShapingCache::_shape(Fontface &fontface, FontFeatures features, Slice<Rune> runes) {
+    ShapedWord word;
+    word.glyphs.ensure(runes.len());
+    fontface.shape(runes, features, word.glyphs);
+
+    // Glyphs sharing a cluster cover the runes up to the next cluster, their
+    // advance is split evenly between those runes so that the caret can be
+    // placed inside of a ligature.
+    word.pos.ensure(runes.len());
+    word.adv.ensure(runes.len());
+
+    f32 pen = 0;
+    usize rune = 0;
+    usize i = 0;
+    while (i < word.glyphs.len()) {
+        auto cluster = word.glyphs[i].cluster;
+        f32 width = 0;
+        usize j = i;
+        while (j < word.glyphs.len() and word.glyphs[j].cluster == cluster)
+            width += word.glyphs[j++].advance;
+
+        usize end = j < word.glyphs.len() ? word.glyphs[j].cluster : runes.len();
+        end = clamp(end, min(rune + 1, runes.len()), runes.len());
+
+        if (end > rune) {
+            f32 each = width / (end - rune);
+            for (; rune < end; rune++) {
+                word.pos.pushBack(pen);
+                word.adv.pushBack(each);
+                pen += each;
+            }
+        } else if (any(word.adv)) {
+            last(word.adv) += width;
+            pen += width;
+        }
+
+        i = j;
+    }
+
+    for (; rune < runes.len(); rune++) {
+        word.pos.pushBack(pen);
+        word.adv.pushBack(0);
+    }
+
+    word.width = pen;
+    return word;
+}
+
+ShapedWord const &ShapingCache::shape(Strong<Fontface> fontface, Slice<Rune> runes, FontFeatures features) {
+    auto h = _hash(*fontface, features, runes);
+
+    if (_slots.len()) {
+        usize mask = _slots.len() - 1;
+        for (usize i = h & mask; _slots[i]; i = (i + 1) & mask) {
+            auto &e = *_slots[i];
+            if (e.hash == h and
+                &*e.fontface == &*fontface and
+                e.features == features and
+                sub(e.runes) == runes) {
+                _stats.hits++;
+                e.used = _generation;
+                e.stamp = _stamp++;
+                return e.word;
+            }
+        }
+    }
+
+    _stats.misses++;
+    if (_stats.misses % GENERATION_LEN == 0)
+        _generation++;
+
+    if (_len >= CAPACITY)
+        _evict();
+
+    return _insert({
+                       .hash = h,
+                       .fontface = fontface,
+                       .features = features,
+                       .runes = runes,
+                       .word = _shape(*fontface, features, runes),
+                       .used = _generation,
+                       .stamp = _stamp++,
+                   })
+        .word;
+}
+
+ShapingCache::_Entry &ShapingCache::_insert(_Entry entry) {
+    // Keep the load factor under one half so probe sequences stay short.
+    if (_slots.len() < (_len + 1) * 2) {
+        auto old = std::move(_slots);
+        _slots = {};
+        _slots.resize(max(64uz, old.len() * 2));
+        _len = 0;
+        for (auto &slot : old)
+            if (slot)
+                _insert(slot.take());
+    }
+
+    usize mask = _slots.len() - 1;
+    usize i = entry.hash & mask;
+    while (_slots[i])
+        i = (i + 1) & mask;
+
+    _slots[i] = std::move(entry);
+    _len++;
+    return *_slots[i];
+}
+
+void ShapingCache::_evict() {
+    // Count the entries by the number of generations since their last use.
+    Array<usize, MAX_AGE + 1> byAge{};
+    for (auto &slot : _slots)
+        if (slot)
+            byAge[_age(*slot)]++;
+
+    // Keep the most recently used generations that fit in the budget.
+    usize maxAge = 0;
+    usize kept = 0;
+    while (maxAge <= MAX_AGE and kept + byAge[maxAge] <= KEEP) {
+        kept += byAge[maxAge];
+        maxAge++;
+    }
+
+    // And what's left of the budget from the next one, most recently used
+    // first. Otherwise a generation larger than the budget would empty
+    // the cache.
+    usize minStamp = _stamp;
+    if (maxAge <= MAX_AGE and kept < KEEP) {
+        Vec<usize> stamps;
+        stamps.ensure(byAge[maxAge]);
+        for (auto &slot : _slots)
+            if (slot and _age(*slot) == maxAge)
+                stamps.pushBack(slot->stamp);
+        sort(stamps);
+        minStamp = stamps[stamps.len() - (KEEP - kept)];
+    }
+
+    auto old = std::move(_slots);
+    _slots = {};
+    _slots.resize(old.len());
+    _len = 0;
+
+    for (auto &slot : old) {
+        if (not slot)
+            continue;
+
+        auto age = _age(*slot);
+        if (age < maxAge or (age == maxAge and slot->stamp >= minStamp))
+            _insert(slot.take());
+        else
+            _stats.evictions++;
+    }
+}
+
+void ShapingCache::clear() {
+    _slots.clear();
+    _len = 0;
+    _stamp = 0;
+}
+
+usize ShapingCache::_age(_Entry const &entry) const {
+    return min(_generation - entry.used, MAX_AGE);
+}
+
+} // namespace Karm::Text
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <karm-base/array.h>
+#include <karm-base/hash.h>
+#include <karm-base/vec.h>
+#include <karm-io/emit.h>
+
+#include "font.h"
+
+namespace Karm::Text {
+
+// Glyphs and advances of a word, in ems so that the same entry can be used
+// at any font size.
+struct ShapedWord {
+    Vec<ShapedGlyph> glyphs;
+    Vec<f32> pos; //< Caret position of each rune within the word
+    Vec<f32> adv; //< Advance of each rune, ligatures are split evenly
+    f32 width = 0;
+};
+
+// Cache of shaped words, keyed on the fontface, the features and the runes
+// of the word.
+//
+// NOTE: Entries are stamped with the generation in which they were last
+//       used, a new generation starting every GENERATION_LEN misses. When
+//       the cache is full, the least recently used generations are evicted
+//       as a whole. This approximates a LRU without having to maintain a
+//       list. The generation that doesn't fit as a whole is trimmed to its
+//       most recently used entries, so a full cache never ends up empty.
+struct ShapingCache {
+    static constexpr usize CAPACITY = 8192;
+    static constexpr usize GENERATION_LEN = CAPACITY / 4;
+    static constexpr usize MAX_AGE = 4;
+
+    // Number of entries kept at most after an eviction.
+    static constexpr usize KEEP = CAPACITY * 3 / 4;
+
+    struct Stats {
+        usize hits = 0;
+        usize misses = 0;
+        usize evictions = 0;
+        usize len = 0;
+        usize generation = 0;
+
+        f64 hitRate() const {
+            auto total = hits + misses;
+            if (total == 0)
+                return 0;
+            return hits / (f64)total;
+        }
+
+        void repr(Io::Emit &e) const {
+            e("(shaping-cache len:{} hits:{} misses:{} evictions:{} generation:{} hit-rate:{})", len, hits, misses, evictions, generation, hitRate());
+        }
+    };
+
+    struct _Entry {
+        Hash hash;
+        Strong<Fontface> fontface;
+        FontFeatures features;
+        Vec<Rune> runes;
+        ShapedWord word;
+        usize used;
+        usize stamp; //< Order of the last use, to trim a generation
+    };
+
+    Vec<Opt<_Entry>> _slots{};
+    usize _len = 0;
+    usize _generation = 0;
+    usize _stamp = 0;
+    Stats _stats{};
+
+    // The cache shared by every prose.
+    static ShapingCache &global();
+
+    static Hash _hash(Fontface const &fontface, FontFeatures features, Slice<Rune> runes);
+
+    static ShapedWord _shape(Fontface &fontface, FontFeatures features, Slice<Rune> runes);
+
+    // Shape a word, newlines are shaped as spaces.
+    //
+    // NOTE: The returned reference is only valid until the next call.
+    ShapedWord const &shape(Strong<Fontface> fontface, Slice<Rune> runes, FontFeatures features = FontFeatures::defaults());
+
+    _Entry &_insert(_Entry entry);
+
+    usize _age(_Entry const &entry) const;
+
+    void _evict();
+
+    void clear();
+
+    Stats stats() const {
+        auto stats = _stats;
+        stats.len = _len;
+        stats.generation = _generation;
+        return stats;
+    }
+};
+
+} // namespace Karm::Text
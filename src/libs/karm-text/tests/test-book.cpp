@@ -1,5 +1,6 @@
 #include <karm-test/macros.h>
 #include <karm-text/book.h>
+#include <karm-text/family.h>
 
 namespace Karm::Text::Tests {
 
@@ -14,4 +15,36 @@ test$("karm-text-common-family") {
     return Ok();
 }
 
+test$("karm-text-font-coverage") {
+    FontCoverage coverage;
+    coverage.add(0x20, 0x7e);
+    coverage.add(0x1f600, 0x1f64f);
+
+    expect$(coverage.covers('A'));
+    expect$(coverage.covers(0xff));
+    expect$(not coverage.covers(0x4e00));
+    expect$(coverage.covers(0x1f602));
+    expect$(not coverage.covers(0x1f900));
+
+    // Past the tracked planes, everything is covered.
+    expect$(coverage.covers(0x20000));
+
+    return Ok();
+}
+
+test$("karm-text-family-coverage") {
+    FontCoverage latin;
+    latin.add(0x20, 0x7e);
+
+    Vec<FontFamily::Member> members;
+    members.pushBack({.face = Fontface::fallback(), .ranges = NONE, .coverage = FontCoverage{}});
+    members.pushBack({.face = Fontface::fallback(), .ranges = NONE, .coverage = latin});
+    FontFamily family{std::move(members)};
+
+    // The first member doesn't cover anything, it is never asked.
+    expectEq$(family.glyph('A').font, (u16)1);
+
+    return Ok();
+}
+
 } // namespace Karm::Text::Tests
@@ -0,0 +1,272 @@
+#include <karm-base/array.h>
+#include <karm-io/aton.h>
+#include <karm-logger/logger.h>
+#include <karm-test/macros.h>
+#include <karm-text/breaks.h>
+#include <karm-text/prose.h>
+
+namespace Karm::Text::Tests {
+
+// Cases are written in the notation of the Unicode test files
+// (GraphemeBreakTest.txt, WordBreakTest.txt and LineBreakTest.txt), where
+// "÷" is a boundary and "×" is not.
+struct _Case {
+    Vec<Rune> runes;
+    Vec<usize> breaks;
+};
+
+static _Case _parseCase(Str str) {
+    _Case res;
+    Io::SScan s{str};
+    while (not s.ended()) {
+        if (s.skip(' '))
+            continue;
+
+        if (s.skip("÷")) {
+            if (res.runes.len())
+                res.breaks.pushBack(res.runes.len());
+            continue;
+        }
+
+        if (s.skip("×"))
+            continue;
+
+        auto rune = Io::atoi(s, {.base = 16});
+        if (not rune)
+            panic("invalid test case");
+        res.runes.pushBack(rune.unwrap());
+    }
+    return res;
+}
+
+static Vec<usize> _lineBreaks(Slice<Rune> runes) {
+    Vec<usize> res;
+    for (auto b : iterLineBreaks(runes))
+        res.pushBack(b.pos);
+    return res;
+}
+
+static Vec<usize> _graphemeBreaks(Slice<Rune> runes) {
+    Vec<usize> res;
+    for (auto b : iterGraphemeBreaks(runes))
+        res.pushBack(b);
+    return res;
+}
+
+static Vec<usize> _wordBreaks(Slice<Rune> runes) {
+    Vec<usize> res;
+    for (auto b : iterWordBreaks(runes))
+        res.pushBack(b);
+    return res;
+}
+
+// MARK: Conformance -----------------------------------------------------------
+
+// Every line of the UCD test files, generated by
+// `defs/gen-unicode-props.py --tests`.
+#if __has_include("../defs/unicode-break-tests.inc")
+#    define KARM_TEXT_BREAK_TESTS
+#    include "../defs/unicode-break-tests.inc"
+#endif
+
+[[maybe_unused]] static bool _noTailoring(Slice<Rune>) {
+    return false;
+}
+
+// Tailorings the line breaker doesn't follow, cases exercising them are
+// skipped:
+//
+//  - LB25: LineBreakTest.txt applies the regular expression of UAX #14,
+//    section 8.2, example 7 rather than the default pairs implemented by
+//    LineBreaker. They disagree on CL or CP followed by PO or PR, PO or PR
+//    followed by OP, and IS or SY followed by NU outside of a number.
+[[maybe_unused]] static bool _lineTailoring(Slice<Rune> runes) {
+    using enum LineBreak;
+
+    auto prev = SP;
+    bool number = false;
+    for (auto rune : runes) {
+        auto curr = UnicodeProps::of(rune).lineBreak();
+
+        // LB9: Combining marks take the class of their base
+        if ((curr == CM or curr == ZWJ) and prev != SP and prev != ZW and
+            prev != BK and prev != CR and prev != LF and prev != NL)
+            continue;
+
+        if ((prev == CL or prev == CP) and (curr == PO or curr == PR))
+            return true;
+        if ((prev == PO or prev == PR) and curr == OP)
+            return true;
+        if ((prev == IS or prev == SY) and curr == NU and not number)
+            return true;
+
+        number = curr == NU or (number and (curr == IS or curr == SY));
+        prev = curr;
+    }
+    return false;
+}
+
+[[maybe_unused]] static Res<> _conformance(Str name, Slice<Str> cases, Vec<usize> (*breaks)(Slice<Rune>), bool (*tailored)(Slice<Rune>)) {
+    usize failed = 0;
+    usize skipped = 0;
+    for (auto c : cases) {
+        auto [runes, expected] = _parseCase(c);
+        if (tailored(runes)) {
+            skipped++;
+            continue;
+        }
+
+        if (breaks(runes) != expected) {
+            logError("{}: {}", name, c);
+            failed++;
+        }
+    }
+
+    if (skipped)
+        logInfo("{}: skipped {} of {} cases", name, skipped, cases.len());
+
+    if (failed)
+        return Error::other("breaks do not match the unicode test file");
+
+    return Ok();
+}
+
+test$("karm-text-breaks-ucd-grapheme") {
+#ifdef KARM_TEXT_BREAK_TESTS
+    return _conformance("GraphemeBreakTest.txt", GRAPHEME_BREAK_TESTS, _graphemeBreaks, _noTailoring);
+#else
+    logInfo("Skipping test, run defs/gen-unicode-props.py --tests");
+    return Error::skipped();
+#endif
+}
+
+test$("karm-text-breaks-ucd-word") {
+#ifdef KARM_TEXT_BREAK_TESTS
+    return _conformance("WordBreakTest.txt", WORD_BREAK_TESTS, _wordBreaks, _noTailoring);
+#else
+    logInfo("Skipping test, run defs/gen-unicode-props.py --tests");
+    return Error::skipped();
+#endif
+}
+
+test$("karm-text-breaks-ucd-line") {
+#ifdef KARM_TEXT_BREAK_TESTS
+    return _conformance("LineBreakTest.txt", LINE_BREAK_TESTS, _lineBreaks, _lineTailoring);
+#else
+    logInfo("Skipping test, run defs/gen-unicode-props.py --tests");
+    return Error::skipped();
+#endif
+}
+
+// MARK: Cases -----------------------------------------------------------------
+
+test$("karm-text-breaks-grapheme") {
+    Str cases[] = {
+        "÷ 0020 ÷ 0020 ÷",
+        "÷ 000D × 000A ÷",
+        "÷ 000A ÷ 0308 ÷",
+        "÷ 0061 × 0308 ÷ 0062 ÷",
+        "÷ 0600 × 0020 ÷",
+        "÷ 0915 × 0903 ÷",
+        "÷ 1100 × 1161 × 11A8 ÷",
+        "÷ AC00 × 11A8 ÷ 1100 ÷",
+        "÷ 1F1E6 × 1F1E7 ÷ 1F1E8 ÷",
+        "÷ 0061 ÷ 1F1E6 × 1F1E7 ÷ 1F1E8 × 1F1E9 ÷ 0062 ÷",
+        "÷ 1F476 × 1F3FF ÷ 1F476 ÷",
+        "÷ 1F6D1 × 200D × 1F6D1 ÷",
+        "÷ 0061 × 200D ÷ 1F6D1 ÷",
+    };
+
+    for (auto c : cases) {
+        auto [runes, breaks] = _parseCase(c);
+        expectEq$(_graphemeBreaks(runes), breaks);
+    }
+
+    return Ok();
+}
+
+test$("karm-text-breaks-word") {
+    Str cases[] = {
+        "÷ 0068 × 0065 × 006C × 006C × 006F ÷ 0020 ÷ 0077 × 006F × 0072 × 006C × 0064 ÷",
+        "÷ 0063 × 0061 × 006E × 0027 × 0074 ÷",
+        "÷ 0061 ÷ 002E ÷",
+        "÷ 0033 × 002E × 0031 × 0034 ÷",
+        "÷ 0031 × 002C × 0030 × 0030 × 0030 ÷",
+        "÷ 0061 × 0308 × 0062 ÷",
+        "÷ 0061 × 005F × 0062 ÷",
+        "÷ 0020 × 0020 ÷ 0061 ÷",
+        "÷ 000D × 000A ÷ 0061 ÷",
+        "÷ 30A2 × 30A2 ÷ 3042 ÷",
+        "÷ 1F1E6 × 1F1E7 ÷ 1F1E8 ÷",
+        "÷ 1F6D1 × 200D × 1F6D1 ÷",
+    };
+
+    for (auto c : cases) {
+        auto [runes, breaks] = _parseCase(c);
+        expectEq$(_wordBreaks(runes), breaks);
+    }
+
+    return Ok();
+}
+
+test$("karm-text-breaks-line") {
+    Str cases[] = {
+        "× 0066 × 006F × 006F × 0020 ÷ 0062 × 0061 × 0072 ÷",
+        "× 0061 × 0020 × 0020 ÷ 0062 ÷",
+        "× 0061 × 000A ÷ 0062 ÷",
+        "× 0061 × 000D × 000A ÷ 0062 ÷",
+        "× 0061 × 002D ÷ 0062 ÷",
+        "× 0061 × 00A0 × 0062 ÷",
+        "× 0028 × 0061 × 0029 ÷",
+        "× 0024 × 0031 × 0030 ÷",
+        "× 0031 × 002E × 0035 ÷",
+        "× 200B ÷ 0061 ÷",
+        "× 0061 × 0301 ÷ 4E00 ÷",
+        "× 4E00 ÷ 4E8C ÷ 4E09 ÷",
+        "× 4E00 × 3002 ÷ 4E8C ÷",
+        "× 1100 × 1161 × 11A8 ÷",
+        "× 1F1E6 × 1F1E7 ÷ 1F1E8 ÷",
+        "× 261D × 1F3FB ÷",
+    };
+
+    for (auto c : cases) {
+        auto [runes, breaks] = _parseCase(c);
+        expectEq$(_lineBreaks(runes), breaks);
+    }
+
+    return Ok();
+}
+
+test$("karm-text-breaks-line-mandatory") {
+    auto [runes, _] = _parseCase("× 0061 × 0020 ÷ 0062 × 000A ÷ 0063 ÷");
+
+    Vec<Break> kinds;
+    for (auto b : iterLineBreaks(runes))
+        kinds.pushBack(b.kind);
+
+    expectEq$(kinds.len(), 3uz);
+    expectEq$(kinds[0], Break::OPPORTUNITY);
+    expectEq$(kinds[1], Break::MANDATORY);
+    expectEq$(kinds[2], Break::MANDATORY);
+
+    return Ok();
+}
+
+test$("karm-text-breaks-prose-cjk") {
+    Prose prose{
+        {
+            .font = Font::fallback(),
+            .multiline = true,
+        },
+        "一二三四五六"
+    };
+
+    // VGA glyphs are 8px wide, every ideograph is a break opportunity.
+    prose.layout(24);
+    expectEq$(prose._blocks.len(), 6uz);
+    expectEq$(prose._lines.len(), 2uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
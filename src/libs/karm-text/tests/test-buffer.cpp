@@ -0,0 +1,82 @@
+#include <karm-test/macros.h>
+#include <karm-text/buffer.h>
+
+namespace Karm::Text::Tests {
+
+test$("karm-text-buffer-edits") {
+    Buffer buf{"hello world"};
+
+    buf.insert(5, Vec<Rune>{',', ' ', 'd', 'e', 'a', 'r'});
+    expectEq$(buf.string(), "hello, dear world"s);
+
+    buf.remove({5, 6});
+    expectEq$(buf.string(), "hello world"s);
+
+    buf.insert(0, '>');
+    buf.insert(buf.len(), '<');
+    expectEq$(buf.string(), ">hello world<"s);
+    expectEq$(buf.at(1), (Rune)'h');
+    expectEq$(buf.len(), 13uz);
+
+    return Ok();
+}
+
+test$("karm-text-buffer-typing-extends-piece") {
+    Buffer buf{"abcdef"};
+
+    for (auto r : Vec<Rune>{'x', 'y', 'z'})
+        buf.insert(3 + buf.len() - 6, r);
+
+    expectEq$(buf.string(), "abcxyzdef"s);
+
+    // One piece before, one for the typed text, one after.
+    expect$(buf._root);
+    usize pieces = 0;
+    buf.iterChunks({0, buf.len()}, [&](Slice<Rune>) {
+        pieces++;
+    });
+    expectEq$(pieces, 3uz);
+
+    return Ok();
+}
+
+test$("karm-text-buffer-lines") {
+    Buffer buf{"foo\nbar\n\nbaz"};
+
+    expectEq$(buf.lines(), 4uz);
+    expectEq$(buf.lineStart(1), 4uz);
+    expectEq$(buf.lineStart(2), 8uz);
+    expectEq$(buf.lineStart(3), 9uz);
+    expectEq$(buf.lineEnd(0), 3uz);
+    expectEq$(buf.lineEnd(3), 12uz);
+    expectEq$(buf.lineAt(0), 0uz);
+    expectEq$(buf.lineAt(3), 0uz);
+    expectEq$(buf.lineAt(4), 1uz);
+    expectEq$(buf.lineAt(12), 3uz);
+
+    buf.insert(5, Vec<Rune>{'\n', 'q'});
+    expectEq$(buf.lines(), 5uz);
+    expectEq$(buf.lineStart(2), 6uz);
+    expectEq$(buf.locAt(7).line, 2uz);
+    expectEq$(buf.locAt(7).column, 1uz);
+    expectEq$(buf.posAt({2, 1}), 7uz);
+
+    return Ok();
+}
+
+test$("karm-text-buffer-snapshots") {
+    Buffer buf{"one two"};
+    auto before = buf.snapshot();
+
+    buf.remove({3, 4});
+    buf.insert(3, Vec<Rune>{'!'});
+    expectEq$(buf.string(), "one!"s);
+
+    buf.restore(before);
+    expectEq$(buf.string(), "one two"s);
+    expectEq$(buf.lines(), 1uz);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
@@ -21,4 +21,54 @@ test$("karm-text-model-moves") {
     return Ok();
 }
 
+test$("karm-text-model-undo") {
+    Model mdl{"foo\nbar"};
+
+    mdl.moveEnd();
+    mdl.insert('!');
+    mdl.moveUp();
+    mdl.backspace();
+    expectEq$(mdl.string(), "fo\nbar!"s);
+
+    mdl.undo();
+    expectEq$(mdl.string(), "foo\nbar!"s);
+
+    mdl.undo();
+    expectEq$(mdl.string(), "foo\nbar"s);
+
+    mdl.redo();
+    expectEq$(mdl.string(), "foo\nbar!"s);
+    expectEq$(mdl.len(), 8uz);
+
+    return Ok();
+}
+
+test$("karm-text-model-change") {
+    Model mdl{"foo bar"};
+    (void)mdl.takeChange();
+
+    mdl.moveEnd();
+    expectNot$(mdl.takeChange().has());
+
+    mdl.moveStart();
+    mdl.moveNextWord();
+    mdl.insert('!');
+    mdl.moveEnd();
+    mdl.backspace();
+    expectEq$(mdl.string(), "foo! ba"s);
+
+    auto change = mdl.takeChange();
+    expect$(change.has());
+    expectEq$(change->prefix, 3uz);
+    expectEq$(change->suffix, 0uz);
+
+    mdl.undo();
+    change = mdl.takeChange();
+    expect$(change.has());
+    expectEq$(change->prefix, 7uz);
+    expectEq$(change->suffix, 0uz);
+
+    return Ok();
+}
+
 } // namespace Karm::Text::Tests
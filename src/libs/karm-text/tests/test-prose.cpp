@@ -0,0 +1,110 @@
+#include <karm-test/macros.h>
+#include <karm-text/prose.h>
+
+namespace Karm::Text::Tests {
+
+static ProseStyle _style() {
+    return {
+        .font = Font::fallback(),
+        .multiline = true,
+    };
+}
+
+static bool _sameLines(Prose const &a, Prose const &b) {
+    if (a._lines.len() != b._lines.len())
+        return false;
+
+    for (usize i = 0; i < a._lines.len(); i++) {
+        auto const &la = a._lines[i];
+        auto const &lb = b._lines[i];
+        if (la.runeRange != lb.runeRange or
+            la.blockRange != lb.blockRange or
+            la.width != lb.width or
+            la.baseline != lb.baseline)
+            return false;
+    }
+
+    return true;
+}
+
+test$("karm-text-prose-wrap") {
+    Prose prose{_style(), "foo bar baz\nqux"};
+
+    // VGA glyphs are 8px wide, "foo " is 32px.
+    prose.layout(64);
+    expectEq$(prose._lines.len(), 3uz);
+    expectEq$(prose._lines[0].blockRange, (urange{0, 2}));
+    expectEq$(prose._lines[1].blockRange, (urange{2, 1}));
+    expectEq$(prose._lines[2].blockRange, (urange{3, 1}));
+
+    prose.layout(1000);
+    expectEq$(prose._lines.len(), 2uz);
+
+    return Ok();
+}
+
+test$("karm-text-prose-content-width") {
+    Prose prose{_style(), "foo barbaz\nqux"};
+
+    expectEq$(prose.minContentWidth(), 56.0);
+    expectEq$(prose.maxContentWidth(), 88.0);
+
+    return Ok();
+}
+
+test$("karm-text-prose-incremental-append") {
+    Prose prose{_style(), "the quick brown fox "};
+    prose.layout(80);
+    prose.append(Str{"jumps over\nthe lazy dog"});
+    prose.layout(80);
+
+    Prose fresh{_style(), "the quick brown fox jumps over\nthe lazy dog"};
+    fresh.layout(80);
+
+    expect$(_sameLines(prose, fresh));
+
+    return Ok();
+}
+
+test$("karm-text-prose-incremental-edit") {
+    Prose prose{_style(), "the quick brown fox jumps over the lazy dog"};
+    prose.layout(96);
+
+    Prose fresh{_style(), "the quick red fox jumps over the lazy dog"};
+    fresh.layout(96);
+
+    Prose edited{_style(), "the quick brown fox jumps over the lazy dog"};
+    edited.layout(96);
+    edited.assign(fresh._runes);
+    edited.layout(96);
+
+    expect$(_sameLines(edited, fresh));
+    expectEq$(edited._runes.len(), fresh._runes.len());
+
+    return Ok();
+}
+
+test$("karm-text-prose-incremental-replace") {
+    Prose prose{_style(), "the quick brown fox jumps over the lazy dog"};
+    prose.layout(96);
+    Rune red[] = {'r', 'e', 'd'};
+    prose.replace({10, 5}, Slice<Rune>{red, 3});
+    prose.layout(96);
+
+    Prose fresh{_style(), "the quick red fox jumps over the lazy dog"};
+    fresh.layout(96);
+
+    expect$(_sameLines(prose, fresh));
+    expectEq$(prose._blocks.len(), fresh._blocks.len());
+    for (usize i = 0; i < fresh._blocks.len(); i++) {
+        expectEq$(prose._blocks[i].runeRange, fresh._blocks[i].runeRange);
+        expectEq$(prose._blocks[i].cellRange, fresh._blocks[i].cellRange);
+    }
+    for (usize i = 0; i < fresh._cells.len(); i++)
+        expectEq$(prose._cells[i].runeRange, fresh._cells[i].runeRange);
+    expect$(prose._runes == fresh._runes);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
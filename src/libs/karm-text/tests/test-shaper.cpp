@@ -0,0 +1,167 @@
+#include <karm-test/macros.h>
+#include <karm-text/prose.h>
+#include <karm-text/shaper.h>
+
+namespace Karm::Text::Tests {
+
+static Ttf::Coverage _coverage(Slice<u16> glyphs) {
+    Ttf::Coverage res;
+    for (usize i = 0; i < glyphs.len(); i++)
+        res._ranges.pushBack({glyphs[i], glyphs[i], (u16)i});
+    return res;
+}
+
+test$("karm-text-shaper-coverage") {
+    u8 format1[] = {
+        0x00, 0x01, 0x00, 0x04,
+        0x00, 0x05, 0x00, 0x06, 0x00, 0x07, 0x00, 0x0A
+    };
+    auto c1 = Ttf::Coverage::decode({format1, sizeof(format1)});
+    expectEq$(c1._ranges.len(), 2uz);
+    expectEq$(c1.indexOf(5), Opt<usize>{0});
+    expectEq$(c1.indexOf(7), Opt<usize>{2});
+    expectEq$(c1.indexOf(10), Opt<usize>{3});
+    expect$(not c1.has(8));
+    expect$(not c1.has(4));
+
+    u8 format2[] = {
+        0x00, 0x02, 0x00, 0x01,
+        0x00, 0x14, 0x00, 0x19, 0x00, 0x04
+    };
+    auto c2 = Ttf::Coverage::decode({format2, sizeof(format2)});
+    expectEq$(c2.indexOf(22), Opt<usize>{6});
+    expect$(not c2.has(26));
+
+    return Ok();
+}
+
+test$("karm-text-shaper-classes") {
+    u8 format2[] = {
+        0x00, 0x02, 0x00, 0x02,
+        0x00, 0x0A, 0x00, 0x0F, 0x00, 0x01,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x03
+    };
+    auto classes = Ttf::Classes::decode({format2, sizeof(format2)});
+    expectEq$(classes.classOf(12), 1);
+    expectEq$(classes.classOf(32), 3);
+    expectEq$(classes.classOf(16), 0);
+    expectEq$(classes.classOf(0), 0);
+
+    return Ok();
+}
+
+test$("karm-text-shaper-features") {
+    auto features = FontFeatures::defaults();
+    expect$(features.has(FontFeature::LIGA));
+    expect$(features.has(FontFeature::KERN));
+    expect$(not features.has(FontFeature::SMCP));
+    expect$(features.has("liga"));
+
+    features = features.without(FontFeature::LIGA).with(FontFeature::SMCP);
+    expect$(not features.has(FontFeature::LIGA));
+    expect$(features.has(FontFeature::SMCP));
+
+    return Ok();
+}
+
+test$("karm-text-shaper-ligature") {
+    // f + i -> fi, skipping over the mark between them.
+    Array<u16, 1> first = {1};
+    Ttf::LigatureSubst liga{.coverage = _coverage(first), .sets = {}};
+    Vec<Ttf::Ligature> set;
+    set.pushBack({.glyph = 100, .components = {2}});
+    liga.sets.pushBack(std::move(set));
+
+    Ttf::Lookup lookup{
+        .kind = Ttf::Lookup::Kind::LIGATURE_SUBST,
+        .flags = Ttf::LookupTable::IGNORE_MARKS,
+    };
+    lookup.starts.add(1);
+    lookup.subtables.pushBack(std::move(liga));
+
+    Ttf::Layout layout;
+    layout.gsub.lookups.pushBack(std::move(lookup));
+
+    ShapingPlan plan{
+        .script = Ttf::tagOf("latn"),
+        .features = FontFeatures::defaults(),
+        .gsub = {0},
+        .gpos = {},
+    };
+
+    Array<Rune, 4> runes = {'f', 0x301, 'i', 'x'};
+    Array<u16, 4> glyphs = {1, 50, 2, 3};
+
+    Shaper shaper{layout};
+    shaper.load(runes, glyphs);
+    shaper.substitute(plan);
+
+    expectEq$(shaper._slots.len(), 3uz);
+    expectEq$(shaper._slots[0].glyph, 100);
+    expectEq$(shaper._slots[0].cluster, 0u);
+    expectEq$(shaper._slots[1].glyph, 50);
+    expectEq$(shaper._slots[1].ligComponent, 1);
+    expectEq$(shaper._slots[2].glyph, 3);
+    expectEq$(shaper._slots[2].cluster, 3u);
+
+    return Ok();
+}
+
+test$("karm-text-shaper-mark-to-base") {
+    Array<u16, 1> marks = {20};
+    Array<u16, 1> bases = {10};
+    Ttf::MarkAttach attach{
+        .markCoverage = _coverage(marks),
+        .baseCoverage = _coverage(bases),
+        .classCount = 1,
+        .marks = {},
+        .anchors = {},
+    };
+    attach.marks.pushBack({.klass = 0, .anchor = {0, 0}});
+    attach.anchors.pushBack(Ttf::Anchor{300, 500});
+
+    Ttf::Lookup lookup{.kind = Ttf::Lookup::Kind::MARK_TO_BASE};
+    lookup.starts.add(20);
+    lookup.subtables.pushBack(std::move(attach));
+
+    Ttf::Layout layout;
+    layout.gpos.lookups.pushBack(std::move(lookup));
+
+    ShapingPlan plan{
+        .script = Ttf::tagOf("latn"),
+        .features = FontFeatures::defaults(),
+        .gsub = {},
+        .gpos = {0},
+    };
+
+    Array<Rune, 2> runes = {'a', 0x301};
+    Array<u16, 2> glyphs = {10, 20};
+
+    Shaper shaper{layout};
+    shaper.load(runes, glyphs);
+    for (auto &slot : shaper._slots)
+        slot.advance = 500;
+    shaper.position(plan);
+
+    // The mark takes no room and is drawn over the base.
+    expectEq$(shaper._slots[1].advance, 0.0);
+    expectEq$(shaper._slots[1].xOffset, -200.0);
+    expectEq$(shaper._slots[1].yOffset, 500.0);
+
+    return Ok();
+}
+
+test$("karm-text-shaper-prose-glyphs") {
+    Prose prose{{.font = Font::fallback()}, "hello world"};
+    prose.layout(200);
+
+    // Fonts without layout tables still map runes one to one.
+    expectEq$(prose._glyphs.len(), 11uz);
+    expectEq$(prose._blocks[1].glyphs().len(), 5uz);
+    expectEq$(prose._glyphs[6].cell, 6uz);
+    expectEq$(prose._glyphs[6].pos.x, 0.0);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
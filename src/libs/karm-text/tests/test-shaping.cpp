@@ -0,0 +1,90 @@
+#include <karm-test/macros.h>
+#include <karm-text/shaping.h>
+
+namespace Karm::Text::Tests {
+
+test$("karm-text-shaping-cache-hits") {
+    ShapingCache cache;
+    auto face = Fontface::fallback();
+    Vec<Rune> hello = {'h', 'e', 'l', 'l', 'o', ' '};
+    Vec<Rune> world = {'w', 'o', 'r', 'l', 'd', '\n'};
+
+    auto width = cache.shape(face, hello).width;
+    expectEq$(cache.shape(face, hello).width, width);
+    expectEq$(cache.shape(face, world).glyphs.len(), 6uz);
+
+    auto stats = cache.stats();
+    expectEq$(stats.hits, 1uz);
+    expectEq$(stats.misses, 2uz);
+    expectEq$(stats.len, 2uz);
+
+    // Another fontface doesn't share the entries.
+    cache.shape(Fontface::fallback(), hello);
+    expectEq$(cache.stats().misses, 3uz);
+
+    return Ok();
+}
+
+test$("karm-text-shaping-cache-eviction") {
+    ShapingCache cache;
+    auto face = Fontface::fallback();
+    Vec<Rune> hot = {'h', 'o', 't'};
+
+    for (u32 i = 0; i < ShapingCache::CAPACITY * 2; i++) {
+        Vec<Rune> word = {
+            (Rune)('a' + i % 26),
+            (Rune)('a' + i / 26 % 26),
+            (Rune)('a' + i / 676 % 26),
+        };
+        cache.shape(face, word);
+        cache.shape(face, hot);
+    }
+
+    auto stats = cache.stats();
+    expect$(stats.len <= ShapingCache::CAPACITY);
+    expect$(stats.evictions > 0);
+
+    // The word used all along survived every eviction.
+    auto misses = stats.misses;
+    cache.shape(face, hot);
+    expectEq$(cache.stats().misses, misses);
+
+    return Ok();
+}
+
+static Vec<Rune> _word(u32 i) {
+    return {
+        (Rune)('a' + i % 26),
+        (Rune)('a' + i / 26 % 26),
+        (Rune)('a' + i / 676 % 26),
+    };
+}
+
+test$("karm-text-shaping-cache-large-generation") {
+    ShapingCache cache;
+    auto face = Fontface::fallback();
+
+    // Every entry is used again in the same generation, which doesn't fit
+    // in what's kept after an eviction.
+    u32 n = ShapingCache::CAPACITY - 1;
+    for (u32 i = 0; i < n; i++)
+        cache.shape(face, _word(i));
+    for (u32 i = 0; i < n; i++)
+        cache.shape(face, _word(i));
+    cache.shape(face, _word(n));
+    cache.shape(face, _word(n + 1));
+
+    auto stats = cache.stats();
+    expect$(stats.evictions > 0);
+    expectEq$(stats.len, ShapingCache::KEEP + 1);
+
+    // The most recently used words survived it.
+    auto misses = stats.misses;
+    for (u32 i = n - 100; i < n + 2; i++)
+        cache.shape(face, _word(i));
+    expectEq$(cache.stats().misses, misses);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
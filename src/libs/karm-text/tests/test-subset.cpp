@@ -0,0 +1,77 @@
+#include <karm-logger/logger.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-test/macros.h>
+#include <karm-text/ttf/subset.h>
+
+namespace Karm::Text::Tests {
+
+static Vec<u16> _components(Ttf::Subset const &subset, u16 id) {
+    Vec<u16> res;
+    Ttf::Subset::_iterComponents(subset._glyphData(id), [&](usize, u16 component) {
+        res.pushBack(component);
+    });
+    return res;
+}
+
+test$("karm-text-ttf-subset") {
+    // Droid Sans draws accented letters as composites of the letter and
+    // the accent, and uses short offsets in its 'loca'.
+    auto file = Sys::File::open("bundle://fonts-droid-sans/fonts/DroidSans.ttf"_url);
+    if (not file) {
+        logInfo("Skipping test, font not bundled: {}", file.none());
+        return Error::skipped();
+    }
+    auto map = try$(Sys::mmap().map(file.unwrap()));
+    auto font = try$(Ttf::Parser::init(map.bytes()));
+
+    Ttf::Subset subset{font};
+    expectEq$(subset.add(font.glyph('B')), 1);
+    expectEq$(subset.add(font.glyph(0xC1)), 2); // Á
+    expectEq$(subset.add(font.glyph('B')), 1);
+
+    Io::BufferWriter buf;
+    try$(subset.write(buf));
+
+    // The components of Á come after the glyphs that were added.
+    expectEq$(subset.len(), 5uz);
+    auto a = subset._ids[font.glyph('A').index];
+    auto acute = subset._ids[font.glyph(0xB4).index];
+    expectEq$(a, 3);
+    expectEq$(acute, 4);
+
+    auto out = try$(Ttf::Parser::init(buf.bytes()));
+    expectEq$(out.numGlyphs(), 5uz);
+    expectEq$(out._head.locaFormat(), 1);
+
+    Ttf::Subset reread{out};
+    expectEq$(_components(reread, 2), (Vec<u16>{a, acute}));
+
+    for (u16 id = 0; id < subset.len(); id++) {
+        // Glyphs are copied as they are, padded to four bytes, except for
+        // the components, which are renumbered.
+        auto original = subset._glyphData(subset._glyphs[id]);
+        auto copied = reread._glyphData(id);
+        expectEq$(copied.len(), alignUp(original.len(), 4));
+        if (id != 2)
+            expect$(sub(copied, 0, original.len()) == original);
+
+        auto before = font._hmtx.metrics(subset._glyphs[id], font._hhea);
+        auto after = out._hmtx.metrics(id, out._hhea);
+        expectEq$(after.advanceWidth, before.advanceWidth);
+        expectEq$(after.lsb, before.lsb);
+    }
+
+    // Runes map to the glyphs of the subset, including the components.
+    expectEq$(out.glyph('B'), Glyph(1));
+    expectEq$(out.glyph(0xC1), Glyph(2));
+    expectEq$(out.glyph('A'), Glyph(3));
+    expectEq$(out.glyph('C'), Glyph(0));
+
+    // The checksum of the whole font adds up to the magic number.
+    expectEq$(Ttf::Subset::_checksum(buf.bytes()), Ttf::Subset::CHECKSUM_MAGIC);
+
+    return Ok();
+}
+
+} // namespace Karm::Text::Tests
@@ -11,6 +11,10 @@ TtfFontface::TtfFontface(Sys::Mmap &&mmap, Ttf::Parser parser)
     : _mmap(std::move(mmap)),
       _parser(std::move(parser)) {
     _unitPerEm = _parser.unitPerEm();
+
+    _advances.resize(_parser.numGlyphs());
+    for (usize i = 0; i < _advances.len(); i++)
+        _advances[i] = _parser._hmtx.metrics(i, _parser._hhea).advanceWidth / _unitPerEm;
 }
 
 FontMetrics TtfFontface::metrics() const {
@@ -48,36 +52,104 @@ FontAttrs TtfFontface::attrs() const {
     return attrs;
 }
 
+void TtfFontface::_loadDirectGlyphs() {
+    _directGlyphs.resize(DIRECT_RUNES);
+    for (usize r = 0; r < DIRECT_RUNES; r++)
+        _directGlyphs[r] = _parser.glyph(r);
+}
+
 Glyph TtfFontface::glyph(Rune rune) {
-    auto glyph = _cachedEntries.tryGet(rune);
-    if (glyph.has())
-        return glyph.unwrap();
-    auto g = _parser.glyph(rune);
-    _cachedEntries.put(rune, g);
-    return g;
+    if (rune < DIRECT_RUNES) {
+        if (isEmpty(_directGlyphs))
+            _loadDirectGlyphs();
+        return _directGlyphs[rune];
+    }
+
+    return _parser.glyph(rune);
 }
 
 f64 TtfFontface::advance(Glyph glyph) {
-    auto advance = _cachedAdvances.tryGet(glyph);
-    if (advance.has())
-        return advance.unwrap();
-    auto a = _parser.glyphMetrics(glyph).advance / _unitPerEm;
-    _cachedAdvances.put(glyph, a);
-    return a;
+    if (glyph.index < _advances.len())
+        return _advances[glyph.index];
+    return _parser.glyphMetrics(glyph).advance / _unitPerEm;
 }
 
-f64 TtfFontface::kern(Glyph prev, Glyph curr) {
-    auto kern = _cachedKerns.tryGet({prev, curr});
-    if (kern.has())
-        return kern.unwrap();
+Ttf::Kerning const &TtfFontface::_ensureKerning() {
+    if (not _kerning)
+        _kerning = Ttf::Kerning::load(_parser._gpos, _parser._kern, _parser.numGlyphs());
+    return *_kerning;
+}
 
-    auto k = _parser.glyphKern(prev, curr) / _unitPerEm;
-    _cachedKerns.put({prev, curr}, k);
-    return k;
+f64 TtfFontface::kern(Glyph prev, Glyph curr) {
+    return _ensureKerning().get(prev.index, curr.index) / _unitPerEm;
 }
 
 void TtfFontface::contour(Gfx::Canvas &g, Glyph glyph) const {
     g.scale(1.0 / _unitPerEm);
     _parser.glyphContour(g, glyph);
 }
+
+Ttf::Layout const &TtfFontface::_ensureLayout() {
+    if (not _layout)
+        _layout = Ttf::Layout::load(_parser._gsub, _parser._gpos, _parser._gdef);
+    return *_layout;
+}
+
+ShapingPlan const &TtfFontface::_plan(u32 script, FontFeatures features) {
+    for (auto const &plan : _plans)
+        if (plan.script == script and plan.features == features)
+            return plan;
+
+    _plans.pushBack(ShapingPlan::build(_ensureLayout(), script, features));
+    return last(_plans);
+}
+
+void TtfFontface::shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out) {
+    auto const &layout = _ensureLayout();
+    if (layout.gsub.empty() and layout.gpos.empty()) {
+        Fontface::shape(runes, features, out);
+        return;
+    }
+
+    auto const &plan = _plan(Shaper::scriptOf(runes), features);
+
+    Vec<u16> glyphs;
+    glyphs.ensure(runes.len());
+    for (auto rune : runes)
+        glyphs.pushBack(glyph(rune == '\n' ? ' ' : rune).index);
+
+    Shaper shaper{layout};
+    shaper.load(runes, glyphs);
+    shaper.substitute(plan);
+
+    for (auto &slot : shaper._slots)
+        slot.advance = advance(Glyph{slot.glyph, 0}) * _unitPerEm;
+    shaper.position(plan);
+
+    // Fonts without a kern feature in GPOS might still have a legacy kern
+    // table.
+    if (features.has(FontFeature::KERN) and not plan.kern) {
+        auto const &kerning = _ensureKerning();
+        for (usize i = 1; i < shaper._slots.len(); i++)
+            shaper._slots[i - 1].advance += kerning.get(shaper._slots[i - 1].glyph, shaper._slots[i].glyph);
+    }
+
+    out.ensure(out.len() + shaper._slots.len());
+    for (auto const &slot : shaper._slots) {
+        out.pushBack({
+            .glyph = {slot.glyph, 0},
+            .cluster = slot.cluster,
+            .advance = slot.advance / _unitPerEm,
+            .xOffset = slot.xOffset / _unitPerEm,
+            .yOffset = slot.yOffset / _unitPerEm,
+        });
+    }
+}
+
+FontCoverage TtfFontface::coverage() const {
+    FontCoverage res;
+    for (auto [start, end] : _parser._cmapTable.iterRanges())
+        res.add(start, end);
+    return res;
+}
 } // namespace Karm::Text
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <karm-base/map.h>
 #include <karm-sys/mmap.h>
 
 #include "font.h"
+#include "shaper.h"
 #include "ttf/parser.h"
 
 namespace Karm::Text {
@@ -11,11 +11,18 @@ namespace Karm::Text {
 struct TtfFontface : public Fontface {
     Sys::Mmap _mmap;
     Ttf::Parser _parser;
-    Map<Rune, Glyph> _cachedEntries;
-    Map<Glyph, f64> _cachedAdvances;
-    Map<Cons<Glyph>, f64> _cachedKerns;
     f64 _unitPerEm = 0;
 
+    // Runes below this are mapped to glyphs through a flat table, this
+    // covers Latin, Greek, Cyrillic and the common punctuation.
+    static constexpr usize DIRECT_RUNES = 0x3000;
+
+    Vec<Glyph> _directGlyphs; //< Lazily filled on the first lookup
+    Vec<f32> _advances;       //< Advance of each glyph, in ems
+    Opt<Ttf::Kerning> _kerning;
+    Opt<Ttf::Layout> _layout;
+    Vec<ShapingPlan> _plans; //< By script and features, built on first use
+
     static Res<Strong<TtfFontface>> load(Sys::Mmap &&mmap);
 
     TtfFontface(Sys::Mmap &&mmap, Ttf::Parser parser);
@@ -24,13 +31,29 @@ struct TtfFontface : public Fontface {
 
     FontAttrs attrs() const override;
 
+    void _loadDirectGlyphs();
+
     Glyph glyph(Rune rune) override;
 
     f64 advance(Glyph glyph) override;
 
+    Ttf::Kerning const &_ensureKerning();
+
     f64 kern(Glyph prev, Glyph curr) override;
 
     void contour(Gfx::Canvas &g, Glyph glyph) const override;
+
+    Ttf::Layout const &_ensureLayout();
+
+    ShapingPlan const &_plan(u32 script, FontFeatures features);
+
+    void shape(Slice<Rune> runes, FontFeatures features, Vec<ShapedGlyph> &out) override;
+
+    FontCoverage coverage() const override;
+
+    GlyphSource source(Glyph) const override {
+        return {&_parser};
+    }
 };
 
 } // namespace Karm::Text
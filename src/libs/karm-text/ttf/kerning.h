@@ -0,0 +1,191 @@
+#pragma once
+
+#include <karm-base/vec.h>
+
+#include "table-gpos.h"
+#include "table-kern.h"
+
+namespace Ttf {
+
+// Kerning pairs and class-pair matrices decoded once from the GPOS "kern"
+// feature, or from the legacy kern table, so that looking up a pair doesn't
+// have to walk the font tables.
+struct Kerning {
+    static constexpr u16 UNCOVERED = 0xFFFF;
+
+    enum struct Kind {
+        PAIRS,
+        CLASSES,
+    };
+
+    struct Subtable {
+        Kind kind;
+
+        // Kind::PAIRS, sorted by key (prev << 16 | curr)
+        Vec<Cons<u32, i16>> pairs{};
+
+        // Kind::CLASSES, class of each glyph, indexed by glyph id
+        Vec<u16> first{};
+        Vec<u16> second{};
+        usize class1Count = 0;
+        usize class2Count = 0;
+        Vec<i16> matrix{};
+    };
+
+    Vec<Subtable> _subtables{};
+
+    static u32 _key(u16 prev, u16 curr) {
+        return (u32)prev << 16 | curr;
+    }
+
+    static void _sortPairs(Subtable &st) {
+        sort(st.pairs, [](auto const &a, auto const &b) {
+            return a.car <=> b.car;
+        });
+    }
+
+    static Subtable _decodeGlyphPairs(GlyphPairAdjustment const &table) {
+        Subtable st{.kind = Kind::PAIRS};
+        if (table.format() != GlyphPairAdjustment::FORMAT)
+            return st;
+
+        auto s = table.begin();
+        /* format = */ s.nextU16be();
+        auto coverageOffset = s.nextU16be();
+        auto valueFormat1 = s.nextU16be();
+        auto valueFormat2 = s.nextU16be();
+        usize pairSetCount = s.nextU16be();
+
+        CoverageTable coverage{table.begin().skip(coverageOffset).remBytes()};
+        auto glyphs = coverage.glyphs();
+
+        for (usize i = 0; i < min(pairSetCount, glyphs.len()); i++) {
+            auto pairSetOffset = s.nextU16be();
+            auto pairSet = table.begin().skip(pairSetOffset);
+            auto pairValueCount = pairSet.nextU16be();
+
+            for (usize j : range(pairValueCount)) {
+                (void)j;
+                auto secondGlyph = pairSet.nextU16be();
+                auto value1 = ValueRecord::read(pairSet, valueFormat1);
+                /* value2 = */ ValueRecord::read(pairSet, valueFormat2);
+                st.pairs.pushBack({_key(glyphs[i], secondGlyph), value1.xAdvance});
+            }
+        }
+
+        _sortPairs(st);
+        return st;
+    }
+
+    static Subtable _decodeClassPairs(ClassPairAdjustment const &table, usize numGlyphs) {
+        Subtable st{.kind = Kind::CLASSES};
+
+        auto s = table.begin();
+        /* format = */ s.nextU16be();
+        auto coverageOffset = s.nextU16be();
+        auto valueFormat1 = s.nextU16be();
+        auto valueFormat2 = s.nextU16be();
+        auto classDef1Offset = s.nextU16be();
+        auto classDef2Offset = s.nextU16be();
+        st.class1Count = s.nextU16be();
+        st.class2Count = s.nextU16be();
+
+        // Glyphs covered by the subtable default to class 0.
+        st.first.resize(numGlyphs);
+        for (auto &c : st.first)
+            c = UNCOVERED;
+
+        CoverageTable coverage{table.begin().skip(coverageOffset).remBytes()};
+        for (auto glyph : coverage.glyphs())
+            if (glyph < numGlyphs)
+                st.first[glyph] = 0;
+
+        Vec<u16> classes;
+        classes.resize(numGlyphs);
+        ClassDef{table.begin().skip(classDef1Offset).remBytes()}.decode(mutSub(classes));
+        for (usize glyph = 0; glyph < numGlyphs; glyph++)
+            if (st.first[glyph] != UNCOVERED)
+                st.first[glyph] = classes[glyph];
+
+        st.second.resize(numGlyphs);
+        ClassDef{table.begin().skip(classDef2Offset).remBytes()}.decode(mutSub(st.second));
+
+        st.matrix.resize(st.class1Count * st.class2Count);
+        for (usize i = 0; i < st.matrix.len(); i++) {
+            auto value1 = ValueRecord::read(s, valueFormat1);
+            /* value2 = */ ValueRecord::read(s, valueFormat2);
+            st.matrix[i] = value1.xAdvance;
+        }
+
+        return st;
+    }
+
+    static Kerning load(Gpos const &gpos, Kern const &kern, usize numGlyphs) {
+        Kerning res;
+
+        if (gpos.present()) {
+            auto kernFeature = gpos.kernFeature().unwrapOrDefault(NONE);
+            if (kernFeature) {
+                for (auto lookupIndex : kernFeature->iterLookups()) {
+                    auto lookupTable = gpos.lookupList().at(lookupIndex);
+
+                    // FIXME: We only support pair adjustment lookups.
+                    if (lookupTable.lookupType() != (u16)GposLookupType::PAIR_ADJUSTMENT)
+                        continue;
+
+                    for (auto lookupSubtable : lookupTable.iter()) {
+                        if (auto glyphPair = lookupSubtable.is<GlyphPairAdjustment>())
+                            res._subtables.pushBack(_decodeGlyphPairs(*glyphPair));
+                        else if (auto classPair = lookupSubtable.is<ClassPairAdjustment>())
+                            res._subtables.pushBack(_decodeClassPairs(*classPair, numGlyphs));
+                    }
+                }
+            }
+        }
+
+        if (isEmpty(res._subtables) and kern.present()) {
+            Subtable st{.kind = Kind::PAIRS};
+            for (auto pair : kern.iterPairs())
+                st.pairs.pushBack({_key(pair.left, pair.right), pair.value});
+            _sortPairs(st);
+            res._subtables.pushBack(std::move(st));
+        }
+
+        return res;
+    }
+
+    // Get the horizontal adjustment between two glyphs, in font units.
+    i16 get(u16 prev, u16 curr) const {
+        for (auto const &st : _subtables) {
+            if (st.kind == Kind::PAIRS) {
+                u32 key = _key(prev, curr);
+                usize lo = 0;
+                usize hi = st.pairs.len();
+                while (lo < hi) {
+                    usize mid = lo + (hi - lo) / 2;
+                    if (st.pairs[mid].car < key)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+
+                if (lo < st.pairs.len() and st.pairs[lo].car == key)
+                    return st.pairs[lo].cdr;
+            } else {
+                if (prev >= st.first.len() or st.first[prev] == UNCOVERED)
+                    continue;
+
+                usize class1 = st.first[prev];
+                usize class2 = curr < st.second.len() ? st.second[curr] : 0;
+                if (class1 >= st.class1Count or class2 >= st.class2Count)
+                    return 0;
+
+                return st.matrix[class1 * st.class2Count + class2];
+            }
+        }
+
+        return 0;
+    }
+};
+
+} // namespace Ttf
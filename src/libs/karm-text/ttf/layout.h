@@ -0,0 +1,1085 @@
+#pragma once
+
+#include <karm-base/union.h>
+#include <karm-base/vec.h>
+
+#include "table-gdef.h"
+#include "table-gpos.h"
+#include "table-gsub.h"
+
+namespace Ttf {
+
+// The GSUB, GPOS and GDEF tables decoded once into flat structures, so
+// that shaping a run doesn't have to walk the font tables.
+//
+// NOTE: Coverage and class definition tables become sorted arrays of
+//       ranges searched by bisection, and each lookup keeps a bitset of
+//       every glyph it can start at, so that most glyphs are skipped
+//       without looking at its subtables at all.
+
+static inline u32 tagOf(Str str) {
+    u32 tag = 0;
+    for (usize i = 0; i < 4; i++)
+        tag = (tag << 8) | (i < str.len() ? (u8)str[i] : ' ');
+    return tag;
+}
+
+static inline Bytes _at(Bytes bytes, usize offset) {
+    return Io::BScan{bytes}.skip(offset).remBytes();
+}
+
+// MARK: Glyph Sets ------------------------------------------------------------
+
+struct GlyphSet {
+    Vec<u64> _bits;
+
+    void add(usize glyph) {
+        if (glyph / 64 >= _bits.len())
+            _bits.resize(glyph / 64 + 1, 0);
+        _bits[glyph / 64] |= 1ull << (glyph % 64);
+    }
+
+    bool has(usize glyph) const {
+        if (glyph / 64 >= _bits.len())
+            return false;
+        return (_bits[glyph / 64] >> (glyph % 64)) & 1;
+    }
+};
+
+// MARK: Coverage --------------------------------------------------------------
+
+struct Coverage {
+    struct Range {
+        u16 start;
+        u16 end;
+        u16 index; //< Coverage index of the first glyph
+    };
+
+    Vec<Range> _ranges;
+
+    static Coverage decode(Bytes bytes) {
+        Coverage res;
+        Io::BScan s{bytes};
+        auto format = s.nextU16be();
+        usize count = s.nextU16be();
+
+        if (format == 1) {
+            for (usize i = 0; i < count; i++) {
+                usize glyph = s.nextU16be();
+                if (any(res._ranges)) {
+                    auto &r = last(res._ranges);
+                    if (r.end + 1uz == glyph and r.index + (glyph - r.start) == i) {
+                        r.end = glyph;
+                        continue;
+                    }
+                }
+                res._ranges.pushBack({(u16)glyph, (u16)glyph, (u16)i});
+            }
+        } else if (format == 2) {
+            for (usize i = 0; i < count; i++) {
+                u16 start = s.nextU16be();
+                u16 end = s.nextU16be();
+                u16 index = s.nextU16be();
+                if (start <= end)
+                    res._ranges.pushBack({start, end, index});
+            }
+        }
+
+        sort(res._ranges, [](auto const &a, auto const &b) {
+            return a.start <=> b.start;
+        });
+
+        return res;
+    }
+
+    Opt<usize> indexOf(usize glyph) const {
+        usize lo = 0;
+        usize hi = _ranges.len();
+        while (lo < hi) {
+            usize mid = lo + (hi - lo) / 2;
+            if (_ranges[mid].end < glyph)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo == _ranges.len() or _ranges[lo].start > glyph)
+            return NONE;
+
+        return _ranges[lo].index + (glyph - _ranges[lo].start);
+    }
+
+    bool has(usize glyph) const {
+        return indexOf(glyph).has();
+    }
+
+    void collect(GlyphSet &set) const {
+        for (auto const &r : _ranges)
+            for (usize glyph = r.start; glyph <= r.end; glyph++)
+                set.add(glyph);
+    }
+};
+
+// MARK: Classes ---------------------------------------------------------------
+
+struct Classes {
+    struct Range {
+        u16 start;
+        u16 end;
+        u16 klass;
+    };
+
+    Vec<Range> _ranges;
+
+    static Classes decode(Bytes bytes) {
+        Classes res;
+        Io::BScan s{bytes};
+        auto format = s.nextU16be();
+
+        if (format == 1) {
+            usize startGlyph = s.nextU16be();
+            usize glyphCount = s.nextU16be();
+            for (usize i = 0; i < glyphCount; i++) {
+                u16 klass = s.nextU16be();
+                usize glyph = startGlyph + i;
+                if (klass == 0)
+                    continue;
+
+                if (any(res._ranges)) {
+                    auto &r = last(res._ranges);
+                    if (r.end + 1uz == glyph and r.klass == klass) {
+                        r.end = glyph;
+                        continue;
+                    }
+                }
+                res._ranges.pushBack({(u16)glyph, (u16)glyph, klass});
+            }
+        } else if (format == 2) {
+            usize count = s.nextU16be();
+            for (usize i = 0; i < count; i++) {
+                u16 start = s.nextU16be();
+                u16 end = s.nextU16be();
+                u16 klass = s.nextU16be();
+                if (start <= end and klass != 0)
+                    res._ranges.pushBack({start, end, klass});
+            }
+        }
+
+        sort(res._ranges, [](auto const &a, auto const &b) {
+            return a.start <=> b.start;
+        });
+
+        return res;
+    }
+
+    // Glyphs not listed are in class 0.
+    u16 classOf(usize glyph) const {
+        usize lo = 0;
+        usize hi = _ranges.len();
+        while (lo < hi) {
+            usize mid = lo + (hi - lo) / 2;
+            if (_ranges[mid].end < glyph)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo == _ranges.len() or _ranges[lo].start > glyph)
+            return 0;
+
+        return _ranges[lo].klass;
+    }
+
+    bool empty() const {
+        return isEmpty(_ranges);
+    }
+};
+
+// MARK: Substitution Subtables ------------------------------------------------
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-1-single-substitution-subtable
+struct SingleSubst {
+    Coverage coverage;
+    i16 delta = 0;
+    Vec<u16> substitutes; //< Format 2, by coverage index
+
+    static SingleSubst decode(Bytes bytes) {
+        SingleSubst res;
+        Io::BScan s{bytes};
+        auto format = s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+
+        if (format == 1) {
+            res.delta = s.nextI16be();
+        } else if (format == 2) {
+            usize count = s.nextU16be();
+            for (usize i = 0; i < count; i++)
+                res.substitutes.pushBack(s.nextU16be());
+        }
+
+        return res;
+    }
+
+    Opt<u16> apply(usize glyph) const {
+        auto index = try$(coverage.indexOf(glyph));
+        if (isEmpty(substitutes))
+            return (u16)(glyph + delta);
+        if (index >= substitutes.len())
+            return NONE;
+        return substitutes[index];
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-2-multiple-substitution-subtable
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-3-alternate-substitution-subtable
+//
+// NOTE: Alternate substitutions use the same layout, the first alternate
+//       is always picked.
+struct MultipleSubst {
+    Coverage coverage;
+    Vec<Vec<u16>> sequences; //< By coverage index
+
+    static MultipleSubst decode(Bytes bytes) {
+        MultipleSubst res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+
+        usize count = s.nextU16be();
+        for (usize i = 0; i < count; i++) {
+            Io::BScan seq{_at(bytes, s.nextU16be())};
+            usize len = seq.nextU16be();
+            Vec<u16> glyphs;
+            for (usize j = 0; j < len; j++)
+                glyphs.pushBack(seq.nextU16be());
+            res.sequences.pushBack(std::move(glyphs));
+        }
+
+        return res;
+    }
+};
+
+struct Ligature {
+    u16 glyph;
+    Vec<u16> components; //< Every component but the first one
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-4-ligature-substitution-subtable
+struct LigatureSubst {
+    Coverage coverage;
+    Vec<Vec<Ligature>> sets; //< By coverage index, in order of preference
+
+    static LigatureSubst decode(Bytes bytes) {
+        LigatureSubst res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+
+        usize setCount = s.nextU16be();
+        for (usize i = 0; i < setCount; i++) {
+            auto setBytes = _at(bytes, s.nextU16be());
+            Io::BScan set{setBytes};
+            usize count = set.nextU16be();
+
+            Vec<Ligature> ligatures;
+            for (usize j = 0; j < count; j++) {
+                Io::BScan lig{_at(setBytes, set.nextU16be())};
+                Ligature ligature{.glyph = lig.nextU16be(), .components = {}};
+                usize componentCount = lig.nextU16be();
+                for (usize k = 1; k < componentCount; k++)
+                    ligature.components.pushBack(lig.nextU16be());
+                ligatures.pushBack(std::move(ligature));
+            }
+            res.sets.pushBack(std::move(ligatures));
+        }
+
+        return res;
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gsub#lookuptype-8-reverse-chaining-contextual-single-substitution-subtable
+struct ReverseChainSubst {
+    Coverage coverage;
+    Vec<Coverage> backtrack;
+    Vec<Coverage> lookahead;
+    Vec<u16> substitutes; //< By coverage index
+
+    static ReverseChainSubst decode(Bytes bytes) {
+        ReverseChainSubst res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+
+        usize backtrackCount = s.nextU16be();
+        for (usize i = 0; i < backtrackCount; i++)
+            res.backtrack.pushBack(Coverage::decode(_at(bytes, s.nextU16be())));
+
+        usize lookaheadCount = s.nextU16be();
+        for (usize i = 0; i < lookaheadCount; i++)
+            res.lookahead.pushBack(Coverage::decode(_at(bytes, s.nextU16be())));
+
+        usize glyphCount = s.nextU16be();
+        for (usize i = 0; i < glyphCount; i++)
+            res.substitutes.pushBack(s.nextU16be());
+
+        return res;
+    }
+};
+
+// MARK: Contextual Subtables --------------------------------------------------
+
+struct SequenceLookup {
+    u16 sequenceIndex;
+    u16 lookupIndex;
+};
+
+// Each sequence holds glyph ids, classes or coverage indices depending on
+// the format of the subtable.
+struct ContextRule {
+    Vec<u16> backtrack; //< Closest glyph first
+    Vec<u16> input;     //< Every input glyph but the first one
+    Vec<u16> lookahead;
+    Vec<SequenceLookup> lookups;
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/chapter2#sequence-context-format-1-simple-glyph-contexts
+// https://learn.microsoft.com/en-us/typography/opentype/spec/chapter2#chained-sequence-context-format-1-simple-glyph-contexts
+//
+// NOTE: Sequence contexts are decoded as chained sequence contexts with
+//       no backtrack and no lookahead.
+struct ContextSubst {
+    enum struct Format : u8 {
+        GLYPHS = 1,
+        CLASSES = 2,
+        COVERAGES = 3,
+    };
+
+    Format format = Format::GLYPHS;
+    Coverage coverage; //< First input glyph
+
+    // Format::CLASSES
+    Classes backtrackClasses;
+    Classes inputClasses;
+    Classes lookaheadClasses;
+
+    // Format::GLYPHS by coverage index, Format::CLASSES by class of the
+    // first glyph, Format::COVERAGES has a single rule.
+    Vec<Vec<ContextRule>> ruleSets;
+
+    // Format::COVERAGES
+    Vec<Coverage> coverages;
+
+    static Vec<u16> _readSeq(Io::BScan &s, usize len) {
+        Vec<u16> res;
+        for (usize i = 0; i < len; i++)
+            res.pushBack(s.nextU16be());
+        return res;
+    }
+
+    static Vec<SequenceLookup> _readLookups(Io::BScan &s, usize len) {
+        Vec<SequenceLookup> res;
+        for (usize i = 0; i < len; i++) {
+            u16 sequenceIndex = s.nextU16be();
+            u16 lookupIndex = s.nextU16be();
+            res.pushBack({sequenceIndex, lookupIndex});
+        }
+        return res;
+    }
+
+    static ContextRule _readRule(Bytes bytes, bool chained) {
+        Io::BScan s{bytes};
+        ContextRule rule;
+
+        if (chained)
+            rule.backtrack = _readSeq(s, s.nextU16be());
+
+        usize inputCount = s.nextU16be();
+        if (chained) {
+            rule.input = _readSeq(s, inputCount ? inputCount - 1 : 0);
+            rule.lookahead = _readSeq(s, s.nextU16be());
+            rule.lookups = _readLookups(s, s.nextU16be());
+        } else {
+            usize lookupCount = s.nextU16be();
+            rule.input = _readSeq(s, inputCount ? inputCount - 1 : 0);
+            rule.lookups = _readLookups(s, lookupCount);
+        }
+
+        return rule;
+    }
+
+    static Vec<Vec<ContextRule>> _readRuleSets(Bytes bytes, Io::BScan &s, bool chained) {
+        Vec<Vec<ContextRule>> res;
+        usize setCount = s.nextU16be();
+        for (usize i = 0; i < setCount; i++) {
+            Vec<ContextRule> rules;
+            usize setOffset = s.nextU16be();
+            if (setOffset) {
+                auto setBytes = _at(bytes, setOffset);
+                Io::BScan set{setBytes};
+                usize ruleCount = set.nextU16be();
+                for (usize j = 0; j < ruleCount; j++)
+                    rules.pushBack(_readRule(_at(setBytes, set.nextU16be()), chained));
+            }
+            res.pushBack(std::move(rules));
+        }
+        return res;
+    }
+
+    Vec<u16> _readCoverages(Bytes bytes, Io::BScan &s, usize len) {
+        Vec<u16> res;
+        for (usize i = 0; i < len; i++) {
+            res.pushBack(coverages.len());
+            coverages.pushBack(Coverage::decode(_at(bytes, s.nextU16be())));
+        }
+        return res;
+    }
+
+    static ContextSubst decode(Bytes bytes, bool chained) {
+        ContextSubst res;
+        Io::BScan s{bytes};
+        res.format = (Format)s.nextU16be();
+
+        if (res.format == Format::GLYPHS) {
+            res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+            res.ruleSets = _readRuleSets(bytes, s, chained);
+        } else if (res.format == Format::CLASSES) {
+            res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+            if (chained)
+                res.backtrackClasses = Classes::decode(_at(bytes, s.nextU16be()));
+            res.inputClasses = Classes::decode(_at(bytes, s.nextU16be()));
+            if (chained)
+                res.lookaheadClasses = Classes::decode(_at(bytes, s.nextU16be()));
+            res.ruleSets = _readRuleSets(bytes, s, chained);
+        } else if (res.format == Format::COVERAGES) {
+            ContextRule rule;
+            if (chained) {
+                rule.backtrack = res._readCoverages(bytes, s, s.nextU16be());
+                usize inputCount = s.nextU16be();
+                auto input = res._readCoverages(bytes, s, inputCount);
+                rule.lookahead = res._readCoverages(bytes, s, s.nextU16be());
+                rule.lookups = _readLookups(s, s.nextU16be());
+                rule.input = std::move(input);
+            } else {
+                usize inputCount = s.nextU16be();
+                usize lookupCount = s.nextU16be();
+                rule.input = res._readCoverages(bytes, s, inputCount);
+                rule.lookups = _readLookups(s, lookupCount);
+            }
+
+            if (isEmpty(rule.input))
+                return res;
+
+            // The first input coverage selects the rule.
+            res.coverage = res.coverages[first(rule.input)];
+            rule.input.removeAt(0);
+            res.ruleSets.pushBack(Vec<ContextRule>{});
+            res.ruleSets[0].pushBack(std::move(rule));
+        }
+
+        return res;
+    }
+
+    enum struct Seq : u8 {
+        BACKTRACK,
+        INPUT,
+        LOOKAHEAD,
+    };
+
+    bool matches(Seq seq, u16 value, usize glyph) const {
+        switch (format) {
+        case Format::GLYPHS:
+            return value == glyph;
+
+        case Format::CLASSES:
+            if (seq == Seq::BACKTRACK)
+                return backtrackClasses.classOf(glyph) == value;
+            if (seq == Seq::INPUT)
+                return inputClasses.classOf(glyph) == value;
+            return lookaheadClasses.classOf(glyph) == value;
+
+        case Format::COVERAGES:
+            return value < coverages.len() and coverages[value].has(glyph);
+        }
+
+        return false;
+    }
+
+    // Rules to try for a glyph covered by the subtable.
+    Slice<ContextRule> rulesFor(usize glyph) const {
+        usize index = 0;
+        if (format == Format::GLYPHS)
+            index = coverage.indexOf(glyph).unwrapOrDefault(ruleSets.len());
+        else if (format == Format::CLASSES)
+            index = inputClasses.classOf(glyph);
+
+        if (index >= ruleSets.len())
+            return {};
+        return ruleSets[index];
+    }
+};
+
+// MARK: Positioning Subtables -------------------------------------------------
+
+struct Value {
+    i16 xPlacement = 0;
+    i16 yPlacement = 0;
+    i16 xAdvance = 0;
+    i16 yAdvance = 0;
+
+    static Value read(Io::BScan &s, u16 format) {
+        auto r = ValueRecord::read(s, format);
+        return {r.xPlacement, r.yPlacement, r.xAdvance, r.yAdvance};
+    }
+};
+
+struct Anchor {
+    i16 x;
+    i16 y;
+
+    // Device and variation tables of format 3 anchors are ignored.
+    static Opt<Anchor> read(Bytes bytes, usize offset) {
+        if (offset == 0)
+            return NONE;
+        Io::BScan s{_at(bytes, offset)};
+        /* format = */ s.nextU16be();
+        i16 x = s.nextI16be();
+        i16 y = s.nextI16be();
+        return Anchor{x, y};
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-1-single-adjustment-positioning-subtable
+struct SingleAdjust {
+    Coverage coverage;
+    Vec<Value> values; //< A single value for format 1, by coverage index for format 2
+
+    static SingleAdjust decode(Bytes bytes) {
+        SingleAdjust res;
+        Io::BScan s{bytes};
+        auto format = s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        auto valueFormat = s.nextU16be();
+
+        usize count = format == 2 ? s.nextU16be() : 1;
+        for (usize i = 0; i < count; i++)
+            res.values.pushBack(Value::read(s, valueFormat));
+
+        return res;
+    }
+
+    Opt<Value> get(usize glyph) const {
+        auto index = try$(coverage.indexOf(glyph));
+        if (values.len() == 1)
+            return values[0];
+        if (index >= values.len())
+            return NONE;
+        return values[index];
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-2-pair-adjustment-positioning-subtable
+struct PairAdjust {
+    struct PairValue {
+        u32 key;
+        Value first;
+        Value second;
+    };
+
+    u16 format = 1;
+    Coverage coverage;
+    bool hasSecond = false; //< Whether the second glyph is positioned too
+
+    // Format 1, sorted by key (first << 16 | second)
+    Vec<PairValue> pairs;
+
+    // Format 2
+    Classes classes1;
+    Classes classes2;
+    usize class1Count = 0;
+    usize class2Count = 0;
+    Vec<Cons<Value>> matrix;
+
+    static PairAdjust decode(Bytes bytes) {
+        PairAdjust res;
+        Io::BScan s{bytes};
+        res.format = s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        auto valueFormat1 = s.nextU16be();
+        auto valueFormat2 = s.nextU16be();
+        res.hasSecond = valueFormat2 != 0;
+
+        if (res.format == 1) {
+            // Coverage indices are in glyph order, walk the ranges to map
+            // them back to glyph ids.
+            Vec<u16> firsts;
+            for (auto const &r : res.coverage._ranges) {
+                for (usize glyph = r.start; glyph <= r.end; glyph++) {
+                    usize index = r.index + (glyph - r.start);
+                    if (firsts.len() <= index)
+                        firsts.resize(index + 1, 0);
+                    firsts[index] = glyph;
+                }
+            }
+
+            usize setCount = s.nextU16be();
+            for (usize i = 0; i < min(setCount, firsts.len()); i++) {
+                Io::BScan set{_at(bytes, s.nextU16be())};
+                usize count = set.nextU16be();
+                for (usize j = 0; j < count; j++) {
+                    u16 second = set.nextU16be();
+                    auto value1 = Value::read(set, valueFormat1);
+                    auto value2 = Value::read(set, valueFormat2);
+                    res.pairs.pushBack({(u32)firsts[i] << 16 | second, value1, value2});
+                }
+            }
+
+            sort(res.pairs, [](auto const &a, auto const &b) {
+                return a.key <=> b.key;
+            });
+        } else if (res.format == 2) {
+            res.classes1 = Classes::decode(_at(bytes, s.nextU16be()));
+            res.classes2 = Classes::decode(_at(bytes, s.nextU16be()));
+            res.class1Count = s.nextU16be();
+            res.class2Count = s.nextU16be();
+
+            res.matrix.ensure(res.class1Count * res.class2Count);
+            for (usize i = 0; i < res.class1Count * res.class2Count; i++) {
+                auto value1 = Value::read(s, valueFormat1);
+                auto value2 = Value::read(s, valueFormat2);
+                res.matrix.pushBack({value1, value2});
+            }
+        }
+
+        return res;
+    }
+
+    Opt<Cons<Value>> get(usize first, usize second) const {
+        if (not coverage.has(first))
+            return NONE;
+
+        if (format == 1) {
+            u32 key = (u32)first << 16 | (u32)second;
+            usize lo = 0;
+            usize hi = pairs.len();
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                if (pairs[mid].key < key)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            if (lo == pairs.len() or pairs[lo].key != key)
+                return NONE;
+            return Cons<Value>{pairs[lo].first, pairs[lo].second};
+        }
+
+        usize class1 = classes1.classOf(first);
+        usize class2 = classes2.classOf(second);
+        if (class1 >= class1Count or class2 >= class2Count)
+            return NONE;
+        return matrix[class1 * class2Count + class2];
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-3-cursive-attachment-positioning-subtable
+struct CursiveAttach {
+    Coverage coverage;
+    Vec<Cons<Opt<Anchor>>> entryExits; //< By coverage index
+
+    static CursiveAttach decode(Bytes bytes) {
+        CursiveAttach res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.coverage = Coverage::decode(_at(bytes, s.nextU16be()));
+
+        usize count = s.nextU16be();
+        for (usize i = 0; i < count; i++) {
+            auto entry = Anchor::read(bytes, s.nextU16be());
+            auto exit = Anchor::read(bytes, s.nextU16be());
+            res.entryExits.pushBack({entry, exit});
+        }
+
+        return res;
+    }
+};
+
+struct MarkRecord {
+    u16 klass;
+    Anchor anchor;
+};
+
+static inline Vec<MarkRecord> _readMarkArray(Bytes bytes) {
+    Vec<MarkRecord> res;
+    Io::BScan s{bytes};
+    usize count = s.nextU16be();
+    for (usize i = 0; i < count; i++) {
+        u16 klass = s.nextU16be();
+        auto anchor = Anchor::read(bytes, s.nextU16be()).unwrapOrDefault({0, 0});
+        res.pushBack({klass, anchor});
+    }
+    return res;
+}
+
+static inline Vec<Opt<Anchor>> _readAnchorMatrix(Bytes bytes, usize classCount) {
+    Vec<Opt<Anchor>> res;
+    Io::BScan s{bytes};
+    usize count = s.nextU16be();
+    res.ensure(count * classCount);
+    for (usize i = 0; i < count * classCount; i++)
+        res.pushBack(Anchor::read(bytes, s.nextU16be()));
+    return res;
+}
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-4-mark-to-base-attachment-positioning-subtable
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-6-mark-to-mark-attachment-positioning-subtable
+struct MarkAttach {
+    Coverage markCoverage;
+    Coverage baseCoverage; //< Base glyphs, or the marks attached to
+    usize classCount = 0;
+    Vec<MarkRecord> marks;    //< By mark coverage index
+    Vec<Opt<Anchor>> anchors; //< By base coverage index, then mark class
+
+    static MarkAttach decode(Bytes bytes) {
+        MarkAttach res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.markCoverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        res.baseCoverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        res.classCount = s.nextU16be();
+        res.marks = _readMarkArray(_at(bytes, s.nextU16be()));
+        res.anchors = _readAnchorMatrix(_at(bytes, s.nextU16be()), res.classCount);
+        return res;
+    }
+
+    // Offset from the origin of the base to the origin of the mark.
+    Opt<Cons<isize>> offset(usize mark, usize base) const {
+        auto markIndex = try$(markCoverage.indexOf(mark));
+        auto baseIndex = try$(baseCoverage.indexOf(base));
+        if (markIndex >= marks.len())
+            return NONE;
+
+        auto const &record = marks[markIndex];
+        if (record.klass >= classCount or baseIndex * classCount + record.klass >= anchors.len())
+            return NONE;
+
+        auto anchor = try$(anchors[baseIndex * classCount + record.klass]);
+        return Cons<isize>{
+            anchor.x - record.anchor.x,
+            anchor.y - record.anchor.y,
+        };
+    }
+};
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#lookup-type-5-mark-to-ligature-attachment-positioning-subtable
+struct MarkLigatureAttach {
+    Coverage markCoverage;
+    Coverage ligatureCoverage;
+    usize classCount = 0;
+    Vec<MarkRecord> marks;
+    Vec<Vec<Opt<Anchor>>> anchors; //< By ligature coverage index, then component and mark class
+
+    static MarkLigatureAttach decode(Bytes bytes) {
+        MarkLigatureAttach res;
+        Io::BScan s{bytes};
+        /* format = */ s.nextU16be();
+        res.markCoverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        res.ligatureCoverage = Coverage::decode(_at(bytes, s.nextU16be()));
+        res.classCount = s.nextU16be();
+        res.marks = _readMarkArray(_at(bytes, s.nextU16be()));
+
+        auto ligatureArray = _at(bytes, s.nextU16be());
+        Io::BScan la{ligatureArray};
+        usize count = la.nextU16be();
+        for (usize i = 0; i < count; i++)
+            res.anchors.pushBack(_readAnchorMatrix(_at(ligatureArray, la.nextU16be()), res.classCount));
+
+        return res;
+    }
+
+    usize componentCount(usize ligatureIndex) const {
+        if (ligatureIndex >= anchors.len() or classCount == 0)
+            return 0;
+        return anchors[ligatureIndex].len() / classCount;
+    }
+
+    // Offset from the origin of the ligature to the origin of the mark
+    // attached to one of its components.
+    Opt<Cons<isize>> offset(usize mark, usize ligature, Opt<usize> component) const {
+        auto markIndex = try$(markCoverage.indexOf(mark));
+        auto ligatureIndex = try$(ligatureCoverage.indexOf(ligature));
+        if (markIndex >= marks.len())
+            return NONE;
+
+        auto count = componentCount(ligatureIndex);
+        if (count == 0)
+            return NONE;
+
+        // Marks not placed on a known component go on the last one.
+        usize comp = min(component.unwrapOrDefault(count - 1), count - 1);
+        auto const &record = marks[markIndex];
+        if (record.klass >= classCount)
+            return NONE;
+
+        auto anchor = try$(anchors[ligatureIndex][comp * classCount + record.klass]);
+        return Cons<isize>{
+            anchor.x - record.anchor.x,
+            anchor.y - record.anchor.y,
+        };
+    }
+};
+
+// MARK: Lookups ---------------------------------------------------------------
+
+using Subtable = Union<
+    SingleSubst,
+    MultipleSubst,
+    LigatureSubst,
+    ContextSubst,
+    ReverseChainSubst,
+    SingleAdjust,
+    PairAdjust,
+    CursiveAttach,
+    MarkAttach,
+    MarkLigatureAttach>;
+
+struct Lookup {
+    enum struct Kind : u8 {
+        SINGLE_SUBST,
+        MULTIPLE_SUBST,
+        ALTERNATE_SUBST,
+        LIGATURE_SUBST,
+        CONTEXT,
+        REVERSE_CHAIN_SUBST,
+        SINGLE_ADJUST,
+        PAIR_ADJUST,
+        CURSIVE_ATTACH,
+        MARK_TO_BASE,
+        MARK_TO_LIGATURE,
+        MARK_TO_MARK,
+        UNSUPPORTED,
+    };
+
+    Kind kind = Kind::UNSUPPORTED;
+    u16 flags = 0;
+    u16 markFilteringSet = 0;
+    GlyphSet starts; //< Every glyph a subtable can apply to
+    Vec<Subtable> subtables;
+
+    static Kind _gsubKind(u16 type) {
+        switch (type) {
+        case 1:
+            return Kind::SINGLE_SUBST;
+        case 2:
+            return Kind::MULTIPLE_SUBST;
+        case 3:
+            return Kind::ALTERNATE_SUBST;
+        case 4:
+            return Kind::LIGATURE_SUBST;
+        case 5:
+        case 6:
+            return Kind::CONTEXT;
+        case 8:
+            return Kind::REVERSE_CHAIN_SUBST;
+        default:
+            return Kind::UNSUPPORTED;
+        }
+    }
+
+    static Kind _gposKind(u16 type) {
+        switch (type) {
+        case 1:
+            return Kind::SINGLE_ADJUST;
+        case 2:
+            return Kind::PAIR_ADJUST;
+        case 3:
+            return Kind::CURSIVE_ATTACH;
+        case 4:
+            return Kind::MARK_TO_BASE;
+        case 5:
+            return Kind::MARK_TO_LIGATURE;
+        case 6:
+            return Kind::MARK_TO_MARK;
+        case 7:
+        case 8:
+            return Kind::CONTEXT;
+        default:
+            return Kind::UNSUPPORTED;
+        }
+    }
+
+    static Subtable _decodeSubtable(Kind kind, Bytes bytes, bool chained) {
+        switch (kind) {
+        case Kind::SINGLE_SUBST:
+            return SingleSubst::decode(bytes);
+        case Kind::MULTIPLE_SUBST:
+        case Kind::ALTERNATE_SUBST:
+            return MultipleSubst::decode(bytes);
+        case Kind::LIGATURE_SUBST:
+            return LigatureSubst::decode(bytes);
+        case Kind::REVERSE_CHAIN_SUBST:
+            return ReverseChainSubst::decode(bytes);
+        case Kind::SINGLE_ADJUST:
+            return SingleAdjust::decode(bytes);
+        case Kind::PAIR_ADJUST:
+            return PairAdjust::decode(bytes);
+        case Kind::CURSIVE_ATTACH:
+            return CursiveAttach::decode(bytes);
+        case Kind::MARK_TO_BASE:
+        case Kind::MARK_TO_MARK:
+            return MarkAttach::decode(bytes);
+        case Kind::MARK_TO_LIGATURE:
+            return MarkLigatureAttach::decode(bytes);
+        default:
+            return ContextSubst::decode(bytes, chained);
+        }
+    }
+
+    static Lookup decode(LookupTable const &table, bool gpos) {
+        Lookup res;
+        res.flags = table.lookupFlag();
+        res.markFilteringSet = table.markFilteringSet();
+
+        u16 type = table.lookupType();
+        for (usize i = 0; i < table.len(); i++) {
+            auto bytes = table.subtable(i);
+            u16 subtableType = type;
+
+            // Extension subtables point to a subtable of another type
+            // with a 32-bit offset.
+            if ((not gpos and type == 7) or (gpos and type == 9)) {
+                Io::BScan s{bytes};
+                /* format = */ s.nextU16be();
+                subtableType = s.nextU16be();
+                bytes = _at(bytes, s.nextU32be());
+            }
+
+            res.kind = gpos ? _gposKind(subtableType) : _gsubKind(subtableType);
+            if (res.kind == Kind::UNSUPPORTED) {
+                logWarn("ttf: unsupported {} lookup type {}", gpos ? "GPOS" : "GSUB", subtableType);
+                return res;
+            }
+
+            bool chained = gpos ? subtableType == 8 : subtableType == 6;
+            res.subtables.pushBack(_decodeSubtable(res.kind, bytes, chained));
+        }
+
+        for (auto const &subtable : res.subtables) {
+            subtable.visit(Visitor{
+                [&](MarkAttach const &t) {
+                    t.markCoverage.collect(res.starts);
+                },
+                [&](MarkLigatureAttach const &t) {
+                    t.markCoverage.collect(res.starts);
+                },
+                [&](auto const &t) {
+                    t.coverage.collect(res.starts);
+                },
+            });
+        }
+
+        return res;
+    }
+};
+
+// MARK: Layout ----------------------------------------------------------------
+
+struct Layout {
+    struct Feature {
+        u32 tag;
+        Vec<u16> lookups;
+    };
+
+    struct Script {
+        u32 tag;
+        Opt<u16> required;
+        Vec<u16> features;
+    };
+
+    // The decoded content of a GSUB or GPOS table.
+    struct Table {
+        Vec<Script> scripts;
+        Vec<Feature> features;
+        Vec<Lookup> lookups;
+
+        template <typename T>
+        static Table decode(T const &table, bool gpos) {
+            Table res;
+            if (not table.present())
+                return res;
+
+            // Only the default language system of each script is used.
+            for (auto const &script : table.scriptList().iter()) {
+                Script s{.tag = tagOf(script.tag), .required = NONE, .features = {}};
+                Opt<LangSys> langSys = NONE;
+                if (script.hasDefaultLangSys())
+                    langSys = script.defaultLangSys();
+                else if (script.len() > 0)
+                    langSys = script.at(0);
+
+                if (langSys) {
+                    auto required = langSys->get<LangSys::ReqFeatureIndex>();
+                    if (required != LangSys::NO_REQUIRED_FEATURE)
+                        s.required = required;
+                    for (auto index : langSys->iterFeatures())
+                        s.features.pushBack(index);
+                }
+                res.scripts.pushBack(std::move(s));
+            }
+
+            for (auto const &feature : table.featureList().iter()) {
+                Feature f{.tag = tagOf(feature.tag), .lookups = {}};
+                for (auto index : feature.iterLookups())
+                    f.lookups.pushBack(index);
+                res.features.pushBack(std::move(f));
+            }
+
+            for (auto const &lookup : table.lookupList().iter())
+                res.lookups.pushBack(Lookup::decode(lookup, gpos));
+
+            return res;
+        }
+
+        // Pick the script to use, falling back on the default script then
+        // on latin as recommended by the specification.
+        Opt<usize> script(u32 tag) const {
+            for (u32 t : {tag, tagOf("DFLT"), tagOf("dflt"), tagOf("latn")})
+                for (usize i = 0; i < scripts.len(); i++)
+                    if (scripts[i].tag == t)
+                        return i;
+            return NONE;
+        }
+
+        bool empty() const {
+            return isEmpty(lookups);
+        }
+    };
+
+    Table gsub;
+    Table gpos;
+
+    Classes glyphClasses;
+    Classes markAttachClasses;
+    Vec<Coverage> markGlyphSets;
+
+    static Layout load(Gsub const &gsub, Gpos const &gpos, Gdef const &gdef) {
+        Layout res;
+        res.gsub = Table::decode(gsub, false);
+        res.gpos = Table::decode(gpos, true);
+
+        if (gdef.present()) {
+            res.glyphClasses = Classes::decode(gdef.glyphClassDef().bytes());
+            res.markAttachClasses = Classes::decode(gdef.markAttachClassDef().bytes());
+            for (usize i = 0; i < gdef.markGlyphSetCount(); i++)
+                res.markGlyphSets.pushBack(Coverage::decode(gdef.markGlyphSet(i).bytes()));
+        }
+
+        return res;
+    }
+
+    bool hasGlyphClasses() const {
+        return not glyphClasses.empty();
+    }
+};
+
+} // namespace Ttf
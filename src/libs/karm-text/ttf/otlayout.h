@@ -2,6 +2,7 @@
 
 #include <karm-base/cons.h>
 #include <karm-base/opt.h>
+#include <karm-base/vec.h>
 #include <karm-io/bscan.h>
 #include <karm-logger/logger.h>
 
@@ -15,6 +16,8 @@ struct LangSys : public Io::BChunk {
 
     Str tag;
 
+    static constexpr u16 NO_REQUIRED_FEATURE = 0xFFFF;
+
     LangSys(Str tag, Bytes bytes)
         : BChunk{bytes}, tag(tag) {}
 
@@ -37,6 +40,10 @@ struct ScriptTable : public Io::BChunk {
     ScriptTable(Str tag, Bytes bytes)
         : BChunk{bytes}, tag(tag) {}
 
+    bool hasDefaultLangSys() const {
+        return get<DefaultLangSysOffset>() != 0;
+    }
+
     LangSys defaultLangSys() const {
         return {"DFLT", begin().skip(get<DefaultLangSysOffset>()).remBytes()};
     }
@@ -159,6 +166,36 @@ struct CoverageTable : public Io::BChunk {
 
         return NONE;
     }
+
+    // Decode the covered glyphs, ordered by coverage index.
+    Vec<u16> glyphs() const {
+        Vec<u16> res;
+        auto s = begin().skip(4);
+
+        if (format() == 1) {
+            for (auto i : range(len())) {
+                (void)i;
+                res.pushBack(s.nextU16be());
+            }
+        }
+
+        if (format() == 2) {
+            for (auto i : range(len())) {
+                (void)i;
+                auto start = s.nextU16be();
+                auto end = s.nextU16be();
+                auto index = s.nextU16be();
+                for (usize glyph = start; glyph <= end; glyph++) {
+                    usize at = index + glyph - start;
+                    if (res.len() <= at)
+                        res.resize(at + 1);
+                    res[at] = glyph;
+                }
+            }
+        }
+
+        return res;
+    }
 };
 
 struct LookupSubtableBase : public Io::BChunk {
@@ -296,6 +333,35 @@ struct ClassDef : public Io::BChunk {
 
         return NONE;
     }
+
+    // Decode the class of every glyph into `classes`, indexed by glyph id.
+    // NOTE: Glyphs not listed keep their previous value, usually class 0.
+    void decode(MutSlice<u16> classes) const {
+        auto s = begin();
+        auto format = s.nextU16be();
+
+        if (format == 1) {
+            usize startGlyph = s.nextU16be();
+            usize glyphCount = s.nextU16be();
+            for (usize i = 0; i < glyphCount; i++) {
+                auto glyphClass = s.nextU16be();
+                if (startGlyph + i < classes.len())
+                    classes[startGlyph + i] = glyphClass;
+            }
+        }
+
+        if (format == 2) {
+            auto classRangeCount = s.nextU16be();
+            for (usize i : range(classRangeCount)) {
+                (void)i;
+                usize startGlyph = s.nextU16be();
+                usize endGlyph = s.nextU16be();
+                auto glyphClass = s.nextU16be();
+                for (usize glyph = startGlyph; glyph <= endGlyph and glyph < classes.len(); glyph++)
+                    classes[glyph] = glyphClass;
+            }
+        }
+    }
 };
 
 // https://learn.microsoft.com/en-us/typography/opentype/spec/gpos#pair-adjustment-positioning-format-2-class-pair-adjustment
@@ -364,6 +430,12 @@ struct LookupTable : public Io::BChunk {
                    : 0;
     }
 
+    // The bytes of a subtable, whatever its type.
+    Bytes subtable(usize i) const {
+        auto off = begin().skip(6 + i * 2).nextU16be();
+        return begin().skip(off).remBytes();
+    }
+
     LookupSubtable at(usize i) const {
         auto off = begin().skip(6 + i * 2).nextU16be();
         auto subtable = begin().skip(off);
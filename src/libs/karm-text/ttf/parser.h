@@ -2,13 +2,16 @@
 
 #include <karm-logger/logger.h>
 
+#include "kerning.h"
 #include "table-cmap.h"
+#include "table-gdef.h"
 #include "table-glyf.h"
 #include "table-gpos.h"
 #include "table-gsub.h"
 #include "table-head.h"
 #include "table-hhea.h"
 #include "table-hmtx.h"
+#include "table-kern.h"
 #include "table-loca.h"
 #include "table-maxp.h"
 #include "table-name.h"
@@ -51,8 +54,11 @@ struct Parser {
     Loca _loca;
     Hhea _hhea;
     Hmtx _hmtx;
+    Maxp _maxp;
     Gpos _gpos;
+    Kern _kern;
     Gsub _gsub;
+    Gdef _gdef;
     Name _name;
     Post _post;
     Os2 _os2;
@@ -117,8 +123,11 @@ struct Parser {
         font._loca = try$(font.requireTable<Loca>());
         font._hhea = try$(font.requireTable<Hhea>());
         font._hmtx = try$(font.requireTable<Hmtx>());
+        font._maxp = font.lookupTable<Maxp>();
         font._gpos = font.lookupTable<Gpos>();
+        font._kern = font.lookupTable<Kern>();
         font._gsub = font.lookupTable<Gsub>();
+        font._gdef = font.lookupTable<Gdef>();
         font._name = font.lookupTable<Name>();
         font._post = font.lookupTable<Post>();
         if (not font._post.present())
@@ -143,7 +152,7 @@ struct Parser {
         return begin().nextU32be();
     }
 
-    auto iterTables() {
+    auto iterTables() const {
         auto scan = begin();
         /* auto version = */ scan.nextU32be();
         auto numTables = scan.nextU16be();
@@ -199,6 +208,15 @@ struct Parser {
         return Error::other("table not found");
     }
 
+    usize numGlyphs() const {
+        if (_maxp.present())
+            return _maxp.numGlyphs();
+
+        // Fallback on the size of the loca table.
+        usize entries = _loca.bytes().len() / (_head.locaFormat() == 0 ? 2 : 4);
+        return entries > 0 ? entries - 1 : 0;
+    }
+
     Text::Glyph glyph(Rune rune) const {
         return _cmapTable.glyphIdFor(rune);
     }
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <karm-io/impls.h>
+
+#include "parser.h"
+
+namespace Ttf {
+
+// A font with only some of the glyphs of another one, renumbered in the order
+// they are added, for embedding it in documents. The glyphs composite ones
+// are made of are added when it's written.
+struct Subset {
+    // Flags of the components of composite glyphs
+    static constexpr u16 ARG_1_AND_2_ARE_WORDS = 0x0001;
+    static constexpr u16 WE_HAVE_A_SCALE = 0x0008;
+    static constexpr u16 MORE_COMPONENTS = 0x0020;
+    static constexpr u16 WE_HAVE_AN_X_AND_Y_SCALE = 0x0040;
+    static constexpr u16 WE_HAVE_A_TWO_BY_TWO = 0x0080;
+
+    static constexpr u32 CHECKSUM_MAGIC = 0xB1B0AFBA;
+
+    Parser _parser;
+    Vec<u16> _glyphs; //< Index in the font of each glyph of the subset
+    Vec<u16> _ids;    //< Index in the subset of each glyph of the font, zero if it isn't in it
+
+    Subset(Parser parser) : _parser(parser) {
+        _ids.resize(_parser.numGlyphs(), 0);
+        _glyphs.pushBack(0); // The missing glyph always comes first
+    }
+
+    Parser const &parser() const {
+        return _parser;
+    }
+
+    usize len() const {
+        return _glyphs.len();
+    }
+
+    Text::Glyph glyph(u16 id) const {
+        return Text::Glyph(_glyphs[id]);
+    }
+
+    // Add a glyph if it isn't in the subset yet, returns its index in it.
+    u16 add(Text::Glyph glyph) {
+        if (glyph.index >= _ids.len())
+            return 0;
+
+        if (glyph.index != 0 and _ids[glyph.index] == 0) {
+            _ids[glyph.index] = _glyphs.len();
+            _glyphs.pushBack(glyph.index);
+        }
+
+        return _ids[glyph.index];
+    }
+
+    // Advance of a glyph of the subset, in ems.
+    f64 advance(u16 id) const {
+        return _parser._hmtx.metrics(_glyphs[id], _parser._hhea).advanceWidth / _parser.unitPerEm();
+    }
+
+    Bytes _table(Str tag) const {
+        for (auto table : _parser.iterTables()) {
+            if (table.tag == tag and table.offset <= _parser._slice.len())
+                return sub(_parser._slice, table.offset, table.offset + table.length);
+        }
+        return {};
+    }
+
+    Bytes _glyphData(u16 index) const {
+        auto start = _parser._loca.glyfOffset(index, _parser._head);
+        auto end = _parser._loca.glyfOffset(index + 1, _parser._head);
+        if (end <= start or start > _parser._glyf.bytes().len())
+            return {};
+        return sub(_parser._glyf.bytes(), start, end);
+    }
+
+    // Call `f` with the position and the glyph of each component of a
+    // composite glyph, does nothing for simple ones.
+    static void _iterComponents(Bytes data, auto f) {
+        Io::BScan s{data};
+        if (s.rem() < 10 or s.peekI16be() >= 0)
+            return;
+
+        s.skip(10);
+        while (s.rem() >= 4) {
+            usize at = data.len() - s.rem() + 2;
+            u16 flags = s.nextU16be();
+            f(at, s.nextU16be());
+
+            s.skip(flags & ARG_1_AND_2_ARE_WORDS ? 4 : 2);
+            if (flags & WE_HAVE_A_SCALE)
+                s.skip(2);
+            else if (flags & WE_HAVE_AN_X_AND_Y_SCALE)
+                s.skip(4);
+            else if (flags & WE_HAVE_A_TWO_BY_TWO)
+                s.skip(8);
+
+            if (not(flags & MORE_COMPONENTS))
+                break;
+        }
+    }
+
+    // A format 12 'cmap' mapping the runes of the glyphs of the subset, in
+    // groups of consecutive runes with consecutive glyphs.
+    Buf<Byte> _cmap() const {
+        struct Group {
+            Rune start;
+            Rune end;
+            u32 id;
+        };
+
+        Vec<Group> groups;
+        auto &cmap = _parser._cmapTable;
+        for (auto range : cmap.iterRanges()) {
+            for (Rune r = range.car; r <= range.cdr; r++) {
+                auto glyph = cmap.lookup(r);
+                if (not glyph or glyph->index >= _ids.len() or not _ids[glyph->index])
+                    continue;
+
+                u32 id = _ids[glyph->index];
+                if (groups.len() and
+                    last(groups).end + 1 == r and
+                    last(groups).id + (r - last(groups).start) == id) {
+                    last(groups).end = r;
+                } else {
+                    groups.pushBack({r, r, id});
+                }
+            }
+        }
+
+        Io::BufferWriter buf;
+        Io::BEmit e{buf};
+        e.writeU16be(0);  // version
+        e.writeU16be(1);  // numTables
+        e.writeU16be(3);  // platformID: Windows
+        e.writeU16be(10); // encodingID: Unicode full repertoire
+        e.writeU32be(12); // offset
+
+        e.writeU16be(12); // format
+        e.writeU16be(0);  // reserved
+        e.writeU32be(16 + groups.len() * 12);
+        e.writeU32be(0); // language
+        e.writeU32be(groups.len());
+        for (auto &group : groups) {
+            e.writeU32be(group.start);
+            e.writeU32be(group.end);
+            e.writeU32be(group.id);
+        }
+
+        return buf.take();
+    }
+
+    static u32 _checksum(Bytes data) {
+        u32 sum = 0;
+        for (usize i = 0; i < data.len(); i += 4) {
+            u32 word = 0;
+            for (usize j = 0; j < 4; j++)
+                word = (word << 8) | (i + j < data.len() ? data[i + j] : 0);
+            sum += word;
+        }
+        return sum;
+    }
+
+    static void _put16(MutBytes data, usize at, u16 value) {
+        data[at] = value >> 8;
+        data[at + 1] = value;
+    }
+
+    static void _put32(MutBytes data, usize at, u32 value) {
+        _put16(data, at, value >> 16);
+        _put16(data, at + 2, value);
+    }
+
+    static void _pad(Io::BEmit &e, usize len) {
+        while (len++ % 4)
+            e.writeU8be(0);
+    }
+
+    // Write the font, `cmap`, `glyf`, `loca` and `hmtx` are rebuilt around
+    // the glyphs of the subset, `head`, `hhea` and `maxp` patched to match
+    // them, and the hinting tables copied as they are. Other tables aren't
+    // needed to draw the glyphs and are left out.
+    Res<> write(Io::Writer &w) {
+        for (usize i = 0; i < _glyphs.len(); i++)
+            _iterComponents(_glyphData(_glyphs[i]), [&](usize, u16 component) {
+                add(Text::Glyph(component));
+            });
+
+        Io::BufferWriter glyfBuf, locaBuf, hmtxBuf;
+        Io::BEmit glyf{glyfBuf}, loca{locaBuf}, hmtx{hmtxBuf};
+
+        Buf<Byte> data;
+        for (auto index : _glyphs) {
+            loca.writeU32be(glyfBuf.bytes().len());
+
+            data = _glyphData(index);
+            _iterComponents(data, [&](usize at, u16 component) {
+                _put16(data, at, component < _ids.len() ? _ids[component] : 0);
+            });
+            glyf.writeBytes(data);
+            _pad(glyf, data.len());
+
+            auto metrics = _parser._hmtx.metrics(index, _parser._hhea);
+            hmtx.writeU16be(metrics.advanceWidth);
+            hmtx.writeI16be(metrics.lsb);
+        }
+        loca.writeU32be(glyfBuf.bytes().len());
+
+        // Long offsets in the loca table, and the checksum adjustment is
+        // computed once the whole font is laid out.
+        Buf<Byte> head = _parser._head.bytes();
+        if (head.len() < 54) {
+            logError("ttf: 'head' table is too short");
+            return Error::invalidData("head table is too short");
+        }
+        _put32(head, 8, 0);
+        _put16(head, 50, 1);
+
+        Buf<Byte> hhea = _parser._hhea.bytes();
+        if (hhea.len() < 36) {
+            logError("ttf: 'hhea' table is too short");
+            return Error::invalidData("hhea table is too short");
+        }
+        _put16(hhea, 34, _glyphs.len());
+
+        // Fonts without a 'maxp' get the short version 0.5 of it.
+        Buf<Byte> maxp = _parser._maxp.bytes();
+        if (maxp.len() < 6)
+            maxp = {0x00, 0x00, 0x50, 0x00, 0x00, 0x00};
+        _put16(maxp, 4, _glyphs.len());
+
+        struct Table {
+            Str tag;
+            Bytes data;
+        };
+
+        // Sorted by tag, as the table directory should be.
+        Vec<Table> tables;
+        auto addTable = [&](Str tag, Bytes data) {
+            if (data.len())
+                tables.pushBack({tag, data});
+        };
+        Buf<Byte> cmap = _cmap();
+        addTable("cmap", cmap);
+        addTable("cvt ", _table("cvt "));
+        addTable("fpgm", _table("fpgm"));
+        addTable("glyf", glyfBuf.bytes());
+        addTable("head", head);
+        addTable("hhea", hhea);
+        addTable("hmtx", hmtxBuf.bytes());
+        addTable("loca", locaBuf.bytes());
+        addTable("maxp", maxp);
+        addTable("prep", _table("prep"));
+
+        usize entrySelector = 0;
+        while ((2uz << entrySelector) <= tables.len())
+            entrySelector++;
+        usize searchRange = (1uz << entrySelector) * 16;
+
+        Io::BufferWriter dirBuf;
+        Io::BEmit dir{dirBuf};
+        dir.writeU32be(0x00010000);
+        dir.writeU16be(tables.len());
+        dir.writeU16be(searchRange);
+        dir.writeU16be(entrySelector);
+        dir.writeU16be(tables.len() * 16 - searchRange);
+
+        usize offset = 12 + tables.len() * 16;
+        u32 sum = 0;
+        for (auto &table : tables) {
+            u32 checksum = _checksum(table.data);
+            sum += checksum;
+
+            dir.writeStr(table.tag);
+            dir.writeU32be(checksum);
+            dir.writeU32be(offset);
+            dir.writeU32be(table.data.len());
+            offset = alignUp(offset + table.data.len(), 4);
+        }
+        sum += _checksum(dirBuf.bytes());
+        _put32(head, 8, CHECKSUM_MAGIC - sum);
+
+        try$(w.write(dirBuf.bytes()));
+        Io::BEmit e{w};
+        for (auto &table : tables) {
+            try$(w.write(table.data));
+            _pad(e, table.data.len());
+        }
+
+        return Ok();
+    }
+};
+
+} // namespace Ttf
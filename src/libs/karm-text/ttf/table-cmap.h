@@ -21,71 +21,132 @@ struct Cmap : public Io::BChunk {
             return slice;
         }
 
-        Text::Glyph _glyphIdForType4(Rune r) const {
-            u16 segCountX2 = begin().skip(6).nextU16be();
-            u16 segCount = segCountX2 / 2;
+        // Segments are sorted by end code, find the first one that ends
+        // at or after the rune using a binary search.
+        Opt<Text::Glyph> _glyphIdForType4(Rune r) const {
+            if (r > 0xFFFF)
+                return NONE;
 
-            for (usize i = 0; i < segCount; i++) {
-                auto s = begin().skip(14);
+            usize segCountX2 = begin().skip(6).nextU16be();
+            usize segCount = segCountX2 / 2;
+
+            usize endCodes = 14;
+            usize startCodes = endCodes + segCountX2 + 2; // + 2 for reserved padding
+            usize idDeltas = startCodes + segCountX2;
+            usize idRangeOffsets = idDeltas + segCountX2;
+
+            usize lo = 0;
+            usize hi = segCount;
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                u16 endCode = begin().skip(endCodes + mid * 2).peekU16be();
+                if (endCode < r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
 
-                u16 endCode = s.skip(i * 2).peekU16be();
+            if (lo == segCount)
+                return NONE;
 
-                if (r > endCode)
-                    continue;
+            u16 startCode = begin().skip(startCodes + lo * 2).peekU16be();
+            if (r < startCode)
+                return NONE;
 
-                // + 2 for reserved padding
-                u16 startCode = s.skip(segCountX2 + 2).peekU16be();
+            u16 idDelta = begin().skip(idDeltas + lo * 2).peekI16be();
+            u16 idRangeOffset = begin().skip(idRangeOffsets + lo * 2).peekU16be();
 
-                if (r < startCode)
-                    break;
+            if (idRangeOffset == 0)
+                return Text::Glyph((r + idDelta) & 0xFFFF);
 
-                u16 idDelta = s.skip(segCountX2).peekI16be();
-                u16 idRangeOffset = s.skip(segCountX2).peekU16be();
+            // The offset is relative to the idRangeOffset entry itself.
+            usize offset = idRangeOffsets + lo * 2 + idRangeOffset + (r - startCode) * 2;
+            u16 glyph = begin().skip(offset).peekU16be();
+            if (glyph == 0)
+                return NONE;
 
-                if (idRangeOffset == 0) {
-                    return Text::Glyph((r + idDelta) & 0xFFFF);
-                }
+            return Text::Glyph((glyph + idDelta) & 0xFFFF);
+        }
 
-                auto offset = idRangeOffset + (r - startCode) * 2;
-                return Text::Glyph(s.skip(offset).nextU16be());
+        // Groups are sorted by start code, find the first one that ends
+        // at or after the rune using a binary search.
+        Opt<Text::Glyph> _glyphForType12(Rune r) const {
+            static constexpr usize GROUPS = 16;
+            static constexpr usize GROUP_SIZE = 12;
+
+            u32 nGroups = begin().skip(12).nextU32be();
+
+            u32 lo = 0;
+            u32 hi = nGroups;
+            while (lo < hi) {
+                u32 mid = lo + (hi - lo) / 2;
+                u32 endCode = begin().skip(GROUPS + mid * GROUP_SIZE + 4).peekU32be();
+                if (endCode < r)
+                    lo = mid + 1;
+                else
+                    hi = mid;
             }
 
-            logWarn("ttf: glyph not found for rune {x}", r);
-            return Text::Glyph(0);
-        }
+            if (lo == nGroups)
+                return NONE;
 
-        Text::Glyph _glyphForType12(Rune r) const {
-            auto s = begin().skip(12);
-            u32 nGroups = s.nextU32be();
+            auto s = begin().skip(GROUPS + lo * GROUP_SIZE);
+            u32 startCode = s.nextU32be();
+            /* endCode = */ s.nextU32be();
+            u32 glyphOffset = s.nextU32be();
 
-            for (u32 i = 0; i < nGroups; i++) {
-                u32 startCode = s.nextU32be();
-                u32 endCode = s.nextU32be();
-                u32 glyphOffset = s.nextU32be();
+            if (r < startCode)
+                return NONE;
 
-                if (r < startCode)
-                    break;
+            return Text::Glyph((r - startCode) + glyphOffset);
+        }
 
-                if (r > endCode)
-                    continue;
+        // Lookup the glyph for the given rune, returns NONE if the font doesn't cover it.
+        Opt<Text::Glyph> lookup(Rune r) const {
+            if (type == 4)
+                return _glyphIdForType4(r);
+            else if (type == 12)
+                return _glyphForType12(r);
+            return NONE;
+        }
 
-                if (r >= startCode and r <= endCode) {
-                    return Text::Glyph((r - startCode) + glyphOffset);
+        // Iterate over the ranges of runes mapped by the table, as inclusive
+        // start and end pairs.
+        // NOTE: Ranges might contain runes mapped to the missing glyph.
+        auto iterRanges() const {
+            usize segCountX2 = type == 4 ? begin().skip(6).peekU16be() : 0;
+            usize len = 0;
+            if (type == 4)
+                len = segCountX2 / 2;
+            else if (type == 12)
+                len = begin().skip(12).peekU32be();
+
+            return Iter{[this, segCountX2, len, i = 0uz] mutable -> Opt<Cons<Rune>> {
+                while (i < len) {
+                    usize at = i++;
+
+                    if (type == 12) {
+                        auto s = begin().skip(16 + at * 12);
+                        Rune start = s.nextU32be();
+                        Rune end = s.nextU32be();
+                        return Cons<Rune>{start, end};
+                    }
+
+                    Rune end = begin().skip(14 + at * 2).peekU16be();
+                    Rune start = begin().skip(14 + segCountX2 + 2 + at * 2).peekU16be();
+
+                    // Skip the sentinel segment terminating the table.
+                    if (start == 0xFFFF)
+                        continue;
+
+                    return Cons<Rune>{start, end};
                 }
-            }
-
-            logWarn("ttf: glyph not found for rune {c}", r);
-            return Text::Glyph(0);
+                return NONE;
+            }};
         }
 
         Text::Glyph glyphIdFor(Rune r) const {
-            if (type == 4) {
-                return _glyphIdForType4(r);
-            } else if (type == 12) {
-                return _glyphForType12(r);
-            } else {
-                return Text::Glyph(0);
-            }
+            return lookup(r).unwrapOrDefault(Text::Glyph(0));
         }
     };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/gdef
+
+#include "otlayout.h"
+
+namespace Ttf {
+
+struct Gdef : public Io::BChunk {
+    static constexpr Str SIG = "GDEF";
+
+    using MajorVersion = Io::BField<u16be, 0>;
+    using MinorVersion = Io::BField<u16be, 2>;
+    using GlyphClassDefOffset = Io::BField<u16be, 4>;
+    using MarkAttachClassDefOffset = Io::BField<u16be, 10>;
+    using MarkGlyphSetsDefOffset = Io::BField<u16be, 12>;
+
+    enum GlyphClass : u16 {
+        UNCLASSIFIED = 0,
+        BASE = 1,
+        LIGATURE = 2,
+        MARK = 3,
+        COMPONENT = 4,
+    };
+
+    ClassDef _classDef(usize offset) const {
+        if (offset == 0)
+            return {};
+        return ClassDef{begin().skip(offset).remBytes()};
+    }
+
+    ClassDef glyphClassDef() const {
+        return _classDef(get<GlyphClassDefOffset>());
+    }
+
+    ClassDef markAttachClassDef() const {
+        return _classDef(get<MarkAttachClassDefOffset>());
+    }
+
+    // Mark glyph sets are only present since version 1.2
+    usize markGlyphSetCount() const {
+        if (get<MinorVersion>() < 2 or get<MarkGlyphSetsDefOffset>() == 0)
+            return 0;
+        auto s = begin().skip(get<MarkGlyphSetsDefOffset>());
+        /* format = */ s.nextU16be();
+        return s.nextU16be();
+    }
+
+    CoverageTable markGlyphSet(usize i) const {
+        auto sets = begin().skip(get<MarkGlyphSetsDefOffset>());
+        auto s = sets;
+        s.skip(4 + i * 4);
+        return CoverageTable{sets.skip(s.nextU32be()).remBytes()};
+    }
+};
+
+} // namespace Ttf
@@ -40,7 +40,7 @@ struct Gpos : public Io::BChunk {
         return LookupList{begin().skip(get<LookupListOffset>()).remBytes()};
     }
 
-    Res<Pair<ValueRecord>> adjustments(usize prev, usize curr) const {
+    Res<Opt<FeatureTable>> kernFeature() const {
         // 1. Locate the current script in the GPOS ScriptList table.
 
         // FIXME: We assume that the script is always "latn".
@@ -54,21 +54,15 @@ struct Gpos : public Io::BChunk {
 
         // 3. The LangSys table provides index numbers into the GPOS FeatureList
         //    table to access a required feature and a number of additional features.
-        Opt<FeatureTable> kernFeatureTable;
         for (auto featureIndex : langSys.iterFeatures()) {
             auto featureTable = featureList().at(featureIndex);
 
             // 4. Inspect the featureTag of each feature, and select the feature
             //    tables to apply to an input glyph string.
-            if (featureTable.tag == "kern") {
-                kernFeatureTable = featureTable;
-                break;
-            }
+            if (featureTable.tag == "kern")
+                return Ok(featureTable);
         }
 
-        if (not kernFeatureTable)
-            return Ok(Pair<ValueRecord>{});
-
         // 5. If a Feature Variation table is present, evaluate conditions in
         //    the Feature Variation table to determine if any of the initially-
         //    selected feature tables should be substituted by an alternate
@@ -76,6 +70,14 @@ struct Gpos : public Io::BChunk {
 
         // FIXME: We don't support feature variations.
 
+        return Ok(NONE);
+    }
+
+    Res<Pair<ValueRecord>> adjustments(usize prev, usize curr) const {
+        auto kernFeatureTable = try$(kernFeature());
+        if (not kernFeatureTable)
+            return Ok(Pair<ValueRecord>{});
+
         // 6. Each feature provides an array of index numbers into the GPOS
         //    LookupList table. Assemble all lookups from the set of chosen
         //    feature tables, and apply the lookups in the order given in the
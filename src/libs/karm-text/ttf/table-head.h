@@ -13,6 +13,23 @@ struct Head : public Io::BChunk {
         return s.nextU16be();
     }
 
+    // Bounding box of all the glyphs.
+    i16 xMin() const {
+        return begin().skip(36).nextI16be();
+    }
+
+    i16 yMin() const {
+        return begin().skip(38).nextI16be();
+    }
+
+    i16 xMax() const {
+        return begin().skip(40).nextI16be();
+    }
+
+    i16 yMax() const {
+        return begin().skip(42).nextI16be();
+    }
+
     u16 locaFormat() const {
         auto s = begin();
         s.skip(50);
@@ -0,0 +1,70 @@
+#pragma once
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/kern
+
+#include <karm-io/bscan.h>
+
+namespace Ttf {
+
+struct Kern : public Io::BChunk {
+    static constexpr Str SIG = "kern";
+
+    static constexpr u16 HORIZONTAL = 1 << 0;
+    static constexpr u16 MINIMUM = 1 << 1;
+    static constexpr u16 CROSS_STREAM = 1 << 2;
+
+    struct Pair {
+        u16 left;
+        u16 right;
+        i16 value;
+    };
+
+    // Iterate over the pairs of all the horizontal format 0 subtables.
+    auto iterPairs() const {
+        auto s = begin();
+        usize nTables = 0;
+        if (present()) {
+            /* version = */ s.nextU16be();
+            nTables = s.nextU16be();
+        }
+
+        return Iter{[s, pairs = Io::BScan{Bytes{}}, i = 0uz, nTables, remaining = 0uz] mutable -> Opt<Pair> {
+            while (remaining == 0) {
+                if (i == nTables or s.ended())
+                    return NONE;
+                i++;
+
+                pairs = s;
+                /* version = */ pairs.nextU16be();
+                /* length = */ pairs.nextU16be();
+                u16 coverage = pairs.nextU16be();
+
+                u8 format = coverage >> 8;
+                if (format != 0)
+                    // We can't know the size of other formats, stop here.
+                    return NONE;
+
+                remaining = pairs.nextU16be();
+                /* searchRange = */ pairs.nextU16be();
+                /* entrySelector = */ pairs.nextU16be();
+                /* rangeShift = */ pairs.nextU16be();
+
+                // NOTE: The length field overflows in large tables, compute
+                //       the size of the subtable from the number of pairs.
+                s.skip(14 + remaining * 6);
+
+                if (not(coverage & HORIZONTAL) or (coverage & (MINIMUM | CROSS_STREAM)))
+                    remaining = 0;
+            }
+
+            remaining--;
+            Pair p;
+            p.left = pairs.nextU16be();
+            p.right = pairs.nextU16be();
+            p.value = pairs.nextI16be();
+            return p;
+        }};
+    }
+};
+
+} // namespace Ttf
@@ -0,0 +1,25 @@
+#include <karm-base/array.h>
+
+#include "unicode.h"
+
+namespace Karm::Text {
+
+namespace _Props {
+
+#include "defs/unicode-props.inc"
+
+} // namespace _Props
+
+UnicodeProps UnicodeProps::of(Rune rune) {
+    using namespace _Props;
+
+    // Out of range runes get the properties of an unassigned code point.
+    if (rune > 0x10FFFF)
+        rune = 0x10FFFF;
+
+    usize block = STAGE1[rune >> SHIFT];
+    usize index = STAGE2[(block << SHIFT) | (rune & ((1 << SHIFT) - 1))];
+    return {RECORDS[index]};
+}
+
+} // namespace Karm::Text
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <karm-base/rune.h>
+
+namespace Karm::Text {
+
+// https://www.unicode.org/reports/tr14/#Table1
+//
+// NOTE: The lookup table already resolves AI, SG, XX, SA and CJ as
+//       described in LB1, these classes are never returned.
+enum struct LineBreak : u8 {
+    BK,
+    CR,
+    LF,
+    CM,
+    NL,
+    SG,
+    WJ,
+    ZW,
+    GL,
+    SP,
+    ZWJ,
+    B2,
+    BA,
+    BB,
+    HY,
+    CB,
+    CL,
+    CP,
+    EX,
+    IN,
+    NS,
+    OP,
+    QU,
+    IS,
+    NU,
+    PO,
+    PR,
+    SY,
+    AI,
+    AL,
+    CJ,
+    EB,
+    EM,
+    H2,
+    H3,
+    HL,
+    ID,
+    JL,
+    JV,
+    JT,
+    RI,
+    SA,
+    XX,
+};
+
+// https://www.unicode.org/reports/tr29/#Grapheme_Cluster_Break_Property_Values
+enum struct GraphemeBreak : u8 {
+    OTHER,
+    CR,
+    LF,
+    CONTROL,
+    EXTEND,
+    ZWJ,
+    REGIONAL_INDICATOR,
+    PREPEND,
+    SPACING_MARK,
+    L,
+    V,
+    T,
+    LV,
+    LVT,
+};
+
+// https://www.unicode.org/reports/tr29/#Word_Break_Property_Values
+enum struct WordBreak : u8 {
+    OTHER,
+    CR,
+    LF,
+    NEWLINE,
+    EXTEND,
+    ZWJ,
+    REGIONAL_INDICATOR,
+    FORMAT,
+    KATAKANA,
+    HEBREW_LETTER,
+    ALETTER,
+    SINGLE_QUOTE,
+    DOUBLE_QUOTE,
+    MID_NUM_LET,
+    MID_LETTER,
+    MID_NUM,
+    NUMERIC,
+    EXTEND_NUM_LET,
+    WSEG_SPACE,
+};
+
+// The properties of a rune used for segmenting text, packed in 32 bits.
+struct UnicodeProps {
+    u32 _bits;
+
+    static UnicodeProps of(Rune rune);
+
+    LineBreak lineBreak() const {
+        return (LineBreak)(_bits & 0x3f);
+    }
+
+    GraphemeBreak graphemeBreak() const {
+        return (GraphemeBreak)((_bits >> 6) & 0xf);
+    }
+
+    WordBreak wordBreak() const {
+        return (WordBreak)((_bits >> 10) & 0x1f);
+    }
+
+    bool extendedPictographic() const {
+        return _bits & (1 << 15);
+    }
+
+    // East Asian Width is F, W or H.
+    bool eastAsianWide() const {
+        return _bits & (1 << 16);
+    }
+
+    // Extended pictographic code point not yet assigned.
+    bool reservedPictographic() const {
+        return _bits & (1 << 17);
+    }
+};
+
+} // namespace Karm::Text
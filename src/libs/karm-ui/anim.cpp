@@ -154,7 +154,7 @@ struct Carousel : public GroupNode<Carousel> {
         GroupNode::event(e);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
         for (auto &child : children()) {
             child->layout(r);
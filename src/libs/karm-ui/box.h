@@ -111,7 +111,7 @@ struct _Box : public ProxyNode<Crtp> {
         });
     }
 
-    void layout(Math::Recti rect) override {
+    void _layout(Math::Recti rect) override {
         rect = rect.shrink(boxStyle().margin);
         rect = rect.shrink(boxStyle().padding);
 
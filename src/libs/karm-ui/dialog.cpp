@@ -114,7 +114,7 @@ struct DialogLayer : public LeafNode<DialogLayer> {
         LeafNode<DialogLayer>::bubble(e);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         if (_shouldDialogClose) {
             if (_dialog) {
                 (*_dialog)->detach(this);
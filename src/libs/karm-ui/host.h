@@ -3,6 +3,7 @@
 #include <karm-app/host.h>
 #include <karm-base/ring.h>
 #include <karm-gfx/cpu/canvas.h>
+#include <karm-math/region.h>
 #include <karm-text/loader.h>
 
 #include "node.h"
@@ -14,7 +15,7 @@ struct Host : public Node {
     Child _root;
     Opt<Res<>> _res;
     Gfx::CpuCanvas _g;
-    Vec<Math::Recti> _dirty;
+    Math::Regioni _dirty;
     PerfGraph _perf;
 
     bool _shouldLayout{};
@@ -71,7 +72,10 @@ struct Host : public Node {
 
     void paint() {
         if (debugShowPerfGraph)
-            _dirty.pushBack({0, 0, 256, 100});
+            _dirty.add({0, 0, 256, 100});
+
+        _perf.frame(debugFrameStats);
+        debugFrameStats = {};
 
         _g.begin(mutPixels());
 
@@ -89,11 +93,11 @@ struct Host : public Node {
 
         _g.end();
 
-        flip(_dirty);
+        flip(_dirty.rects());
         _dirty.clear();
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _perf.record(PerfEvent::LAYOUT);
         _root->layout(r);
         auto elapsed = _perf.end();
@@ -117,7 +121,7 @@ struct Host : public Node {
 
     void bubble(App::Event &event) override {
         if (auto e = event.is<Node::PaintEvent>()) {
-            _dirty.pushBack(e->bound);
+            _dirty.add(e->bound);
             event.accept();
         } else if (auto e = event.is<Node::LayoutEvent>()) {
             _shouldLayout = true;
@@ -168,10 +172,10 @@ struct Host : public Node {
                 layout(bound());
                 _shouldLayout = false;
                 _shouldAnimate = true;
-                _dirty.pushBack(bound());
+                _dirty.add(bound());
             }
 
-            if (_dirty.len() > 0) {
+            if (not _dirty.empty()) {
                 paint();
                 _dirty.clear();
             }
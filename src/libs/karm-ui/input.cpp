@@ -270,6 +270,43 @@ Child button(OnPress onPress, Mdi::Icon i, Str t) {
 
 // MARK: Input -----------------------------------------------------------------
 
+static bool _sameProseStyle(Text::ProseStyle const &a, Text::ProseStyle const &b) {
+    return &*a.font.fontface == &*b.font.fontface and
+           a.font.fontsize == b.font.fontsize and
+           a.font.lineheight == b.font.lineheight and
+           a.align == b.align and
+           a.color == b.color and
+           a.wordwrap == b.wordwrap and
+           a.multiline == b.multiline;
+}
+
+static void _buildProse(Text::Prose &prose, Text::Model &model) {
+    model.iterChunks({0, model.len()}, [&](Slice<Rune> chunk) {
+        prose.append(chunk);
+    });
+    (void)model.takeChange();
+}
+
+// Only the runes the model changed are copied out of its buffer.
+static void _updateProse(Text::Prose &prose, Text::Model &model) {
+    auto change = model.takeChange();
+    if (not change)
+        return;
+
+    usize len = prose._runes.len();
+    if ((change->prefix or change->suffix) and change->prefix + change->suffix <= len) {
+        prose.replace(
+            {change->prefix, len - change->prefix - change->suffix},
+            model.runes({change->prefix, model.len() - change->prefix - change->suffix})
+        );
+    } else if (len) {
+        // The whole model is new, but its text might not be.
+        prose.assign(model.runes({0, model.len()}));
+    } else {
+        _buildProse(prose, model);
+    }
+}
+
 struct Input : public View<Input> {
     Text::ProseStyle _style;
 
@@ -277,25 +314,32 @@ struct Input : public View<Input> {
     OnChange<Text::Action> _onChange;
 
     Opt<Strong<Text::Prose>> _text;
+    bool _textDirty = false;
 
     Input(Text::ProseStyle style, Strong<Text::Model> model, OnChange<Text::Action> onChange)
         : _style(style), _model(model), _onChange(std::move(onChange)) {}
 
     void reconcile(Input &o) override {
+        if (not _sameProseStyle(_style, o._style))
+            _text = NONE;
+
         _style = o._style;
         _model = o._model;
         _onChange = std::move(o._onChange);
 
-        // NOTE: The model might have changed,
-        //       so we need to invalidate the presentation.
-        _text = NONE;
+        // NOTE: The model might have changed, the presentation is
+        //       updated from the first edited block.
+        _textDirty = true;
     }
 
     Text::Prose &_ensureText() {
         if (not _text) {
             _text = makeStrong<Text::Prose>(_style);
-            (*_text)->append(_model->runes());
+            _buildProse(**_text, *_model);
+        } else if (_textDirty) {
+            _updateProse(**_text, *_model);
         }
+        _textDirty = false;
         return **_text;
     }
 
@@ -322,9 +366,9 @@ struct Input : public View<Input> {
         }
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _ensureText().layout(bound.width);
-        View<Input>::layout(bound);
+        View<Input>::_layout(bound);
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint) override {
@@ -349,6 +393,7 @@ struct SimpleInput : public View<SimpleInput> {
     FocusListener _focus;
     Opt<Text::Model> _model;
     Opt<Strong<Text::Prose>> _prose;
+    bool _proseDirty = false;
 
     SimpleInput(Text::ProseStyle style, String text, OnChange<String> onChange)
         : _style(style),
@@ -356,13 +401,16 @@ struct SimpleInput : public View<SimpleInput> {
           _onChange(std::move(onChange)) {}
 
     void reconcile(SimpleInput &o) override {
+        if (not _sameProseStyle(_style, o._style))
+            _prose = NONE;
+
         _style = o._style;
         _model = o._model;
         _onChange = std::move(o._onChange);
 
-        // NOTE: The model might have changed,
-        //       so we need to invalidate the presentation.
-        _prose = NONE;
+        // NOTE: The model might have changed, the presentation is
+        //       updated from the first edited block.
+        _proseDirty = true;
     }
 
     Text::Model &_ensureModel() {
@@ -374,8 +422,11 @@ struct SimpleInput : public View<SimpleInput> {
     Text::Prose &_ensureText() {
         if (not _prose) {
             _prose = makeStrong<Text::Prose>(_style);
-            (*_prose)->append(_ensureModel().runes());
+            _buildProse(**_prose, _ensureModel());
+        } else if (_proseDirty) {
+            _updateProse(**_prose, _ensureModel());
         }
+        _proseDirty = false;
         return **_prose;
     }
 
@@ -402,7 +453,7 @@ struct SimpleInput : public View<SimpleInput> {
             e.accept();
             _ensureModel().reduce(*a);
             _text = _ensureModel().string();
-            _prose = NONE;
+            _proseDirty = true;
             if (_onChange)
                 _onChange(*this, _text);
             else
@@ -410,9 +461,9 @@ struct SimpleInput : public View<SimpleInput> {
         }
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _ensureText().layout(bound.width);
-        View<SimpleInput>::layout(bound);
+        View<SimpleInput>::_layout(bound);
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint) override {
@@ -445,7 +496,7 @@ struct Slider : public ProxyNode<Slider> {
         ProxyNode<Slider>::reconcile(o);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
         child().layout(_bound.hsplit(((r.width - r.height) * _value) + r.height).car);
     }
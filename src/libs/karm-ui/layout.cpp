@@ -85,7 +85,7 @@ struct Bound : public ProxyNode<Bound> {
         return _bound;
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _bound = bound;
         child().layout(bound);
     }
@@ -115,7 +115,7 @@ struct Placed : public ProxyNode<Placed> {
         return _bound;
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _bound = bound;
         auto place = _place;
         place.xy = place.xy + _bound.xy;
@@ -157,7 +157,7 @@ struct Align : public ProxyNode<Align> {
 
     Align(Math::Align align, Child child) : ProxyNode(child), _align(align) {}
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         auto childSize = child().size(
             bound.size(), _child.is<Grow>()
                               ? Hint::MAX
@@ -239,7 +239,7 @@ struct Sizing : public ProxyNode<Sizing> {
         ProxyNode<Sizing>::reconcile(o);
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _rect = bound;
         child().layout(bound);
     }
@@ -315,7 +315,7 @@ struct Insets : public ProxyNode<Insets> {
         }
     }
 
-    void layout(Math::Recti rect) override {
+    void _layout(Math::Recti rect) override {
         child().layout(rect.shrink(_insets));
     }
 
@@ -433,7 +433,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
         return (growTotal) / max(1, grows);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
 
         f64 growUnit = _computeGrowUnit(r);
@@ -595,7 +595,7 @@ struct GridLayout : public GroupNode<GridLayout> {
         child->layout(childRect);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
 
         // compute the dimensions of the grid
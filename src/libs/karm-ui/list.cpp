@@ -0,0 +1,429 @@
+#include "list.h"
+
+#include <karm-math/funcs.h>
+
+#include "anim.h"
+#include "funcs.h"
+
+namespace Karm::Ui {
+
+// MARK: List ------------------------------------------------------------------
+
+struct List : public LeafNode<List> {
+    static constexpr isize SCROLL_BAR_WIDTH = 4;
+    static constexpr isize SCROLL_BAR_MIN = 16;
+    static constexpr usize MAX_PASSES = 4;
+
+    struct Item {
+        usize index;
+        Child child;
+    };
+
+    ListStyle _style;
+    Opt<isize> _cellWidth; //< Only set for grids
+    usize _count;
+    ItemBuilder _builder;
+
+    Math::Recti _bound{};
+    usize _columns = 1;
+    Vec<Item> _items; //< Materialized items, sorted by index
+
+    // Only used when extents are estimated, starts before _validStarts are
+    // up to date with the measured extents.
+    Vec<isize> _extents;
+    Vec<isize> _starts;
+    usize _validStarts = 0;
+
+    bool _mouseIn = false;
+    bool _animated = false;
+    f64 _scroll = 0;
+    f64 _targetScroll = 0;
+    Easedf _scrollOpacity;
+
+    List(ListStyle style, Opt<isize> cellWidth, usize count, ItemBuilder builder)
+        : _style(style), _cellWidth(cellWidth), _count(count), _builder(std::move(builder)) {
+        _syncExtents();
+    }
+
+    ~List() {
+        for (auto &item : _items)
+            item.child->detach(this);
+    }
+
+    void reconcile(List &o) override {
+        _style = o._style;
+        _cellWidth = o._cellWidth;
+        _count = o._count;
+        _builder = std::move(o._builder);
+
+        // Only the items in view are rebuilt, the next layout takes care
+        // of whatever came into view.
+        Vec<Item> items;
+        items.ensure(_items.len());
+        for (auto &item : _items) {
+            if (item.index >= _count) {
+                item.child->detach(this);
+                continue;
+            }
+
+            auto child = item.child->reconcile(_builder(item.index)).unwrapOr(item.child);
+            if (&child.unwrap() != &item.child.unwrap())
+                item.child->detach(this);
+            child->attach(this);
+            items.pushBack({item.index, child});
+        }
+        _items = std::move(items);
+        _syncExtents();
+    }
+
+    // MARK: Geometry ----------------------------------------------------------
+
+    usize _rows() const {
+        return (_count + _columns - 1) / _columns;
+    }
+
+    isize _pitch() const {
+        return _style.extent + _style.gaps.y;
+    }
+
+    isize _columnWidth() const {
+        if (_cellWidth)
+            return *_cellWidth;
+        return _bound.width;
+    }
+
+    void _syncExtents() {
+        if (not _style.estimated) {
+            _extents.clear();
+            _starts.clear();
+            _validStarts = 0;
+            return;
+        }
+
+        // Rows that are still there keep their measured extent.
+        auto rows = _rows();
+        auto kept = min(_extents.len(), rows);
+        _extents.resize(rows, _style.extent);
+        _starts.resize(rows + 1, 0);
+        _validStarts = clamp(_validStarts, 1uz, kept + 1);
+    }
+
+    isize _rowStart(usize row) {
+        if (not _style.estimated)
+            return (isize)row * _pitch();
+
+        for (; _validStarts <= row; _validStarts++)
+            _starts[_validStarts] = _starts[_validStarts - 1] + _extents[_validStarts - 1] + _style.gaps.y;
+        return _starts[row];
+    }
+
+    isize _rowExtent(usize row) const {
+        if (not _style.estimated)
+            return _style.extent;
+        return _extents[row];
+    }
+
+    void _setRowExtent(usize row, isize extent) {
+        if (_extents[row] == extent)
+            return;
+        _extents[row] = extent;
+        _validStarts = min(_validStarts, row + 1);
+    }
+
+    usize _rowAt(isize offset) {
+        auto rows = _rows();
+        if (rows == 0 or offset <= 0)
+            return 0;
+
+        if (not _style.estimated)
+            return min((usize)(offset / max(_pitch(), 1)), rows - 1);
+
+        _rowStart(rows - 1);
+        usize lo = 0;
+        usize hi = rows;
+        while (hi - lo > 1) {
+            usize mid = lo + (hi - lo) / 2;
+            if (_starts[mid] <= offset)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    isize _contentHeight() {
+        auto rows = _rows();
+        if (rows == 0)
+            return 0;
+        return _rowStart(rows - 1) + _rowExtent(rows - 1);
+    }
+
+    Math::Recti _itemBound(usize index) {
+        auto row = index / _columns;
+        auto col = index % _columns;
+        return {
+            _bound.x + (isize)col * (_columnWidth() + _style.gaps.x),
+            _bound.y + _rowStart(row),
+            _columnWidth(),
+            _rowExtent(row),
+        };
+    }
+
+    // MARK: Items -------------------------------------------------------------
+
+    // Build the items that came into view, the ones that went out of it are
+    // recycled for the new ones when possible.
+    bool _materialize() {
+        urange range = {};
+        if (auto rows = _rows()) {
+            auto top = (isize)-_scroll;
+            auto firstRow = _rowAt(top);
+            auto lastRow = _rowAt(top + _bound.height);
+            firstRow = firstRow > _style.overscan ? firstRow - _style.overscan : 0;
+            lastRow = min(lastRow + _style.overscan, rows - 1);
+            range = urange::fromStartEnd(firstRow * _columns, min((lastRow + 1) * _columns, _count));
+        }
+
+        if (_items.len() == range.size and
+            (range.empty() or (_items[0].index == range.start and last(_items).index + 1 == range.end())))
+            return false;
+
+        Children spares;
+        for (auto &item : _items)
+            if (not range.contains(item.index))
+                spares.pushBack(item.child);
+
+        Vec<Item> items;
+        items.ensure(range.size);
+        usize j = 0;
+        for (usize i : range.iter()) {
+            while (j < _items.len() and _items[j].index < i)
+                j++;
+
+            if (j < _items.len() and _items[j].index == i) {
+                items.pushBack({i, _items[j].child});
+                continue;
+            }
+
+            auto child = _builder(i);
+            if (any(spares)) {
+                auto spare = spares.popBack();
+                mouseLeave(*spare);
+                if (auto other = spare->reconcile(child)) {
+                    spare->detach(this);
+                    child = other.take();
+                } else {
+                    child = spare;
+                }
+            }
+            child->attach(this);
+            items.pushBack({i, child});
+        }
+
+        for (auto &spare : spares)
+            spare->detach(this);
+
+        _items = std::move(items);
+        return true;
+    }
+
+    // Measure the materialized rows, the scroll offset is adjusted so that
+    // the first row in view doesn't move.
+    void _measure() {
+        if (not _style.estimated or isEmpty(_items))
+            return;
+
+        auto top = (isize)-_scroll;
+        auto anchor = _rowAt(top);
+        auto delta = top - _rowStart(anchor);
+
+        usize i = 0;
+        while (i < _items.len()) {
+            auto row = _items[i].index / _columns;
+            isize extent = 0;
+            for (; i < _items.len() and _items[i].index / _columns == row; i++) {
+                auto size = _items[i].child->size({_columnWidth(), _style.extent}, Hint::MIN);
+                extent = max(extent, size.y);
+            }
+            _setRowExtent(row, extent);
+        }
+
+        auto shift = (f64)(_rowStart(anchor) + delta - top);
+        _scroll -= shift;
+        _targetScroll -= shift;
+    }
+
+    void _update(bool relayout) {
+        if (relayout)
+            _measure();
+
+        // Measuring can bring more rows into view, or push some out.
+        for (usize i = 0; i < MAX_PASSES and _materialize(); i++) {
+            _measure();
+            relayout = true;
+        }
+
+        if (not relayout)
+            return;
+
+        for (auto &item : _items)
+            item.child->layout(_itemBound(item.index));
+    }
+
+    // MARK: Scrolling ---------------------------------------------------------
+
+    Math::Vec2i _offset() const {
+        return {0, (isize)_scroll};
+    }
+
+    void scroll(f64 s) {
+        auto maxScroll = max(_contentHeight() - _bound.height, 0);
+        _targetScroll = clamp(s, -(f64)maxScroll, 0.0);
+        if (Math::abs(_scroll - _targetScroll) < 0.5) {
+            _scroll = _targetScroll;
+            _animated = false;
+        } else {
+            _animated = true;
+        }
+    }
+
+    bool canVScroll() {
+        return _contentHeight() > _bound.height;
+    }
+
+    Math::Recti vTrack() {
+        return Math::Recti{_bound.end() - SCROLL_BAR_WIDTH, _bound.top(), SCROLL_BAR_WIDTH, _bound.height};
+    }
+
+    // MARK: Node --------------------------------------------------------------
+
+    void paint(Gfx::Canvas &g, Math::Recti r) override {
+        g.push();
+        g.clip(_bound);
+        g.origin(_offset().cast<f64>());
+        r.xy = r.xy - _offset();
+        for (auto &item : _items) {
+            if (not item.child->bound().colide(r))
+                continue;
+            item.child->paint(g, r);
+        }
+        g.pop();
+
+        if (debugShowScrollBounds)
+            g.plot(_bound, Gfx::CYAN);
+
+        if (not canVScroll())
+            return;
+
+        // The content can be huge, keep the bar big enough to be seen.
+        auto content = _contentHeight();
+        auto barHeight = max(_bound.height * _bound.height / content, min(SCROLL_BAR_MIN, _bound.height));
+        auto barY = _bound.top() + (isize)(-_scroll * (_bound.height - barHeight) / (content - _bound.height));
+
+        g.push();
+        g.clip(_bound);
+        g.fillStyle(Ui::GRAY500.withOpacity(0.5 * clamp01(_scrollOpacity.value())));
+        g.fill(Math::Recti{_bound.end() - SCROLL_BAR_WIDTH, barY, SCROLL_BAR_WIDTH, barHeight});
+        g.pop();
+    }
+
+    void _dispatch(App::Event &e) {
+        for (auto &item : _items) {
+            if (e.accepted())
+                return;
+            item.child->event(e);
+        }
+    }
+
+    void event(App::Event &e) override {
+        if (_scrollOpacity.needRepaint(*this, e) and canVScroll())
+            shouldRepaint(*parent(), vTrack());
+
+        if (auto me = e.is<App::MouseEvent>()) {
+            if (_bound.contains(me->pos)) {
+                _mouseIn = true;
+
+                me->pos = me->pos - _offset();
+                _dispatch(e);
+                me->pos = me->pos + _offset();
+
+                if (not e.accepted() and me->type == App::MouseEvent::SCROLL) {
+                    scroll(_scroll + me->scroll.y * 128);
+                    shouldAnimate(*this);
+                    _scrollOpacity.delay(0).animate(*this, 1, 0.3);
+                }
+            } else if (_mouseIn) {
+                _mouseIn = false;
+                for (auto &item : _items)
+                    mouseLeave(*item.child);
+            }
+        } else if (e.is<Node::AnimateEvent>() and _animated) {
+            shouldRepaint(*parent(), _bound);
+
+            _scroll += (_targetScroll - _scroll) * (e.unwrap<Node::AnimateEvent>().dt * 12);
+
+            if (Math::abs(_scroll - _targetScroll) < 0.5) {
+                _scroll = _targetScroll;
+                _animated = false;
+                _scrollOpacity.delay(1.0).animate(*this, 0, 0.3);
+            } else {
+                shouldAnimate(*this);
+            }
+
+            _update(false);
+            _dispatch(e);
+        } else {
+            _dispatch(e);
+        }
+    }
+
+    void bubble(App::Event &e) override {
+        if (auto pe = e.is<Node::PaintEvent>()) {
+            pe->bound.xy = pe->bound.xy + _offset();
+            pe->bound = pe->bound.clipTo(_bound);
+        }
+
+        LeafNode::bubble(e);
+    }
+
+    void _layout(Math::Recti r) override {
+        usize columns = 1;
+        if (_cellWidth)
+            columns = (usize)max((r.width + _style.gaps.x) / max(*_cellWidth + _style.gaps.x, 1), 1);
+
+        // Rows are made of other items when the number of columns changes.
+        if (columns != _columns) {
+            _columns = columns;
+            _extents.clear();
+            _validStarts = 0;
+            _syncExtents();
+        }
+
+        _bound = r;
+        _update(true);
+        scroll(_targetScroll);
+    }
+
+    Math::Vec2i size(Math::Vec2i s, Hint hint) override {
+        // Measuring every item would defeat the purpose, the estimate
+        // is good enough.
+        isize height = _contentHeight();
+        if (hint == Hint::MIN)
+            return {_cellWidth.unwrapOrDefault(0), min(height, s.y)};
+        return {s.x, height};
+    }
+
+    Math::Recti bound() override {
+        return _bound;
+    }
+};
+
+Child list(ListStyle style, usize count, ItemBuilder builder) {
+    return makeStrong<List>(style, NONE, count, std::move(builder));
+}
+
+Child grid(ListStyle style, isize cellWidth, usize count, ItemBuilder builder) {
+    return makeStrong<List>(style, cellWidth, count, std::move(builder));
+}
+
+} // namespace Karm::Ui
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "node.h"
+
+namespace Karm::Ui {
+
+// MARK: List ------------------------------------------------------------------
+
+// Lists and grids of items built on demand, only the items in view (plus
+// an overscan on each side) have a node, which are recycled while scrolling.
+// This is what should be used for collections that can grow large, like the
+// content of a directory.
+
+using ItemBuilder = Func<Child(usize)>;
+
+struct ListStyle {
+    isize extent = 32;      //< Extent of an item, or of a row in a grid
+    bool estimated = false; //< Items are measured when built, the extent is only a guess
+    Math::Vec2i gaps{};
+    usize overscan = 4; //< Number of rows materialized on each side of the view
+
+    static ListStyle fixed(isize extent, isize gaps = 0) {
+        return {.extent = extent, .gaps = gaps};
+    }
+
+    static ListStyle estimate(isize extent, isize gaps = 0) {
+        return {.extent = extent, .estimated = true, .gaps = gaps};
+    }
+
+    ListStyle withOverscan(usize overscan) const {
+        ListStyle style = *this;
+        style.overscan = overscan;
+        return style;
+    }
+};
+
+Child list(ListStyle style, usize count, ItemBuilder builder);
+
+// Items are laid out left to right in as many columns of `cellWidth` as
+// fit, then top to bottom.
+//
+// NOTE: This is not related to the `grid(GridStyle, Children)` layout,
+//       which places a known set of children in tracks.
+Child grid(ListStyle style, isize cellWidth, usize count, ItemBuilder builder);
+
+} // namespace Karm::Ui
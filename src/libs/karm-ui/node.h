@@ -26,6 +26,15 @@ extern bool debugShowScrollBounds;
 extern bool debugShowPerfGraph;
 extern int debugNodeCount;
 
+struct FrameStats {
+    usize built;
+    usize reconciled;
+    usize laidOut;
+};
+
+// Counted since the last frame, shown by the perf graph.
+extern FrameStats debugFrameStats;
+
 struct Node;
 
 using Child = Strong<Node>;
@@ -53,6 +62,7 @@ struct Node : public App::Dispatch {
 
     Node() {
         debugNodeCount++;
+        debugFrameStats.built++;
     }
 
     virtual ~Node() {
@@ -67,7 +77,14 @@ struct Node : public App::Dispatch {
 
     virtual void paint(Gfx::Canvas &, Math::Recti) {}
 
-    virtual void layout(Math::Recti) {}
+    // Nodes override _layout(), layout() counts the nodes laid out in a
+    // frame before forwarding to it.
+    void layout(Math::Recti r) {
+        debugFrameStats.laidOut++;
+        _layout(r);
+    }
+
+    virtual void _layout(Math::Recti) {}
 
     virtual Math::Vec2i size(Math::Vec2i s, Hint) { return s; }
 
@@ -129,6 +146,7 @@ struct LeafNode : public Node {
 
         reconcile(other.unwrap<Crtp>());
         other->_consumed = true;
+        debugFrameStats.reconciled++;
 
         return NONE;
     }
@@ -184,10 +202,87 @@ struct GroupNode : public LeafNode<Crtp> {
         return _children;
     }
 
+    static bool _keyed(Children const &children) {
+        for (auto &c : children)
+            if (c->key())
+                return true;
+        return false;
+    }
+
+    // Keyed children are paired by key, the others by order among
+    // themselves, so moving or inserting a keyed child doesn't rebuild
+    // its siblings.
+    void _reconcileKeyed(Children &them) {
+        auto &us = children();
+
+        Vec<Cons<Hash, usize>> keyed;
+        Vec<usize> unkeyed;
+        for (usize i = 0; i < us.len(); i++) {
+            if (auto k = us[i]->key())
+                keyed.pushBack({*k, i});
+            else
+                unkeyed.pushBack(i);
+        }
+        sort(keyed, [](auto const &a, auto const &b) {
+            return a.car <=> b.car;
+        });
+
+        Vec<bool> used;
+        used.resize(us.len(), false);
+
+        auto match = [&](Key key, usize &nextUnkeyed) -> Opt<usize> {
+            if (not key) {
+                if (nextUnkeyed < unkeyed.len())
+                    return unkeyed[nextUnkeyed++];
+                return NONE;
+            }
+
+            usize lo = 0;
+            usize hi = keyed.len();
+            while (lo < hi) {
+                usize mid = lo + (hi - lo) / 2;
+                if (keyed[mid].car < *key)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            // Children sharing a key are paired in order.
+            for (; lo < keyed.len() and keyed[lo].car == *key; lo++)
+                if (not used[keyed[lo].cdr])
+                    return keyed[lo].cdr;
+            return NONE;
+        };
+
+        Children res;
+        res.ensure(them.len());
+        usize nextUnkeyed = 0;
+        for (auto &c : them) {
+            auto child = c;
+            if (auto i = match(c->key(), nextUnkeyed)) {
+                used[*i] = true;
+                child = us[*i]->reconcile(c).unwrapOr(us[*i]);
+            }
+            child->attach(this);
+            res.pushBack(child);
+        }
+
+        for (usize i = 0; i < us.len(); i++)
+            if (not used[i])
+                us[i]->detach(this);
+
+        us = std::move(res);
+    }
+
     void reconcile(Crtp &o) override {
         auto &us = children();
         auto &them = o.children();
 
+        if (_keyed(us) or _keyed(them)) {
+            _reconcileKeyed(them);
+            return;
+        }
+
         for (usize i = 0; i < them.len(); i++) {
             if (i < us.len()) {
                 us.replace(i, us[i]->reconcile(them[i]).unwrapOr(us[i]));
@@ -220,7 +315,7 @@ struct GroupNode : public LeafNode<Crtp> {
         }
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
 
         for (auto &child : children())
@@ -271,7 +366,7 @@ struct ProxyNode : public LeafNode<Crtp> {
         child().event(e);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         child().layout(r);
     }
 
@@ -4,6 +4,8 @@
 #include <karm-sys/time.h>
 #include <karm-text/prose.h>
 
+#include "node.h"
+
 namespace Karm::Ui {
 
 static constexpr auto FRAME_RATE = 60;
@@ -46,6 +48,7 @@ struct PerfGraph {
     usize _index{};
     Array<PerfRecord, 256> _records{};
     f64 _frameTime = 1;
+    FrameStats _stats{};
 
     void record(PerfEvent e) {
         auto now = Sys::now();
@@ -64,6 +67,11 @@ struct PerfGraph {
         return elapsed;
     }
 
+    // Keep the counters of the frame that just ended.
+    void frame(FrameStats stats) {
+        _stats = stats;
+    }
+
     f64 fps() {
         return 1000.0 / _frameTime;
     }
@@ -92,8 +100,12 @@ struct PerfGraph {
             );
         }
 
-        auto text = Io::format("FPS: {}", (isize)fps()).take();
-        Text::Prose gText{Text::ProseStyle{.font = Text::Font::fallback()}};
+        auto fmt = Io::format(
+            "FPS: {}\nbuilt: {} reconciled: {} laid out: {}",
+            (isize)fps(), _stats.built, _stats.reconciled, _stats.laidOut
+        );
+        auto text = fmt.take();
+        Text::Prose gText{Text::ProseStyle{.font = Text::Font::fallback(), .multiline = true}};
         gText.append(text.str());
         gText.layout(256);
 
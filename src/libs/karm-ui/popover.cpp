@@ -99,8 +99,8 @@ struct PopoverLayer : public ProxyNode<PopoverLayer> {
         LeafNode<PopoverLayer>::bubble(event);
     }
 
-    void layout(Math::Recti r) override {
-        ProxyNode::layout(r);
+    void _layout(Math::Recti r) override {
+        ProxyNode::_layout(r);
 
         if (_shouldPopoverClose) {
             if (_popover) {
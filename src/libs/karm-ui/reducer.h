@@ -127,7 +127,7 @@ struct Reducer :
         }
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         ensureBuild();
         (*_child)->layout(r);
     }
@@ -182,4 +182,81 @@ inline Child state(auto build) {
 template <typename T>
 using Action = SharedFunc<void(Ui::Node &, T const &)>;
 
+// MARK: Memo ------------------------------------------------------------------
+
+// Only rebuilds its subtree when the hash of its dependencies changes, and
+// only lays it out again when it's given a new bound or something in it
+// asked for a layout.
+struct Memo : public LeafNode<Memo> {
+    Hash _deps;
+    Slot _build;
+    Opt<Child> _child;
+    Opt<Math::Recti> _laidOut;
+
+    Memo(Hash deps, Slot build)
+        : _deps(deps), _build(std::move(build)) {}
+
+    ~Memo() {
+        if (_child)
+            (*_child)->detach(this);
+    }
+
+    Node &child() {
+        if (not _child) {
+            _child = _build();
+            (*_child)->attach(this);
+        }
+        return **_child;
+    }
+
+    void reconcile(Memo &o) override {
+        _build = std::move(o._build);
+        bool changed = _deps != o._deps;
+        _deps = o._deps;
+        if (not changed or not _child)
+            return;
+
+        _laidOut = NONE;
+        auto tmp = (*_child)->reconcile(_build());
+        if (tmp) {
+            (*_child)->detach(this);
+            _child = tmp;
+            (*_child)->attach(this);
+        }
+    }
+
+    void paint(Gfx::Canvas &g, Math::Recti r) override {
+        child().paint(g, r);
+    }
+
+    void event(App::Event &e) override {
+        child().event(e);
+    }
+
+    void bubble(App::Event &e) override {
+        if (e.is<Node::LayoutEvent>())
+            _laidOut = NONE;
+        LeafNode<Memo>::bubble(e);
+    }
+
+    void _layout(Math::Recti r) override {
+        if (_laidOut and _laidOut->xy == r.xy and _laidOut->wh == r.wh)
+            return;
+        child().layout(r);
+        _laidOut = r;
+    }
+
+    Math::Vec2i size(Math::Vec2i s, Hint hint) override {
+        return child().size(s, hint);
+    }
+
+    Math::Recti bound() override {
+        return child().bound();
+    }
+};
+
+inline Child memo(Hashable auto const &deps, Slot build) {
+    return makeStrong<Memo>(hash(deps), std::move(build));
+}
+
 } // namespace Karm::Ui
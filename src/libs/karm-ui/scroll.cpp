@@ -145,7 +145,7 @@ struct Scroll : public ProxyNode<Scroll> {
         ProxyNode::bubble(e);
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
         auto childSize = child().size(_bound.size(), Hint::MAX);
         if (_orient == Math::Orien::HORIZONTAL) {
@@ -214,7 +214,7 @@ struct Clip : public ProxyNode<Clip> {
         g.pop();
     }
 
-    void layout(Math::Recti r) override {
+    void _layout(Math::Recti r) override {
         _bound = r;
         auto childSize = child().size(_bound.size(), Hint::MAX);
         if (_orient == Math::Orien::HORIZONTAL) {
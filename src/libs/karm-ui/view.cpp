@@ -1,6 +1,7 @@
 #include <karm-text/loader.h>
 
 #include "box.h"
+#include "funcs.h"
 #include "view.h"
 
 namespace Karm::Ui {
@@ -242,9 +243,9 @@ struct Text : public View<Text> {
             g.plot(bound(), Gfx::CYAN);
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _prose->layout(bound.width);
-        View<Text>::layout(bound);
+        View<Text>::_layout(bound);
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint) override {
@@ -318,7 +319,7 @@ struct Image : public View<Image> {
             g.fillStyle(_image.pixels());
             g.fill(bound(), *_radii);
         } else {
-            g.blit(bound(), _image);
+            g.blit(bound(), _image.surface());
         }
 
         if (debugShowLayoutBounds)
@@ -340,6 +341,66 @@ Child image(Karm::Image::Picture image, Math::Radiif radii) {
     return makeStrong<Image>(image, radii);
 }
 
+struct AnimatedImage : public View<AnimatedImage> {
+    Strong<Karm::Image::Animation> _animation;
+    f64 _elapsed = 0;
+
+    AnimatedImage(Strong<Karm::Image::Animation> animation)
+        : _animation(animation) {}
+
+    void reconcile(AnimatedImage &o) override {
+        if (&*_animation != &*o._animation) {
+            _animation = o._animation;
+            _elapsed = 0;
+        }
+        View<AnimatedImage>::reconcile(o);
+    }
+
+    void paint(Gfx::Canvas &g, Math::Recti) override {
+        g.push();
+        g.blit(bound(), _animation->surface());
+
+        if (debugShowLayoutBounds)
+            g.plot(bound(), Gfx::CYAN);
+
+        g.pop();
+    }
+
+    void event(App::Event &e) override {
+        auto ae = e.is<Node::AnimateEvent>();
+        if (not ae or _animation->done())
+            return;
+
+        // Frames that should already be gone are skipped, so that the
+        // animation keeps its pace when frames can't be painted in time.
+        _elapsed += ae->dt;
+        bool changed = false;
+        while (not _animation->done()) {
+            f64 delay = _animation->delay().toMSecs() / 1000.0;
+            if (_elapsed < delay)
+                break;
+            _elapsed -= delay;
+            if (not _animation->next()) {
+                logWarn("could not decode the next frame of the animation");
+                return;
+            }
+            changed = true;
+        }
+
+        if (changed)
+            shouldRepaint(*this);
+        shouldAnimate(*this);
+    }
+
+    Math::Vec2i size(Math::Vec2i, Hint) override {
+        return _animation->bound().size().cast<isize>();
+    }
+};
+
+Child image(Strong<Karm::Image::Animation> animation) {
+    return makeStrong<AnimatedImage>(animation);
+}
+
 // MARK: Canvas ----------------------------------------------------------------
 
 struct Canvas : public View<Canvas> {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-gfx/icon.h>
+#include <karm-image/animation.h>
 #include <karm-image/picture.h>
 #include <karm-scene/base.h>
 #include <karm-text/prose.h>
@@ -19,7 +20,7 @@ struct View : public LeafNode<Crtp> {
         return _bound;
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _bound = bound;
     }
 };
@@ -117,6 +118,10 @@ Child image(Image::Picture image);
 
 Child image(Image::Picture image, Math::Radiif radii);
 
+// Play the animation, it's shared with whoever else has it, which then sees
+// the same frames.
+Child image(Strong<Image::Animation> animation);
+
 // MARK: Canvas ----------------------------------------------------------------
 
 using OnPaint = Func<void(Gfx::Canvas &g, Math::Vec2i size)>;
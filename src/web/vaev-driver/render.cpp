@@ -1,5 +1,7 @@
+#include <karm-scene/layer.h>
 #include <karm-scene/stack.h>
 #include <karm-sys/time.h>
+#include <karm-text/shaping.h>
 #include <vaev-layout/builder.h>
 #include <vaev-layout/layout.h>
 #include <vaev-layout/paint.h>
@@ -54,10 +56,15 @@ RenderResult render(Markup::Document const &dom, Style::Media const &media, Layo
 
     elapsed = Sys::now() - start;
     logDebugIf(DEBUG_RENDER, "layout tree layout time: {}", elapsed);
+    logDebugIf(DEBUG_RENDER, "shaping cache: {}", Text::ShapingCache::global().stats());
 
     auto paintStart = Sys::now();
     Layout::paint(root, *sceneRoot);
-    sceneRoot->prepare();
+
+    // NOTE: The scene is kept around until the next relayout, caching it
+    //       lets scrolling composite bitmaps instead of replaying it.
+    auto sceneLayer = makeStrong<Scene::Layer>(sceneRoot);
+    sceneLayer->prepare();
 
     elapsed = Sys::now() - paintStart;
     logDebugIf(DEBUG_RENDER, "layout tree paint time: {}", elapsed);
@@ -65,7 +72,7 @@ RenderResult render(Markup::Document const &dom, Style::Media const &media, Layo
     return {
         std::move(stylebook),
         makeStrong<Layout::Box>(std::move(tree.root)),
-        sceneRoot,
+        sceneLayer,
         makeStrong<Layout::Frag>(std::move(root))
     };
 }
@@ -9,10 +9,12 @@ Output inlineLayout(Tree &, Box &box, Input input) {
     auto &prose = *box.content.unwrap<Strong<Text::Prose>>("inlineLayout");
 
     auto inlineSize = input.knownSize.x.unwrapOrElse([&] {
+        // NOTE: Intrinsic widths are queried from the measured blocks, so
+        //       that the prose doesn't have to be wrapped at an extreme width.
         if (input.intrinsic == IntrinsicSize::MIN_CONTENT) {
-            return 0_px;
+            return Px::fromFloatCeil(prose.minContentWidth());
         } else if (input.intrinsic == IntrinsicSize::MAX_CONTENT) {
-            return Limits<Px>::MAX;
+            return Px::fromFloatCeil(prose.maxContentWidth());
         } else {
             return input.availableSpace.x;
         }
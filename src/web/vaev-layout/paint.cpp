@@ -1,5 +1,6 @@
 #include <karm-scene/box.h>
 #include <karm-scene/image.h>
+#include <karm-scene/layer.h>
 #include <karm-scene/text.h>
 
 #include "frag.h"
@@ -134,9 +135,13 @@ static void _paintStackingContext(Frag &frag, Scene::Stack &stack) {
 
 static void _establishStackingContext(Frag &frag, Scene::Stack &stack) {
     auto innerStack = makeStrong<Scene::Stack>();
-    innerStack->zIndex = frag.style().zIndex.value;
     _paintStackingContext(frag, *innerStack);
-    stack.add(std::move(innerStack));
+
+    // Stacking contexts are painted atomically, which makes them a good
+    // candidate for being cached as a whole.
+    auto layer = makeStrong<Scene::Layer>(std::move(innerStack));
+    layer->zIndex = frag.style().zIndex.value;
+    stack.add(std::move(layer));
 }
 
 void paint(Frag &frag, Scene::Stack &stack) {
@@ -266,8 +266,10 @@ struct HtmlParser : public HtmlSink {
     void accept(HtmlToken const &t) override;
 
     void write(Str str) {
-        for (auto r : iterRunes(str))
-            _lexer.consume(r);
+        forEachRuneChunk(str, [&](Slice<Rune> runes) {
+            for (auto r : runes)
+                _lexer.consume(r);
+        });
     }
 };
 
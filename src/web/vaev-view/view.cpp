@@ -74,9 +74,9 @@ struct View : public Ui::View<View> {
         g.pop();
     }
 
-    void layout(Math::Recti bound) override {
+    void _layout(Math::Recti bound) override {
         _renderResult = NONE;
-        Ui::View<View>::layout(bound);
+        Ui::View<View>::_layout(bound);
     }
 
     Math::Vec2i size(Math::Vec2i size, Ui::Hint) override {